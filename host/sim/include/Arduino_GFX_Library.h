@@ -0,0 +1,79 @@
+#pragma once
+#include "Arduino.h"
+
+// Arduino_GFX drawing calls the firmware makes. Nothing is rendered and
+// drawing takes no simulated time.
+class Arduino_DataBus {
+public:
+    virtual ~Arduino_DataBus() {}
+};
+
+class Arduino_ESP32QSPI : public Arduino_DataBus {
+public:
+    Arduino_ESP32QSPI(int8_t cs, int8_t sck, int8_t mosi, int8_t miso, int8_t quadwp, int8_t quadhd,
+                      bool is_shared_interface = false) {
+        (void)cs; (void)sck; (void)mosi; (void)miso; (void)quadwp; (void)quadhd; (void)is_shared_interface;
+    }
+};
+
+class Arduino_GFX : public Print {
+protected:
+    int16_t _width;
+    int16_t _height;
+    uint8_t _rotation = 0;
+    int16_t cursor_x = 0;
+    int16_t cursor_y = 0;
+    float text_size = 1.0f;
+    uint16_t text_color = 0xFFFF;
+
+public:
+    Arduino_GFX(int16_t w, int16_t h) : _width(w), _height(h) {}
+
+    virtual bool begin(int32_t speed = 0) { (void)speed; return true; }
+    size_t write(uint8_t c) override;
+
+    int16_t width() const { return (_rotation & 1) ? _height : _width; }
+    int16_t height() const { return (_rotation & 1) ? _width : _height; }
+    void setRotation(uint8_t r) { _rotation = r & 3; }
+    void setCursor(int16_t x, int16_t y) { cursor_x = x; cursor_y = y; }
+    void setTextColor(uint16_t c) { text_color = c; }
+    void setTextColor(uint16_t c, uint16_t bg) { text_color = c; (void)bg; }
+    void setTextSize(float s) { text_size = s; }
+
+    void startWrite() {}
+    void endWrite() {}
+    void fillScreen(uint16_t color) { (void)color; }
+    void drawPixel(int16_t x, int16_t y, uint16_t color) { (void)x; (void)y; (void)color; }
+    void drawLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t color) {
+        (void)x0; (void)y0; (void)x1; (void)y1; (void)color;
+    }
+    void drawRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+        (void)x; (void)y; (void)w; (void)h; (void)color;
+    }
+    void fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+        (void)x; (void)y; (void)w; (void)h; (void)color;
+    }
+    void drawCircle(int16_t x, int16_t y, int16_t r, uint16_t color) { (void)x; (void)y; (void)r; (void)color; }
+    void fillCircle(int16_t x, int16_t y, int16_t r, uint16_t color) { (void)x; (void)y; (void)r; (void)color; }
+};
+
+class Arduino_CO5300 : public Arduino_GFX {
+private:
+    bool on = false;
+    uint8_t brightness = 0;
+
+public:
+    Arduino_CO5300(Arduino_DataBus* bus, int8_t rst = -1, uint8_t r = 0, int16_t w = 480, int16_t h = 480,
+                   uint8_t col_offset1 = 0, uint8_t row_offset1 = 0, uint8_t col_offset2 = 0, uint8_t row_offset2 = 0)
+        : Arduino_GFX(w, h) {
+        (void)bus; (void)rst; (void)col_offset1; (void)row_offset1; (void)col_offset2; (void)row_offset2;
+        setRotation(r);
+    }
+
+    bool begin(int32_t speed = 0) override { (void)speed; on = true; return true; }
+    void displayOn() { on = true; }
+    void displayOff() { on = false; }
+    void setBrightness(uint8_t value) { brightness = value; }
+    bool isOn() const { return on; }
+    uint8_t getBrightness() const { return brightness; }
+};
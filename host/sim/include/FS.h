@@ -0,0 +1,62 @@
+#pragma once
+#include <memory>
+
+#include "Arduino.h"
+
+#define FILE_READ "r"
+#define FILE_WRITE "w"
+#define FILE_APPEND "a"
+
+namespace fs {
+    struct FileImpl;
+
+    enum SeekMode { SeekSet = 0, SeekCur = 1, SeekEnd = 2 };
+
+    // Handle to an open file; copies share the open file, as in arduino-esp32
+    class File : public Stream {
+    private:
+        std::shared_ptr<FileImpl> impl;
+
+    public:
+        File() {}
+        explicit File(std::shared_ptr<FileImpl> impl) : impl(impl) {}
+
+        size_t write(uint8_t c) override;
+        size_t write(const uint8_t* buffer, size_t size) override;
+        using Print::write;
+
+        int available() override;
+        int read() override;
+        int peek() override;
+        void flush() override {}
+        size_t read(uint8_t* buffer, size_t size);
+
+        bool seek(uint32_t pos, SeekMode mode = SeekSet);
+        size_t position() const;
+        size_t size() const;
+        void close();
+        operator bool() const;
+        bool isDirectory() const;
+        const char* path() const;
+    };
+
+    // Flash file system held in host memory; its contents survive simulated resets
+    class FS {
+    public:
+        File open(const char* path, const char* mode = FILE_READ, bool create = false);
+        File open(const String& path, const char* mode = FILE_READ, bool create = false) {
+            return open(path.c_str(), mode, create);
+        }
+        bool exists(const char* path);
+        bool exists(const String& path) { return exists(path.c_str()); }
+        bool remove(const char* path);
+        bool remove(const String& path) { return remove(path.c_str()); }
+        bool rename(const char* from, const char* to);
+
+    protected:
+        bool mounted = false;
+    };
+}
+
+using fs::File;
+using fs::FS;
@@ -0,0 +1,21 @@
+#pragma once
+#include "Stream.h"
+
+// USB Serial/JTAG console: output goes to the simulation console (sim::console)
+class HWCDC : public Stream {
+public:
+    void begin(unsigned long baud = 115200) { (void)baud; }
+    void end() {}
+    operator bool() const { return true; }
+
+    size_t write(uint8_t c) override;
+    size_t write(const uint8_t* buffer, size_t size) override;
+    using Print::write;
+
+    int available() override { return 0; }
+    int read() override { return -1; }
+    int peek() override { return -1; }
+};
+
+// ARDUINO_USB_CDC_ON_BOOT: Serial is the USB console
+extern HWCDC Serial;
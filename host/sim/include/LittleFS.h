@@ -0,0 +1,17 @@
+#pragma once
+#include "FS.h"
+
+namespace fs {
+    class LittleFSFS : public FS {
+    public:
+        bool begin(bool formatOnFail = false, const char* basePath = "/littlefs", uint8_t maxOpenFiles = 10,
+                   const char* partitionLabel = "spiffs");
+        void end() { mounted = false; }
+        bool format();
+        size_t totalBytes();
+        size_t usedBytes();
+    };
+}
+
+using fs::LittleFSFS;
+extern fs::LittleFSFS LittleFS;
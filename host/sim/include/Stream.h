@@ -0,0 +1,19 @@
+#pragma once
+#include "Print.h"
+
+class Stream : public Print {
+protected:
+    unsigned long timeout_ms = 1000;
+
+public:
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() = 0;
+    virtual void flush() {}
+
+    void setTimeout(unsigned long timeout) { timeout_ms = timeout; }
+    size_t readBytes(uint8_t* buffer, size_t length);
+    size_t readBytes(char* buffer, size_t length) { return readBytes((uint8_t*)buffer, length); }
+    String readStringUntil(char terminator);
+    String readString();
+};
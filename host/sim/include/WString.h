@@ -0,0 +1,100 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+
+// Arduino String on std::string (arduino-esp32 formatting rules)
+class String {
+private:
+    std::string s;
+
+    static std::string formatSigned(long long value, unsigned char base);
+    static std::string formatUnsigned(unsigned long long value, unsigned char base);
+    static std::string formatFloat(double value, unsigned char decimals);
+
+public:
+    String() {}
+    String(const char* cstr) : s(cstr ? cstr : "") {}
+    String(const std::string& str) : s(str) {}
+    explicit String(char c) : s(1, c) {}
+    explicit String(unsigned char value, unsigned char base = 10) : s(formatUnsigned(value, base)) {}
+    explicit String(int value, unsigned char base = 10) : s(formatSigned(value, base)) {}
+    explicit String(unsigned int value, unsigned char base = 10) : s(formatUnsigned(value, base)) {}
+    explicit String(long value, unsigned char base = 10) : s(formatSigned(value, base)) {}
+    explicit String(unsigned long value, unsigned char base = 10) : s(formatUnsigned(value, base)) {}
+    explicit String(long long value, unsigned char base = 10) : s(formatSigned(value, base)) {}
+    explicit String(unsigned long long value, unsigned char base = 10) : s(formatUnsigned(value, base)) {}
+    explicit String(float value, unsigned char decimals = 2) : s(formatFloat(value, decimals)) {}
+    explicit String(double value, unsigned char decimals = 2) : s(formatFloat(value, decimals)) {}
+
+    const char* c_str() const { return s.c_str(); }
+    unsigned int length() const { return (unsigned int)s.size(); }
+    bool isEmpty() const { return s.empty(); }
+    bool reserve(unsigned int size) { s.reserve(size); return true; }
+
+    char charAt(unsigned int index) const { return index < s.size() ? s[index] : 0; }
+    char operator[](unsigned int index) const { return charAt(index); }
+    int indexOf(char c, unsigned int from = 0) const;
+    int indexOf(const String& str, unsigned int from = 0) const;
+    String substring(unsigned int from) const { return substring(from, length()); }
+    String substring(unsigned int from, unsigned int to) const;
+    bool startsWith(const String& prefix) const { return s.compare(0, prefix.s.size(), prefix.s) == 0; }
+    bool endsWith(const String& suffix) const;
+    void trim();
+    long toInt() const;
+    float toFloat() const;
+
+    bool concat(const String& str) { s += str.s; return true; }
+    bool concat(const char* cstr) { if (cstr) s += cstr; return true; }
+    bool concat(char c) { s += c; return true; }
+    String& operator+=(const String& str) { s += str.s; return *this; }
+    String& operator+=(const char* cstr) { concat(cstr); return *this; }
+    String& operator+=(char c) { s += c; return *this; }
+
+    bool equals(const String& str) const { return s == str.s; }
+    bool equals(const char* cstr) const { return s == (cstr ? cstr : ""); }
+    bool operator==(const String& str) const { return equals(str); }
+    bool operator==(const char* cstr) const { return equals(cstr); }
+    bool operator!=(const String& str) const { return !equals(str); }
+    bool operator!=(const char* cstr) const { return !equals(cstr); }
+    bool operator<(const String& str) const { return s < str.s; }
+};
+
+inline String operator+(const String& lhs, const String& rhs) {
+    String out(lhs);
+    out += rhs;
+    return out;
+}
+inline String operator+(const String& lhs, const char* rhs) {
+    String out(lhs);
+    out += rhs;
+    return out;
+}
+inline String operator+(const char* lhs, const String& rhs) {
+    String out(lhs);
+    out += rhs;
+    return out;
+}
+inline String operator+(const String& lhs, char rhs) {
+    String out(lhs);
+    out += rhs;
+    return out;
+}
+
+// Numbers append their decimal form, as with Arduino's StringSumHelper
+#define SIM_STRING_SUM(T)                                 \
+    inline String operator+(const String& lhs, T rhs) {   \
+        String out(lhs);                                  \
+        out += String(rhs);                               \
+        return out;                                       \
+    }
+SIM_STRING_SUM(unsigned char)
+SIM_STRING_SUM(int)
+SIM_STRING_SUM(unsigned int)
+SIM_STRING_SUM(long)
+SIM_STRING_SUM(unsigned long)
+SIM_STRING_SUM(long long)
+SIM_STRING_SUM(unsigned long long)
+SIM_STRING_SUM(float)
+SIM_STRING_SUM(double)
+#undef SIM_STRING_SUM
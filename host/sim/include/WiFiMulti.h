@@ -0,0 +1,19 @@
+#pragma once
+#include <string>
+#include <vector>
+
+#include "WiFi.h"
+
+// Blocking scan, then a connect to the first configured AP, as arduino-esp32's WiFiMulti
+class WiFiMulti {
+private:
+    struct AccessPoint {
+        std::string ssid;
+        std::string passphrase;
+    };
+    std::vector<AccessPoint> aps;
+
+public:
+    bool addAP(const char* ssid, const char* passphrase = nullptr);
+    uint8_t run(uint32_t connectTimeout = 5000);
+};
@@ -0,0 +1,57 @@
+#pragma once
+#include "Arduino.h"
+
+#define I2C_BUFFER_LENGTH 128
+
+// arduino-esp32 TwoWire on the simulated bus (see sim/i2c.hpp)
+class TwoWire : public Stream {
+private:
+    uint8_t bus_num;
+    bool started = false;
+    uint32_t frequency = 0;
+    uint16_t timeout_ms = 50;
+
+    uint8_t tx_address = 0;
+    uint8_t tx_buffer[I2C_BUFFER_LENGTH];
+    size_t tx_length = 0;
+    bool tx_open = false;
+    bool tx_pending = false;    // endTransmission(false): held for the next requestFrom()
+
+    uint8_t rx_buffer[I2C_BUFFER_LENGTH];
+    size_t rx_length = 0;
+    size_t rx_index = 0;
+
+    void lock();
+    void unlock();
+    bool transfer(uint8_t address, const uint8_t* tx, size_t tx_len, uint8_t* rx, size_t rx_len);
+
+public:
+    explicit TwoWire(uint8_t bus_num) : bus_num(bus_num) {}
+
+    bool begin(int sda = -1, int scl = -1, uint32_t frequency = 0);
+    bool end();
+    bool setClock(uint32_t frequency);
+    uint32_t getClock() { return frequency; }
+    void setTimeOut(uint16_t timeout) { timeout_ms = timeout; }
+    uint16_t getTimeOut() { return timeout_ms; }
+
+    void beginTransmission(uint8_t address);
+    void beginTransmission(int address) { beginTransmission((uint8_t)address); }
+    uint8_t endTransmission(bool sendStop = true);
+
+    size_t requestFrom(uint8_t address, size_t size, bool sendStop = true);
+    size_t requestFrom(uint16_t address, size_t size, bool sendStop) { return requestFrom((uint8_t)address, size, sendStop); }
+    uint8_t requestFrom(int address, int size) { return (uint8_t)requestFrom((uint8_t)address, (size_t)size, true); }
+
+    size_t write(uint8_t data) override;
+    size_t write(const uint8_t* data, size_t quantity) override;
+    using Print::write;
+
+    int available() override { return (int)(rx_length - rx_index); }
+    int read() override { return rx_index < rx_length ? rx_buffer[rx_index++] : -1; }
+    int peek() override { return rx_index < rx_length ? rx_buffer[rx_index] : -1; }
+    void flush() override { rx_index = rx_length = 0; }
+};
+
+extern TwoWire Wire;
+extern TwoWire Wire1;
@@ -0,0 +1,38 @@
+#pragma once
+#include "Wire.h"
+
+// XPowersLib AXP2101 driver, as far as the firmware uses it: begin() starts
+// the bus and checks the chip ID over I2C
+class XPowersAXP2101 {
+private:
+    static constexpr uint8_t REG_CHIP_ID = 0x03;
+    static constexpr uint8_t CHIP_ID = 0x4A;
+
+    TwoWire* wire = nullptr;
+    uint8_t address = 0x34;
+
+public:
+    bool begin(TwoWire& w, uint8_t addr, int sda, int scl) {
+        wire = &w;
+        address = addr;
+        wire->begin(sda, scl);
+        return readRegister(REG_CHIP_ID) == CHIP_ID;
+    }
+
+    int readRegister(uint8_t reg) {
+        if (wire == nullptr) return -1;
+        wire->beginTransmission(address);
+        wire->write(reg);
+        if (wire->endTransmission(false) != 0) return -1;
+        if (wire->requestFrom(address, (size_t)1) != 1) return -1;
+        return wire->read();
+    }
+
+    int writeRegister(uint8_t reg, uint8_t value) {
+        if (wire == nullptr) return -1;
+        wire->beginTransmission(address);
+        wire->write(reg);
+        wire->write(value);
+        return wire->endTransmission() == 0 ? 0 : -1;
+    }
+};
@@ -0,0 +1,9 @@
+#pragma once
+#include "driver/gpio.h"
+
+// RTC domain pulls, the ones that hold in deep sleep
+esp_err_t rtc_gpio_pullup_en(gpio_num_t gpio_num);
+esp_err_t rtc_gpio_pullup_dis(gpio_num_t gpio_num);
+esp_err_t rtc_gpio_pulldown_en(gpio_num_t gpio_num);
+esp_err_t rtc_gpio_pulldown_dis(gpio_num_t gpio_num);
+bool rtc_gpio_is_valid_gpio(gpio_num_t gpio_num);
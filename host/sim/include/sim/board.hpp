@@ -0,0 +1,213 @@
+#pragma once
+#include <stdint.h>
+#include <deque>
+#include <functional>
+
+#include "sim/i2c.hpp"
+
+/**
+ * The board around the ESP32-S3: register models of the I2C devices, wired
+ * to their interrupt lines, and the two buttons.
+ *
+ * Each model is created and attached to the bus on first use (run() attaches
+ * all four). Models are outside the chip: they keep their state and keep
+ * running (sampling, counting time) through light and deep sleep.
+ */
+namespace sim {
+namespace board {
+    // Board motion in the IMU's frame: acceleration in g (gravity included), rotation in dps
+    struct Motion {
+        float ax, ay, az;
+        float gx, gy, gz;
+    };
+    typedef std::function<Motion(int64_t t_us)> MotionSource;
+
+    // QMI8658 6-axis IMU at 0x6B, INT2 push-pull on IMU_INT2.
+    // Models the output data rates, the data-ready and FIFO watermark
+    // interrupts, the stream FIFO, the CTRL9 command handshake, the motion
+    // engine and the pedometer (peak detection on the accel magnitude)
+    class Qmi8658 : public i2c::Target {
+    public:
+        Qmi8658();
+        bool transfer(const uint8_t* tx, size_t tx_len, uint8_t* rx, size_t rx_len) override;
+
+        // Default: lying flat and still, with a little sensor noise
+        void setMotion(MotionSource source);
+        // Sensor clock error against the simulated time
+        void setClockErrorPpm(double ppm) { clock_ppm = ppm; }
+
+        double getOutputRateHz() const;     // 0 while no sensor is enabled
+        uint32_t getSampleCount() const { return samples; }
+        uint32_t getStepCount() const { return step_count; }
+        uint32_t getFifoOverflowCount() const { return fifo_overflows; }
+
+    private:
+        uint8_t regs[0x80];
+        uint8_t pointer = 0;
+        std::deque<uint8_t> fifo;
+        bool fifo_full = false;
+        bool fifo_overflow = false;
+        uint32_t fifo_overflows = 0;
+
+        MotionSource motion;
+        double clock_ppm = 0.0;
+        uint64_t sample_event = 0;
+        double sample_period_us = 0.0;
+        double next_sample_us = 0.0;
+        uint32_t timestamp = 0;
+        uint32_t samples = 0;
+        bool drdy = false;          // Data-ready level (syncSmpl: until STATUSINT is read)
+        bool drdy_pulse = false;    // Data-ready pulse (free-running output)
+        int int2 = -1;
+
+        // Motion engine (CONFIGURE_MOTION pages)
+        uint8_t any_threshold[3] = {0};
+        uint8_t no_threshold[3] = {0};
+        uint8_t any_window = 1;
+        uint8_t no_window = 1;
+        uint16_t sig_wait = 0;
+        uint16_t sig_confirm = 0;
+        float last_accel[3] = {0};
+        bool have_last = false;
+        uint32_t any_run = 0;
+        uint32_t no_run = 0;
+        int32_t sig_phase = -1;     // Samples since the first any-motion, -1 = idle
+
+        // Pedometer (CONFIGURE_PEDOMETER pages)
+        uint16_t ped_sample_cnt = 0;
+        uint16_t ped_peak2peak = 0;
+        uint16_t ped_peak = 0;
+        uint16_t ped_time_up = 0;
+        uint8_t ped_time_low = 0;
+        uint8_t ped_cnt_entry = 0;
+        float ped_mean = 1000.0f;   // mg
+        float ped_min = 0.0f;
+        bool ped_above = false;
+        uint32_t ped_since_step = 0;
+        uint32_t ped_pending = 0;   // Steps seen before the entry count is met
+        uint32_t step_count = 0;
+
+        void reset();
+        uint8_t readRegister(uint8_t reg);
+        void writeRegister(uint8_t reg, uint8_t value);
+        void command(uint8_t cmd);
+        void reschedule();
+        void scheduleSample();
+        void sample();
+        void runMotionEngine(const float accel_g[3]);
+        void runPedometer(const float accel_g[3]);
+        void updateInt2();
+        size_t frameBytes() const;
+        size_t fifoCapacityFrames() const;
+    };
+
+    // PCF85063A RTC at 0x51, INT open drain on RTC_INT.
+    // Counts local time from the simulated world time, with STOP/prescaler
+    // behaviour, the alarm, the countdown timer and the minute interrupt
+    class Pcf85063 : public i2c::Target {
+    public:
+        Pcf85063();
+        bool transfer(const uint8_t* tx, size_t tx_len, uint8_t* rx, size_t rx_len) override;
+
+        // Crystal error against the simulated time
+        void setDriftPpm(double ppm);
+        // RTC time in µs since the epoch (the board keeps local time in it)
+        int64_t getTimeUs() const;
+        void setTimeUs(int64_t rtc_us);
+        // Sets the alarm and/or timer flag as if the event happened now
+        void raiseFlags(bool alarm, bool timer);
+
+    private:
+        uint8_t regs[0x12];
+        uint8_t pointer = 0;
+        double drift_ppm = 0.0;
+        int64_t anchor_sim_us = 0;  // Simulated time at which the RTC read anchor_rtc_us
+        int64_t anchor_rtc_us = 0;
+        bool stopped = false;
+        uint8_t weekday_offset = 0;   // Weekday register against the calendar
+        bool alarm_match = false;
+        uint64_t tick_event = 0;
+
+        uint8_t timer_count = 0;
+        double timer_period_us = 0.0;
+        double timer_next_rtc_us = 0.0;
+        uint64_t timer_event = 0;
+
+        void tick();
+        void scheduleTick();
+        void scheduleTimer();
+        void timerTick();
+        void loadTime(uint8_t* out) const;
+        void storeTime(const uint8_t* in);
+        void updateInt();
+        int64_t rtcToSim(int64_t rtc_us) const;
+    };
+
+    // FT3168 touch controller at 0x38, INT open drain on TOUCH_INT, reset on TOUCH_RST
+    class Ft3168 : public i2c::Target {
+    public:
+        Ft3168();
+        bool transfer(const uint8_t* tx, size_t tx_len, uint8_t* rx, size_t rx_len) override;
+
+        // One finger down at (x, y) for duration_us; frames every REPORT_US
+        void press(uint16_t x, uint16_t y, int64_t duration_us);
+        // Straight drag from (x0, y0) to (x1, y1)
+        void swipe(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1, int64_t duration_us);
+        // One report frame as recorded (fingers 0 = lift); ends a running press/swipe
+        void frame(uint8_t fingers, uint16_t x, uint16_t y);
+        bool isHibernating() const { return state == HIBERNATE; }
+
+        static const int64_t REPORT_US = 10000;
+        static const int64_t BOOT_US = 40000;
+
+    private:
+        enum State : uint8_t { READY, IN_RESET, BOOTING, HIBERNATE };
+        State state = READY;
+        uint8_t regs[0x100];
+        uint8_t pointer = 0;
+        uint64_t boot_event = 0;
+        uint64_t gesture = 0;       // Generation of the running press/swipe
+
+        void report(uint64_t generation, int64_t start_us, int64_t duration_us,
+                    uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1);
+        void pulse();
+        void onReset(int level);
+    };
+
+    // AXP2101 PMU at 0x34. Chip ID, status, ADC, fuel gauge and the IRQ
+    // enable/status registers; the IRQ line is only driven when irq_pin >= 0
+    class Axp2101 : public i2c::Target {
+    public:
+        Axp2101();
+        bool transfer(const uint8_t* tx, size_t tx_len, uint8_t* rx, size_t rx_len) override;
+
+        void pressKey(bool long_press);
+        void setVbus(bool present);
+        void setBattery(bool present, uint16_t mv, uint8_t percent);
+        void setIrqPin(int pin) { irq_pin = pin; updateIrq(); }
+
+    private:
+        uint8_t regs[0x100];
+        uint8_t pointer = 0;
+        int irq_pin = -1;
+
+        void raise(uint8_t reg, uint8_t bits);
+        void setAdc(uint8_t reg, uint16_t value);
+        void updateStatus();
+        void updateIrq();
+        bool vbus = true;
+        bool battery = true;
+        uint16_t battery_mv = 3900;
+        uint8_t battery_percent = 80;
+    };
+
+    Qmi8658& imu();
+    Pcf85063& rtc();
+    Ft3168& touch();
+    Axp2101& pmu();
+    void attachAll();
+
+    // Buttons are active low with a board pull-up
+    void pressButton(int pin, int64_t duration_us);
+}
+}
@@ -0,0 +1,37 @@
+#pragma once
+#include <stdint.h>
+#include <stdio.h>
+
+#include "sim/i2c.hpp"
+
+namespace sim {
+    // I2C bus time per pass through loop() from start() until now, per
+    // device and against the firmware's own estimate (I2CBusStats)
+    class BusReport {
+    public:
+        struct Device {
+            const char* name;
+            uint8_t address;
+        };
+        static const Device DEVICES[4];
+
+        void start();
+
+        uint32_t getLoops() const;
+        int64_t getElapsedUs() const;
+        i2c::Stats getTotal() const;
+        i2c::Stats getDevice(uint8_t address) const;
+        double getBusUsPerLoop() const;
+        double getBusLoad() const;              // Fraction of the elapsed time the bus was busy
+        uint64_t getEstimatedBusUs() const;     // I2CBusStats over the same span
+
+        void print(FILE* out) const;
+
+    private:
+        int64_t start_us = 0;
+        uint32_t start_loops = 0;
+        i2c::Stats start_total;
+        i2c::Stats start_device[4];
+        uint64_t start_estimate_us = 0;
+    };
+}
@@ -0,0 +1,41 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * The simulated I2C bus behind Wire.
+ *
+ * Each transfer reaches the target at its address at once; the calling
+ * task then waits for the transfer's wire time at the bus clock, so other
+ * tasks run meanwhile, as with the IDF driver. Wire time is counted as
+ * I2CBusStats does: 9 bits per byte (address included), one per START
+ * and one for the STOP.
+ */
+namespace sim {
+namespace i2c {
+    struct Target {
+        virtual ~Target() {}
+        // tx: bytes written after the address; rx: bytes read after a
+        // (repeated) START. Returns false to NACK the address.
+        virtual bool transfer(const uint8_t* tx, size_t tx_len, uint8_t* rx, size_t rx_len) = 0;
+    };
+
+    void attach(uint8_t address, Target* target);
+    void detach(uint8_t address);
+
+    // Runs the bus at hz whatever the firmware configures (0 = the firmware's clock)
+    void setClockOverride(uint32_t hz);
+    uint32_t getClock();
+
+    struct Stats {
+        uint32_t transactions = 0;
+        uint32_t nacks = 0;
+        uint64_t bytes = 0;
+        uint64_t bits = 0;
+        uint64_t bus_ns = 0;
+    };
+    const Stats& getStats(uint8_t address);
+    Stats getTotal();
+    void resetStats();
+}
+}
@@ -0,0 +1,66 @@
+#pragma once
+#include <stdint.h>
+#include <functional>
+
+/**
+ * Host simulation of the Waveshare ESP32-S3 Touch AMOLED board.
+ *
+ * The firmware in src/ builds unchanged against the headers of this
+ * library: Arduino, ESP-IDF and FreeRTOS calls run on a simulated clock,
+ * and the shared I2C bus carries register models of the QMI8658 (0x6B),
+ * PCF85063 (0x51), FT3168 (0x38) and AXP2101 (0x34) whose transfers take
+ * their wire time at the configured bus clock (see sim/board.hpp).
+ *
+ * Firmware tasks run one at a time in FreeRTOS priority order. Simulated
+ * time only moves while a task waits (delay(), a blocking RTOS call, an
+ * I2C transfer) or burns it explicitly (delayMicroseconds()); code between
+ * those points takes none. CPU cost is therefore not simulated: cycle
+ * counts from ESP.getCycleCount() are host TSC cycles.
+ *
+ * esp_deep_sleep_start() waits for its wake source, then restarts the
+ * firmware with a fresh reset reason: other tasks are dropped and run()
+ * calls setup() again. RTC_DATA_ATTR state survives as on the chip, but so
+ * does every other static, unlike on the chip.
+ */
+namespace sim {
+    // Thrown out of esp_deep_sleep_start() to restart the firmware
+    struct Reboot {};
+
+    // Simulated time in µs since the simulation started (esp_timer_get_time() counts from the last reset)
+    int64_t now();
+
+    // Arduino setup(), then loop() until the simulated time reaches until_us.
+    // Later calls continue where the last one stopped.
+    void run(int64_t until_us);
+    inline void runFor(int64_t duration_us) { run(now() + duration_us); }
+    uint32_t getLoopCount();
+    uint32_t getResetCount();   // Deep sleep resets
+
+    // Schedules fn at the simulated time when_us, on the device side: it also
+    // runs while the firmware is in light or deep sleep
+    void at(int64_t when_us, std::function<void()> fn);
+
+    // UTC as the outside world (NTP) sees it; the simulated RTC starts from it
+    void setWorldTime(int64_t utc_s);
+    int64_t getWorldTimeUs();
+
+    // Access point reachability for WiFi.begin()/WiFiMulti::run()
+    void setWifiReachable(bool reachable);
+
+    namespace gpio {
+        // External circuit on a pin: drive() overrides the pin's pull, release() lets it float back
+        void drive(int pin, int level);
+        void release(int pin);
+        // Board pull resistor, used while nothing drives the pin
+        void pull(int pin, int level);
+        int level(int pin);
+        // Called when the firmware changes an output pin
+        void onWrite(int pin, std::function<void(int level)> listener);
+    }
+
+    namespace console {
+        // Firmware serial output goes to stdout unless echo is off; the listener sees every line
+        void setEcho(bool echo);
+        void onLine(std::function<void(const char* line)> listener);
+    }
+}
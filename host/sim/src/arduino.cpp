@@ -0,0 +1,281 @@
+#include <Arduino.h>
+
+#include <chrono>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "hal.hpp"
+#include "kernel.hpp"
+#include "sim/sim.hpp"
+
+// String
+
+std::string String::formatSigned(long long value, unsigned char base) {
+    if (value >= 0) return formatUnsigned((unsigned long long)value, base);
+    if (base == 10) return "-" + formatUnsigned(0ULL - (unsigned long long)value, base);
+    // Other bases print the 32-bit two's complement, as ltoa() does on the chip
+    return formatUnsigned((uint32_t)value, base);
+}
+
+std::string String::formatUnsigned(unsigned long long value, unsigned char base) {
+    if (base < 2 || base > 36) base = 10;
+    char digits[66];
+    int i = sizeof(digits);
+    digits[--i] = 0;
+    do {
+        unsigned digit = (unsigned)(value % base);
+        digits[--i] = (char)(digit < 10 ? '0' + digit : 'a' + digit - 10);
+        value /= base;
+    } while (value != 0);
+    return std::string(&digits[i]);
+}
+
+std::string String::formatFloat(double value, unsigned char decimals) {
+    if (std::isnan(value)) return "nan";
+    if (std::isinf(value)) return value > 0 ? "inf" : "-inf";
+    char buffer[64];
+    snprintf(buffer, sizeof(buffer), "%.*f", (int)decimals, value);
+    return std::string(buffer);
+}
+
+int String::indexOf(char c, unsigned int from) const {
+    size_t at = s.find(c, from);
+    return at == std::string::npos ? -1 : (int)at;
+}
+
+int String::indexOf(const String& str, unsigned int from) const {
+    size_t at = s.find(str.s, from);
+    return at == std::string::npos ? -1 : (int)at;
+}
+
+String String::substring(unsigned int from, unsigned int to) const {
+    if (from > to) std::swap(from, to);
+    if (from >= s.size()) return String();
+    if (to > s.size()) to = (unsigned int)s.size();
+    return String(s.substr(from, to - from));
+}
+
+bool String::endsWith(const String& suffix) const {
+    return s.size() >= suffix.s.size() && s.compare(s.size() - suffix.s.size(), suffix.s.size(), suffix.s) == 0;
+}
+
+void String::trim() {
+    size_t begin = s.find_first_not_of(" \t\r\n\f\v");
+    if (begin == std::string::npos) {
+        s.clear();
+        return;
+    }
+    size_t end = s.find_last_not_of(" \t\r\n\f\v");
+    s = s.substr(begin, end - begin + 1);
+}
+
+long String::toInt() const {
+    return strtol(s.c_str(), nullptr, 10);
+}
+
+float String::toFloat() const {
+    return strtof(s.c_str(), nullptr);
+}
+
+// Print and Stream
+
+size_t Print::write(const uint8_t* buffer, size_t size) {
+    size_t written = 0;
+    while (size--) written += write(*buffer++);
+    return written;
+}
+
+size_t Print::write(const char* str) {
+    return str ? write((const uint8_t*)str, strlen(str)) : 0;
+}
+
+size_t Print::printf(const char* format, ...) {
+    char small[128];
+    va_list args;
+    va_start(args, format);
+    int length = vsnprintf(small, sizeof(small), format, args);
+    va_end(args);
+    if (length < 0) return 0;
+    if ((size_t)length < sizeof(small)) return write((const uint8_t*)small, length);
+
+    std::vector<char> big(length + 1);
+    va_start(args, format);
+    vsnprintf(big.data(), big.size(), format, args);
+    va_end(args);
+    return write((const uint8_t*)big.data(), length);
+}
+
+namespace {
+    // Stream reads wait up to the timeout, in simulated time
+    int timedRead(Stream& stream, unsigned long timeout_ms) {
+        unsigned long start = millis();
+        do {
+            int c = stream.read();
+            if (c >= 0) return c;
+            delay(1);
+        } while (millis() - start < timeout_ms);
+        return -1;
+    }
+}
+
+size_t Stream::readBytes(uint8_t* buffer, size_t length) {
+    size_t count = 0;
+    while (count < length) {
+        int c = timedRead(*this, timeout_ms);
+        if (c < 0) break;
+        buffer[count++] = (uint8_t)c;
+    }
+    return count;
+}
+
+String Stream::readStringUntil(char terminator) {
+    std::string out;
+    for (;;) {
+        int c = timedRead(*this, timeout_ms);
+        if (c < 0 || c == terminator) break;
+        out += (char)c;
+    }
+    return String(out);
+}
+
+String Stream::readString() {
+    std::string out;
+    for (int c = timedRead(*this, timeout_ms); c >= 0; c = timedRead(*this, timeout_ms)) out += (char)c;
+    return String(out);
+}
+
+// Console
+
+HWCDC Serial;
+
+size_t HWCDC::write(uint8_t c) {
+    sim::hal::consoleWrite(&c, 1);
+    return 1;
+}
+
+size_t HWCDC::write(const uint8_t* buffer, size_t size) {
+    sim::hal::consoleWrite(buffer, size);
+    return size;
+}
+
+namespace {
+    struct Console {
+        bool echo = true;
+        std::string line;
+        std::vector<std::function<void(const char*)>> listeners;
+    };
+
+    Console& consoleState() {
+        static Console* state = new Console();
+        return *state;
+    }
+}
+
+void sim::hal::consoleWrite(const uint8_t* data, size_t size) {
+    Console& c = consoleState();
+    if (c.echo) fwrite(data, 1, size, stdout);
+    for (size_t i = 0; i < size; i++) {
+        char ch = (char)data[i];
+        if (ch == '\r') continue;
+        if (ch != '\n') {
+            c.line += ch;
+            continue;
+        }
+        for (auto& listener : c.listeners) listener(c.line.c_str());
+        c.line.clear();
+    }
+}
+
+void sim::console::setEcho(bool echo) {
+    consoleState().echo = echo;
+}
+
+void sim::console::onLine(std::function<void(const char* line)> listener) {
+    consoleState().listeners.push_back(std::move(listener));
+}
+
+// Timing
+
+int64_t esp_timer_get_time(void) {
+    return sim::kernel::now() - sim::hal::bootUs();
+}
+
+unsigned long millis() {
+    return (unsigned long)(uint32_t)(esp_timer_get_time() / 1000);
+}
+
+unsigned long micros() {
+    return (unsigned long)(uint32_t)esp_timer_get_time();
+}
+
+void delay(uint32_t ms) {
+    sim::kernel::sleepFor((int64_t)ms * 1000);
+}
+
+void delayMicroseconds(uint32_t us) {
+    sim::kernel::consume(us);
+}
+
+void yield() {}
+
+// CPU clock: only reported, the simulation does not model CPU time
+
+namespace {
+    uint32_t cpu_mhz = 240;
+}
+
+bool setCpuFrequencyMhz(uint32_t cpu_freq_mhz) {
+    if (cpu_freq_mhz != 240 && cpu_freq_mhz != 160 && cpu_freq_mhz != 80 && cpu_freq_mhz != 40 &&
+        cpu_freq_mhz != 20 && cpu_freq_mhz != 10) {
+        return false;
+    }
+    cpu_mhz = cpu_freq_mhz;
+    return true;
+}
+
+uint32_t getCpuFrequencyMhz() { return cpu_mhz; }
+uint32_t getXtalFrequencyMhz() { return 40; }
+uint32_t getApbFrequency() { return cpu_mhz >= 80 ? 80000000 : cpu_mhz * 1000000; }
+
+// Misc
+
+long random(long howbig) {
+    return howbig <= 0 ? 0 : ::random() % howbig;
+}
+
+long random(long howsmall, long howbig) {
+    return howsmall >= howbig ? howsmall : howsmall + random(howbig - howsmall);
+}
+
+void randomSeed(unsigned long seed) {
+    if (seed != 0) srandom((unsigned)seed);
+}
+
+long map(long x, long in_min, long in_max, long out_min, long out_max) {
+    long divisor = in_max - in_min;
+    return divisor == 0 ? -1 : (x - in_min) * (out_max - out_min) / divisor + out_min;
+}
+
+// ESP
+
+EspClass ESP;
+
+uint32_t EspClass::getHeapSize() { return 327680; }
+uint32_t EspClass::getFreeHeap() { return 262144; }
+uint32_t EspClass::getMinFreeHeap() { return 245760; }
+uint32_t EspClass::getMaxAllocHeap() { return 114688; }
+uint32_t EspClass::getPsramSize() { return 8388608; }
+uint32_t EspClass::getFreePsram() { return 8126464; }
+uint32_t EspClass::getFlashChipSize() { return 33554432; }
+
+uint32_t EspClass::getCycleCount() {
+    // Host time at the simulated CPU clock: cycle counts measure the host's CPU time
+    static const auto origin = std::chrono::steady_clock::now();
+    auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - origin).count();
+    return (uint32_t)((uint64_t)ns * cpu_mhz / 1000);
+}
+
+void EspClass::restart() {
+    esp_restart();
+}
@@ -0,0 +1,133 @@
+#include <string.h>
+
+#include "kernel.hpp"
+#include "sim/board.hpp"
+#include "sim/sim.hpp"
+
+// AXP2101 registers (datasheet rev. 1.0); only what the firmware and XPowersLib touch
+namespace {
+    enum : uint8_t {
+        STATUS_1 = 0x00, STATUS_2 = 0x01, CHIP_ID = 0x03,
+        VBAT_H = 0x34, VBUS_H = 0x38, VSYS_H = 0x3A, TDIE_H = 0x3C,
+        IRQ_ENABLE_0 = 0x40, IRQ_STATUS_0 = 0x48, IRQ_STATUS_1 = 0x49, IRQ_STATUS_2 = 0x4A,
+        BATTERY_PERCENT = 0xA4,
+    };
+
+    const uint8_t CHIP_ID_AXP2101 = 0x4A;
+
+    const uint8_t STATUS_1_VBUS_GOOD = 1 << 5;
+    const uint8_t STATUS_1_BATTERY_PRESENT = 1 << 3;
+    const uint8_t DIRECTION_STANDBY = 0;
+    const uint8_t DIRECTION_CHARGING = 1;
+    const uint8_t DIRECTION_DISCHARGING = 2;
+    const uint8_t PHASE_CC = 2;
+    const uint8_t PHASE_DONE = 4;
+
+    // IRQ_STATUS_1 / IRQ_STATUS_2
+    const uint8_t IRQ1_KEY_LONG = 1 << 2;
+    const uint8_t IRQ1_KEY_SHORT = 1 << 3;
+    const uint8_t IRQ1_BATTERY_REMOVE = 1 << 4;
+    const uint8_t IRQ1_BATTERY_INSERT = 1 << 5;
+    const uint8_t IRQ1_VBUS_REMOVE = 1 << 6;
+    const uint8_t IRQ1_VBUS_INSERT = 1 << 7;
+    const uint8_t IRQ2_CHARGE_START = 1 << 3;
+    const uint8_t IRQ2_CHARGE_DONE = 1 << 4;
+
+    const uint16_t VBUS_MV = 5000;
+    const uint16_t VSYS_MV = 4950;
+    const uint16_t TDIE_RAW = 7114;     // 30 °C (22 °C + (7274 - raw) / 20)
+}
+
+namespace sim {
+namespace board {
+
+Axp2101::Axp2101() {
+    memset(regs, 0, sizeof(regs));
+    regs[CHIP_ID] = CHIP_ID_AXP2101;
+    regs[0x30] = 0x11;  // VBAT and TDIE measured after power-on
+    setAdc(TDIE_H, TDIE_RAW);
+    updateStatus();
+}
+
+bool Axp2101::transfer(const uint8_t* tx, size_t tx_len, uint8_t* rx, size_t rx_len) {
+    if (tx_len > 0) {
+        pointer = tx[0];
+        for (size_t i = 1; i < tx_len; i++) {
+            uint8_t reg = pointer++;
+            if (reg >= IRQ_STATUS_0 && reg <= IRQ_STATUS_2) {
+                regs[reg] &= (uint8_t)~tx[i];  // Write 1 to clear
+            } else if (reg > STATUS_2 && reg != CHIP_ID && !(reg >= VBAT_H && reg <= TDIE_H + 1) && reg != BATTERY_PERCENT) {
+                regs[reg] = tx[i];
+            }
+        }
+        updateIrq();
+    }
+    for (size_t i = 0; i < rx_len; i++) rx[i] = regs[pointer++];
+    return true;
+}
+
+void Axp2101::setAdc(uint8_t reg, uint16_t value) {
+    regs[reg] = (uint8_t)(value >> 8);
+    regs[reg + 1] = (uint8_t)(value & 0xFF);
+}
+
+void Axp2101::updateStatus() {
+    bool charging = vbus && battery && battery_percent < 100;
+    uint8_t direction = charging ? DIRECTION_CHARGING : (battery && !vbus ? DIRECTION_DISCHARGING : DIRECTION_STANDBY);
+    uint8_t phase = charging ? PHASE_CC : PHASE_DONE;
+    regs[STATUS_1] = (uint8_t)((vbus ? STATUS_1_VBUS_GOOD : 0) | (battery ? STATUS_1_BATTERY_PRESENT : 0));
+    regs[STATUS_2] = (uint8_t)(direction << 5 | phase);
+    setAdc(VBAT_H, battery ? battery_mv : 0);
+    setAdc(VBUS_H, vbus ? VBUS_MV : 0);
+    setAdc(VSYS_H, vbus ? VSYS_MV : (battery ? battery_mv : 0));
+    regs[BATTERY_PERCENT] = battery ? battery_percent : 0;
+}
+
+void Axp2101::raise(uint8_t reg, uint8_t bits) {
+    regs[reg] |= bits;
+    updateIrq();
+}
+
+// IRQ is open drain, low while an enabled status bit is set
+void Axp2101::updateIrq() {
+    if (irq_pin < 0) return;
+    bool active = false;
+    for (int i = 0; i < 3; i++) {
+        if (regs[IRQ_STATUS_0 + i] & regs[IRQ_ENABLE_0 + i]) active = true;
+    }
+    if (active) {
+        sim::gpio::drive(irq_pin, 0);
+    } else {
+        sim::gpio::release(irq_pin);
+    }
+}
+
+void Axp2101::pressKey(bool long_press) {
+    raise(IRQ_STATUS_1, long_press ? IRQ1_KEY_LONG : IRQ1_KEY_SHORT);
+}
+
+void Axp2101::setVbus(bool present) {
+    if (present == vbus) return;
+    bool was_charging = (regs[STATUS_2] >> 5) == DIRECTION_CHARGING;
+    vbus = present;
+    updateStatus();
+    raise(IRQ_STATUS_1, present ? IRQ1_VBUS_INSERT : IRQ1_VBUS_REMOVE);
+    bool charging = (regs[STATUS_2] >> 5) == DIRECTION_CHARGING;
+    if (charging && !was_charging) raise(IRQ_STATUS_2, IRQ2_CHARGE_START);
+}
+
+void Axp2101::setBattery(bool present, uint16_t mv, uint8_t percent) {
+    bool was_present = battery;
+    bool was_charging = (regs[STATUS_2] >> 5) == DIRECTION_CHARGING;
+    battery = present;
+    battery_mv = mv;
+    battery_percent = percent > 100 ? 100 : percent;
+    updateStatus();
+    if (present != was_present) raise(IRQ_STATUS_1, present ? IRQ1_BATTERY_INSERT : IRQ1_BATTERY_REMOVE);
+    bool charging = (regs[STATUS_2] >> 5) == DIRECTION_CHARGING;
+    if (was_charging && !charging && present && vbus) raise(IRQ_STATUS_2, IRQ2_CHARGE_DONE);
+    if (charging && !was_charging) raise(IRQ_STATUS_2, IRQ2_CHARGE_START);
+}
+
+}
+}
@@ -0,0 +1,53 @@
+#include "config.h"
+#include "kernel.hpp"
+#include "sim/board.hpp"
+#include "sim/sim.hpp"
+
+namespace {
+    // Pull-ups on the board: buttons and the open-drain interrupt lines
+    void pullUps() {
+        static bool done = false;
+        if (done) return;
+        done = true;
+        sim::gpio::pull(BTN_BOOT, 1);
+        sim::gpio::pull(BTN_PWR, 1);
+        sim::gpio::pull(TOUCH_INT, 1);
+        sim::gpio::pull(RTC_INT, 1);
+    }
+
+    template <typename Model>
+    Model& attached(uint8_t address) {
+        static Model* model = [address] {
+            pullUps();
+            Model* created = new Model();
+            sim::i2c::attach(address, created);
+            return created;
+        }();
+        return *model;
+    }
+}
+
+namespace sim {
+namespace board {
+
+Qmi8658& imu() { return attached<Qmi8658>(0x6B); }
+Pcf85063& rtc() { return attached<Pcf85063>(0x51); }
+Ft3168& touch() { return attached<Ft3168>(0x38); }
+Axp2101& pmu() { return attached<Axp2101>(0x34); }
+
+void attachAll() {
+    pullUps();
+    imu();
+    rtc();
+    touch();
+    pmu();
+}
+
+void pressButton(int pin, int64_t duration_us) {
+    pullUps();
+    sim::gpio::drive(pin, 0);
+    sim::kernel::at(sim::kernel::now() + duration_us, [pin] { sim::gpio::release(pin); }, sim::kernel::DEVICE);
+}
+
+}
+}
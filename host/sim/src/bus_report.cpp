@@ -0,0 +1,90 @@
+#include "sim/bus_report.hpp"
+
+#include "sim/sim.hpp"
+#include "system/bus/bus_stats.hpp"
+
+namespace {
+    sim::i2c::Stats minus(const sim::i2c::Stats& a, const sim::i2c::Stats& b) {
+        sim::i2c::Stats d;
+        d.transactions = a.transactions - b.transactions;
+        d.nacks = a.nacks - b.nacks;
+        d.bytes = a.bytes - b.bytes;
+        d.bits = a.bits - b.bits;
+        d.bus_ns = a.bus_ns - b.bus_ns;
+        return d;
+    }
+}
+
+namespace sim {
+
+const BusReport::Device BusReport::DEVICES[4] = {
+    {"QMI8658", 0x6B},
+    {"PCF85063", 0x51},
+    {"FT3168", 0x38},
+    {"AXP2101", 0x34},
+};
+
+void BusReport::start() {
+    start_us = sim::now();
+    start_loops = sim::getLoopCount();
+    start_total = i2c::getTotal();
+    for (int i = 0; i < 4; i++) start_device[i] = i2c::getStats(DEVICES[i].address);
+    start_estimate_us = I2CBusStats::getBusTimeUs();
+}
+
+uint32_t BusReport::getLoops() const {
+    return sim::getLoopCount() - start_loops;
+}
+
+int64_t BusReport::getElapsedUs() const {
+    return sim::now() - start_us;
+}
+
+i2c::Stats BusReport::getTotal() const {
+    return minus(i2c::getTotal(), start_total);
+}
+
+i2c::Stats BusReport::getDevice(uint8_t address) const {
+    for (int i = 0; i < 4; i++) {
+        if (DEVICES[i].address == address) return minus(i2c::getStats(address), start_device[i]);
+    }
+    return i2c::getStats(address);
+}
+
+double BusReport::getBusUsPerLoop() const {
+    uint32_t loops = getLoops();
+    return loops ? (double)getTotal().bus_ns / 1000.0 / loops : 0.0;
+}
+
+double BusReport::getBusLoad() const {
+    int64_t elapsed = getElapsedUs();
+    return elapsed > 0 ? (double)getTotal().bus_ns / 1000.0 / (double)elapsed : 0.0;
+}
+
+uint64_t BusReport::getEstimatedBusUs() const {
+    return I2CBusStats::getBusTimeUs() - start_estimate_us;
+}
+
+void BusReport::print(FILE* out) const {
+    uint32_t loops = getLoops();
+    double seconds = getElapsedUs() / 1e6;
+    i2c::Stats total = getTotal();
+
+    fprintf(out, "\n== I2C bus at %lu Hz over %.1f s simulated ==\n", (unsigned long)i2c::getClock(), seconds);
+    fprintf(out, "loop() passes: %lu (%.1f/s)\n", (unsigned long)loops, seconds > 0 ? loops / seconds : 0.0);
+    fprintf(out, "%-9s %5s %12s %6s %10s %11s %10s\n", "device", "addr", "transactions", "nacks", "bytes", "bus ms",
+            "us/loop");
+    for (int i = 0; i < 4; i++) {
+        i2c::Stats d = getDevice(DEVICES[i].address);
+        fprintf(out, "%-9s  0x%02X %12lu %6lu %10llu %11.2f %10.2f\n", DEVICES[i].name, DEVICES[i].address,
+                (unsigned long)d.transactions, (unsigned long)d.nacks, (unsigned long long)d.bytes, d.bus_ns / 1e6,
+                loops ? d.bus_ns / 1000.0 / loops : 0.0);
+    }
+    fprintf(out, "%-9s       %12lu %6lu %10llu %11.2f %10.2f\n", "total", (unsigned long)total.transactions,
+            (unsigned long)total.nacks, (unsigned long long)total.bytes, total.bus_ns / 1e6, getBusUsPerLoop());
+    fprintf(out, "bus load: %.3f%%\n", 100.0 * getBusLoad());
+    fprintf(out, "I2CBusStats estimate: %llu us (simulated wire time %.0f us)\n",
+            (unsigned long long)getEstimatedBusUs(), total.bus_ns / 1000.0);
+}
+
+}
@@ -0,0 +1,310 @@
+#include <Arduino.h>
+#include <driver/rtc_io.h>
+#include <esp_pm.h>
+#include <esp_sleep.h>
+#include <esp_sntp.h>
+#include <esp_system.h>
+
+#include <sys/time.h>
+
+#include "hal.hpp"
+#include "kernel.hpp"
+#include "sim/sim.hpp"
+
+namespace {
+    // 2025-06-01 15:00:00 UTC
+    const int64_t DEFAULT_WORLD_UTC_S = 1748790000;
+    // ROM and bootloader before setup() after a deep sleep wake
+    const int64_t DEEP_SLEEP_BOOT_US = 30000;
+    // SNTP request to the system clock being set
+    const int64_t SNTP_ROUND_TRIP_US = 150000;
+
+    struct State {
+        int64_t boot_us = 0;
+        esp_reset_reason_t reset_reason = ESP_RST_POWERON;
+
+        // System clock (gettimeofday) = simulated time + offset; the RTC timer
+        // keeps it across deep sleep, as on the chip
+        int64_t system_offset_us = 0;
+        int64_t world_offset_us = DEFAULT_WORLD_UTC_S * 1000000LL;
+
+        sntp_sync_status_t sntp_status = SNTP_SYNC_STATUS_RESET;
+        uint64_t sntp_event = 0;
+
+        // Wake-up sources
+        uint64_t timer_us = 0;
+        bool timer_enabled = false;
+        int ext0_pin = -1;
+        int ext0_level = 0;
+        uint64_t ext1_mask = 0;
+        esp_sleep_ext1_wakeup_mode_t ext1_mode = ESP_EXT1_WAKEUP_ANY_LOW;
+        bool gpio_enabled = false;
+
+        esp_sleep_wakeup_cause_t cause = ESP_SLEEP_WAKEUP_UNDEFINED;
+        uint64_t ext1_status = 0;
+    };
+
+    State& st() {
+        static State* state = [] {
+            setenv("TZ", "UTC0", 1);  // No TZ until configTime(), as on the chip
+            tzset();
+            sim::kernel::onReset([] { sim::hal::gpioReset(); sim::hal::wireReset(); sim::hal::wifiReset(); });
+            return new State();
+        }();
+        return *state;
+    }
+
+    bool ext0Pending() {
+        return st().ext0_pin >= 0 && sim::gpio::level(st().ext0_pin) == st().ext0_level;
+    }
+
+    uint64_t ext1Pending() {
+        State& s = st();
+        uint64_t active = 0;
+        for (int pin = 0; pin < GPIO_NUM_MAX; pin++) {
+            if (!(s.ext1_mask & (1ULL << pin))) continue;
+            if (sim::gpio::level(pin) == (s.ext1_mode == ESP_EXT1_WAKEUP_ANY_HIGH ? HIGH : LOW)) active |= 1ULL << pin;
+        }
+        return active;
+    }
+
+    // Sleeps until a wake-up source fires and records it as the cause
+    void sleep(bool gpio) {
+        State& s = st();
+        int64_t until = s.timer_enabled ? sim::kernel::now() + (int64_t)s.timer_us : -1;
+        auto pending = [gpio] { return (gpio && st().gpio_enabled && sim::hal::gpioWakePending()) || ext0Pending() || ext1Pending() != 0; };
+
+        s.ext1_status = 0;
+        if (!sim::kernel::sleepUntil(pending, until)) {
+            s.cause = ESP_SLEEP_WAKEUP_TIMER;
+        } else if (gpio && s.gpio_enabled && sim::hal::gpioWakePending()) {
+            s.cause = ESP_SLEEP_WAKEUP_GPIO;
+        } else if (ext0Pending()) {
+            s.cause = ESP_SLEEP_WAKEUP_EXT0;
+        } else {
+            s.cause = ESP_SLEEP_WAKEUP_EXT1;
+            s.ext1_status = ext1Pending();
+        }
+    }
+
+    [[noreturn]] void reboot(esp_reset_reason_t reason) {
+        fflush(stdout);
+        State& s = st();
+        s.reset_reason = reason;
+        s.sntp_status = SNTP_SYNC_STATUS_RESET;
+        s.sntp_event = 0;
+        sim::kernel::reset();
+        s.boot_us = sim::kernel::now();
+        s.timer_enabled = false;
+        s.ext0_pin = -1;
+        s.ext1_mask = 0;
+        s.gpio_enabled = false;
+        sim::kernel::consume(DEEP_SLEEP_BOOT_US);
+        throw sim::Reboot();
+    }
+
+    void setTimeZone(long offset, int daylight) {
+        // Same POSIX TZ string as arduino-esp32, without the DST part when there is no DST
+        char tz[40];
+        if (offset % 3600) {
+            snprintf(tz, sizeof(tz), "UTC%ld:%02u:%02u", offset / 3600, (unsigned)labs((offset % 3600) / 60), (unsigned)labs(offset % 60));
+        } else {
+            snprintf(tz, sizeof(tz), "UTC%ld", offset / 3600);
+        }
+        if (daylight != 0) {
+            long dst = offset - daylight;
+            size_t used = strlen(tz);
+            snprintf(tz + used, sizeof(tz) - used, "DST%ld", dst / 3600);
+        }
+        setenv("TZ", tz, 1);
+        tzset();
+    }
+
+    void sntpPoll() {
+        State& s = st();
+        if (!sim::hal::wifiConnected()) {
+            s.sntp_event = sim::kernel::at(sim::kernel::now() + 1000000, sntpPoll, sim::kernel::FIRMWARE);
+            return;
+        }
+        s.sntp_event = sim::kernel::at(sim::kernel::now() + SNTP_ROUND_TRIP_US, [] {
+            State& s = st();
+            s.system_offset_us = sim::getWorldTimeUs() - sim::kernel::now();
+            s.sntp_status = SNTP_SYNC_STATUS_COMPLETED;
+            s.sntp_event = 0;
+        }, sim::kernel::FIRMWARE);
+    }
+}
+
+int64_t sim::hal::bootUs() {
+    return st().boot_us;
+}
+
+int64_t sim::now() {
+    return sim::kernel::now();
+}
+
+void sim::setWorldTime(int64_t utc_s) {
+    st().world_offset_us = utc_s * 1000000LL - sim::kernel::now();
+}
+
+int64_t sim::getWorldTimeUs() {
+    return st().world_offset_us + sim::kernel::now();
+}
+
+// System clock: the firmware's gettimeofday()/settimeofday()/time() land
+// here instead of libc, so they run on the simulated clock and never touch
+// the host's
+
+extern "C" int gettimeofday(struct timeval* __restrict tv, void* __restrict tz) __THROW {
+    // glibc declares tv nonnull, as the firmware always passes one
+    (void)tz;
+    int64_t us = st().system_offset_us + sim::kernel::now();
+    tv->tv_sec = (time_t)(us / 1000000);
+    tv->tv_usec = (suseconds_t)(us % 1000000);
+    return 0;
+}
+
+extern "C" int settimeofday(const struct timeval* tv, const struct timezone* tz) __THROW {
+    (void)tz;
+    if (tv != nullptr) st().system_offset_us = (int64_t)tv->tv_sec * 1000000 + tv->tv_usec - sim::kernel::now();
+    return 0;
+}
+
+extern "C" time_t time(time_t* out) __THROW {
+    time_t now = (time_t)((st().system_offset_us + sim::kernel::now()) / 1000000);
+    if (out != nullptr) *out = now;
+    return now;
+}
+
+void configTime(long gmtOffset_sec, int daylightOffset_sec, const char* server1, const char* server2,
+                const char* server3) {
+    (void)server1;
+    (void)server2;
+    (void)server3;
+    State& s = st();
+    setTimeZone(-gmtOffset_sec, daylightOffset_sec);
+    if (s.sntp_event != 0) sim::kernel::cancel(s.sntp_event);
+    s.sntp_status = SNTP_SYNC_STATUS_RESET;
+    sntpPoll();
+}
+
+bool getLocalTime(struct tm* info, uint32_t ms) {
+    uint32_t start = millis();
+    for (;;) {
+        time_t now;
+        time(&now);
+        localtime_r(&now, info);
+        if (info->tm_year > (2016 - 1900)) return true;
+        if (millis() - start > ms) return false;
+        delay(10);
+    }
+}
+
+sntp_sync_status_t sntp_get_sync_status(void) {
+    // Reported once, as in the IDF's immediate sync mode
+    sntp_sync_status_t status = st().sntp_status;
+    if (status == SNTP_SYNC_STATUS_COMPLETED) st().sntp_status = SNTP_SYNC_STATUS_RESET;
+    return status;
+}
+
+// System
+
+esp_reset_reason_t esp_reset_reason(void) {
+    return st().reset_reason;
+}
+
+uint32_t esp_get_free_heap_size(void) {
+    return ESP.getFreeHeap();
+}
+
+void esp_restart(void) {
+    reboot(ESP_RST_SW);
+}
+
+// Sleep
+
+esp_err_t esp_sleep_enable_timer_wakeup(uint64_t time_in_us) {
+    st().timer_us = time_in_us;
+    st().timer_enabled = true;
+    return ESP_OK;
+}
+
+esp_err_t esp_sleep_enable_ext0_wakeup(gpio_num_t gpio_num, int level) {
+    if (!rtc_gpio_is_valid_gpio(gpio_num)) return ESP_ERR_INVALID_ARG;
+    st().ext0_pin = gpio_num;
+    st().ext0_level = level ? HIGH : LOW;
+    return ESP_OK;
+}
+
+esp_err_t esp_sleep_enable_ext1_wakeup(uint64_t io_mask, esp_sleep_ext1_wakeup_mode_t level_mode) {
+    for (int pin = 0; pin < GPIO_NUM_MAX; pin++) {
+        if ((io_mask & (1ULL << pin)) && !rtc_gpio_is_valid_gpio((gpio_num_t)pin)) return ESP_ERR_INVALID_ARG;
+    }
+    st().ext1_mask = io_mask;
+    st().ext1_mode = level_mode;
+    return ESP_OK;
+}
+
+esp_err_t esp_sleep_enable_gpio_wakeup(void) {
+    st().gpio_enabled = true;
+    return ESP_OK;
+}
+
+esp_err_t esp_sleep_disable_wakeup_source(esp_sleep_source_t source) {
+    State& s = st();
+    bool all = source == ESP_SLEEP_WAKEUP_ALL;
+    if (all || source == ESP_SLEEP_WAKEUP_TIMER) s.timer_enabled = false;
+    if (all || source == ESP_SLEEP_WAKEUP_EXT0) s.ext0_pin = -1;
+    if (all || source == ESP_SLEEP_WAKEUP_EXT1) s.ext1_mask = 0;
+    if (all || source == ESP_SLEEP_WAKEUP_GPIO) s.gpio_enabled = false;
+    return ESP_OK;
+}
+
+esp_err_t esp_light_sleep_start(void) {
+    State& s = st();
+    bool gpio = s.gpio_enabled && sim::hal::gpioWakeArmed();
+    if (!gpio && !s.timer_enabled && s.ext0_pin < 0 && s.ext1_mask == 0) return ESP_ERR_INVALID_STATE;
+    sleep(true);
+    sim::hal::gpioRunDeferredIsrs();
+    return ESP_OK;
+}
+
+void esp_deep_sleep_start(void) {
+    fflush(stdout);
+    sleep(false);
+    reboot(ESP_RST_DEEPSLEEP);
+}
+
+esp_sleep_wakeup_cause_t esp_sleep_get_wakeup_cause(void) {
+    return st().cause;
+}
+
+uint64_t esp_sleep_get_ext1_wakeup_status(void) {
+    return st().ext1_status;
+}
+
+// Power management
+
+esp_err_t esp_pm_configure(const void* config) {
+    (void)config;
+    return ESP_OK;
+}
+
+esp_err_t esp_pm_lock_create(esp_pm_lock_type_t lock_type, int arg, const char* name, esp_pm_lock_handle_t* out_handle) {
+    (void)lock_type;
+    (void)arg;
+    (void)name;
+    static char lock;
+    if (out_handle != nullptr) *out_handle = reinterpret_cast<esp_pm_lock_handle_t>(&lock);
+    return ESP_OK;
+}
+
+esp_err_t esp_pm_lock_acquire(esp_pm_lock_handle_t handle) {
+    (void)handle;
+    return ESP_OK;
+}
+
+esp_err_t esp_pm_lock_release(esp_pm_lock_handle_t handle) {
+    (void)handle;
+    return ESP_OK;
+}
@@ -0,0 +1,409 @@
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "freertos/timers.h"
+
+#include <string.h>
+#include <deque>
+#include <string>
+#include <vector>
+
+#include "kernel.hpp"
+
+using sim::kernel::Task;
+
+struct QueueDefinition {
+    enum Kind : uint8_t { QUEUE, MUTEX, RECURSIVE_MUTEX, SEMAPHORE };
+
+    Kind kind = QUEUE;
+    size_t item_size = 0;
+    size_t length = 0;
+    std::deque<std::vector<uint8_t>> items;
+
+    // Semaphores and mutexes
+    UBaseType_t count = 0;
+    UBaseType_t max_count = 0;
+    Task* holder = nullptr;
+    UBaseType_t recursion = 0;
+};
+
+struct tmrTimerControl {
+    std::string name;
+    TickType_t period;
+    bool auto_reload;
+    void* id;
+    TimerCallbackFunction_t callback;
+    bool active = false;
+    int64_t expiry_us = 0;
+    uint64_t event = 0;
+};
+
+namespace {
+    int64_t ticksToUs(TickType_t ticks) {
+        return ticks == portMAX_DELAY ? -1 : (int64_t)ticks * portTICK_PERIOD_MS * 1000;
+    }
+
+    // Blocks until ready() holds or the ticks run out; object is what the waker signals
+    template <typename Ready>
+    bool waitFor(const void* object, TickType_t ticks, Ready ready) {
+        if (ready()) return true;
+        if (ticks == 0) return false;
+
+        int64_t timeout = ticksToUs(ticks);
+        int64_t deadline = timeout < 0 ? -1 : sim::kernel::now() + timeout;
+        for (;;) {
+            int64_t left = deadline < 0 ? -1 : deadline - sim::kernel::now();
+            if (deadline >= 0 && left <= 0) return ready();
+            sim::kernel::block(object, left);
+            if (ready()) return true;
+        }
+    }
+
+    BaseType_t notify(Task* task, uint32_t value, eNotifyAction action) {
+        if (task == nullptr) return pdFAIL;
+        switch (action) {
+            case eSetBits: task->notify_value |= value; break;
+            case eIncrement: task->notify_value++; break;
+            case eSetValueWithOverwrite: task->notify_value = value; break;
+            case eSetValueWithoutOverwrite:
+                if (task->notify_pending) return pdFAIL;
+                task->notify_value = value;
+                break;
+            case eNoAction: break;
+        }
+        task->notify_pending = true;
+        sim::kernel::wakeAll(&task->notify_value);
+        return pdPASS;
+    }
+
+    void setWoken(Task* task, BaseType_t* woken) {
+        if (woken != nullptr && task != nullptr && task->state == Task::READY &&
+            task->priority > sim::kernel::self()->priority) {
+            *woken = pdTRUE;
+        }
+    }
+
+    QueueHandle_t createSemaphore(QueueDefinition::Kind kind, UBaseType_t max_count, UBaseType_t initial) {
+        QueueDefinition* semaphore = new QueueDefinition();
+        semaphore->kind = kind;
+        semaphore->max_count = max_count;
+        semaphore->count = initial;
+        return semaphore;
+    }
+
+    bool available(QueueDefinition* semaphore, Task* me) {
+        switch (semaphore->kind) {
+            case QueueDefinition::MUTEX: return semaphore->holder == nullptr;
+            case QueueDefinition::RECURSIVE_MUTEX: return semaphore->holder == nullptr || semaphore->holder == me;
+            default: return semaphore->count > 0;
+        }
+    }
+
+    void armTimer(TimerHandle_t timer, int64_t expiry_us);
+
+    void fireTimer(TimerHandle_t timer) {
+        timer->event = 0;
+        if (timer->auto_reload) {
+            armTimer(timer, timer->expiry_us + ticksToUs(timer->period));
+        } else {
+            timer->active = false;
+        }
+        timer->callback(timer);
+    }
+
+    void armTimer(TimerHandle_t timer, int64_t expiry_us) {
+        if (timer->event != 0) sim::kernel::cancel(timer->event);
+        timer->active = true;
+        timer->expiry_us = expiry_us;
+        timer->event = sim::kernel::at(expiry_us, [timer] { fireTimer(timer); }, sim::kernel::FIRMWARE);
+    }
+}
+
+// Tasks
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t code, const char* name, uint32_t stack_depth, void* parameters,
+                                   UBaseType_t priority, TaskHandle_t* created_task, BaseType_t core_id) {
+    (void)stack_depth;
+    (void)core_id;
+    Task* task = sim::kernel::spawn(name, priority, [code, parameters] { code(parameters); });
+    if (created_task != nullptr) *created_task = task;
+    sim::kernel::yieldIfPreempted();
+    return pdPASS;
+}
+
+BaseType_t xTaskCreate(TaskFunction_t code, const char* name, uint32_t stack_depth, void* parameters,
+                       UBaseType_t priority, TaskHandle_t* created_task) {
+    return xTaskCreatePinnedToCore(code, name, stack_depth, parameters, priority, created_task, tskNO_AFFINITY);
+}
+
+void vTaskDelete(TaskHandle_t task) {
+    sim::kernel::kill(static_cast<Task*>(task));
+}
+
+void vTaskDelay(TickType_t ticks) {
+    sim::kernel::sleepFor(ticksToUs(ticks));
+}
+
+TickType_t xTaskGetTickCount(void) {
+    return (TickType_t)(esp_timer_get_time() / (portTICK_PERIOD_MS * 1000));
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void) {
+    return sim::kernel::self();
+}
+
+UBaseType_t uxTaskPriorityGet(TaskHandle_t task) {
+    return (task ? static_cast<Task*>(task) : sim::kernel::self())->priority;
+}
+
+char* pcTaskGetName(TaskHandle_t task) {
+    return &(task ? static_cast<Task*>(task) : sim::kernel::self())->name[0];
+}
+
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t task) {
+    (void)task;
+    return 0;
+}
+
+void taskYIELD(void) {
+    Task* me = sim::kernel::self();
+    sim::kernel::at(sim::kernel::now(), [me] { sim::kernel::wake(me); }, sim::kernel::FIRMWARE);
+    sim::kernel::block(me, -1);
+}
+
+// Direct-to-task notifications
+
+BaseType_t xTaskNotify(TaskHandle_t task, uint32_t value, eNotifyAction action) {
+    return notify(static_cast<Task*>(task), value, action);
+}
+
+BaseType_t xTaskNotifyFromISR(TaskHandle_t task, uint32_t value, eNotifyAction action, BaseType_t* woken) {
+    BaseType_t result = notify(static_cast<Task*>(task), value, action);
+    setWoken(static_cast<Task*>(task), woken);
+    return result;
+}
+
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t* woken) {
+    notify(static_cast<Task*>(task), 0, eIncrement);
+    setWoken(static_cast<Task*>(task), woken);
+}
+
+BaseType_t xTaskNotifyWait(uint32_t bits_to_clear_on_entry, uint32_t bits_to_clear_on_exit, uint32_t* notification_value,
+                           TickType_t ticks_to_wait) {
+    Task* me = sim::kernel::self();
+    if (!me->notify_pending) me->notify_value &= ~bits_to_clear_on_entry;
+
+    bool received = waitFor(&me->notify_value, ticks_to_wait, [me] { return me->notify_pending; });
+    if (notification_value != nullptr) *notification_value = me->notify_value;
+    if (received) me->notify_value &= ~bits_to_clear_on_exit;
+    me->notify_pending = false;
+    return received ? pdTRUE : pdFALSE;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clear_count_on_exit, TickType_t ticks_to_wait) {
+    Task* me = sim::kernel::self();
+    waitFor(&me->notify_value, ticks_to_wait, [me] { return me->notify_value != 0; });
+
+    uint32_t value = me->notify_value;
+    if (value != 0) me->notify_value = clear_count_on_exit ? 0 : value - 1;
+    me->notify_pending = false;
+    return value;
+}
+
+// Queues
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t item_size) {
+    if (length == 0) return nullptr;
+    QueueDefinition* queue = new QueueDefinition();
+    queue->length = length;
+    queue->item_size = item_size;
+    return queue;
+}
+
+void vQueueDelete(QueueHandle_t queue) {
+    delete queue;
+}
+
+BaseType_t xQueueSend(QueueHandle_t queue, const void* item, TickType_t ticks_to_wait) {
+    if (!waitFor(queue, ticks_to_wait, [queue] { return queue->items.size() < queue->length; })) return errQUEUE_FULL;
+    const uint8_t* bytes = static_cast<const uint8_t*>(item);
+    queue->items.emplace_back(bytes, bytes + queue->item_size);
+    sim::kernel::wakeAll(queue);
+    return pdPASS;
+}
+
+BaseType_t xQueueSendToBack(QueueHandle_t queue, const void* item, TickType_t ticks_to_wait) {
+    return xQueueSend(queue, item, ticks_to_wait);
+}
+
+BaseType_t xQueueSendFromISR(QueueHandle_t queue, const void* item, BaseType_t* woken) {
+    if (queue->items.size() >= queue->length) return errQUEUE_FULL;
+    const uint8_t* bytes = static_cast<const uint8_t*>(item);
+    queue->items.emplace_back(bytes, bytes + queue->item_size);
+    sim::kernel::wakeAll(queue);
+    if (woken != nullptr) *woken = pdFALSE;
+    return pdPASS;
+}
+
+BaseType_t xQueueOverwrite(QueueHandle_t queue, const void* item) {
+    queue->items.clear();
+    return xQueueSend(queue, item, 0);
+}
+
+BaseType_t xQueueReceive(QueueHandle_t queue, void* buffer, TickType_t ticks_to_wait) {
+    if (!waitFor(queue, ticks_to_wait, [queue] { return !queue->items.empty(); })) return errQUEUE_EMPTY;
+    memcpy(buffer, queue->items.front().data(), queue->item_size);
+    queue->items.pop_front();
+    sim::kernel::wakeAll(queue);
+    return pdPASS;
+}
+
+BaseType_t xQueuePeek(QueueHandle_t queue, void* buffer, TickType_t ticks_to_wait) {
+    if (!waitFor(queue, ticks_to_wait, [queue] { return !queue->items.empty(); })) return errQUEUE_EMPTY;
+    memcpy(buffer, queue->items.front().data(), queue->item_size);
+    return pdPASS;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue) {
+    return (UBaseType_t)queue->items.size();
+}
+
+UBaseType_t uxQueueSpacesAvailable(QueueHandle_t queue) {
+    return (UBaseType_t)(queue->length - queue->items.size());
+}
+
+BaseType_t xQueueReset(QueueHandle_t queue) {
+    queue->items.clear();
+    sim::kernel::wakeAll(queue);
+    return pdPASS;
+}
+
+// Semaphores
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void) {
+    return createSemaphore(QueueDefinition::MUTEX, 1, 1);
+}
+
+SemaphoreHandle_t xSemaphoreCreateRecursiveMutex(void) {
+    return createSemaphore(QueueDefinition::RECURSIVE_MUTEX, 1, 1);
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinary(void) {
+    return createSemaphore(QueueDefinition::SEMAPHORE, 1, 0);
+}
+
+SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t max_count, UBaseType_t initial_count) {
+    return createSemaphore(QueueDefinition::SEMAPHORE, max_count, initial_count);
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t semaphore) {
+    delete semaphore;
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t ticks_to_wait) {
+    Task* me = sim::kernel::self();
+    bool mutex = semaphore->kind != QueueDefinition::SEMAPHORE;
+
+    // Priority inheritance: the holder runs at the waiter's priority until it gives the mutex back
+    if (mutex && semaphore->holder != nullptr && semaphore->holder != me && semaphore->holder->priority < me->priority) {
+        semaphore->holder->priority = me->priority;
+    }
+    if (!waitFor(semaphore, ticks_to_wait, [semaphore, me] { return available(semaphore, me); })) return pdFALSE;
+
+    if (mutex) {
+        semaphore->holder = me;
+        semaphore->recursion++;
+    } else {
+        semaphore->count--;
+    }
+    return pdTRUE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore) {
+    if (semaphore->kind != QueueDefinition::SEMAPHORE) {
+        Task* me = sim::kernel::self();
+        if (semaphore->holder != me) return pdFALSE;
+        if (--semaphore->recursion > 0) return pdTRUE;
+        semaphore->holder = nullptr;
+        me->priority = me->base_priority;
+    } else {
+        if (semaphore->count >= semaphore->max_count) return pdFALSE;
+        semaphore->count++;
+    }
+    sim::kernel::wakeAll(semaphore);
+    return pdTRUE;
+}
+
+BaseType_t xSemaphoreTakeRecursive(SemaphoreHandle_t mutex, TickType_t ticks_to_wait) {
+    return xSemaphoreTake(mutex, ticks_to_wait);
+}
+
+BaseType_t xSemaphoreGiveRecursive(SemaphoreHandle_t mutex) {
+    return xSemaphoreGive(mutex);
+}
+
+BaseType_t xSemaphoreGiveFromISR(SemaphoreHandle_t semaphore, BaseType_t* woken) {
+    if (semaphore->count >= semaphore->max_count) return pdFALSE;
+    semaphore->count++;
+    sim::kernel::wakeAll(semaphore);
+    if (woken != nullptr) *woken = pdFALSE;
+    return pdTRUE;
+}
+
+UBaseType_t uxSemaphoreGetCount(SemaphoreHandle_t semaphore) {
+    if (semaphore->kind != QueueDefinition::SEMAPHORE) return semaphore->holder == nullptr ? 1 : 0;
+    return semaphore->count;
+}
+
+// Software timers
+
+TimerHandle_t xTimerCreate(const char* name, TickType_t period, UBaseType_t auto_reload, void* timer_id,
+                           TimerCallbackFunction_t callback) {
+    if (period == 0 || callback == nullptr) return nullptr;
+    tmrTimerControl* timer = new tmrTimerControl();
+    timer->name = name ? name : "";
+    timer->period = period;
+    timer->auto_reload = auto_reload != pdFALSE;
+    timer->id = timer_id;
+    timer->callback = callback;
+    return timer;
+}
+
+BaseType_t xTimerStart(TimerHandle_t timer, TickType_t ticks_to_wait) {
+    (void)ticks_to_wait;
+    armTimer(timer, sim::kernel::now() + ticksToUs(timer->period));
+    return pdPASS;
+}
+
+BaseType_t xTimerReset(TimerHandle_t timer, TickType_t ticks_to_wait) {
+    return xTimerStart(timer, ticks_to_wait);
+}
+
+BaseType_t xTimerStop(TimerHandle_t timer, TickType_t ticks_to_wait) {
+    (void)ticks_to_wait;
+    if (timer->event != 0) sim::kernel::cancel(timer->event);
+    timer->event = 0;
+    timer->active = false;
+    return pdPASS;
+}
+
+BaseType_t xTimerChangePeriod(TimerHandle_t timer, TickType_t new_period, TickType_t ticks_to_wait) {
+    timer->period = new_period;
+    return xTimerStart(timer, ticks_to_wait);
+}
+
+BaseType_t xTimerDelete(TimerHandle_t timer, TickType_t ticks_to_wait) {
+    xTimerStop(timer, ticks_to_wait);
+    delete timer;
+    return pdPASS;
+}
+
+BaseType_t xTimerIsTimerActive(TimerHandle_t timer) {
+    return timer->active ? pdTRUE : pdFALSE;
+}
+
+void* pvTimerGetTimerID(TimerHandle_t timer) {
+    return timer->id;
+}
@@ -0,0 +1,187 @@
+#include <FS.h>
+#include <LittleFS.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+// Files live in host memory for the whole process, so they outlast simulated resets like flash
+namespace {
+    const size_t BLOCK_SIZE = 4096;
+    const size_t PARTITION_BYTES = 0x160000;
+
+    std::map<std::string, std::vector<uint8_t>>& files() {
+        static std::map<std::string, std::vector<uint8_t>>* table = new std::map<std::string, std::vector<uint8_t>>();
+        return *table;
+    }
+
+    std::string normalize(const char* path) {
+        std::string name = path ? path : "";
+        if (name.empty() || name[0] != '/') name.insert(name.begin(), '/');
+        return name;
+    }
+}
+
+namespace fs {
+    struct FileImpl {
+        std::string path;
+        bool writable = false;
+        bool open = true;
+        size_t position = 0;
+
+        std::vector<uint8_t>* data() {
+            if (!open) return nullptr;
+            auto it = files().find(path);
+            return it == files().end() ? nullptr : &it->second;
+        }
+    };
+
+    size_t File::write(uint8_t c) {
+        return write(&c, 1);
+    }
+
+    size_t File::write(const uint8_t* buffer, size_t size) {
+        std::vector<uint8_t>* data = impl ? impl->data() : nullptr;
+        if (data == nullptr || !impl->writable) return 0;
+        if (impl->position > data->size()) impl->position = data->size();
+        size_t overlap = std::min(size, data->size() - impl->position);
+        std::copy(buffer, buffer + overlap, data->begin() + impl->position);
+        data->insert(data->end(), buffer + overlap, buffer + size);
+        impl->position += size;
+        return size;
+    }
+
+    int File::available() {
+        std::vector<uint8_t>* data = impl ? impl->data() : nullptr;
+        if (data == nullptr || impl->position >= data->size()) return 0;
+        return (int)(data->size() - impl->position);
+    }
+
+    int File::read() {
+        uint8_t c;
+        return read(&c, 1) == 1 ? c : -1;
+    }
+
+    int File::peek() {
+        std::vector<uint8_t>* data = impl ? impl->data() : nullptr;
+        if (data == nullptr || impl->position >= data->size()) return -1;
+        return (*data)[impl->position];
+    }
+
+    size_t File::read(uint8_t* buffer, size_t size) {
+        std::vector<uint8_t>* data = impl ? impl->data() : nullptr;
+        if (data == nullptr || impl->position >= data->size()) return 0;
+        size_t count = std::min(size, data->size() - impl->position);
+        std::copy(data->begin() + impl->position, data->begin() + impl->position + count, buffer);
+        impl->position += count;
+        return count;
+    }
+
+    bool File::seek(uint32_t pos, SeekMode mode) {
+        std::vector<uint8_t>* data = impl ? impl->data() : nullptr;
+        if (data == nullptr) return false;
+        int64_t base = mode == SeekSet ? 0 : mode == SeekCur ? (int64_t)impl->position : (int64_t)data->size();
+        int64_t target = base + (int32_t)pos;
+        if (target < 0 || target > (int64_t)data->size()) return false;
+        impl->position = (size_t)target;
+        return true;
+    }
+
+    size_t File::position() const {
+        return impl ? impl->position : 0;
+    }
+
+    size_t File::size() const {
+        std::vector<uint8_t>* data = impl ? impl->data() : nullptr;
+        return data ? data->size() : 0;
+    }
+
+    void File::close() {
+        if (impl) impl->open = false;
+        impl.reset();
+    }
+
+    File::operator bool() const {
+        return impl && impl->data() != nullptr;
+    }
+
+    bool File::isDirectory() const {
+        return false;
+    }
+
+    const char* File::path() const {
+        return impl ? impl->path.c_str() : nullptr;
+    }
+
+    File FS::open(const char* path, const char* mode, bool create) {
+        (void)create;
+        if (!mounted || path == nullptr || mode == nullptr) return File();
+        std::string name = normalize(path);
+        auto it = files().find(name);
+
+        std::shared_ptr<FileImpl> impl = std::make_shared<FileImpl>();
+        impl->path = name;
+        switch (mode[0]) {
+            case 'r':
+                if (it == files().end()) return File();
+                impl->writable = mode[1] == '+';
+                break;
+            case 'w':
+                files()[name].clear();
+                impl->writable = true;
+                break;
+            case 'a':
+                impl->position = files()[name].size();
+                impl->writable = true;
+                break;
+            default:
+                return File();
+        }
+        return File(impl);
+    }
+
+    bool FS::exists(const char* path) {
+        return mounted && files().count(normalize(path)) > 0;
+    }
+
+    bool FS::remove(const char* path) {
+        return mounted && files().erase(normalize(path)) > 0;
+    }
+
+    bool FS::rename(const char* from, const char* to) {
+        if (!mounted) return false;
+        auto it = files().find(normalize(from));
+        if (it == files().end()) return false;
+        std::vector<uint8_t> data = std::move(it->second);
+        files().erase(it);
+        files()[normalize(to)] = std::move(data);
+        return true;
+    }
+
+    bool LittleFSFS::begin(bool formatOnFail, const char* basePath, uint8_t maxOpenFiles, const char* partitionLabel) {
+        (void)formatOnFail;
+        (void)basePath;
+        (void)maxOpenFiles;
+        (void)partitionLabel;
+        mounted = true;
+        return true;
+    }
+
+    bool LittleFSFS::format() {
+        files().clear();
+        return true;
+    }
+
+    size_t LittleFSFS::totalBytes() {
+        return PARTITION_BYTES;
+    }
+
+    // Whole blocks per file plus the two superblocks, as littlefs counts them
+    size_t LittleFSFS::usedBytes() {
+        size_t blocks = 2;
+        for (const auto& entry : files()) blocks += (entry.second.size() + BLOCK_SIZE - 1) / BLOCK_SIZE + 1;
+        return blocks * BLOCK_SIZE;
+    }
+}
+
+fs::LittleFSFS LittleFS;
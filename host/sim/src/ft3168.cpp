@@ -0,0 +1,128 @@
+#include <string.h>
+
+#include "config.h"
+#include "kernel.hpp"
+#include "sim/board.hpp"
+#include "sim/sim.hpp"
+
+// FocalTech FT3168 registers (FT3x68 application note)
+namespace {
+    enum : uint8_t {
+        TD_STATUS = 0x02, P1_XH = 0x03, P1_XL = 0x04, P1_YH = 0x05, P1_YL = 0x06,
+        ID_G_CIPHER = 0xA0, ID_G_PMODE = 0xA5,
+    };
+
+    const uint8_t PMODE_HIBERNATE = 0x03;
+    const uint8_t CHIP_ID = 0x03;
+
+    // Event flag in P1_XH[7:6]
+    const uint8_t EVENT_DOWN = 0x00;
+    const uint8_t EVENT_UP = 0x01;
+    const uint8_t EVENT_CONTACT = 0x02;
+
+    const int64_t INT_PULSE_US = 100;
+}
+
+namespace sim {
+namespace board {
+
+Ft3168::Ft3168() {
+    memset(regs, 0, sizeof(regs));
+    regs[ID_G_CIPHER] = CHIP_ID;
+    sim::gpio::onWrite(TOUCH_RST, [this](int level) { onReset(level); });
+}
+
+// Reset is active low; the controller answers again BOOT_US after it is released
+void Ft3168::onReset(int level) {
+    if (level == 0) {
+        if (boot_event != 0) sim::kernel::cancel(boot_event);
+        boot_event = 0;
+        state = IN_RESET;
+        gesture++;  // A reset drops the touch in progress
+        return;
+    }
+    if (state != IN_RESET) return;
+    state = BOOTING;
+    boot_event = sim::kernel::at(sim::kernel::now() + BOOT_US, [this] {
+        boot_event = 0;
+        memset(regs, 0, sizeof(regs));
+        regs[ID_G_CIPHER] = CHIP_ID;
+        state = READY;
+    }, sim::kernel::DEVICE);
+}
+
+bool Ft3168::transfer(const uint8_t* tx, size_t tx_len, uint8_t* rx, size_t rx_len) {
+    if (state != READY) return false;  // No ACK in reset, while booting or hibernating
+
+    if (tx_len > 0) {
+        pointer = tx[0];
+        for (size_t i = 1; i < tx_len; i++) {
+            uint8_t reg = pointer++;
+            if (reg == ID_G_CIPHER) continue;
+            regs[reg] = tx[i];
+            if (reg == ID_G_PMODE && tx[i] == PMODE_HIBERNATE) {
+                state = HIBERNATE;  // Until the next reset
+                gesture++;
+            }
+        }
+    }
+    for (size_t i = 0; i < rx_len; i++) rx[i] = regs[pointer++];
+    return true;
+}
+
+void Ft3168::press(uint16_t x, uint16_t y, int64_t duration_us) {
+    swipe(x, y, x, y, duration_us);
+}
+
+void Ft3168::swipe(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1, int64_t duration_us) {
+    uint64_t generation = ++gesture;
+    int64_t start = sim::kernel::now();
+    sim::kernel::at(start, [=] { report(generation, start, duration_us, x0, y0, x1, y1); }, sim::kernel::DEVICE);
+}
+
+void Ft3168::frame(uint8_t fingers, uint16_t x, uint16_t y) {
+    gesture++;
+    if (state != READY) return;
+    bool was_down = regs[TD_STATUS] != 0;
+    uint8_t event = fingers == 0 ? EVENT_UP : (was_down ? EVENT_CONTACT : EVENT_DOWN);
+    regs[TD_STATUS] = fingers;
+    regs[P1_XH] = (uint8_t)(event << 6 | ((x >> 8) & 0x0F));
+    regs[P1_XL] = (uint8_t)(x & 0xFF);
+    regs[P1_YH] = (uint8_t)((y >> 8) & 0x0F);
+    regs[P1_YL] = (uint8_t)(y & 0xFF);
+    pulse();
+}
+
+// One report frame; a newer gesture, a reset or hibernate ends the current one
+void Ft3168::report(uint64_t generation, int64_t start_us, int64_t duration_us,
+                    uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1) {
+    if (generation != gesture || state != READY) return;
+
+    int64_t elapsed = sim::kernel::now() - start_us;
+    bool lift = elapsed >= duration_us;
+    float t = duration_us > 0 ? (float)(lift ? duration_us : elapsed) / (float)duration_us : 1.0f;
+    uint16_t x = (uint16_t)(x0 + ((float)x1 - (float)x0) * t + 0.5f);
+    uint16_t y = (uint16_t)(y0 + ((float)y1 - (float)y0) * t + 0.5f);
+    uint8_t event = lift ? EVENT_UP : (elapsed == 0 ? EVENT_DOWN : EVENT_CONTACT);
+
+    regs[TD_STATUS] = lift ? 0 : 1;
+    regs[P1_XH] = (uint8_t)(event << 6 | ((x >> 8) & 0x0F));
+    regs[P1_XL] = (uint8_t)(x & 0xFF);
+    regs[P1_YH] = (uint8_t)((y >> 8) & 0x0F);
+    regs[P1_YL] = (uint8_t)(y & 0xFF);
+    pulse();
+
+    if (lift) return;
+    int64_t next = sim::kernel::now() + REPORT_US;
+    if (next > start_us + duration_us) next = start_us + duration_us;
+    sim::kernel::at(next, [=] { report(generation, start_us, duration_us, x0, y0, x1, y1); }, sim::kernel::DEVICE);
+}
+
+// INT is open drain, pulled low for a moment per report
+void Ft3168::pulse() {
+    sim::gpio::drive(TOUCH_INT, 0);
+    sim::kernel::at(sim::kernel::now() + INT_PULSE_US, [] { sim::gpio::release(TOUCH_INT); }, sim::kernel::DEVICE);
+}
+
+}
+}
@@ -0,0 +1,12 @@
+#include <Arduino_GFX_Library.h>
+
+// Text only moves the cursor (6x8 glyphs at size 1, as the built-in font)
+size_t Arduino_GFX::write(uint8_t c) {
+    if (c == '\n') {
+        cursor_x = 0;
+        cursor_y = (int16_t)(cursor_y + 8 * text_size);
+    } else if (c != '\r') {
+        cursor_x = (int16_t)(cursor_x + 6 * text_size);
+    }
+    return 1;
+}
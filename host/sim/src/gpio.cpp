@@ -0,0 +1,281 @@
+#include <Arduino.h>
+#include <driver/gpio.h>
+#include <driver/rtc_io.h>
+
+#include <functional>
+#include <vector>
+
+#include "hal.hpp"
+#include "kernel.hpp"
+#include "sim/sim.hpp"
+
+namespace {
+    struct Pin {
+        uint8_t mode = 0;           // pinMode(); 0 = not configured
+        int output = LOW;
+        int external = -1;          // Level an outside circuit drives, -1 = none
+        int rtc_pull = -1;          // RTC domain pull (holds in deep sleep), -1 = none
+        int board_pull = -1;        // Resistor on the board, -1 = none
+        int last = LOW;
+
+        std::function<void()> isr;
+        gpio_int_type_t intr_type = GPIO_INTR_DISABLE;
+        bool intr_enabled = false;
+        bool deferred = false;      // Edge seen while asleep
+        gpio_int_type_t wakeup = GPIO_INTR_DISABLE;
+
+        std::vector<std::function<void(int)>> listeners;
+    };
+
+    std::vector<Pin>& pins() {
+        static std::vector<Pin>* table = new std::vector<Pin>(GPIO_NUM_MAX);
+        return *table;
+    }
+
+    bool valid(int pin) { return pin >= 0 && pin < GPIO_NUM_MAX; }
+
+    int levelOf(const Pin& p) {
+        bool push_pull = (p.mode & OUTPUT) == OUTPUT && !(p.mode & OPEN_DRAIN);
+        if (push_pull) return p.output;
+        if ((p.mode & OUTPUT) == OUTPUT && p.output == LOW) return LOW;  // Open drain pulling down
+        if (p.external >= 0) return p.external;
+        if (p.rtc_pull >= 0) return p.rtc_pull;
+        if (p.mode & PULLUP) return HIGH;
+        if (p.mode & PULLDOWN) return LOW;
+        if (p.board_pull >= 0) return p.board_pull;
+        return LOW;
+    }
+
+    bool triggers(gpio_int_type_t type, int from, int to) {
+        switch (type) {
+            case GPIO_INTR_POSEDGE: return from == LOW && to == HIGH;
+            case GPIO_INTR_NEGEDGE: return from == HIGH && to == LOW;
+            case GPIO_INTR_ANYEDGE: return from != to;
+            case GPIO_INTR_LOW_LEVEL: return to == LOW;
+            case GPIO_INTR_HIGH_LEVEL: return to == HIGH;
+            default: return false;
+        }
+    }
+
+    void runIsr(Pin& p) {
+        {
+            sim::kernel::IsrScope scope;
+            p.isr();
+        }
+        sim::kernel::yieldIfPreempted();
+    }
+
+    // Something that sets the pin level changed: fire its interrupt on a matching transition
+    void update(int pin) {
+        Pin& p = pins()[pin];
+        int level = levelOf(p);
+        if (level == p.last) return;
+        int from = p.last;
+        p.last = level;
+
+        if (!p.intr_enabled || !p.isr || !triggers(p.intr_type, from, level)) return;
+        if (sim::kernel::isSleeping()) {
+            p.deferred = true;  // The GPIO matrix is clock gated: the CPU sees it after the wake
+            return;
+        }
+        runIsr(p);
+    }
+
+    gpio_int_type_t intrType(int mode) {
+        switch (mode) {
+            case RISING: return GPIO_INTR_POSEDGE;
+            case FALLING: return GPIO_INTR_NEGEDGE;
+            case CHANGE: return GPIO_INTR_ANYEDGE;
+            case ONLOW: return GPIO_INTR_LOW_LEVEL;
+            case ONHIGH: return GPIO_INTR_HIGH_LEVEL;
+            default: return GPIO_INTR_DISABLE;
+        }
+    }
+}
+
+// Arduino
+
+void pinMode(uint8_t pin, uint8_t mode) {
+    if (!valid(pin)) return;
+    pins()[pin].mode = mode;
+    update(pin);
+}
+
+void digitalWrite(uint8_t pin, uint8_t value) {
+    if (!valid(pin)) return;
+    Pin& p = pins()[pin];
+    p.output = value ? HIGH : LOW;
+    update(pin);
+    for (auto& listener : p.listeners) listener(p.output);
+}
+
+int digitalRead(uint8_t pin) {
+    return valid(pin) ? levelOf(pins()[pin]) : LOW;
+}
+
+void attachInterrupt(uint8_t pin, void (*handler)(void), int mode) {
+    if (!valid(pin) || handler == nullptr) return;
+    Pin& p = pins()[pin];
+    p.isr = handler;
+    p.intr_type = intrType(mode);
+    p.intr_enabled = p.intr_type != GPIO_INTR_DISABLE;
+    p.last = levelOf(p);
+}
+
+void attachInterruptArg(uint8_t pin, void (*handler)(void*), void* arg, int mode) {
+    if (!valid(pin) || handler == nullptr) return;
+    Pin& p = pins()[pin];
+    p.isr = [handler, arg] { handler(arg); };
+    p.intr_type = intrType(mode);
+    p.intr_enabled = p.intr_type != GPIO_INTR_DISABLE;
+    p.last = levelOf(p);
+}
+
+void detachInterrupt(uint8_t pin) {
+    if (!valid(pin)) return;
+    Pin& p = pins()[pin];
+    p.isr = nullptr;
+    p.intr_type = GPIO_INTR_DISABLE;
+    p.intr_enabled = false;
+}
+
+// ESP-IDF
+
+int gpio_get_level(gpio_num_t gpio_num) {
+    return digitalRead(gpio_num);
+}
+
+esp_err_t gpio_set_intr_type(gpio_num_t gpio_num, gpio_int_type_t intr_type) {
+    if (!valid(gpio_num) || intr_type >= GPIO_INTR_MAX) return ESP_ERR_INVALID_ARG;
+    pins()[gpio_num].intr_type = intr_type;
+    return ESP_OK;
+}
+
+esp_err_t gpio_intr_enable(gpio_num_t gpio_num) {
+    if (!valid(gpio_num)) return ESP_ERR_INVALID_ARG;
+    Pin& p = pins()[gpio_num];
+    p.intr_enabled = true;
+    p.last = levelOf(p);
+    // A level interrupt enabled while its level is present fires at once
+    if (p.isr && (p.intr_type == GPIO_INTR_LOW_LEVEL || p.intr_type == GPIO_INTR_HIGH_LEVEL) &&
+        triggers(p.intr_type, p.last, p.last) && !sim::kernel::isSleeping()) {
+        runIsr(p);
+    }
+    return ESP_OK;
+}
+
+esp_err_t gpio_intr_disable(gpio_num_t gpio_num) {
+    if (!valid(gpio_num)) return ESP_ERR_INVALID_ARG;
+    pins()[gpio_num].intr_enabled = false;
+    return ESP_OK;
+}
+
+esp_err_t gpio_wakeup_enable(gpio_num_t gpio_num, gpio_int_type_t intr_type) {
+    if (!valid(gpio_num)) return ESP_ERR_INVALID_ARG;
+    if (intr_type != GPIO_INTR_LOW_LEVEL && intr_type != GPIO_INTR_HIGH_LEVEL) return ESP_ERR_INVALID_ARG;
+    Pin& p = pins()[gpio_num];
+    p.wakeup = intr_type;
+    p.intr_type = intr_type;  // As in IDF: the wake-up level is the pin's interrupt type
+    return ESP_OK;
+}
+
+esp_err_t gpio_wakeup_disable(gpio_num_t gpio_num) {
+    if (!valid(gpio_num)) return ESP_ERR_INVALID_ARG;
+    pins()[gpio_num].wakeup = GPIO_INTR_DISABLE;
+    return ESP_OK;
+}
+
+esp_err_t gpio_hold_en(gpio_num_t gpio_num) {
+    return valid(gpio_num) ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+esp_err_t gpio_hold_dis(gpio_num_t gpio_num) {
+    return valid(gpio_num) ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+bool rtc_gpio_is_valid_gpio(gpio_num_t gpio_num) {
+    return gpio_num >= 0 && gpio_num <= 21;
+}
+
+namespace {
+    esp_err_t setRtcPull(gpio_num_t gpio_num, int level, bool enable) {
+        if (!rtc_gpio_is_valid_gpio(gpio_num)) return ESP_ERR_INVALID_ARG;
+        Pin& p = pins()[gpio_num];
+        if (enable) {
+            p.rtc_pull = level;
+        } else if (p.rtc_pull == level) {
+            p.rtc_pull = -1;
+        }
+        update(gpio_num);
+        return ESP_OK;
+    }
+}
+
+esp_err_t rtc_gpio_pullup_en(gpio_num_t gpio_num) { return setRtcPull(gpio_num, HIGH, true); }
+esp_err_t rtc_gpio_pullup_dis(gpio_num_t gpio_num) { return setRtcPull(gpio_num, HIGH, false); }
+esp_err_t rtc_gpio_pulldown_en(gpio_num_t gpio_num) { return setRtcPull(gpio_num, LOW, true); }
+esp_err_t rtc_gpio_pulldown_dis(gpio_num_t gpio_num) { return setRtcPull(gpio_num, LOW, false); }
+
+// Simulation side
+
+void sim::gpio::drive(int pin, int level) {
+    if (!valid(pin)) return;
+    pins()[pin].external = level ? HIGH : LOW;
+    update(pin);
+}
+
+void sim::gpio::release(int pin) {
+    if (!valid(pin)) return;
+    pins()[pin].external = -1;
+    update(pin);
+}
+
+void sim::gpio::pull(int pin, int level) {
+    if (!valid(pin)) return;
+    pins()[pin].board_pull = level < 0 ? -1 : (level ? HIGH : LOW);
+    update(pin);
+}
+
+int sim::gpio::level(int pin) {
+    return digitalRead(pin);
+}
+
+void sim::gpio::onWrite(int pin, std::function<void(int level)> listener) {
+    if (valid(pin)) pins()[pin].listeners.push_back(std::move(listener));
+}
+
+bool sim::hal::gpioWakeArmed() {
+    for (const Pin& p : pins()) {
+        if (p.wakeup != GPIO_INTR_DISABLE) return true;
+    }
+    return false;
+}
+
+bool sim::hal::gpioWakePending() {
+    for (const Pin& p : pins()) {
+        if (p.wakeup != GPIO_INTR_DISABLE && triggers(p.wakeup, p.last, levelOf(p))) return true;
+    }
+    return false;
+}
+
+void sim::hal::gpioRunDeferredIsrs() {
+    for (Pin& p : pins()) {
+        if (!p.deferred) continue;
+        p.deferred = false;
+        if (p.intr_enabled && p.isr) runIsr(p);
+    }
+}
+
+void sim::hal::gpioReset() {
+    for (size_t pin = 0; pin < pins().size(); pin++) {
+        Pin& p = pins()[pin];
+        p.mode = 0;
+        p.output = LOW;
+        p.isr = nullptr;
+        p.intr_type = GPIO_INTR_DISABLE;
+        p.intr_enabled = false;
+        p.deferred = false;
+        p.wakeup = GPIO_INTR_DISABLE;
+        p.last = levelOf(p);
+    }
+}
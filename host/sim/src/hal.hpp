@@ -0,0 +1,29 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+#include "driver/gpio.h"
+
+// Internal glue between the shims (not part of the library's API)
+namespace sim {
+namespace hal {
+    // Simulated time of the last reset; esp_timer counts from here
+    int64_t bootUs();
+
+    void consoleWrite(const uint8_t* data, size_t size);
+
+    // GPIO wake-up as armed by gpio_wakeup_enable() and esp_sleep_enable_ext0/ext1_wakeup()
+    bool gpioWakeArmed();
+    bool gpioWakePending();
+    // Runs edge interrupts that came in while the chip slept, if still enabled
+    void gpioRunDeferredIsrs();
+    // Deep sleep: clears pin modes, interrupts and wake-up levels, keeps the RTC pulls
+    void gpioReset();
+
+    // Deep sleep reset of the I2C controller and the radio
+    void wireReset();
+    void wifiReset();
+
+    bool wifiConnected();
+}
+}
@@ -0,0 +1,49 @@
+// Host entry point: runs the firmware on the simulated board and reports
+// how much I2C bus time each pass through loop() costs.
+//
+//   program [--seconds N] [--bus-hz HZ] [--no-wifi] [--quiet]
+//
+// Unit tests (PIO_UNIT_TESTING) and host tools built with SIM_CUSTOM_MAIN
+// bring their own main() and drive sim::run().
+#if !defined(PIO_UNIT_TESTING) && !defined(SIM_CUSTOM_MAIN)
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "sim/bus_report.hpp"
+#include "sim/i2c.hpp"
+#include "sim/sim.hpp"
+
+int main(int argc, char** argv) {
+    double seconds = 60.0;
+    uint32_t bus_hz = 0;
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--seconds") && i + 1 < argc) {
+            seconds = atof(argv[++i]);
+        } else if (!strcmp(argv[i], "--bus-hz") && i + 1 < argc) {
+            bus_hz = (uint32_t)atol(argv[++i]);
+        } else if (!strcmp(argv[i], "--no-wifi")) {
+            sim::setWifiReachable(false);
+        } else if (!strcmp(argv[i], "--quiet")) {
+            sim::console::setEcho(false);
+        } else {
+            fprintf(stderr, "usage: %s [--seconds N] [--bus-hz HZ] [--no-wifi] [--quiet]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (bus_hz) sim::i2c::setClockOverride(bus_hz);
+
+    // Boot and settle first: the report covers steady-state loop iterations
+    const int64_t settle_us = 5000000;
+    sim::run(settle_us);
+    sim::BusReport report;
+    report.start();
+    sim::run(settle_us + (int64_t)(seconds * 1e6));
+    report.print(stdout);
+    fflush(stdout);
+    _exit(0);  // Firmware tasks stay blocked in their threads
+}
+
+#endif
@@ -0,0 +1,388 @@
+#include "kernel.hpp"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace sim {
+namespace kernel {
+namespace {
+    struct Event {
+        std::function<void()> fn;
+        EventClass cls;
+    };
+    typedef std::pair<int64_t, uint64_t> Key;  // (time, id): same-time events run in order of scheduling
+
+    struct State {
+        std::mutex baton;
+        Task* running = nullptr;
+        Task* main = nullptr;
+        std::vector<Task*> tasks;
+        std::deque<Task*> ready;
+        std::map<Key, Event> events;
+        std::unordered_map<uint64_t, int64_t> event_time;
+        uint64_t next_event = 1;
+        int64_t now = 0;
+        int isr_depth = 0;
+        int event_depth = 0;
+        bool sleeping = false;
+        bool control_due = false;   // runUntil() time reached
+        Task* paused = nullptr;     // Task that held the CPU when control returned to the host
+        std::vector<std::function<void()>> reset_hooks;
+    };
+
+    // Never destroyed: detached task threads may still wait on it at exit
+    State& k() {
+        static State* state = new State();
+        return *state;
+    }
+
+    void ensureMain() {
+        State& s = k();
+        if (s.main != nullptr) return;
+        Task* task = new Task();
+        task->name = "main";
+        task->base_priority = task->priority = 1;
+        task->state = Task::RUNNING;
+        s.main = task;
+        s.running = task;
+        s.tasks.push_back(task);
+    }
+
+    [[noreturn]] void deadlock() {
+        fprintf(stderr, "sim: deadlock at %lld us - no task ready and no event pending\n", (long long)k().now);
+        for (Task* task : k().tasks) {
+            if (task->state == Task::BLOCKED) fprintf(stderr, "sim:   %s blocked\n", task->name.c_str());
+        }
+        abort();
+    }
+
+    Task* highestReady() {
+        Task* best = nullptr;
+        for (Task* task : k().ready) {
+            if (best == nullptr || task->priority > best->priority) best = task;
+        }
+        return best;
+    }
+
+    Task* pickReady() {
+        Task* best = highestReady();
+        if (best != nullptr) {
+            std::deque<Task*>& ready = k().ready;
+            for (auto it = ready.begin(); it != ready.end(); ++it) {
+                if (*it == best) {
+                    ready.erase(it);
+                    break;
+                }
+            }
+        }
+        return best;
+    }
+
+    void makeReady(Task* task) {
+        task->state = Task::READY;
+        k().ready.push_back(task);
+    }
+
+    bool runNextEvent() {
+        State& s = k();
+        if (s.events.empty()) return false;
+        auto it = s.events.begin();
+        int64_t when = it->first.first;
+        Event event = std::move(it->second);
+        s.event_time.erase(it->first.second);
+        s.events.erase(it);
+
+        if (when > s.now) s.now = when;
+        s.event_depth++;
+        event.fn();
+        s.event_depth--;
+        return true;
+    }
+
+    // Passes the CPU to next and waits until it comes back
+    void handoff(Task* me, Task* next) {
+        std::unique_lock<std::mutex> lock(k().baton);
+        k().running = next;
+        next->cv.notify_one();
+        me->cv.wait(lock, [me] { return k().running == me; });
+    }
+
+    void switchTo(Task* me, Task* next) {
+        next->state = Task::RUNNING;
+        if (next != me) handoff(me, next);
+    }
+
+    // The running task gave up the CPU: run the next ready one, advancing time until there is one
+    void reschedule(Task* me) {
+        for (;;) {
+            if (me == k().main && k().control_due) return;
+
+            Task* next = pickReady();
+            if (next != nullptr) {
+                switchTo(me, next);
+                return;
+            }
+            if (!runNextEvent()) deadlock();
+        }
+    }
+}
+
+int64_t now() { return k().now; }
+
+Task* self() {
+    ensureMain();
+    return k().running;
+}
+
+Task* getMainTask() {
+    ensureMain();
+    return k().main;
+}
+
+Task* spawn(const char* name, unsigned priority, std::function<void()> entry) {
+    ensureMain();
+    Task* task = new Task();
+    task->name = name ? name : "";
+    task->base_priority = task->priority = priority;
+    task->entry = std::move(entry);
+    k().tasks.push_back(task);
+
+    std::thread([task] {
+        {
+            std::unique_lock<std::mutex> lock(k().baton);
+            task->cv.wait(lock, [task] { return k().running == task; });
+        }
+        task->entry();
+        exitTask();
+    }).detach();
+
+    makeReady(task);
+    return task;
+}
+
+void exitTask() {
+    Task* me = self();
+    me->state = Task::DEAD;
+    for (;;) {
+        Task* next = pickReady();
+        if (next != nullptr) {
+            next->state = Task::RUNNING;
+            handoff(me, next);  // Never returns: a dead task is not scheduled again
+        }
+        if (!runNextEvent()) deadlock();
+    }
+}
+
+void kill(Task* task) {
+    if (task == nullptr || task == self()) {
+        exitTask();
+        return;
+    }
+    task->state = Task::DEAD;
+    std::deque<Task*>& ready = k().ready;
+    for (auto it = ready.begin(); it != ready.end(); ++it) {
+        if (*it == task) {
+            ready.erase(it);
+            break;
+        }
+    }
+}
+
+bool block(const void* object, int64_t timeout_us) {
+    Task* me = self();
+    if (me == k().main && k().paused != nullptr) {
+        fprintf(stderr, "sim: the host thread cannot wait while the firmware is paused in run()\n");
+        abort();
+    }
+    me->state = Task::BLOCKED;
+    me->waiting_on = object;
+    me->woken = false;
+    uint64_t seq = ++me->wait_seq;
+
+    uint64_t timeout = 0;
+    if (timeout_us >= 0) {
+        timeout = at(k().now + timeout_us, [me, seq] {
+            if (me->state == Task::BLOCKED && me->wait_seq == seq) makeReady(me);
+        }, FIRMWARE);
+    }
+    reschedule(me);
+
+    if (timeout != 0) cancel(timeout);
+    me->waiting_on = nullptr;
+    return me->woken;
+}
+
+void wake(Task* task) {
+    if (task == nullptr || task->state != Task::BLOCKED) return;
+    task->woken = true;
+    makeReady(task);
+    yieldIfPreempted();
+}
+
+void wakeAll(const void* object) {
+    for (Task* task : k().tasks) {
+        if (task->state == Task::BLOCKED && task->waiting_on == object) {
+            task->woken = true;
+            makeReady(task);
+        }
+    }
+    yieldIfPreempted();
+}
+
+void yieldIfPreempted() {
+    State& s = k();
+    if (s.isr_depth > 0 || s.event_depth > 0 || s.sleeping) return;
+    Task* me = self();
+    if (me == s.main) return;  // The host thread only gives the CPU away by waiting
+    Task* best = highestReady();
+    if (best == nullptr || best->priority <= me->priority) return;
+
+    me->state = Task::READY;
+    s.ready.push_front(me);
+    reschedule(me);
+}
+
+void consume(int64_t us) {
+    State& s = k();
+    int64_t end = s.now + us;
+    while (!s.events.empty() && s.events.begin()->first.first <= end) {
+        runNextEvent();
+        yieldIfPreempted();
+    }
+    if (s.now < end) s.now = end;
+}
+
+void sleepFor(int64_t us) {
+    block(nullptr, us < 0 ? 0 : us);
+}
+
+uint64_t at(int64_t when_us, std::function<void()> fn, EventClass cls) {
+    State& s = k();
+    if (when_us < s.now) when_us = s.now;
+    uint64_t id = s.next_event++;
+    s.events[Key(when_us, id)] = Event{std::move(fn), cls};
+    s.event_time[id] = when_us;
+    return id;
+}
+
+void cancel(uint64_t id) {
+    State& s = k();
+    auto it = s.event_time.find(id);
+    if (it == s.event_time.end()) return;
+    s.events.erase(Key(it->second, id));
+    s.event_time.erase(it);
+}
+
+IsrScope::IsrScope() { k().isr_depth++; }
+IsrScope::~IsrScope() { k().isr_depth--; }
+
+bool inInterrupt() { return k().isr_depth > 0; }
+
+bool sleepUntil(std::function<bool()> wake, int64_t until_us) {
+    State& s = k();
+    s.sleeping = true;
+    std::vector<std::pair<Key, Event>> deferred;
+    bool woke = false;
+
+    for (;;) {
+        if (wake()) {
+            woke = true;
+            break;
+        }
+        auto it = s.events.begin();
+        if (it == s.events.end() || (until_us >= 0 && it->first.first > until_us)) {
+            if (until_us < 0) {
+                fprintf(stderr, "sim: sleep at %lld us has no wake source\n", (long long)s.now);
+                abort();
+            }
+            if (s.now < until_us) s.now = until_us;
+            break;
+        }
+        if (it->second.cls == FIRMWARE) {
+            // The RTOS tick is stopped: timers and timeouts fire after the wake
+            deferred.emplace_back(it->first, std::move(it->second));
+            s.event_time.erase(it->first.second);
+            s.events.erase(it);
+            continue;
+        }
+        runNextEvent();
+    }
+
+    for (auto& event : deferred) {
+        s.event_time[event.first.second] = event.first.first;
+        s.events[event.first] = std::move(event.second);
+    }
+    s.sleeping = false;
+    return woke;
+}
+
+bool isSleeping() { return k().sleeping; }
+
+void runUntil(int64_t until_us) {
+    State& s = k();
+    Task* me = self();
+    if (me != s.main) {
+        fprintf(stderr, "sim: run() called from a firmware task\n");
+        abort();
+    }
+
+    // The event fires on whichever thread holds the CPU, even one in sleep:
+    // that task is parked where it is and resumed by the next call
+    s.control_due = false;
+    at(until_us, [] {
+        State& s = k();
+        s.control_due = true;
+        Task* running = s.running;
+        if (running == s.main) return;
+        s.paused = running;
+        handoff(running, s.main);
+    }, DEVICE);
+
+    me->state = Task::BLOCKED;
+    me->waiting_on = &s.control_due;
+    Task* resume = s.paused;
+    s.paused = nullptr;
+    if (resume != nullptr) {
+        handoff(me, resume);
+    } else {
+        reschedule(me);
+    }
+    me->state = Task::RUNNING;
+    me->waiting_on = nullptr;
+    s.control_due = false;
+}
+
+void reset() {
+    State& s = k();
+    Task* me = self();
+    for (Task* task : s.tasks) {
+        if (task != me && task != s.main) task->state = Task::DEAD;
+    }
+    s.ready.clear();
+
+    for (auto it = s.events.begin(); it != s.events.end();) {
+        if (it->second.cls == FIRMWARE) {
+            s.event_time.erase(it->first.second);
+            it = s.events.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    me->priority = me->base_priority;
+    me->notify_value = 0;
+    me->notify_pending = false;
+    for (auto& hook : s.reset_hooks) hook();
+}
+
+void onReset(std::function<void()> hook) {
+    k().reset_hooks.push_back(std::move(hook));
+}
+}
+}
@@ -0,0 +1,95 @@
+#pragma once
+#include <stdint.h>
+#include <condition_variable>
+#include <functional>
+#include <string>
+
+/**
+ * Simulation kernel: a cooperative scheduler for the firmware's tasks and
+ * a time-ordered event queue for everything else.
+ *
+ * Every task is a host thread, but only the one holding the baton runs;
+ * the others wait on their condition variable. A task gives the baton away
+ * when it blocks, or when it makes a higher-priority task ready outside an
+ * interrupt. With no task ready the kernel advances the clock to the next
+ * event. Events are device behaviour (a sensor sample, a touch frame) or
+ * firmware timers and timeouts; only the former run while the chip sleeps
+ * and survive a deep sleep reset.
+ *
+ * Nothing in here is destroyed at exit: tasks that never finish stay
+ * blocked on their condition variables.
+ */
+namespace sim {
+namespace kernel {
+    struct Task {
+        enum State : uint8_t { READY, RUNNING, BLOCKED, DEAD };
+
+        std::string name;
+        unsigned base_priority;
+        unsigned priority;          // Raised while holding a mutex a higher-priority task waits for
+        State state = READY;
+        std::condition_variable cv;
+        std::function<void()> entry;
+
+        const void* waiting_on = nullptr;
+        bool woken = false;
+        uint64_t wait_seq = 0;
+
+        // FreeRTOS direct-to-task notification
+        uint32_t notify_value = 0;
+        bool notify_pending = false;
+    };
+
+    enum EventClass : uint8_t {
+        DEVICE,     // Hardware: runs in sleep, survives a reset
+        FIRMWARE,   // RTOS timeouts and timers: deferred in light sleep, dropped at a reset
+    };
+
+    int64_t now();
+    Task* self();
+    Task* getMainTask();    // The host thread, registered on first use
+
+    // New tasks are ready; the caller switches with yieldIfPreempted() when it wants to
+    Task* spawn(const char* name, unsigned priority, std::function<void()> entry);
+    void exitTask();    // Does not return
+    void kill(Task* task);
+
+    // Blocks the running task on object until wakeAll(object)/wake() or the
+    // timeout (µs, negative = forever); true if woken
+    bool block(const void* object, int64_t timeout_us);
+    void wake(Task* task);
+    void wakeAll(const void* object);
+    // Highest priority ready task would preempt: switch to it (no-op in interrupts
+    // and on the host thread)
+    void yieldIfPreempted();
+    // Busy time of the running task; due events run and may preempt it
+    void consume(int64_t us);
+    // Blocking delay
+    void sleepFor(int64_t us);
+
+    uint64_t at(int64_t when_us, std::function<void()> fn, EventClass cls);
+    void cancel(uint64_t id);
+
+    // Interrupt context: RTOS calls make tasks ready without switching
+    struct IsrScope {
+        IsrScope();
+        ~IsrScope();
+    };
+    bool inInterrupt();
+
+    // Sleep: runs device events only until wake() is true or the time
+    // reaches until_us (negative = no limit); returns false at the limit.
+    // Firmware events that came due are kept for after the wake.
+    bool sleepUntil(std::function<bool()> wake, int64_t until_us);
+    bool isSleeping();
+
+    // Host thread (the process' main thread): lets the tasks run until the
+    // time, then returns with them paused. Between calls the host must not
+    // wait in the kernel (bus transfers, delays).
+    void runUntil(int64_t until_us);
+
+    // Deep sleep reset: drops every task but the calling one (and the host thread) and all firmware events
+    void reset();
+    void onReset(std::function<void()> hook);
+}
+}
@@ -0,0 +1,265 @@
+#include <math.h>
+#include <string.h>
+#include <time.h>
+
+#include "config.h"
+#include "kernel.hpp"
+#include "sim/board.hpp"
+#include "sim/sim.hpp"
+
+// Register numbers and bits from the PCF85063A datasheet (rev. 7)
+namespace {
+    enum : uint8_t {
+        CONTROL_1 = 0x00, CONTROL_2 = 0x01, SECONDS = 0x04, YEARS = 0x0A,
+        SECOND_ALARM = 0x0B, WEEKDAY_ALARM = 0x0F, TIMER_VALUE = 0x10, TIMER_MODE = 0x11,
+    };
+
+    const uint8_t CONTROL_1_STOP = 1 << 5;
+    const uint8_t CONTROL_2_AIE = 1 << 7;
+    const uint8_t CONTROL_2_AF = 1 << 6;
+    const uint8_t CONTROL_2_MI = 1 << 5;
+    const uint8_t CONTROL_2_HMI = 1 << 4;
+    const uint8_t CONTROL_2_TF = 1 << 3;
+    const uint8_t TIMER_MODE_TE = 1 << 2;
+    const uint8_t TIMER_MODE_TIE = 1 << 1;
+    const uint8_t SECONDS_OS = 1 << 7;
+    const uint8_t ALARM_DISABLED = 1 << 7;
+
+    // The first increment after STOP is released (datasheet: 0.507813 s to 0.507935 s)
+    const int64_t STOP_RELEASE_TO_TICK_US = 507813;
+
+    // Countdown timer source clocks by TCF (TIMER_MODE[4:3]), in µs per tick
+    const double TIMER_PERIOD_US[] = {1e6 / 4096.0, 1e6 / 64.0, 1e6, 60e6};
+
+    uint8_t toBcd(int value) { return (uint8_t)((value / 10) << 4 | (value % 10)); }
+    int fromBcd(uint8_t value) { return (value >> 4) * 10 + (value & 0x0F); }
+
+    int64_t floorDiv(int64_t a, int64_t b) { return a / b - ((a % b != 0) && ((a < 0) != (b < 0))); }
+}
+
+namespace sim {
+namespace board {
+
+Pcf85063::Pcf85063() {
+    memset(regs, 0, sizeof(regs));
+    regs[SECOND_ALARM] = regs[SECOND_ALARM + 1] = regs[SECOND_ALARM + 2] = ALARM_DISABLED;
+    regs[SECOND_ALARM + 3] = regs[WEEKDAY_ALARM] = ALARM_DISABLED;
+    regs[TIMER_MODE] = 0x18;  // TCF = 1/60 Hz, timer off
+    // The backup supply kept it running: local time, as the firmware sets it
+    anchor_sim_us = sim::kernel::now();
+    anchor_rtc_us = sim::getWorldTimeUs() + (int64_t)WIFI_GMT_OFFSET_SEC * 1000000;
+    updateInt();
+    scheduleTick();
+}
+
+int64_t Pcf85063::getTimeUs() const {
+    if (stopped) return anchor_rtc_us;
+    double elapsed = (double)(sim::kernel::now() - anchor_sim_us) * (1.0 + drift_ppm * 1e-6);
+    return anchor_rtc_us + (int64_t)floor(elapsed);
+}
+
+int64_t Pcf85063::rtcToSim(int64_t rtc_us) const {
+    double elapsed = (double)(rtc_us - anchor_rtc_us) / (1.0 + drift_ppm * 1e-6);
+    return anchor_sim_us + (int64_t)ceil(elapsed);
+}
+
+void Pcf85063::setTimeUs(int64_t rtc_us) {
+    anchor_sim_us = sim::kernel::now();
+    anchor_rtc_us = rtc_us;
+    scheduleTick();
+    scheduleTimer();
+}
+
+void Pcf85063::raiseFlags(bool alarm, bool timer) {
+    if (alarm) regs[CONTROL_2] |= CONTROL_2_AF;
+    if (timer) regs[CONTROL_2] |= CONTROL_2_TF;
+    updateInt();
+}
+
+void Pcf85063::setDriftPpm(double ppm) {
+    anchor_rtc_us = getTimeUs();
+    anchor_sim_us = sim::kernel::now();
+    drift_ppm = ppm;
+    scheduleTick();
+    scheduleTimer();
+}
+
+// Seconds .. Years as the chip shows them
+void Pcf85063::loadTime(uint8_t* out) const {
+    time_t seconds = (time_t)floorDiv(getTimeUs(), 1000000);
+    struct tm tm;
+    gmtime_r(&seconds, &tm);
+    out[0] = (uint8_t)(toBcd(tm.tm_sec) | (regs[SECONDS] & SECONDS_OS));
+    out[1] = toBcd(tm.tm_min);
+    out[2] = toBcd(tm.tm_hour);
+    out[3] = toBcd(tm.tm_mday);
+    out[4] = (uint8_t)((tm.tm_wday + weekday_offset) % 7);
+    out[5] = toBcd(tm.tm_mon + 1);
+    out[6] = toBcd(tm.tm_year - 100);
+}
+
+// A time write keeps the prescaler phase: only STOP resets it
+void Pcf85063::storeTime(const uint8_t* in) {
+    struct tm tm = {};
+    tm.tm_sec = fromBcd(in[0] & 0x7F);
+    tm.tm_min = fromBcd(in[1] & 0x7F);
+    tm.tm_hour = fromBcd(in[2] & 0x3F);
+    tm.tm_mday = fromBcd(in[3] & 0x3F);
+    tm.tm_mon = fromBcd(in[5] & 0x1F) - 1;
+    tm.tm_year = fromBcd(in[6]) + 100;
+    time_t seconds = timegm(&tm);
+    gmtime_r(&seconds, &tm);
+    weekday_offset = (uint8_t)(((in[4] & 0x07) + 7 - tm.tm_wday) % 7);
+    regs[SECONDS] = in[0] & SECONDS_OS;
+
+    int64_t now_us = getTimeUs();
+    int64_t phase = now_us - floorDiv(now_us, 1000000) * 1000000;
+    if (stopped) {
+        anchor_rtc_us = (int64_t)seconds * 1000000;
+    } else {
+        anchor_rtc_us = (int64_t)seconds * 1000000 + phase;
+        anchor_sim_us = sim::kernel::now();
+    }
+    alarm_match = false;
+    scheduleTick();
+}
+
+bool Pcf85063::transfer(const uint8_t* tx, size_t tx_len, uint8_t* rx, size_t rx_len) {
+    // Time registers are latched for the whole transfer
+    uint8_t time[7];
+    loadTime(time);
+    bool time_written = false;
+
+    if (tx_len > 0) {
+        pointer = tx[0] % (TIMER_MODE + 1);
+        for (size_t i = 1; i < tx_len; i++) {
+            uint8_t reg = pointer;
+            uint8_t value = tx[i];
+            pointer = (pointer + 1) % (TIMER_MODE + 1);
+
+            if (reg >= SECONDS && reg <= YEARS) {
+                time[reg - SECONDS] = value;
+                time_written = true;
+            } else if (reg == CONTROL_1) {
+                bool stop = (value & CONTROL_1_STOP) != 0;
+                regs[CONTROL_1] = value & 0xAF;  // SR (0x58) is not modelled
+                if (stop && !stopped) {
+                    // STOP freezes the time and clears the prescaler
+                    anchor_rtc_us = floorDiv(getTimeUs(), 1000000) * 1000000;
+                    stopped = true;
+                    scheduleTick();
+                    scheduleTimer();
+                } else if (!stop && stopped) {
+                    stopped = false;
+                    anchor_sim_us = sim::kernel::now();
+                    anchor_rtc_us += 1000000 - STOP_RELEASE_TO_TICK_US;
+                    scheduleTick();
+                    scheduleTimer();
+                }
+            } else if (reg == CONTROL_2) {
+                // AF and TF are write-0-to-clear
+                uint8_t flags = regs[CONTROL_2] & value & (CONTROL_2_AF | CONTROL_2_TF);
+                regs[CONTROL_2] = (uint8_t)((value & ~(CONTROL_2_AF | CONTROL_2_TF)) | flags);
+            } else if (reg == TIMER_VALUE) {
+                regs[TIMER_VALUE] = value;
+                timer_count = value;
+                scheduleTimer();
+            } else if (reg == TIMER_MODE) {
+                regs[TIMER_MODE] = value & 0x1F;
+                scheduleTimer();
+            } else {
+                regs[reg] = value;
+            }
+        }
+        if (time_written) storeTime(time);
+        updateInt();
+    }
+
+    for (size_t i = 0; i < rx_len; i++) {
+        uint8_t reg = pointer;
+        pointer = (pointer + 1) % (TIMER_MODE + 1);
+        if (reg >= SECONDS && reg <= YEARS) {
+            rx[i] = time[reg - SECONDS];
+        } else if (reg == TIMER_VALUE) {
+            rx[i] = timer_count;
+        } else {
+            rx[i] = regs[reg];
+        }
+    }
+    return true;
+}
+
+void Pcf85063::scheduleTick() {
+    if (tick_event != 0) sim::kernel::cancel(tick_event);
+    tick_event = 0;
+    if (stopped) return;
+    int64_t next = (floorDiv(getTimeUs(), 1000000) + 1) * 1000000;
+    tick_event = sim::kernel::at(rtcToSim(next), [this] { tick_event = 0; tick(); }, sim::kernel::DEVICE);
+}
+
+// One second increment: alarm match and the minute/half-minute interrupts
+void Pcf85063::tick() {
+    uint8_t time[7];
+    loadTime(time);
+
+    bool match = false;
+    for (int i = 0; i < 5; i++) {
+        uint8_t alarm = regs[SECOND_ALARM + i];
+        if (alarm & ALARM_DISABLED) continue;
+        uint8_t current = time[i] & (i == 0 ? 0x7F : 0xFF);
+        if ((alarm & 0x7F) != current) {
+            match = false;
+            break;
+        }
+        match = true;
+    }
+    if (match && !alarm_match) regs[CONTROL_2] |= CONTROL_2_AF;
+    alarm_match = match;
+
+    uint8_t seconds = time[0] & 0x7F;
+    if ((regs[CONTROL_2] & CONTROL_2_MI) && seconds == 0) regs[CONTROL_2] |= CONTROL_2_TF;
+    if ((regs[CONTROL_2] & CONTROL_2_HMI) && (seconds == 0 || seconds == 0x30)) regs[CONTROL_2] |= CONTROL_2_TF;
+
+    updateInt();
+    scheduleTick();
+}
+
+void Pcf85063::scheduleTimer() {
+    if (timer_event != 0) sim::kernel::cancel(timer_event);
+    timer_event = 0;
+    if (stopped || !(regs[TIMER_MODE] & TIMER_MODE_TE) || regs[TIMER_VALUE] == 0) return;
+    timer_period_us = TIMER_PERIOD_US[(regs[TIMER_MODE] >> 3) & 0x03];
+    timer_next_rtc_us = (double)getTimeUs() + timer_period_us;
+    timer_event = sim::kernel::at(rtcToSim((int64_t)ceil(timer_next_rtc_us)), [this] { timer_event = 0; timerTick(); },
+                                  sim::kernel::DEVICE);
+}
+
+void Pcf85063::timerTick() {
+    if (timer_count > 1) {
+        timer_count--;
+    } else {
+        // Reaching zero sets TF and reloads the counter
+        timer_count = regs[TIMER_VALUE];
+        regs[CONTROL_2] |= CONTROL_2_TF;
+        updateInt();
+    }
+    timer_next_rtc_us += timer_period_us;
+    timer_event = sim::kernel::at(rtcToSim((int64_t)ceil(timer_next_rtc_us)), [this] { timer_event = 0; timerTick(); },
+                                  sim::kernel::DEVICE);
+}
+
+// Open drain, active low; the timer runs in flag mode (TI_TP = 0), so INT follows the flags
+void Pcf85063::updateInt() {
+    uint8_t ctrl2 = regs[CONTROL_2];
+    bool alarm = (ctrl2 & CONTROL_2_AF) && (ctrl2 & CONTROL_2_AIE);
+    bool timer = (ctrl2 & CONTROL_2_TF) &&
+                 ((regs[TIMER_MODE] & TIMER_MODE_TIE) || (ctrl2 & (CONTROL_2_MI | CONTROL_2_HMI)));
+    if (alarm || timer) {
+        sim::gpio::drive(RTC_INT, 0);
+    } else {
+        sim::gpio::release(RTC_INT);
+    }
+}
+
+}
+}
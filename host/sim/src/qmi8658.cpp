@@ -0,0 +1,498 @@
+#include <math.h>
+#include <string.h>
+
+#include "config.h"
+#include "kernel.hpp"
+#include "sim/board.hpp"
+#include "sim/sim.hpp"
+
+// Register numbers and bits from the QMI8658 datasheet (rev. 0.9)
+namespace {
+    enum : uint8_t {
+        WHO_AM_I = 0x00, REVISION_ID = 0x01,
+        CTRL1 = 0x02, CTRL2 = 0x03, CTRL3 = 0x04, CTRL7 = 0x08, CTRL8 = 0x09, CTRL9 = 0x0A,
+        CAL1_L = 0x0B, CAL1_H = 0x0C, CAL2_L = 0x0D, CAL2_H = 0x0E, CAL3_L = 0x0F, CAL3_H = 0x10,
+        CAL4_L = 0x11, CAL4_H = 0x12,
+        FIFO_WTM_TH = 0x13, FIFO_CTRL = 0x14, FIFO_SMPL_CNT = 0x15, FIFO_STATUS = 0x16, FIFO_DATA = 0x17,
+        STATUSINT = 0x2D, STATUS0 = 0x2E, STATUS1 = 0x2F, TIMESTAMP_L = 0x30, TEMP_L = 0x33,
+        AX_L = 0x35, GX_L = 0x3B, STEP_CNT_L = 0x5A, RESET = 0x60,
+    };
+
+    const uint8_t CTRL1_ADDR_AI = 1 << 6;
+    const uint8_t CTRL1_INT2_EN = 1 << 4;
+    const uint8_t CTRL1_FIFO_INT_SEL = 1 << 2;
+    const uint8_t CTRL7_SYNC_SMPL = 1 << 7;
+    const uint8_t CTRL7_DRDY_DIS = 1 << 5;
+    const uint8_t CTRL7_GYRO_EN = 1 << 1;
+    const uint8_t CTRL7_ACCEL_EN = 1 << 0;
+    const uint8_t CTRL8_ACTIVITY_INT_SEL = 1 << 6;
+    const uint8_t CTRL8_PEDO_EN = 1 << 4;
+    const uint8_t CTRL8_SIG_MOTION_EN = 1 << 3;
+    const uint8_t CTRL8_NO_MOTION_EN = 1 << 2;
+    const uint8_t CTRL8_ANY_MOTION_EN = 1 << 1;
+    const uint8_t FIFO_CTRL_RD_MODE = 1 << 7;
+    const uint8_t STATUSINT_CMD_DONE = 1 << 7;
+    const uint8_t STATUSINT_AVAIL = 1 << 0;
+    const uint8_t STATUS1_SIG_MOTION = 1 << 7;
+    const uint8_t STATUS1_NO_MOTION = 1 << 6;
+    const uint8_t STATUS1_ANY_MOTION = 1 << 5;
+
+    const uint8_t CMD_ACK = 0x00;
+    const uint8_t CMD_RST_FIFO = 0x04;
+    const uint8_t CMD_REQ_FIFO = 0x05;
+    const uint8_t CMD_CONFIGURE_PEDOMETER = 0x0D;
+    const uint8_t CMD_CONFIGURE_MOTION = 0x0E;
+    const uint8_t CMD_RESET_PEDOMETER = 0x0F;
+
+    const uint8_t FIFO_MODE_BYPASS = 0;
+    const uint8_t FIFO_MODE_FIFO = 1;
+
+    const int64_t DRDY_PULSE_US = 2;
+
+    // Accel-only ODR by CTRL2[3:0]; codes 12..15 are the low-power modes
+    double accelOdrHz(uint8_t code) {
+        static const double low_power[] = {128.0, 21.0, 11.0, 3.0};
+        if (code <= 8) return 8000.0 / (1 << code);
+        if (code >= 12) return low_power[code - 12];
+        return 0.0;
+    }
+
+    // With the gyro on, both sensors run at the gyro ODR (CTRL3[3:0])
+    double gyroOdrHz(uint8_t code) {
+        return code <= 8 ? 7174.4 / (1 << code) : 0.0;
+    }
+
+    int16_t toRaw(float value, float full_scale) {
+        float raw = roundf(value * 32768.0f / full_scale);
+        if (raw > 32767.0f) return 32767;
+        if (raw < -32768.0f) return -32768;
+        return (int16_t)raw;
+    }
+
+    void put16(uint8_t* out, int16_t value) {
+        out[0] = (uint8_t)(value & 0xFF);
+        out[1] = (uint8_t)((uint16_t)value >> 8);
+    }
+
+    // Motion engine thresholds: [7:5] g, [4:0] 1/32 g
+    float thresholdG(uint8_t value) {
+        return (float)(value >> 5) + (float)(value & 0x1F) / 32.0f;
+    }
+
+    // Flat on the table: 1 g on Z and a little deterministic noise
+    sim::board::Motion still(int64_t t_us) {
+        uint32_t seed = (uint32_t)(t_us / 1000) * 2654435761u;
+        float noise[6];
+        for (int i = 0; i < 6; i++) {
+            seed = seed * 1664525u + 1013904223u;
+            noise[i] = ((float)(seed >> 8) / 16777216.0f - 0.5f);
+        }
+        sim::board::Motion m;
+        m.ax = 0.004f * noise[0];
+        m.ay = 0.004f * noise[1];
+        m.az = 1.0f + 0.004f * noise[2];
+        m.gx = 0.2f * noise[3];
+        m.gy = 0.2f * noise[4];
+        m.gz = 0.2f * noise[5];
+        return m;
+    }
+}
+
+namespace sim {
+namespace board {
+
+Qmi8658::Qmi8658() : motion(still) {
+    reset();
+}
+
+void Qmi8658::setMotion(MotionSource source) {
+    motion = source ? source : MotionSource(still);
+}
+
+void Qmi8658::reset() {
+    memset(regs, 0, sizeof(regs));
+    regs[WHO_AM_I] = 0x05;
+    regs[REVISION_ID] = 0x7C;
+    regs[CTRL1] = 0x20;
+    fifo.clear();
+    fifo_full = fifo_overflow = false;
+    drdy = false;
+    timestamp = 0;
+    have_last = false;
+    any_run = no_run = 0;
+    sig_phase = -1;
+    ped_sample_cnt = ped_peak2peak = ped_peak = ped_time_up = 0;
+    ped_time_low = ped_cnt_entry = 0;
+    ped_mean = 1000.0f;
+    ped_min = 0.0f;
+    ped_above = false;
+    ped_since_step = ped_pending = 0;
+    step_count = 0;
+    reschedule();
+    updateInt2();
+}
+
+double Qmi8658::getOutputRateHz() const {
+    if (regs[CTRL7] & CTRL7_GYRO_EN) return gyroOdrHz(regs[CTRL3] & 0x0F);
+    if (regs[CTRL7] & CTRL7_ACCEL_EN) return accelOdrHz(regs[CTRL2] & 0x0F);
+    return 0.0;
+}
+
+size_t Qmi8658::frameBytes() const {
+    return ((regs[CTRL7] & CTRL7_ACCEL_EN) ? 6 : 0) + ((regs[CTRL7] & CTRL7_GYRO_EN) ? 6 : 0);
+}
+
+size_t Qmi8658::fifoCapacityFrames() const {
+    return (size_t)16 << ((regs[FIFO_CTRL] >> 2) & 0x03);
+}
+
+bool Qmi8658::transfer(const uint8_t* tx, size_t tx_len, uint8_t* rx, size_t rx_len) {
+    bool increment = (regs[CTRL1] & CTRL1_ADDR_AI) != 0;
+    if (tx_len > 0) {
+        pointer = tx[0] & 0x7F;
+        for (size_t i = 1; i < tx_len; i++) {
+            writeRegister(pointer, tx[i]);
+            if (increment) pointer = (pointer + 1) & 0x7F;
+        }
+    }
+    for (size_t i = 0; i < rx_len; i++) {
+        rx[i] = readRegister(pointer);
+        // FIFO_DATA is read as a stream from one address
+        if (increment && pointer != FIFO_DATA) pointer = (pointer + 1) & 0x7F;
+    }
+    return true;
+}
+
+uint8_t Qmi8658::readRegister(uint8_t reg) {
+    size_t words = fifo.size() / 2;
+    switch (reg) {
+        case FIFO_SMPL_CNT:
+            return (uint8_t)(words & 0xFF);
+        case FIFO_STATUS: {
+            size_t frame = frameBytes();
+            size_t frames = frame ? fifo.size() / frame : 0;
+            bool wtm = regs[FIFO_WTM_TH] != 0 && frames >= regs[FIFO_WTM_TH];
+            return (uint8_t)((fifo_full ? 0x80 : 0) | (wtm ? 0x40 : 0) | (fifo_overflow ? 0x20 : 0) |
+                             (!fifo.empty() ? 0x10 : 0) | ((words >> 8) & 0x03));
+        }
+        case FIFO_DATA: {
+            if (!(regs[FIFO_CTRL] & FIFO_CTRL_RD_MODE) || fifo.empty()) return 0;
+            uint8_t value = fifo.front();
+            fifo.pop_front();
+            fifo_full = false;
+            updateInt2();
+            return value;
+        }
+        case STATUSINT: {
+            uint8_t value = regs[STATUSINT] | (drdy ? STATUSINT_AVAIL : 0);
+            // syncSmpl: reading STATUSINT releases the data lock and INT2
+            if (drdy) {
+                drdy = false;
+                updateInt2();
+            }
+            return value;
+        }
+        case STATUS0: {
+            uint8_t value = regs[STATUS0];
+            regs[STATUS0] = 0;
+            return value;
+        }
+        case STATUS1: {
+            uint8_t value = regs[STATUS1];
+            regs[STATUS1] = 0;
+            updateInt2();
+            return value;
+        }
+        case STEP_CNT_L:
+        case STEP_CNT_L + 1:
+        case STEP_CNT_L + 2:
+            return (uint8_t)(step_count >> (8 * (reg - STEP_CNT_L)));
+        default:
+            return regs[reg];
+    }
+}
+
+void Qmi8658::writeRegister(uint8_t reg, uint8_t value) {
+    switch (reg) {
+        case CTRL9:
+            command(value);
+            return;
+        case RESET:
+            if (value == 0xB0) reset();
+            return;
+        case FIFO_CTRL: {
+            // RdMode is only set by REQ_FIFO; writing the register leaves read mode
+            uint8_t mode = value & 0x03;
+            regs[FIFO_CTRL] = value & 0x7F;
+            if (mode == FIFO_MODE_BYPASS) {
+                fifo.clear();
+                fifo_full = fifo_overflow = false;
+            }
+            updateInt2();
+            return;
+        }
+        case CTRL1:
+            regs[CTRL1] = value;
+            updateInt2();
+            return;
+        case CTRL2:
+        case CTRL3:
+        case CTRL7:
+            regs[reg] = value;
+            if (reg == CTRL7 && !(value & CTRL7_SYNC_SMPL)) drdy = false;
+            reschedule();
+            updateInt2();
+            return;
+        case CTRL8:
+            regs[CTRL8] = value;
+            updateInt2();
+            return;
+        case WHO_AM_I:
+        case REVISION_ID:
+        case FIFO_SMPL_CNT:
+        case FIFO_STATUS:
+        case FIFO_DATA:
+            return;
+        default:
+            if (reg >= STATUSINT && reg < RESET) return;  // Status and output registers are read-only
+            regs[reg] = value;
+            return;
+    }
+}
+
+void Qmi8658::command(uint8_t cmd) {
+    switch (cmd) {
+        case CMD_ACK:
+            regs[STATUSINT] &= (uint8_t)~STATUSINT_CMD_DONE;
+            return;
+        case CMD_RST_FIFO:
+            fifo.clear();
+            fifo_full = fifo_overflow = false;
+            regs[FIFO_CTRL] &= (uint8_t)~FIFO_CTRL_RD_MODE;
+            break;
+        case CMD_REQ_FIFO:
+            regs[FIFO_CTRL] |= FIFO_CTRL_RD_MODE;
+            break;
+        case CMD_CONFIGURE_PEDOMETER:
+            if (regs[CAL4_H] == 0x01) {
+                ped_sample_cnt = (uint16_t)(regs[CAL1_H] << 8 | regs[CAL1_L]);
+                ped_peak2peak = (uint16_t)(regs[CAL2_H] << 8 | regs[CAL2_L]);
+                ped_peak = (uint16_t)(regs[CAL3_H] << 8 | regs[CAL3_L]);
+            } else if (regs[CAL4_H] == 0x02) {
+                ped_time_up = (uint16_t)(regs[CAL1_H] << 8 | regs[CAL1_L]);
+                ped_time_low = regs[CAL2_L];
+                ped_cnt_entry = regs[CAL2_H];
+            }
+            break;
+        case CMD_CONFIGURE_MOTION:
+            if (regs[CAL4_H] == 0x01) {
+                any_threshold[0] = regs[CAL1_L];
+                any_threshold[1] = regs[CAL1_H];
+                any_threshold[2] = regs[CAL2_L];
+                no_threshold[0] = regs[CAL2_H];
+                no_threshold[1] = regs[CAL3_L];
+                no_threshold[2] = regs[CAL3_H];
+            } else if (regs[CAL4_H] == 0x02) {
+                any_window = regs[CAL1_L] ? regs[CAL1_L] : 1;
+                no_window = regs[CAL1_H] ? regs[CAL1_H] : 1;
+                sig_wait = (uint16_t)(regs[CAL2_H] << 8 | regs[CAL2_L]);
+                sig_confirm = (uint16_t)(regs[CAL3_H] << 8 | regs[CAL3_L]);
+            }
+            break;
+        case CMD_RESET_PEDOMETER:
+            step_count = 0;
+            ped_pending = 0;
+            break;
+        default:
+            break;
+    }
+    regs[STATUSINT] |= STATUSINT_CMD_DONE;
+    updateInt2();
+}
+
+void Qmi8658::reschedule() {
+    double hz = getOutputRateHz();
+    double period_us = hz > 0.0 ? 1e6 / (hz * (1.0 + clock_ppm * 1e-6)) : 0.0;
+    // A rewrite that keeps the rate keeps the sensor's own cadence
+    if (sample_event != 0 && period_us == sample_period_us) return;
+
+    if (sample_event != 0) sim::kernel::cancel(sample_event);
+    sample_event = 0;
+    sample_period_us = period_us;
+    if (period_us <= 0.0) return;
+    next_sample_us = (double)sim::kernel::now() + period_us;
+    scheduleSample();
+}
+
+void Qmi8658::scheduleSample() {
+    sample_event = sim::kernel::at((int64_t)llround(next_sample_us), [this] {
+        sample_event = 0;
+        next_sample_us += sample_period_us;
+        scheduleSample();
+        sample();
+    }, sim::kernel::DEVICE);
+}
+
+void Qmi8658::sample() {
+    samples++;
+    timestamp = (timestamp + 1) & 0xFFFFFF;
+    regs[TIMESTAMP_L] = (uint8_t)timestamp;
+    regs[TIMESTAMP_L + 1] = (uint8_t)(timestamp >> 8);
+    regs[TIMESTAMP_L + 2] = (uint8_t)(timestamp >> 16);
+    put16(&regs[TEMP_L], 25 * 256);
+
+    Motion m = motion(sim::kernel::now());
+    bool accel_on = (regs[CTRL7] & CTRL7_ACCEL_EN) != 0;
+    bool gyro_on = (regs[CTRL7] & CTRL7_GYRO_EN) != 0;
+    float accel_fs = (float)(2 << ((regs[CTRL2] >> 4) & 0x03));
+    float gyro_fs = (float)(16 << ((regs[CTRL3] >> 4) & 0x07));
+
+    uint8_t frame[12];
+    size_t frame_len = 0;
+    if (accel_on) {
+        put16(&regs[AX_L], toRaw(m.ax, accel_fs));
+        put16(&regs[AX_L + 2], toRaw(m.ay, accel_fs));
+        put16(&regs[AX_L + 4], toRaw(m.az, accel_fs));
+        memcpy(&frame[frame_len], &regs[AX_L], 6);
+        frame_len += 6;
+        regs[STATUS0] |= 0x01;
+    }
+    if (gyro_on) {
+        put16(&regs[GX_L], toRaw(m.gx, gyro_fs));
+        put16(&regs[GX_L + 2], toRaw(m.gy, gyro_fs));
+        put16(&regs[GX_L + 4], toRaw(m.gz, gyro_fs));
+        memcpy(&frame[frame_len], &regs[GX_L], 6);
+        frame_len += 6;
+        regs[STATUS0] |= 0x02;
+    }
+
+    uint8_t fifo_mode = regs[FIFO_CTRL] & 0x03;
+    if (fifo_mode != FIFO_MODE_BYPASS && frame_len > 0) {
+        size_t capacity = fifoCapacityFrames() * frame_len;
+        bool store = true;
+        if (fifo.size() + frame_len > capacity) {
+            fifo_overflow = true;
+            fifo_overflows++;
+            if (fifo_mode == FIFO_MODE_FIFO) {
+                store = false;  // FIFO mode stops at full
+            } else {
+                // Stream mode: the oldest frame makes room
+                fifo.erase(fifo.begin(), fifo.begin() + (std::min)(frame_len, fifo.size()));
+            }
+        }
+        if (store) fifo.insert(fifo.end(), frame, frame + frame_len);
+        fifo_full = fifo.size() + frame_len > capacity;
+    }
+
+    float accel_g[3] = {m.ax, m.ay, m.az};
+    if (accel_on && (regs[CTRL8] & (CTRL8_ANY_MOTION_EN | CTRL8_NO_MOTION_EN | CTRL8_SIG_MOTION_EN))) {
+        runMotionEngine(accel_g);
+    }
+    // The pedometer needs the free-running (non-syncSmpl) output
+    if (accel_on && (regs[CTRL8] & CTRL8_PEDO_EN) && !(regs[CTRL7] & CTRL7_SYNC_SMPL)) {
+        runPedometer(accel_g);
+    }
+
+    // Data ready is only signalled with the FIFO bypassed
+    bool drdy_on = (regs[CTRL1] & CTRL1_INT2_EN) && !(regs[CTRL7] & CTRL7_DRDY_DIS) && fifo_mode == FIFO_MODE_BYPASS;
+    if (drdy_on && (regs[CTRL7] & CTRL7_SYNC_SMPL)) {
+        drdy = true;  // Level until STATUSINT is read
+        updateInt2();
+    } else if (drdy_on) {
+        drdy_pulse = true;
+        updateInt2();
+        sim::kernel::at(sim::kernel::now() + DRDY_PULSE_US, [this] { drdy_pulse = false; updateInt2(); }, sim::kernel::DEVICE);
+    } else {
+        updateInt2();
+    }
+}
+
+void Qmi8658::runMotionEngine(const float accel_g[3]) {
+    if (!have_last) {
+        memcpy(last_accel, accel_g, sizeof(last_accel));
+        have_last = true;
+        return;
+    }
+    bool any = false;
+    bool none = true;
+    for (int i = 0; i < 3; i++) {
+        float slope = fabsf(accel_g[i] - last_accel[i]);
+        if (slope > thresholdG(any_threshold[i])) any = true;
+        if (slope >= thresholdG(no_threshold[i])) none = false;
+    }
+    memcpy(last_accel, accel_g, sizeof(last_accel));
+
+    any_run = any ? any_run + 1 : 0;
+    no_run = none ? no_run + 1 : 0;
+    bool any_detected = any_run == any_window;
+
+    uint8_t ctrl8 = regs[CTRL8];
+    if (any_detected && (ctrl8 & CTRL8_ANY_MOTION_EN)) regs[STATUS1] |= STATUS1_ANY_MOTION;
+    if (no_run == no_window && (ctrl8 & CTRL8_NO_MOTION_EN)) regs[STATUS1] |= STATUS1_NO_MOTION;
+
+    // Significant motion: any-motion, a wait window, then any-motion again within the confirm window
+    if (ctrl8 & CTRL8_SIG_MOTION_EN) {
+        if (sig_phase < 0) {
+            if (any_detected) sig_phase = 0;
+        } else if (++sig_phase > (int32_t)sig_wait) {
+            if (any_run > 0) {
+                regs[STATUS1] |= STATUS1_SIG_MOTION;
+                sig_phase = -1;
+            } else if (sig_phase > (int32_t)(sig_wait + sig_confirm)) {
+                sig_phase = -1;
+            }
+        }
+    }
+}
+
+void Qmi8658::runPedometer(const float accel_g[3]) {
+    float mg = 1000.0f * sqrtf(accel_g[0] * accel_g[0] + accel_g[1] * accel_g[1] + accel_g[2] * accel_g[2]);
+    float window = ped_sample_cnt > 0 ? (float)ped_sample_cnt : 32.0f;
+    ped_mean += (mg - ped_mean) / window;
+    float dev = mg - ped_mean;
+    if (ped_since_step < 0xFFFFFF) ped_since_step++;
+
+    // The walk broke off: steps not yet confirmed are dropped
+    if (ped_time_up > 0 && ped_since_step > ped_time_up) ped_pending = 0;
+
+    if (!ped_above) {
+        if (dev < ped_min) ped_min = dev;
+        if (dev > (float)ped_peak && dev - ped_min > (float)ped_peak2peak) {
+            ped_above = true;
+            if (ped_since_step >= ped_time_low) {
+                bool walking = ped_pending >= ped_cnt_entry;
+                ped_since_step = 0;
+                if (walking) {
+                    step_count++;
+                } else if (++ped_pending >= ped_cnt_entry) {
+                    step_count += ped_pending;  // Entry count met: the held steps count too
+                }
+            }
+        }
+    } else if (dev < 0.0f) {
+        ped_above = false;
+        ped_min = dev;
+    }
+    step_count &= 0xFFFFFF;
+}
+
+void Qmi8658::updateInt2() {
+    uint8_t ctrl1 = regs[CTRL1];
+    bool level = false;
+    if (ctrl1 & CTRL1_INT2_EN) {
+        uint8_t fifo_mode = regs[FIFO_CTRL] & 0x03;
+        size_t frame = frameBytes();
+        size_t frames = frame ? fifo.size() / frame : 0;
+        bool wtm = fifo_mode != FIFO_MODE_BYPASS && regs[FIFO_WTM_TH] != 0 && frames >= regs[FIFO_WTM_TH];
+        level = drdy || drdy_pulse || (wtm && !(ctrl1 & CTRL1_FIFO_INT_SEL)) ||
+                ((regs[STATUS1] & (STATUS1_ANY_MOTION | STATUS1_NO_MOTION | STATUS1_SIG_MOTION)) &&
+                 !(regs[CTRL8] & CTRL8_ACTIVITY_INT_SEL));
+    }
+    int next = level ? 1 : 0;
+    if (next == int2) return;
+    int2 = next;
+    sim::gpio::drive(IMU_INT2, next);
+}
+
+}
+}
@@ -0,0 +1,57 @@
+#include "kernel.hpp"
+#include "sim/board.hpp"
+#include "sim/sim.hpp"
+
+// The firmware's Arduino entry points
+void setup();
+void loop();
+
+namespace {
+    struct Runner {
+        bool started = false;
+        uint32_t loops = 0;
+        uint32_t resets = 0;
+    };
+
+    Runner& runner() {
+        static Runner* state = new Runner();
+        return *state;
+    }
+
+    // arduino-esp32's loopTask; a deep sleep reset unwinds it back to setup()
+    void loopTask() {
+        for (;;) {
+            try {
+                setup();
+                for (;;) {
+                    loop();
+                    runner().loops++;
+                }
+            } catch (const sim::Reboot&) {
+                runner().resets++;
+            }
+        }
+    }
+}
+
+void sim::run(int64_t until_us) {
+    Runner& r = runner();
+    if (!r.started) {
+        r.started = true;
+        sim::board::attachAll();
+        sim::kernel::spawn("loopTask", 1, loopTask);
+    }
+    sim::kernel::runUntil(until_us);
+}
+
+uint32_t sim::getLoopCount() {
+    return runner().loops;
+}
+
+uint32_t sim::getResetCount() {
+    return runner().resets;
+}
+
+void sim::at(int64_t when_us, std::function<void()> fn) {
+    sim::kernel::at(when_us, std::move(fn), sim::kernel::DEVICE);
+}
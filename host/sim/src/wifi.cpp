@@ -0,0 +1,164 @@
+#include <WiFi.h>
+#include <WiFiMulti.h>
+
+#include <string>
+
+#include "hal.hpp"
+#include "kernel.hpp"
+#include "sim/sim.hpp"
+
+namespace {
+    // Join times: scan all channels, or go straight to a known channel and BSSID
+    const int64_t SCAN_US = 2200000;
+    const int64_t JOIN_US = 900000;
+    const int64_t FAST_JOIN_US = 250000;
+
+    struct State {
+        bool reachable = true;
+        wifi_mode_t mode = WIFI_MODE_NULL;
+        bool sleep = true;
+        wl_status_t status = WL_IDLE_STATUS;
+        std::string ssid;
+        uint64_t join_event = 0;
+    };
+
+    State& st() {
+        static State* state = new State();
+        return *state;
+    }
+
+    uint8_t AP_BSSID[6] = {0x24, 0x0A, 0xC4, 0x12, 0x34, 0x56};
+    const int32_t AP_CHANNEL = 6;
+
+    void cancelJoin() {
+        if (st().join_event != 0) sim::kernel::cancel(st().join_event);
+        st().join_event = 0;
+    }
+}
+
+WiFiClass WiFi;
+
+String IPAddress::toString() const {
+    char text[16];
+    snprintf(text, sizeof(text), "%u.%u.%u.%u", octets[0], octets[1], octets[2], octets[3]);
+    return String(text);
+}
+
+bool WiFiClass::mode(wifi_mode_t mode) {
+    State& s = st();
+    if (mode == WIFI_MODE_NULL) {
+        cancelJoin();
+        s.status = WL_IDLE_STATUS;
+    } else if (s.mode == WIFI_MODE_NULL) {
+        s.status = WL_DISCONNECTED;
+    }
+    s.mode = mode;
+    return true;
+}
+
+wifi_mode_t WiFiClass::getMode() {
+    return st().mode;
+}
+
+bool WiFiClass::setSleep(bool enabled) {
+    st().sleep = enabled;
+    return true;
+}
+
+bool WiFiClass::getSleep() {
+    return st().sleep;
+}
+
+wl_status_t WiFiClass::begin(const char* ssid, const char* passphrase, int32_t channel, const uint8_t* bssid,
+                             bool connect) {
+    (void)passphrase;
+    State& s = st();
+    if (s.mode == WIFI_MODE_NULL) mode(WIFI_STA);
+    cancelJoin();
+    s.ssid = ssid ? ssid : "";
+    s.status = WL_DISCONNECTED;
+    if (!connect) return s.status;
+
+    int64_t join_us = (channel > 0 && bssid != nullptr) ? FAST_JOIN_US : JOIN_US;
+    s.join_event = sim::kernel::at(sim::kernel::now() + join_us, [] {
+        State& s = st();
+        s.join_event = 0;
+        s.status = s.reachable ? WL_CONNECTED : WL_NO_SSID_AVAIL;
+    }, sim::kernel::FIRMWARE);
+    return s.status;
+}
+
+bool WiFiClass::disconnect(bool wifioff, bool eraseap) {
+    (void)eraseap;
+    cancelJoin();
+    st().status = WL_DISCONNECTED;
+    if (wifioff) mode(WIFI_MODE_NULL);
+    return true;
+}
+
+bool WiFiClass::reconnect() {
+    if (st().ssid.empty()) return false;
+    begin(st().ssid.c_str());
+    return true;
+}
+
+wl_status_t WiFiClass::status() {
+    return st().mode == WIFI_MODE_NULL ? WL_NO_SHIELD : st().status;
+}
+
+String WiFiClass::SSID() {
+    return st().status == WL_CONNECTED ? String(st().ssid.c_str()) : String();
+}
+
+uint8_t* WiFiClass::BSSID() {
+    return st().status == WL_CONNECTED ? AP_BSSID : nullptr;
+}
+
+int32_t WiFiClass::channel() {
+    return AP_CHANNEL;
+}
+
+int8_t WiFiClass::RSSI() {
+    return st().status == WL_CONNECTED ? -55 : 0;
+}
+
+IPAddress WiFiClass::localIP() {
+    return st().status == WL_CONNECTED ? IPAddress(192, 168, 1, 50) : IPAddress();
+}
+
+bool WiFiMulti::addAP(const char* ssid, const char* passphrase) {
+    if (ssid == nullptr || ssid[0] == '\0') return false;
+    aps.push_back(AccessPoint{ssid, passphrase ? passphrase : ""});
+    return true;
+}
+
+uint8_t WiFiMulti::run(uint32_t connectTimeout) {
+    if (WiFi.status() == WL_CONNECTED) return WL_CONNECTED;
+
+    // Synchronous scan, then a join to the AP it found, waiting up to connectTimeout
+    delay((uint32_t)(SCAN_US / 1000));
+    if (aps.empty() || !st().reachable) return WL_NO_SSID_AVAIL;
+    WiFi.begin(aps[0].ssid.c_str(), aps[0].passphrase.c_str(), AP_CHANNEL, AP_BSSID);
+    uint32_t start = millis();
+    while (WiFi.status() != WL_CONNECTED && millis() - start < connectTimeout) delay(10);
+    return WiFi.status();
+}
+
+void sim::setWifiReachable(bool reachable) {
+    State& s = st();
+    s.reachable = reachable;
+    if (!reachable && s.status == WL_CONNECTED) s.status = WL_CONNECTION_LOST;
+}
+
+bool sim::hal::wifiConnected() {
+    return st().mode != WIFI_MODE_NULL && st().status == WL_CONNECTED;
+}
+
+// Deep sleep powers the radio down
+void sim::hal::wifiReset() {
+    State& s = st();
+    s.join_event = 0;   // Firmware events are dropped by the reset
+    s.mode = WIFI_MODE_NULL;
+    s.status = WL_IDLE_STATUS;
+    s.ssid.clear();
+}
@@ -0,0 +1,207 @@
+#include <Wire.h>
+
+#include <map>
+
+#include "hal.hpp"
+#include "kernel.hpp"
+#include "sim/i2c.hpp"
+
+namespace {
+    struct Bus {
+        std::map<uint8_t, sim::i2c::Target*> targets;
+        std::map<uint8_t, sim::i2c::Stats> stats;
+        uint32_t clock_override = 0;
+        uint32_t clock = 0;
+        sim::kernel::Task* owner = nullptr;
+        int depth = 0;
+    };
+
+    Bus& bus() {
+        static Bus* state = new Bus();
+        return *state;
+    }
+
+    // Charges the wire time of one transfer (a NACKed address ends after the address byte)
+    void charge(uint8_t address, size_t bytes, unsigned starts, bool acked) {
+        Bus& b = bus();
+        uint32_t hz = b.clock_override ? b.clock_override : b.clock ? b.clock : 100000;
+        uint64_t bits = (uint64_t)bytes * 9 + starts + 1;
+        uint64_t ns = bits * 1000000000ULL / hz;
+
+        sim::i2c::Stats& stats = b.stats[address];
+        stats.transactions++;
+        if (!acked) stats.nacks++;
+        stats.bytes += bytes;
+        stats.bits += bits;
+        stats.bus_ns += ns;
+
+        sim::kernel::sleepFor((int64_t)((ns + 999) / 1000));
+    }
+}
+
+TwoWire Wire(0);
+TwoWire Wire1(1);
+
+// The bus is held from beginTransmission() to the end of the transaction, as in arduino-esp32
+void TwoWire::lock() {
+    Bus& b = bus();
+    sim::kernel::Task* me = sim::kernel::self();
+    while (b.owner != nullptr && b.owner != me) sim::kernel::block(&b, -1);
+    b.owner = me;
+    b.depth++;
+}
+
+void TwoWire::unlock() {
+    Bus& b = bus();
+    if (b.owner != sim::kernel::self() || --b.depth > 0) return;
+    b.owner = nullptr;
+    sim::kernel::wakeAll(&b);
+}
+
+bool TwoWire::begin(int sda, int scl, uint32_t frequency) {
+    (void)sda;
+    (void)scl;
+    if (started) return true;  // arduino-esp32 keeps the running bus and its clock
+    started = true;
+    setClock(frequency ? frequency : 100000);
+    return true;
+}
+
+bool TwoWire::end() {
+    started = false;
+    tx_open = tx_pending = false;
+    tx_length = 0;
+    rx_index = rx_length = 0;
+    return true;
+}
+
+bool TwoWire::setClock(uint32_t frequency) {
+    if (frequency == 0) return false;
+    this->frequency = frequency;
+    if (bus_num == 0) bus().clock = frequency;
+    return true;
+}
+
+bool TwoWire::transfer(uint8_t address, const uint8_t* tx, size_t tx_len, uint8_t* rx, size_t rx_len) {
+    Bus& b = bus();
+    auto target = b.targets.find(address);
+    bool acked = target != b.targets.end() && target->second->transfer(tx, tx_len, rx, rx_len);
+
+    bool write = tx_len > 0 || rx_len == 0;
+    bool read = rx_len > 0;
+    if (!acked) {
+        charge(address, 1, 1, false);
+    } else {
+        size_t bytes = (write ? 1 + tx_len : 0) + (read ? 1 + rx_len : 0);
+        charge(address, bytes, write && read ? 2 : 1, true);
+    }
+    return acked;
+}
+
+void TwoWire::beginTransmission(uint8_t address) {
+    if (!started) return;
+    lock();
+    if (tx_pending) {
+        // A write held for requestFrom() that never came: it goes out now on its own
+        tx_pending = false;
+        transfer(tx_address, tx_buffer, tx_length, nullptr, 0);
+        unlock();
+    }
+    tx_address = address;
+    tx_length = 0;
+    tx_open = true;
+}
+
+size_t TwoWire::write(uint8_t data) {
+    if (!tx_open || tx_length >= sizeof(tx_buffer)) return 0;
+    tx_buffer[tx_length++] = data;
+    return 1;
+}
+
+size_t TwoWire::write(const uint8_t* data, size_t quantity) {
+    for (size_t i = 0; i < quantity; i++) {
+        if (!write(data[i])) return i;
+    }
+    return quantity;
+}
+
+uint8_t TwoWire::endTransmission(bool sendStop) {
+    if (!started || !tx_open) return 4;
+    tx_open = false;
+    if (!sendStop) {
+        tx_pending = true;  // Sent with the read as one transaction
+        return 0;
+    }
+    bool acked = transfer(tx_address, tx_buffer, tx_length, nullptr, 0);
+    unlock();
+    return acked ? 0 : 2;
+}
+
+size_t TwoWire::requestFrom(uint8_t address, size_t size, bool sendStop) {
+    (void)sendStop;
+    rx_index = rx_length = 0;
+    if (!started || size > sizeof(rx_buffer)) {
+        if (tx_pending) {
+            tx_pending = false;
+            unlock();
+        }
+        return 0;
+    }
+
+    bool combined = tx_pending && tx_address == address;
+    if (!tx_pending) lock();
+    if (tx_pending && !combined) transfer(tx_address, tx_buffer, tx_length, nullptr, 0);
+    tx_pending = false;
+
+    bool acked = transfer(address, tx_buffer, combined ? tx_length : 0, rx_buffer, size);
+    unlock();
+    if (!acked) return 0;
+    rx_length = size;
+    return size;
+}
+
+void sim::i2c::attach(uint8_t address, Target* target) {
+    bus().targets[address] = target;
+}
+
+void sim::i2c::detach(uint8_t address) {
+    bus().targets.erase(address);
+}
+
+void sim::i2c::setClockOverride(uint32_t hz) {
+    bus().clock_override = hz;
+}
+
+uint32_t sim::i2c::getClock() {
+    Bus& b = bus();
+    return b.clock_override ? b.clock_override : b.clock;
+}
+
+const sim::i2c::Stats& sim::i2c::getStats(uint8_t address) {
+    return bus().stats[address];
+}
+
+sim::i2c::Stats sim::i2c::getTotal() {
+    Stats total;
+    for (const auto& entry : bus().stats) {
+        total.transactions += entry.second.transactions;
+        total.nacks += entry.second.nacks;
+        total.bytes += entry.second.bytes;
+        total.bits += entry.second.bits;
+        total.bus_ns += entry.second.bus_ns;
+    }
+    return total;
+}
+
+void sim::i2c::resetStats() {
+    bus().stats.clear();
+}
+
+void sim::hal::wireReset() {
+    Bus& b = bus();
+    b.owner = nullptr;
+    b.depth = 0;
+    b.clock = 0;
+    Wire.end();
+    Wire1.end();
+}
@@ -22,10 +22,13 @@
 #define LCD_ROW_OFFSET1 0
 #define LCD_COL_OFFSET2 0
 #define LCD_ROW_OFFSET2 0
+#define LCD_BRIGHTNESS_USB      255     // Panel brightness on USB power
+#define LCD_BRIGHTNESS_BATTERY  160     // Panel brightness on battery
 
 // I2C bus
 #define I2C_SDA         15      // Shared I2C bus
 #define I2C_SCL         14      // Shared I2C bus
+#define I2C_CLOCK_HZ    100000  // Standard Mode
 
 // Touch controller pins (I2C interface - FT3168)
 #define TOUCH_SDA       I2C_SDA // Shared I2C bus
@@ -38,6 +41,20 @@
 #define IMU_SCL         I2C_SCL // Shared I2C bus
 #define IMU_INT2        21      // IMU interrupt 2 (data ready)
 
+// IMU acquisition
+#define IMU_USE_FIFO        1       // 1 = batch samples through the QMI8658 FIFO, 0 = data ready interrupt per sample
+#define IMU_FIFO_WATERMARK  16      // Samples per FIFO batch (~125ms at 128Hz)
+#define ORIENTATION_FILTER_FIXED    1   // 1 = fixed-point Mahony filter, 0 = float reference
+#define ORIENTATION_FILTER_COMPARE  0   // 1 = run both filters and track their deviation
+#define PEDOMETER_USE_HARDWARE      1   // 1 = QMI8658 on-chip step counter, 0 = software peak detector
+#define IMU_RATE_GOVERNOR           1   // 1 = drop to accel-only low ODR while still, 0 = always full rate
+#define IMU_WAKE_ON_MOTION          1   // 1 = sleep until the IMU motion engine fires, 0 = button/touch/RTC wakes only
+#define GESTURE_CLASSIFIER          0   // 1 = windowed decision tree for wrist gestures, 0 = state machines
+#define GESTURE_TREE_PATH           "/gesture_tree.bin"   // Optional trained tree (built-in tree otherwise)
+#define IMU_TRACE_RECORD            0   // 1 = record raw IMU samples to LittleFS from boot
+#define IMU_TRACE_PATH              "/imu_trace.bin"
+#define IMU_TRACE_MAX_KB            512
+
 // RTC pins (I2C interface - PCF85063)
 #define RTC_SDA         I2C_SDA // Shared I2C bus
 #define RTC_SCL         I2C_SCL // Shared I2C bus
@@ -46,10 +63,29 @@
 // Power management pins (I2C interface - AXP2101)
 #define PMU_SDA         I2C_SDA // Shared I2C bus
 #define PMU_SCL         I2C_SCL // Shared I2C bus
+#define PMU_INT         -1      // AXP2101 IRQ (open drain); -1 = not routed, status registers polled
+#define PMU_IRQ_POLL_MS             1000    // IRQ status poll period without PMU_INT
+#define PMU_TELEMETRY_CHARGING_MS   5000    // Telemetry refresh on USB power / while charging
+#define PMU_TELEMETRY_BATTERY_MS    60000   // Telemetry refresh on battery
+#define BATTERY_CAPACITY_MAH        400     // Fitted cell; scales the fuel gauge into energy
+#define BATTERY_NOMINAL_MV          3700
+#define ENERGY_STATS_PATH           "/energy.bin"   // Persisted energy accounting totals
+
+// CPU clock
+#define CPU_GOVERNOR                1       // 1 = scale the CPU clock on render/input hints, 0 = fixed boot clock
+#define CPU_FREQ_IDLE_MHZ           80      // Polling/idle (lowest clock that keeps WiFi and the 80MHz APB)
+#define CPU_FREQ_BOOST_MHZ          240     // Rendering and input bursts
+#define CPU_AUTO_LIGHT_SLEEP        0       // 1 = esp_pm light sleep while the loop is blocked (needs tickless idle; suspends USB CDC)
+
+// Main loop
+#define EVENT_LOOP_TICK_MS          500     // Housekeeping wake (WiFi, PMU, heartbeat); inputs and deadlines wake the loop in between
 
 // Buttons
 #define BTN_PWR         10      // Power button
 #define BTN_BOOT        0       // Boot button (GPIO0)
+#define SLEEP_WAKE_POWER_KEY        1   // 1 = BTN_PWR wakes from light sleep
+#define SLEEP_WAKE_TOUCH            1   // 1 = touch stays in monitor mode during sleep and a tap wakes the display
+#define DEEP_SLEEP_AFTER_MS         600000  // Light sleep on battery this long drops to deep sleep; 0 = never
 
 // SD card pins (SPI interface)
 #define SD_MOSI         1       // SD card MOSI
@@ -75,3 +111,8 @@
 #define WIFI_DAYLIGHT_OFFSET   0             // Set daylight saving offset if applicable
 #define WIFI_PRIMARY_NTP       "pool.ntp.org"
 #define WIFI_SECONDARY_NTP     "time.nist.gov"
+
+// Debug options
+#ifndef REG_CACHE_VERIFY
+#define REG_CACHE_VERIFY       0             // 1 = check register shadow caches against hardware on every access
+#endif
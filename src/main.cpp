@@ -1,5 +1,6 @@
 #include <Arduino.h>
 #include "system/system_manager.hpp"
+#include "system/power/retained_state.hpp"
 #include "config.h"
 #include "logger/logger.hpp"
 
@@ -8,9 +9,12 @@ Logger logger = Logger();
 SystemManager *system_manager = nullptr;
 
 void setup() {
+    // Deep sleep wake with state in RTC memory: fast path, no waiting for a host
+    bool resume = RetainedState::isValid();
+
     // Initialize USB Serial
     USBSerial.begin(115200);
-    while (!USBSerial) {
+    while (!resume && !USBSerial) {
         ; // Wait for serial port to connect. Needed for native USB
     }
     
@@ -19,11 +23,11 @@ void setup() {
 
     // Welcome message
     logger.header("ESP32-S3 Touch AMOLED System Setup");
-    logger.info("MAIN", "System starting...");
+    logger.info("MAIN", resume ? "Resuming from deep sleep..." : "System starting...");
     logger.info("MAIN", "Version: 1.0.0");
 
     // Initialize system
-    system_manager = new SystemManager(&logger);
+    system_manager = new SystemManager(&logger, resume);
 
     if (!system_manager->isInitialized()) {
         logger.error("MAIN", "System initialization failed - halting");
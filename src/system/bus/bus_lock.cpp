@@ -0,0 +1,8 @@
+#include "bus_lock.hpp"
+
+SemaphoreHandle_t I2CBusLock::mutex = nullptr;
+
+bool I2CBusLock::begin() {
+    if (mutex == nullptr) mutex = xSemaphoreCreateRecursiveMutex();
+    return mutex != nullptr;
+}
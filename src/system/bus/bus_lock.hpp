@@ -0,0 +1,34 @@
+#pragma once
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+
+/**
+ * Serializes access to the shared I2C bus between the main loop and the
+ * IMU sampling task.
+ *
+ * A transaction is more than the Wire calls: the register shadow caches and
+ * the I2CBusStats counters are updated alongside it, and a read-modify-write
+ * from the cache spans two transactions. Holders take the lock around the
+ * whole sequence; the mutex is recursive so nested helpers can take it again.
+ * Before begin() the guard is a no-op (single-threaded startup).
+ */
+class I2CBusLock {
+private:
+    static SemaphoreHandle_t mutex;
+
+public:
+    static bool begin();
+
+    class Guard {
+    public:
+        Guard() {
+            if (mutex != nullptr) xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
+        }
+        ~Guard() {
+            if (mutex != nullptr) xSemaphoreGiveRecursive(mutex);
+        }
+        Guard(const Guard&) = delete;
+        Guard& operator=(const Guard&) = delete;
+    };
+};
@@ -0,0 +1,14 @@
+#include "bus_stats.hpp"
+
+uint32_t I2CBusStats::clock_hz = 100000;
+uint32_t I2CBusStats::transactions = 0;
+uint64_t I2CBusStats::bus_time_ns = 0;
+
+void I2CBusStats::charge(size_t bytes, uint8_t starts) {
+    if (clock_hz == 0) return;
+
+    // 9 bit times per byte, ~1 bit time per START and 1 for the STOP
+    uint32_t bits = bytes * 9 + starts + 1;
+    bus_time_ns += (uint64_t)bits * 1000000000ULL / clock_hz;
+    transactions++;
+}
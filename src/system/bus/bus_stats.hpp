@@ -0,0 +1,43 @@
+#pragma once
+#include <Arduino.h>
+
+#include "bus_lock.hpp"
+
+/**
+ * Estimated I2C bus occupancy for all drivers on the shared bus.
+ *
+ * Each transaction is charged from its byte count at the configured bus
+ * clock: 9 bit times per byte (8 data + ACK) plus START/STOP overhead, and a
+ * repeated START for register reads. This gives the bus cost of a code path
+ * without a logic analyser; clock stretching and driver overhead are not
+ * included. Charges are made under I2CBusLock by the transaction that
+ * incurs them; the getters take it too so the 64-bit total is read whole.
+ */
+class I2CBusStats {
+private:
+    static uint32_t clock_hz;
+    static uint32_t transactions;
+    static uint64_t bus_time_ns;
+
+public:
+    static void setClock(uint32_t hz) { clock_hz = hz; }
+    static uint32_t getClock() { return clock_hz; }
+
+    // Register write: address + register + payload
+    static void chargeWrite(size_t len) { charge(2 + len, 1); }
+
+    // Register read: address + register, repeated START, address + payload
+    static void chargeRead(size_t len) { charge(3 + len, 2); }
+
+    // Generic transaction with the given bytes on the wire and START conditions
+    static void charge(size_t bytes, uint8_t starts);
+
+    static uint32_t getTransactionCount() {
+        I2CBusLock::Guard lock;
+        return transactions;
+    }
+    static uint64_t getBusTimeUs() {
+        I2CBusLock::Guard lock;
+        return bus_time_ns / 1000;
+    }
+};
@@ -0,0 +1,254 @@
+#pragma once
+#include <Arduino.h>
+#include <Wire.h>
+
+#include "config.h"
+#include "../../logger/logger.hpp"
+#include "bus_lock.hpp"
+#include "bus_stats.hpp"
+#include "register_cache.hpp"
+#include "register_map.hpp"
+
+/**
+ * Register-level access to one I2C device.
+ *
+ * Wraps the begin/write/endTransmission boilerplate every driver used to
+ * hand-roll, keeps a shadow cache of the control registers in
+ * [CACHE_FIRST, CACHE_LAST] and counts bus transactions.
+ *
+ * Writes that belong together are queued in a Burst; on flush() adjacent
+ * registers are merged into a single auto-increment write transaction.
+ *
+ * Transactions and cache updates run under I2CBusLock, so the IMU sampling
+ * task and the main loop can share a device.
+ */
+template <uint8_t DEVICE_ADDR, uint8_t CACHE_FIRST, uint8_t CACHE_LAST>
+class I2CRegisterDevice {
+private:
+    TwoWire* i2c = nullptr;
+    Logger* logger = nullptr;
+    const char* tag = "I2C";
+    RegisterCache<CACHE_FIRST, CACHE_LAST> cache;
+    uint32_t transactions = 0;
+
+public:
+    static constexpr uint8_t address = DEVICE_ADDR;
+
+    I2CRegisterDevice(Logger* logger, const char* tag) : logger(logger), tag(tag) {}
+
+    void setBus(TwoWire& bus) { i2c = &bus; }
+    bool hasBus() const { return i2c != nullptr; }
+    TwoWire* getBus() { return i2c; }
+
+    uint32_t getTransactionCount() const { return transactions; }
+    uint32_t getCacheMismatchCount() const { return cache.getMismatchCount(); }
+
+    // Declare bits of a cached register that the hardware changes by itself
+    template <typename F>
+    void declareVolatile() {
+        static_assert(isVolatileAccess<F>(), "Only RO/W0C/W1C fields can be volatile");
+        uint8_t neutral = (F::access == RegAccess::W0C) ? F::mask : 0x00;
+        cache.addVolatileBits(F::address, F::mask, neutral);
+    }
+
+    void invalidateCache() { cache.invalidateAll(); }
+
+    // Raw block access (one transaction each)
+    bool writeBlock(uint8_t reg, const uint8_t* data, size_t len) {
+        if (!i2c) return false;
+
+        I2CBusLock::Guard lock;
+        transactions++;
+        I2CBusStats::chargeWrite(len);
+        i2c->beginTransmission(DEVICE_ADDR);
+        i2c->write(reg);
+        i2c->write(data, len);
+        bool ok = (i2c->endTransmission() == 0);
+
+        for (size_t i = 0; i < len; i++) {
+            if (ok) cache.store(reg + i, data[i]);
+            else cache.invalidate(reg + i);
+        }
+        return ok;
+    }
+
+    bool readBlock(uint8_t reg, uint8_t* buffer, size_t len) {
+        if (!i2c) return false;
+
+        I2CBusLock::Guard lock;
+        transactions++;
+        I2CBusStats::chargeRead(len);
+        i2c->beginTransmission(DEVICE_ADDR);
+        i2c->write(reg);
+        if (i2c->endTransmission(false) != 0) return false;
+
+        if (i2c->requestFrom(DEVICE_ADDR, len) != len) return false;
+
+        for (size_t i = 0; i < len; i++) {
+            buffer[i] = i2c->read();
+        }
+
+        return true;
+    }
+
+    // Typed register access
+    template <typename R>
+    bool write(uint8_t value) {
+        static_assert(R::access != RegAccess::RO, "Register is read-only");
+        return writeBlock(R::address, &value, 1);
+    }
+
+    template <typename R>
+    bool read(uint8_t& value) {
+        static_assert(R::access != RegAccess::WO, "Register is write-only");
+        return readBlock(R::address, &value, 1);
+    }
+
+    // Cached value of a control register, loading it from hardware on a miss
+    template <typename R>
+    bool cached(uint8_t& value) {
+        static_assert(R::address >= CACHE_FIRST && R::address <= CACHE_LAST, "Register is not cached");
+        I2CBusLock::Guard lock;
+        if (cache.get(R::address, value)) {
+            verify(R::address);
+            return true;
+        }
+        if (!readBlock(R::address, &value, 1)) return false;
+        cache.store(R::address, value);
+        return true;
+    }
+
+    // Read-modify-write from the shadow cache: one write transaction
+    template <typename R>
+    bool modify(uint8_t set_bits, uint8_t clear_bits) {
+        static_assert(R::access != RegAccess::RO, "Register is read-only");
+        I2CBusLock::Guard lock;
+        uint8_t current = 0;
+        if (!cached<R>(current)) return false;
+        uint8_t value = cache.compose(R::address, set_bits, clear_bits);
+        return writeBlock(R::address, &value, 1);
+    }
+
+    template <typename F>
+    bool writeField(typename F::value_type value) {
+        static_assert(F::access != RegAccess::RO, "Field is read-only");
+        return modify<typename F::reg>(F::encode(value), F::mask);
+    }
+
+    template <typename F>
+    bool readField(typename F::value_type& value) {
+        uint8_t raw = 0;
+        if (!read<typename F::reg>(raw)) return false;
+        value = F::decode(raw);
+        return true;
+    }
+
+    // Compare a cached register against hardware (REG_CACHE_VERIFY only)
+    bool verify(uint8_t reg) {
+#if REG_CACHE_VERIFY
+        uint8_t hw = 0;
+        if (!readBlock(reg, &hw, 1)) return false;
+        if (!cache.verify(reg, hw)) {
+            uint8_t expected = 0;
+            cache.get(reg, expected);
+            if (logger) {
+                logger->warn(tag, (String("Register cache mismatch at 0x") + String(reg, HEX) +
+                                   " cached=0x" + String(expected, HEX) + " hw=0x" + String(hw, HEX)).c_str());
+            }
+            return false;
+        }
+#else
+        (void)reg;
+#endif
+        return true;
+    }
+
+    /**
+     * Collects register writes and emits them as few transactions as
+     * possible. Writes are sorted by address; runs of consecutive registers
+     * become one auto-increment transaction. A register written twice keeps
+     * the last value.
+     */
+    class Burst {
+    private:
+        static constexpr size_t MAX_WRITES = 16;
+        I2CRegisterDevice& dev;
+        uint8_t regs[MAX_WRITES];
+        uint8_t values[MAX_WRITES];
+        size_t count = 0;
+        bool overflow = false;
+
+        void queue(uint8_t reg, uint8_t value) {
+            // Keep the queue sorted by register address
+            size_t pos = 0;
+            while (pos < count && regs[pos] < reg) pos++;
+            if (pos < count && regs[pos] == reg) {
+                values[pos] = value;
+                return;
+            }
+            if (count == MAX_WRITES) {
+                overflow = true;
+                return;
+            }
+            for (size_t i = count; i > pos; i--) {
+                regs[i] = regs[i - 1];
+                values[i] = values[i - 1];
+            }
+            regs[pos] = reg;
+            values[pos] = value;
+            count++;
+        }
+
+    public:
+        explicit Burst(I2CRegisterDevice& dev) : dev(dev) {}
+        ~Burst() { flush(); }
+
+        template <typename R>
+        Burst& write(uint8_t value) {
+            static_assert(R::access != RegAccess::RO, "Register is read-only");
+            queue(R::address, value);
+            return *this;
+        }
+
+        // Field write merged with the cached (or already queued) register value
+        template <typename F>
+        Burst& writeField(typename F::value_type value) {
+            static_assert(F::access != RegAccess::RO, "Field is read-only");
+            uint8_t base = 0;
+            bool queued = false;
+            for (size_t i = 0; i < count; i++) {
+                if (regs[i] == F::address) {
+                    base = values[i];
+                    queued = true;
+                }
+            }
+            if (!queued) {
+                I2CBusLock::Guard lock;
+                if (!dev.template cached<typename F::reg>(base)) {
+                    overflow = true;
+                    return *this;
+                }
+                base = dev.cache.compose(F::address, 0x00, 0x00);
+            }
+            queue(F::address, (base & ~F::mask) | F::encode(value));
+            return *this;
+        }
+
+        bool flush() {
+            I2CBusLock::Guard lock;
+            bool ok = !overflow;
+            size_t start = 0;
+            while (start < count) {
+                size_t end = start + 1;
+                while (end < count && regs[end] == regs[end - 1] + 1) end++;
+                if (!dev.writeBlock(regs[start], &values[start], end - start)) ok = false;
+                start = end;
+            }
+            count = 0;
+            overflow = false;
+            return ok;
+        }
+    };
+
+    Burst burst() { return Burst(*this); }
+};
@@ -0,0 +1,77 @@
+#pragma once
+#include <Arduino.h>
+
+/**
+ * Shadow copy of a contiguous block of device control registers.
+ *
+ * Drivers store every value they write so that read-modify-write paths can be
+ * served from RAM instead of an I2C read. Bits the device changes on its own
+ * (interrupt/status flags) are marked volatile: they are never taken from the
+ * cache and are written back with their "no effect" value instead.
+ *
+ * With REG_CACHE_VERIFY enabled the driver reads the register from hardware
+ * as well and calls verify() to compare the non-volatile bits.
+ */
+template <uint8_t FIRST_REG, uint8_t LAST_REG>
+class RegisterCache {
+private:
+    static constexpr size_t SIZE = LAST_REG - FIRST_REG + 1;
+
+    uint8_t values[SIZE] = {0};
+    uint8_t volatile_mask[SIZE] = {0};
+    uint8_t volatile_write[SIZE] = {0};
+    bool valid[SIZE] = {false};
+    uint32_t mismatches = 0;
+
+public:
+    bool contains(uint8_t reg) const { return reg >= FIRST_REG && reg <= LAST_REG; }
+
+    // Mark bits the hardware can change by itself. neutral_write holds the
+    // value written to those bits when they are not explicitly set/cleared
+    // (e.g. 1 for "write 0 to clear" flags).
+    void addVolatileBits(uint8_t reg, uint8_t mask, uint8_t neutral_write) {
+        if (!contains(reg)) return;
+        volatile_mask[reg - FIRST_REG] |= mask;
+        volatile_write[reg - FIRST_REG] |= neutral_write & mask;
+        values[reg - FIRST_REG] &= ~mask;
+    }
+
+    bool get(uint8_t reg, uint8_t& value) const {
+        if (!contains(reg) || !valid[reg - FIRST_REG]) return false;
+        value = values[reg - FIRST_REG];
+        return true;
+    }
+
+    void store(uint8_t reg, uint8_t value) {
+        if (!contains(reg)) return;
+        values[reg - FIRST_REG] = value & ~volatile_mask[reg - FIRST_REG];
+        valid[reg - FIRST_REG] = true;
+    }
+
+    void invalidate(uint8_t reg) {
+        if (contains(reg)) valid[reg - FIRST_REG] = false;
+    }
+
+    void invalidateAll() {
+        for (size_t i = 0; i < SIZE; i++) valid[i] = false;
+    }
+
+    // Value to write for a read-modify-write based on the cached contents.
+    // Caller must make sure the register is valid (see get()).
+    uint8_t compose(uint8_t reg, uint8_t set_bits, uint8_t clear_bits) const {
+        size_t i = reg - FIRST_REG;
+        uint8_t base = (values[i] & ~volatile_mask[i]) | volatile_write[i];
+        return (base & ~clear_bits) | set_bits;
+    }
+
+    // Compare the non-volatile bits of a hardware read against the cache.
+    bool verify(uint8_t reg, uint8_t hw_value) {
+        uint8_t cached = 0;
+        if (!get(reg, cached)) return true;
+        bool ok = (cached == (hw_value & ~volatile_mask[reg - FIRST_REG]));
+        if (!ok) mismatches++;
+        return ok;
+    }
+
+    uint32_t getMismatchCount() const { return mismatches; }
+};
@@ -0,0 +1,56 @@
+#pragma once
+#include <Arduino.h>
+
+/**
+ * Compile-time register map building blocks.
+ *
+ * A device register map is a set of type aliases:
+ *
+ *   using Control2 = Register<0x01>;
+ *   using AlarmFlag = Field<Control2, 6, 1, RegAccess::W0C>;
+ *
+ * Addresses, bit positions and access modes are template parameters, so
+ * field encoding folds to constants and writing to a read-only register is
+ * a compile error.
+ */
+enum class RegAccess : uint8_t {
+    RO,   // Read only
+    WO,   // Write only (commands)
+    RW,   // Read/write
+    W0C,  // Set by hardware, cleared by writing 0 (writing 1 has no effect)
+    W1C   // Set by hardware, cleared by writing 1 (writing 0 has no effect)
+};
+
+template <uint8_t ADDRESS, RegAccess ACCESS = RegAccess::RW>
+struct Register {
+    static constexpr uint8_t address = ADDRESS;
+    static constexpr RegAccess access = ACCESS;
+    static constexpr uint8_t mask = 0xFF;
+};
+
+template <typename REG, uint8_t SHIFT, uint8_t WIDTH, RegAccess ACCESS = REG::access, typename T = uint8_t>
+struct Field {
+    static_assert(WIDTH > 0 && SHIFT + WIDTH <= 8, "Field does not fit in an 8-bit register");
+
+    using reg = REG;
+    using value_type = T;
+    static constexpr uint8_t address = REG::address;
+    static constexpr RegAccess access = ACCESS;
+    static constexpr uint8_t shift = SHIFT;
+    static constexpr uint8_t width = WIDTH;
+    static constexpr uint8_t mask = static_cast<uint8_t>(((1u << WIDTH) - 1u) << SHIFT);
+
+    static constexpr uint8_t encode(T value) {
+        return static_cast<uint8_t>((static_cast<uint8_t>(value) << SHIFT) & mask);
+    }
+
+    static constexpr T decode(uint8_t raw) {
+        return static_cast<T>((raw & mask) >> SHIFT);
+    }
+};
+
+// True for fields/registers the hardware may change on its own
+template <typename F>
+constexpr bool isVolatileAccess() {
+    return F::access == RegAccess::RO || F::access == RegAccess::W0C || F::access == RegAccess::W1C;
+}
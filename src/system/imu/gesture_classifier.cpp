@@ -0,0 +1,114 @@
+#include "gesture_classifier.hpp"
+
+#include "imu_kernels.hpp"
+
+namespace {
+    uint32_t isqrt(uint32_t value) {
+        uint32_t result = 0;
+        uint32_t bit = 1UL << 30;
+        while (bit > value) bit >>= 2;
+        while (bit != 0) {
+            if (value >= result + bit) {
+                value -= result + bit;
+                result = (result >> 1) + bit;
+            } else {
+                result >>= 1;
+            }
+            bit >>= 2;
+        }
+        return result;
+    }
+
+    int32_t readI32(const uint8_t* in) {
+        return (int32_t)((uint32_t)in[0] | (uint32_t)in[1] << 8 | (uint32_t)in[2] << 16 | (uint32_t)in[3] << 24);
+    }
+}
+
+void GestureFeatures::extract(const int16_t* const axes[6], size_t n, int32_t out[COUNT]) {
+    size_t tail = n - POSE_SAMPLES;
+    for (size_t axis = 0; axis < 3; axis++) {
+        out[END_AX + axis] = ImuKernels::sum(axes[axis] + tail, POSE_SAMPLES) / (int32_t)POSE_SAMPLES;
+        out[START_AX + axis] = ImuKernels::sum(axes[axis], POSE_SAMPLES) / (int32_t)POSE_SAMPLES;
+    }
+
+    uint64_t gyro_sq = ImuKernels::sumMagnitudeSquared(axes[3], axes[4], axes[5], n);
+    out[GYRO_RMS] = (int32_t)isqrt((uint32_t)(gyro_sq / n));
+
+    int32_t range = 0;
+    for (size_t axis = 0; axis < 3; axis++) {
+        int16_t lo, hi;
+        ImuKernels::minMax(axes[axis], n, lo, hi);
+        if (hi - lo > range) range = hi - lo;
+    }
+    out[ACCEL_RANGE] = range;
+}
+
+Gesture DecisionTreeClassifier::classify(const int16_t* const axes[6], size_t n) {
+    if (n < GestureFeatures::POSE_SAMPLES) return GESTURE_NONE;
+
+    int32_t features[GestureFeatures::COUNT];
+    GestureFeatures::extract(axes, n, features);
+    return classifyFeatures(features);
+}
+
+Gesture DecisionTreeClassifier::classifyFeatures(const int32_t features[GestureFeatures::COUNT]) const {
+    size_t index = 0;
+    while (index < node_count) {
+        const Node& node = nodes[index];
+        if (node.label != NO_LABEL) return (Gesture)node.label;
+        index = (features[node.feature] <= node.threshold) ? node.left : node.right;
+    }
+    return GESTURE_NONE;
+}
+
+bool DecisionTreeClassifier::load(const uint8_t* data, size_t len) {
+    if (len < 5 || data[0] != 'G' || data[1] != 'D' || data[2] != 'T' || data[3] != '1') return false;
+
+    size_t count = data[4];
+    if (count == 0 || count > MAX_NODES || len != 5 + count * NODE_BYTES) return false;
+
+    // Validate before replacing the current tree
+    Node parsed[MAX_NODES];
+    for (size_t i = 0; i < count; i++) {
+        const uint8_t* in = &data[5 + i * NODE_BYTES];
+        Node& node = parsed[i];
+        node.feature = in[0];
+        node.left = in[1];
+        node.right = in[2];
+        node.label = in[3];
+        node.threshold = readI32(&in[4]);
+
+        if (node.label != NO_LABEL) {
+            if (node.label >= GESTURE_COUNT) return false;
+        } else if (node.feature >= GestureFeatures::COUNT || node.left <= i || node.right <= i ||
+                   node.left >= count || node.right >= count) {
+            return false;
+        }
+    }
+
+    for (size_t i = 0; i < count; i++) nodes[i] = parsed[i];
+    node_count = count;
+    return true;
+}
+
+void DecisionTreeClassifier::loadDefault() {
+    using namespace GestureFeatures;
+
+    // Thresholds in raw counts: 4096/g, 32/dps
+    static const Node DEFAULT_TREE[] = {
+        /* 0 */ {GYRO_RMS, 1, 2, NO_LABEL, 800},       // No rotation (< 25dps RMS): nothing
+        /* 1 */ {0, 0, 0, GESTURE_NONE, 0},
+        /* 2 */ {END_AX, 5, 3, NO_LABEL, 819},         // Face towards the user: x > 0.2g ...
+        /* 3 */ {END_AZ, 4, 5, NO_LABEL, -820},        // ... and z < -0.2g
+        /* 4 */ {0, 0, 0, GESTURE_WRIST_RAISE, 0},
+        /* 5 */ {END_AY, 6, 7, NO_LABEL, -1434},       // Arm hanging (standing): y < -0.35g
+        /* 6 */ {0, 0, 0, GESTURE_WRIST_LOWER, 0},
+        /* 7 */ {END_AY, 10, 8, NO_LABEL, 409},        // Arm on the lap (sitting): y > 0.1g ...
+        /* 8 */ {END_AZ, 9, 10, NO_LABEL, -1639},      // ... and z < -0.4g
+        /* 9 */ {0, 0, 0, GESTURE_WRIST_LOWER, 0},
+        /* 10 */ {0, 0, 0, GESTURE_NONE, 0},
+    };
+
+    node_count = sizeof(DEFAULT_TREE) / sizeof(DEFAULT_TREE[0]);
+    for (size_t i = 0; i < node_count; i++) nodes[i] = DEFAULT_TREE[i];
+}
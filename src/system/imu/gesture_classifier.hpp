@@ -0,0 +1,91 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Windowed gesture classification over raw QMI8658 counts (8g, 1024dps).
+ *
+ * A classifier looks at one window of samples in SoA layout (ax, ay, az,
+ * gx, gy, gz arrays, oldest first) and returns a Gesture. The decision
+ * tree implementation works on a handful of integer features, runs in
+ * bounded time (nodes only point forward) and loads from a small binary
+ * blob, so trees trained off-target can be dropped onto LittleFS.
+ *
+ * No Arduino dependencies: tools/gesture_eval.cpp runs the same code on
+ * labeled traces.
+ */
+enum Gesture : uint8_t {
+    GESTURE_NONE = 0,
+    GESTURE_WRIST_RAISE = 1,
+    GESTURE_WRIST_LOWER = 2,
+    GESTURE_COUNT
+};
+
+namespace GestureFeatures {
+    enum Index : uint8_t {
+        END_AX = 0,     // Pose at the end of the window (mean of the newest POSE_SAMPLES)
+        END_AY,
+        END_AZ,
+        START_AX,       // Pose at the start of the window
+        START_AY,
+        START_AZ,
+        GYRO_RMS,       // Rotation over the whole window
+        ACCEL_RANGE,    // Largest max - min over the accel axes
+        COUNT
+    };
+
+    static constexpr size_t POSE_SAMPLES = 16;
+
+    // axes[0..5] = ax, ay, az, gx, gy, gz; n >= POSE_SAMPLES
+    void extract(const int16_t* const axes[6], size_t n, int32_t out[COUNT]);
+}
+
+class GestureClassifier {
+public:
+    virtual ~GestureClassifier() {}
+    virtual const char* name() const = 0;
+    virtual Gesture classify(const int16_t* const axes[6], size_t n) = 0;
+};
+
+/**
+ * Fixed-point decision tree over GestureFeatures.
+ *
+ * Blob format (little endian):
+ *   "GDT1" | node count u8 | nodes[count] x 8 bytes:
+ *   feature u8 | left u8 | right u8 | label u8 | threshold i32
+ *
+ * label != NO_LABEL marks a leaf. Internal nodes go left when
+ * feature <= threshold. Child indices must be greater than the parent's,
+ * which bounds evaluation to at most `count` steps.
+ */
+class DecisionTreeClassifier : public GestureClassifier {
+public:
+    static constexpr size_t MAX_NODES = 63;
+    static constexpr uint8_t NO_LABEL = 0xFF;
+    static constexpr size_t NODE_BYTES = 8;
+
+    struct Node {
+        uint8_t feature;
+        uint8_t left;
+        uint8_t right;
+        uint8_t label;
+        int32_t threshold;
+    };
+
+private:
+    Node nodes[MAX_NODES];
+    size_t node_count = 0;
+
+public:
+    DecisionTreeClassifier() { loadDefault(); }
+
+    const char* name() const override { return "decision_tree"; }
+    Gesture classify(const int16_t* const axes[6], size_t n) override;
+    Gesture classifyFeatures(const int32_t features[GestureFeatures::COUNT]) const;
+
+    // Replace the tree; keeps the current one if the blob is invalid
+    bool load(const uint8_t* data, size_t len);
+    // Built-in tree encoding the former hand-written wrist rules
+    void loadDefault();
+    size_t getNodeCount() const { return node_count; }
+};
@@ -0,0 +1,48 @@
+#include "gesture_classifier_stage.hpp"
+
+void GestureClassifierStage::process(const ImuSample& sample) {
+    const SampleWindow& w = window.getWindow();
+    if (w.size() < WINDOW_SAMPLES || w.getTotal() - last_window_total < HOP_SAMPLES) return;
+    last_window_total = w.getTotal();
+
+    uint32_t start = ESP.getCycleCount();
+    const int16_t* axes[SampleWindow::CHANNELS];
+    for (size_t c = 0; c < SampleWindow::CHANNELS; c++) {
+        w.copyRaw((SampleWindow::Channel)c, WINDOW_SAMPLES, scratch[c]);
+        axes[c] = scratch[c];
+    }
+    Gesture gesture = classifier.classify(axes, WINDOW_SAMPLES);
+    uint32_t cycles = ESP.getCycleCount() - start;
+
+    stats.windows++;
+    stats.cycles += cycles;
+    if (cycles > stats.max_cycles) stats.max_cycles = cycles;
+    if (cycles > CYCLE_BUDGET) stats.over_budget++;
+
+    // Report on entering a gesture class, rate limited
+    if (gesture != GESTURE_NONE && gesture != last_class && sample.timestamp_ms - last_event_ms > COOLDOWN_MS) {
+        pending = gesture;
+        last_event_ms = sample.timestamp_ms;
+    }
+    last_class = gesture;
+}
+
+bool loadGestureTree(FSManager& fs, const char* path, DecisionTreeClassifier& tree, Logger* logger) {
+    if (!fs.isInitialized() || !fs.exists(path)) return false;
+
+    File file = fs.openFile(path, FILE_READ);
+    if (!file) return false;
+
+    uint8_t blob[5 + DecisionTreeClassifier::MAX_NODES * DecisionTreeClassifier::NODE_BYTES];
+    size_t len = file.read(blob, sizeof(blob));
+    file.close();
+
+    if (!tree.load(blob, len)) {
+        if (logger != nullptr) logger->warn("GESTURE", (String("Invalid gesture tree in ") + path + " - using built-in").c_str());
+        return false;
+    }
+    if (logger != nullptr) {
+        logger->info("GESTURE", (String("Loaded gesture tree (") + String(tree.getNodeCount()) + " nodes) from " + path).c_str());
+    }
+    return true;
+}
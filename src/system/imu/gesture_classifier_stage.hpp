@@ -0,0 +1,60 @@
+#pragma once
+#include <Arduino.h>
+
+#include "gesture_classifier.hpp"
+#include "sample_window.hpp"
+#include "../storage/fs_manager.hpp"
+#include "../../logger/logger.hpp"
+
+/**
+ * Runs a GestureClassifier on the shared sample window every HOP_SAMPLES
+ * samples. A gesture is reported when the class changes into it, at most
+ * once per COOLDOWN_MS. Work per window is one linear copy of the window
+ * plus the classifier, with cycles checked against CYCLE_BUDGET.
+ */
+class GestureClassifierStage : public ImuStage {
+public:
+    struct Stats {
+        uint32_t windows;
+        uint64_t cycles;
+        uint32_t max_cycles;
+        uint32_t over_budget;
+    };
+
+private:
+    static constexpr size_t WINDOW_SAMPLES = SampleWindow::CAPACITY;
+    static constexpr size_t HOP_SAMPLES = 16;           // ~125ms at full rate
+    static constexpr uint32_t COOLDOWN_MS = 1000;
+    static constexpr uint32_t CYCLE_BUDGET = 40000;     // ~170us at 240MHz
+
+    const ImuWindowStage& window;
+    GestureClassifier& classifier;
+    Logger* logger = nullptr;
+
+    int16_t scratch[SampleWindow::CHANNELS][WINDOW_SAMPLES];
+    uint32_t last_window_total = 0;
+    Gesture last_class = GESTURE_NONE;
+    uint32_t last_event_ms = 0;
+    Gesture pending = GESTURE_NONE;
+    Stats stats = {};
+
+public:
+    GestureClassifierStage(const ImuWindowStage& window, GestureClassifier& classifier, Logger* logger)
+        : window(window), classifier(classifier), logger(logger) {}
+
+    const char* name() const override { return "classifier"; }
+    void process(const ImuSample& sample) override;
+
+    // Returns the gesture detected since the last call (GESTURE_NONE if none)
+    Gesture takeEvent() {
+        Gesture event = pending;
+        pending = GESTURE_NONE;
+        return event;
+    }
+
+    const Stats& getStats() const { return stats; }
+    void resetClassifierStats() { stats = {}; }
+};
+
+// Loads a decision tree blob from LittleFS into the classifier
+bool loadGestureTree(FSManager& fs, const char* path, DecisionTreeClassifier& tree, Logger* logger);
@@ -0,0 +1,89 @@
+#include "gesture_stages.hpp"
+
+float TiltGestureStage::accelRotationDps(const ImuSample& sample) const {
+    if (state.last_accel_us == 0) return 0.0f;
+    int64_t dt_us = sample.timestamp_us - state.last_accel_us;
+    if (dt_us <= 0 || dt_us > 4 * (int64_t)sample.period_us) return 0.0f;
+
+    // Angle between the previous and current accel direction
+    const IMU::AccelData& a = state.last_accel;
+    const IMU::AccelData& b = sample.accel;
+    float cx = a.y * b.z - a.z * b.y;
+    float cy = a.z * b.x - a.x * b.z;
+    float cz = a.x * b.y - a.y * b.x;
+    float angle = atan2f(sqrtf(cx * cx + cy * cy + cz * cz), a.x * b.x + a.y * b.y + a.z * b.z);
+    return angle * 57.29578f * 1e6f / dt_us;
+}
+
+void TiltGestureStage::process(const ImuSample& sample) {
+    uint32_t now = sample.timestamp_ms;
+
+    bool use_gravity = (orientation != nullptr && orientation->isValid());
+    bool target = inTargetPosition(use_gravity ? orientation->getGravity() : sample.accel);
+    bool strong_rotation;
+    if (sample.gyro_valid) {
+        strong_rotation = (abs(sample.gyro.x) > ROTATION_THRESHOLD_DPS ||
+                           abs(sample.gyro.y) > ROTATION_THRESHOLD_DPS ||
+                           abs(sample.gyro.z) > ROTATION_THRESHOLD_DPS);
+    } else {
+        strong_rotation = accelRotationDps(sample) > ROTATION_THRESHOLD_DPS;
+    }
+    state.last_accel = sample.accel;
+    state.last_accel_us = sample.timestamp_us;
+    bool entered = target && !state.was_target;
+    state.was_target = target;
+
+    // Remember when we last saw rotation
+    if (strong_rotation) {
+        state.last_rotation_ms = now;
+    }
+
+    switch (state.phase) {
+        case State::IDLE:
+            // Moved into the target position AND rotation in the last 1.5 seconds = gesture!
+            if (entered && (now - state.last_rotation_ms < ROTATION_WINDOW_MS)) {
+                state.phase = State::TRIGGERED;
+                state.state_ms = now;
+                state.pending = true;
+                if (logger != nullptr) logger->info("IMU_TILT", eventMessage());
+            }
+            break;
+
+        case State::TRIGGERED:
+            // Cooldown, then back to IDLE once out of the target position
+            if (now - state.state_ms > COOLDOWN_MS && !target) {
+                state.phase = State::IDLE;
+            }
+            break;
+    }
+}
+
+void MotionStage::process(const ImuSample& sample) {
+    uint32_t now = sample.timestamp_ms;
+
+    // Compare magnitudes at a fixed interval, independent of the sample rate
+    if (state.reference_ms != 0 && now - state.reference_ms < COMPARE_INTERVAL_MS) return;
+
+    // RMS magnitude of the samples received since the previous comparison
+    const SampleWindow& w = window.getWindow();
+    size_t n = w.getTotal() - state.reference_total;
+    float magnitude = sqrt(w.meanSquareMagnitude(SampleWindow::AX, n)) * IMU::ACCEL_SCALE;
+    state.reference_total = w.getTotal();
+
+    // Initialize on first sample
+    if (state.reference_ms == 0) {
+        state.reference_magnitude = magnitude;
+        state.reference_ms = now;
+        return;
+    }
+
+    float delta = abs(magnitude - state.reference_magnitude);
+    state.reference_magnitude = magnitude;
+    state.reference_ms = now;
+
+    // Debounce: only report motion once per 2 seconds
+    if (delta > threshold && now - state.last_motion_ms > DEBOUNCE_MS) {
+        state.last_motion_ms = now;
+        state.pending = true;
+    }
+}
@@ -0,0 +1,131 @@
+#pragma once
+#include <Arduino.h>
+
+#include "imu_pipeline.hpp"
+#include "orientation_stage.hpp"
+#include "sample_window.hpp"
+#include "../../logger/logger.hpp"
+
+/**
+ * Wrist gesture detector: remembers the last strong rotation and fires when
+ * the watch moves into the target position within ROTATION_WINDOW_MS of it.
+ * Starting a movement from the target position (e.g. raising a hanging arm
+ * for a lower gesture) does not fire. After firing it waits COOLDOWN_MS and
+ * for the watch to leave the target position before arming again.
+ *
+ * With an OrientationStage attached the target position is evaluated on the
+ * filtered gravity direction instead of the raw accelerometer, so linear
+ * acceleration while the arm moves does not fake or mask the pose. For
+ * accel-only samples (gyro off) the rotation rate is the turn of the accel
+ * direction between samples.
+ */
+class TiltGestureStage : public ImuStage {
+private:
+    static constexpr float ROTATION_THRESHOLD_DPS = 40.0f;
+    static constexpr uint32_t ROTATION_WINDOW_MS = 1500;
+    static constexpr uint32_t COOLDOWN_MS = 1000;
+
+    struct State {
+        enum Phase : uint8_t { IDLE, TRIGGERED } phase = IDLE;
+        uint32_t last_rotation_ms = 0;
+        uint32_t state_ms = 0;
+        bool pending = false;
+        bool was_target = false;
+        IMU::AccelData last_accel = {0.0f, 0.0f, 0.0f};
+        int64_t last_accel_us = 0;
+    };
+
+    State state;
+
+    float accelRotationDps(const ImuSample& sample) const;
+
+protected:
+    Logger* logger = nullptr;
+    const OrientationStage* orientation = nullptr;
+
+    virtual bool inTargetPosition(const IMU::AccelData& accel) const = 0;
+    virtual const char* eventMessage() const = 0;
+
+public:
+    TiltGestureStage(Logger* logger, const OrientationStage* orientation)
+        : logger(logger), orientation(orientation) {}
+
+    void process(const ImuSample& sample) override;
+
+    // Returns true once per detected gesture
+    bool takeEvent() {
+        bool pending = state.pending;
+        state.pending = false;
+        return pending;
+    }
+};
+
+// Wrist raised: watch face up towards the user
+class WristRaiseStage : public TiltGestureStage {
+protected:
+    bool inTargetPosition(const IMU::AccelData& accel) const override {
+        return accel.x > 0.20f && accel.z < -0.20f;
+    }
+    const char* eventMessage() const override { return "✓ Wrist raise gesture!"; }
+
+public:
+    WristRaiseStage(Logger* logger, const OrientationStage* orientation = nullptr)
+        : TiltGestureStage(logger, orientation) {}
+    const char* name() const override { return "wrist_raise"; }
+};
+
+// Wrist lowered: arm hanging (standing) or resting on the lap (sitting)
+class WristLowerStage : public TiltGestureStage {
+protected:
+    bool inTargetPosition(const IMU::AccelData& accel) const override {
+        bool arm_down_standing = (accel.y < -0.35f);
+        // Face up on the lap, but not tilted towards the user (the raise position)
+        bool arm_down_sitting = (accel.y > 0.10f && accel.z < -0.40f && accel.x < 0.20f);
+        return arm_down_standing || arm_down_sitting;
+    }
+    const char* eventMessage() const override { return "✓ Wrist lowered - sleep!"; }
+
+public:
+    WristLowerStage(Logger* logger, const OrientationStage* orientation = nullptr)
+        : TiltGestureStage(logger, orientation) {}
+    const char* name() const override { return "wrist_lower"; }
+};
+
+/**
+ * Software motion detector: change of the RMS acceleration magnitude
+ * between consecutive COMPARE_INTERVAL_MS windows above the threshold,
+ * reported at most every DEBOUNCE_MS. The magnitude comes from a batch
+ * kernel over the shared sample window, one sqrt per interval.
+ */
+class MotionStage : public ImuStage {
+private:
+    static constexpr uint32_t COMPARE_INTERVAL_MS = 100;
+    static constexpr uint32_t DEBOUNCE_MS = 2000;
+
+    struct State {
+        float reference_magnitude = 0.0f;
+        uint32_t reference_ms = 0;
+        uint32_t reference_total = 0;
+        uint32_t last_motion_ms = 0;
+        bool pending = false;
+    };
+
+    const ImuWindowStage& window;
+    State state;
+    float threshold = 0.15f;  // g threshold for motion (walking ~0.2g, running ~0.5g)
+
+public:
+    explicit MotionStage(const ImuWindowStage& window) : window(window) {}
+
+    const char* name() const override { return "motion"; }
+    void process(const ImuSample& sample) override;
+
+    bool takeEvent() {
+        bool pending = state.pending;
+        state.pending = false;
+        return pending;
+    }
+
+    void setThreshold(float threshold_g) { threshold = threshold_g; }
+    float getThreshold() const { return threshold; }
+};
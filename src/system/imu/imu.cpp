@@ -1,54 +1,74 @@
 #include "imu.hpp"
+#include "../loop/event_loop.hpp"
 
 volatile bool IMU::motion_detected = false;
+volatile int64_t IMU::interrupt_time_us = 0;
+TaskHandle_t IMU::interrupt_task = nullptr;
 
 void IRAM_ATTR IMU::motionISR() {
     motion_detected = true;
+    
+    // Deferred acquisition: stamp the edge and wake the sampling task
+    if (interrupt_task != nullptr) {
+        interrupt_time_us = esp_timer_get_time();
+        BaseType_t woken = pdFALSE;
+        vTaskNotifyGiveFromISR(interrupt_task, &woken);
+        portYIELD_FROM_ISR(woken);
+    } else {
+        // FIFO watermark or motion: drained by the main loop
+        EventLoop::postFromISR(EventLoop::EVENT_IMU);
+    }
 }
 
 bool IMU::setBus(TwoWire &bus) {
-    i2c = &bus;
+    using namespace QMI8658;
+    
+    device.setBus(bus);
     interrupt_pin = IMU_INT2;
     
     // Read chip ID
     uint8_t whoami = 0;
-    if (!readRegister(REG_WHO_AM_I, &whoami)) {
+    if (!device.read<WhoAmI>(whoami)) {
         if (logger != nullptr) logger->failure("IMU", "QMI8658 not found");
         return false;
     }
     
     if (logger != nullptr) logger->info("IMU", (String("Chip ID: 0x") + String(whoami, HEX)).c_str());
     
-    // Software reset
-    writeRegister(REG_RESET, 0xB0);
+    // Software reset (all control registers return to defaults)
+    device.write<Reset>(0xB0);
+    device.invalidateCache();
     delay(10);
     
     // Configure CTRL1: Set serial interface, address auto increment, and INT pins
     // Bit 6: address auto increment (1)
     // Bit 3-2: INT pin config (11 = push-pull, active high)
-    if (!writeRegister(REG_CTRL1, 0x4C)) {
+    // Written on its own: bursts below depend on auto increment being enabled.
+    if (!device.write<Ctrl1>(0x4C)) {
         if (logger != nullptr) logger->failure("IMU", "Failed to configure CTRL1");
         return false;
     }
     
+    // Sensor configuration in one burst (CTRL2+CTRL3 coalesce, CTRL7 follows)
+    auto burst = device.burst();
+    
     // Configure accelerometer: 8g range, 128Hz ODR
-    // CTRL2: [7:4] = accel range (0011 = 8g), [3:0] = ODR (0110 = 128Hz)
-    if (!writeRegister(REG_CTRL2, 0x36)) {
-        if (logger != nullptr) logger->failure("IMU", "Failed to configure accelerometer");
-        return false;
-    }
+    // CTRL2: [6:4] = accel range (010 = 8g), [3:0] = ODR (0110 = 128Hz)
+    burst.write<Ctrl2>(0x26);
     
     // Configure gyroscope: 1024dps range, 128Hz ODR
-    // CTRL3: [7:4] = gyro range (0110 = 1024dps), [3:0] = ODR (0110 = 128Hz)
-    if (!writeRegister(REG_CTRL3, 0x66)) {
-        if (logger != nullptr) logger->failure("IMU", "Failed to configure gyroscope");
-        return false;
-    }
+    // CTRL3: [6:4] = gyro range (110 = 1024dps), [3:0] = ODR (0110 = 128Hz)
+    burst.write<Ctrl3>(0x66);
     
     // Enable accelerometer and gyroscope with syncSmpl
     // CTRL7: [7] = syncSmpl (1 = level mode INT2), [1] = enable gyro, [0] = enable accel
-    if (!writeRegister(REG_CTRL7, 0x83)) {  // 0x83 = syncSmpl + gyro + accel
-        if (logger != nullptr) logger->failure("IMU", "Failed to enable sensors");
+    burst.write<Ctrl7>(0x83);  // 0x83 = syncSmpl + gyro + accel
+    
+    // CTRL8: CTRL9 command handshake through STATUSINT.bit7 (INT1 is not wired)
+    burst.write<Ctrl8>(Ctrl8_HandshakeType::encode(1));
+    
+    if (!burst.flush()) {
+        if (logger != nullptr) logger->failure("IMU", "Failed to configure sensors");
         return false;
     }
     
@@ -59,53 +79,25 @@ bool IMU::setBus(TwoWire &bus) {
     pinMode(interrupt_pin, INPUT);
     attachInterrupt(digitalPinToInterrupt(interrupt_pin), motionISR, RISING);
     
-    // Read back CTRL7 for verification
-    uint8_t ctrl7_read = 0;
-    if (readRegister(REG_CTRL7, &ctrl7_read)) {
-        if (logger != nullptr) logger->info("IMU", (String("CTRL7 readback: 0x") + String(ctrl7_read, HEX)).c_str());
+    // CTRL7 comes from the register cache; hardware readback only in verify mode
+    uint8_t ctrl7 = 0;
+    if (device.cached<Ctrl7>(ctrl7)) {
+        if (logger != nullptr) logger->info("IMU", (String("CTRL7: 0x") + String(ctrl7, HEX)).c_str());
     }
     
     if (logger != nullptr) logger->info("IMU", (String("Data Ready interrupt (INT2) on GPIO") + String(interrupt_pin)).c_str());
+    if (logger != nullptr) logger->info("IMU", (String("Init bus transactions: ") + String(device.getTransactionCount())).c_str());
     
     if (logger != nullptr) logger->success("IMU", "QMI8658 initialized");
     initialized = true;
     return true;
 }
 
-bool IMU::writeRegister(uint8_t reg, uint8_t value) {
-    if (!i2c) return false;
-    
-    i2c->beginTransmission(ADDR_QMI8658);
-    i2c->write(reg);
-    i2c->write(value);
-    return (i2c->endTransmission() == 0);
-}
-
-bool IMU::readRegister(uint8_t reg, uint8_t* value) {
-    return readRegisters(reg, value, 1);
-}
-
-bool IMU::readRegisters(uint8_t reg, uint8_t* buffer, size_t len) {
-    if (!i2c) return false;
-    
-    i2c->beginTransmission(ADDR_QMI8658);
-    i2c->write(reg);
-    if (i2c->endTransmission(false) != 0) return false;
-    
-    if (i2c->requestFrom(ADDR_QMI8658, len) != len) return false;
-    
-    for (size_t i = 0; i < len; i++) {
-        buffer[i] = i2c->read();
-    }
-    
-    return true;
-}
-
 bool IMU::readAccel(AccelData& data) {
     if (!initialized) return false;
     
     uint8_t raw[6];
-    if (!readRegisters(REG_AX_L, raw, 6)) return false;
+    if (!device.readBlock(QMI8658::AxL::address, raw, 6)) return false;
     
     // Combine bytes (little endian)
     int16_t ax = (int16_t)(raw[1] << 8 | raw[0]);
@@ -113,10 +105,9 @@ bool IMU::readAccel(AccelData& data) {
     int16_t az = (int16_t)(raw[5] << 8 | raw[4]);
     
     // Convert to g (8g range, 16-bit)
-    const float scale = 8.0f / 32768.0f;
-    data.x = ax * scale;
-    data.y = ay * scale;
-    data.z = az * scale;
+    data.x = ax * ACCEL_SCALE;
+    data.y = ay * ACCEL_SCALE;
+    data.z = az * ACCEL_SCALE;
     
     return true;
 }
@@ -125,7 +116,7 @@ bool IMU::readGyro(GyroData& data) {
     if (!initialized) return false;
     
     uint8_t raw[6];
-    if (!readRegisters(REG_GX_L, raw, 6)) return false;
+    if (!device.readBlock(QMI8658::GxL::address, raw, 6)) return false;
     
     // Combine bytes (little endian)
     int16_t gx = (int16_t)(raw[1] << 8 | raw[0]);
@@ -133,10 +124,9 @@ bool IMU::readGyro(GyroData& data) {
     int16_t gz = (int16_t)(raw[5] << 8 | raw[4]);
     
     // Convert to dps (1024dps range, 16-bit)
-    const float scale = 1024.0f / 32768.0f;
-    data.x = gx * scale;
-    data.y = gy * scale;
-    data.z = gz * scale;
+    data.x = gx * GYRO_SCALE;
+    data.y = gy * GYRO_SCALE;
+    data.z = gz * GYRO_SCALE;
     
     return true;
 }
@@ -145,7 +135,7 @@ bool IMU::readTemperature(float& temp) {
     if (!initialized) return false;
     
     uint8_t raw[2];
-    if (!readRegisters(REG_TEMP_L, raw, 2)) return false;
+    if (!device.readBlock(QMI8658::TempL::address, raw, 2)) return false;
     
     int16_t temp_raw = (int16_t)(raw[1] << 8 | raw[0]);
     
@@ -155,153 +145,453 @@ bool IMU::readTemperature(float& temp) {
     return true;
 }
 
-bool IMU::checkWristTilt() {
+IMU::AccelData IMU::toAccel(const RawSample& raw) {
+    return AccelData{raw.ax * ACCEL_SCALE, raw.ay * ACCEL_SCALE, raw.az * ACCEL_SCALE};
+}
+
+IMU::GyroData IMU::toGyro(const RawSample& raw) {
+    return GyroData{raw.gx * GYRO_SCALE, raw.gy * GYRO_SCALE, raw.gz * GYRO_SCALE};
+}
+
+bool IMU::readSample(RawSample& sample) {
     if (!initialized) return false;
     
-    // Rate limiting: only check every 50ms
-    static unsigned long last_check = 0;
-    unsigned long now = millis();
-    if (now - last_check < 50) return false;
-    last_check = now;
+    // Accel and gyro registers are contiguous (0x35-0x40): one 12-byte read
+    uint8_t raw[12];
+    if (!device.readBlock(QMI8658::AxL::address, raw, sizeof(raw))) return false;
     
-    AccelData accel;
-    GyroData gyro;
+    int16_t* out = &sample.ax;
+    for (size_t i = 0; i < 6; i++) {
+        out[i] = (int16_t)(raw[2 * i + 1] << 8 | raw[2 * i]);
+    }
+    return true;
+}
+
+bool IMU::readTimedSample(TimedSample& sample) {
+    if (!initialized) return false;
     
-    if (!readAccel(accel) || !readGyro(gyro)) return false;
+    // STATUSINT, STATUS0/1, TIMESTAMP, TEMP and accel/gyro are contiguous (0x2D-0x40).
+    // Reading the status registers in the same burst releases the syncSmpl lock.
+    uint8_t raw[QMI8658::GxL::address + 6 - QMI8658::StatusInt::address];
+    if (!device.readBlock(QMI8658::StatusInt::address, raw, sizeof(raw))) return false;
     
-    // Simple state machine: remember rotation, wait for target position
-    static enum { IDLE, TRIGGERED } state = IDLE;
-    static unsigned long last_rotation_time = 0;
-    static unsigned long state_time = 0;
+    const uint8_t* ts = &raw[QMI8658::TimestampL::address - QMI8658::StatusInt::address];
+    sample.sensor_ticks = (uint32_t)ts[2] << 16 | (uint32_t)ts[1] << 8 | ts[0];
     
-    // Target position: WATCH_UP (X > 0.2, Z < -0.2)
-    bool watch_up = (accel.x > 0.20f && accel.z < -0.20f);
-    bool strong_rotation = (abs(gyro.x) > 40.0f || abs(gyro.y) > 40.0f || abs(gyro.z) > 40.0f);
+    const uint8_t* data = &raw[QMI8658::AxL::address - QMI8658::StatusInt::address];
+    int16_t* out = &sample.raw.ax;
+    for (size_t i = 0; i < 6; i++) {
+        out[i] = (int16_t)(data[2 * i + 1] << 8 | data[2 * i]);
+    }
     
-    // Remember when we last saw rotation
-    if (strong_rotation) {
-        last_rotation_time = now;
+    sample.host_us = interrupt_time_us;
+    return true;
+}
+
+bool IMU::enableDataReady() {
+    using namespace QMI8658;
+    if (!initialized || fifo_enabled) return false;
+    if (pedometer_enabled) {
+        if (logger != nullptr) logger->failure("IMU", "Data ready (syncSmpl) would stop the on-chip pedometer");
+        return false;
     }
     
-    switch (state) {
-        case IDLE:
-            // If we see watch_up position AND had rotation in last 1.5 seconds = gesture!
-            if (watch_up && (now - last_rotation_time < 1500)) {
-                state = TRIGGERED;
-                state_time = now;
-                if (logger != nullptr) logger->info("IMU_TILT", "✓ Wrist raise gesture!");
-                return true;
-            }
-            break;
-            
-        case TRIGGERED:
-            // Cooldown: wait 1s, then back to IDLE when NOT in watch_up position
-            if (now - state_time > 1000 && !watch_up) {
-                state = IDLE;
-            }
-            break;
+    auto burst = device.burst();
+    burst.writeField<Ctrl1_Int2Enable>(1)
+         .writeField<Ctrl7_SyncSmpl>(1)
+         .writeField<Ctrl7_DrdyDisable>(0);
+    if (!burst.flush()) {
+        if (logger != nullptr) logger->failure("IMU", "Failed to enable data ready interrupt");
+        return false;
     }
+    motion_detected = false;
+    return true;
+}
+
+bool IMU::sendCommand(uint8_t cmd) {
+    using namespace QMI8658;
     
-    return false;
+    // CTRL9 handshake: issue command, wait for CmdDone, acknowledge
+    if (!device.write<Ctrl9>(cmd)) return false;
+    
+    uint8_t status = 0;
+    unsigned long start = millis();
+    do {
+        if (!device.read<StatusInt>(status)) return false;
+        if (StatusInt_CmdDone::decode(status)) break;
+        if (millis() - start > 10) return false;
+    } while (true);
+    
+    return device.write<Ctrl9>(CTRL_CMD_ACK);
 }
 
-bool IMU::checkWristTiltDown() {
+bool IMU::enableFifo(uint8_t watermark) {
+    using namespace QMI8658;
     if (!initialized) return false;
+    if (watermark == 0 || watermark > FIFO_CAPACITY) watermark = FIFO_CAPACITY / 4;
+    
+    // Route the FIFO watermark interrupt to INT2 (the only IMU line wired to the ESP32)
+    // and drop syncSmpl, which would otherwise own INT2 as data ready.
+    device.declareVolatile<FifoCtrl_RdMode>();
+    auto burst = device.burst();
+    fifo_watermark = watermark;
+    burst.writeField<Ctrl1_Int2Enable>(1)
+         .writeField<Ctrl1_FifoIntSel>(0)
+         .writeField<Ctrl7_SyncSmpl>(0)
+         .write<FifoWtmTh>(effectiveWatermark())
+         .write<FifoCtrl>(FifoCtrl_Size::encode(FIFO_SIZE_64) | FifoCtrl_Mode::encode(FIFO_MODE_STREAM));
+    if (!burst.flush() || !sendCommand(CTRL_CMD_RST_FIFO)) {
+        if (logger != nullptr) logger->failure("IMU", "Failed to enable FIFO");
+        return false;
+    }
     
-    // Rate limiting: only check every 50ms
-    static unsigned long last_check = 0;
-    unsigned long now = millis();
-    if (now - last_check < 50) return false;
-    last_check = now;
-    
-    AccelData accel;
-    GyroData gyro;
+    fifo_enabled = true;
+    fifo_count = 0;
+    resetFifoStats();
+    last_fifo_drain = millis();
+    motion_detected = false;
     
-    if (!readAccel(accel) || !readGyro(gyro)) return false;
+    if (logger != nullptr) logger->info("IMU", (String("FIFO enabled, watermark ") + String(watermark) + " samples").c_str());
+    return true;
+}
+
+bool IMU::disableFifo() {
+    using namespace QMI8658;
+    if (!initialized) return false;
     
-    // Simple state machine: remember rotation, wait for target position
-    static enum { IDLE, TRIGGERED } state = IDLE;
-    static unsigned long last_rotation_time = 0;
-    static unsigned long state_time = 0;
+    auto burst = device.burst();
+    burst.write<FifoCtrl>(FifoCtrl_Mode::encode(FIFO_MODE_BYPASS))
+         .writeField<Ctrl7_SyncSmpl>(1);
+    if (!burst.flush()) return false;
     
-    // Target positions
-    bool watch_up = (accel.x > 0.20f && accel.z < -0.20f);
-    bool arm_down_standing = (accel.y < -0.35f);
-    bool arm_down_sitting = (accel.y > 0.10f && accel.z < -0.40f);
-    bool arm_down = arm_down_standing || arm_down_sitting;
-    bool strong_rotation = (abs(gyro.x) > 40.0f || abs(gyro.y) > 40.0f || abs(gyro.z) > 40.0f);
+    fifo_enabled = false;
+    fifo_count = 0;
+    return true;
+}
+
+size_t IMU::serviceFifo() {
+    if (!fifo_enabled) return 0;
     
-    // Remember when we last saw rotation
-    if (strong_rotation) {
-        last_rotation_time = now;
-    }
+    // Drain on the watermark interrupt; fall back to a timed drain if an edge was missed
+    unsigned long now = millis();
+    if (!motion_detected && (long)(now - nextFifoDrainMs()) < 0) return 0;
+    motion_detected = false;
+    last_fifo_drain = now;
     
-    switch (state) {
-        case IDLE:
-            // If we see arm_down position AND had rotation in last 1.5 seconds = gesture!
-            if (arm_down && (now - last_rotation_time < 1500)) {
-                state = TRIGGERED;
-                state_time = now;
-                if (logger != nullptr) logger->info("IMU_TILT", "✓ Wrist lowered - sleep!");
-                return true;
-            }
-            break;
+    return drainFifo();
+}
+
+unsigned long IMU::nextFifoDrainMs() const {
+    unsigned long batch_ms = (unsigned long)effectiveWatermark() * 1000 / getSampleRateHz();
+    return last_fifo_drain + batch_ms * 2;
+}
+
+size_t IMU::drainFifo() {
+    using namespace QMI8658;
+    
+    uint64_t bus_start = I2CBusStats::getBusTimeUs();
+    uint32_t transactions_start = device.getTransactionCount();
+    
+    // FIFO_SMPL_CNT and FIFO_STATUS are adjacent: one read for count + flags
+    uint8_t count_status[2];
+    if (!device.readBlock(FifoSmplCnt::address, count_status, sizeof(count_status))) return 0;
+    
+    // Count is in 2-byte words
+    size_t bytes = ((size_t)FifoStatus_CountMsb::decode(count_status[1]) << 8 | count_status[0]) * 2;
+    // Frames hold accel + gyro, or accel only while the gyro is off
+    size_t frame_bytes = hasGyro() ? FIFO_FRAME_BYTES : FIFO_FRAME_BYTES / 2;
+    size_t values = frame_bytes / 2;
+    size_t frames = bytes / frame_bytes;
+    if (frames > HISTORY_CAPACITY) frames = HISTORY_CAPACITY;
+    // The overflow flag is sticky in stream mode: count it once, reset the FIFO below
+    bool overflow = FifoStatus_Overflow::decode(count_status[1]);
+    if (overflow) fifo_stats.overflows++;
+    
+    fifo_count = 0;
+    if (frames > 0 && sendCommand(CTRL_CMD_REQ_FIFO)) {
+        uint8_t raw[FIFO_READ_CHUNK * FIFO_FRAME_BYTES];
+        size_t max_chunk = sizeof(raw) / frame_bytes;
+        while (fifo_count < frames) {
+            size_t chunk = frames - fifo_count;
+            if (chunk > max_chunk) chunk = max_chunk;
+            if (!device.readBlock(FifoData::address, raw, chunk * frame_bytes)) break;
             
-        case TRIGGERED:
-            // Cooldown: wait 1s, then back to IDLE when NOT in arm_down position
-            if (now - state_time > 1000 && !arm_down) {
-                state = IDLE;
+            for (size_t f = 0; f < chunk; f++) {
+                RawSample& sample = fifo_batch[fifo_count + f];
+                sample = {};
+                int16_t* out = &sample.ax;
+                const uint8_t* in = &raw[f * frame_bytes];
+                for (size_t i = 0; i < values; i++) {
+                    out[i] = (int16_t)(in[2 * i + 1] << 8 | in[2 * i]);
+                }
             }
-            break;
+            fifo_count += chunk;
+        }
+        
+        // Leave FIFO read mode (RdMode is written back as 0)
+        device.modify<FifoCtrl>(0x00, 0x00);
     }
+    if (overflow) sendCommand(CTRL_CMD_RST_FIFO);
+    
+    fifo_stats.drains++;
+    fifo_stats.samples += fifo_count;
+    fifo_stats.transactions += device.getTransactionCount() - transactions_start;
+    fifo_stats.bus_time_us += I2CBusStats::getBusTimeUs() - bus_start;
     
-    return false;
+    return fifo_count;
 }
 
-bool IMU::checkDataReadyStatus() {
+bool IMU::configurePedometer(uint16_t rate_hz) {
+    using namespace QMI8658;
+    
+    // Sample windows scaled from the vendor defaults (given for 200Hz) to the ODR
+    uint16_t ped_sample_cnt = (uint16_t)((50UL * rate_hz + 100) / 200);
+    uint16_t ped_fix_peak2peak = 0x00AC;
+    uint16_t ped_fix_peak = 0x00AC;
+    uint16_t ped_time_up = (uint16_t)((200UL * rate_hz + 100) / 200);
+    uint8_t ped_time_low = (uint8_t)((20UL * rate_hz + 100) / 200);
+    uint8_t ped_time_cnt_entry = 8;
+    uint8_t ped_fix_precision = 0;
+    uint8_t ped_sig_count = 4;
+    
+    // Page 1: CAL1..CAL4 in one burst, then the configure command
+    auto page1 = device.burst();
+    page1.write<Cal1L>(ped_sample_cnt & 0xFF).write<Cal1H>(ped_sample_cnt >> 8)
+         .write<Cal2L>(ped_fix_peak2peak & 0xFF).write<Cal2H>(ped_fix_peak2peak >> 8)
+         .write<Cal3L>(ped_fix_peak & 0xFF).write<Cal3H>(ped_fix_peak >> 8)
+         .write<Cal4L>(0x02).write<Cal4H>(0x01);
+    if (!page1.flush() || !sendCommand(CTRL_CMD_CONFIGURE_PEDOMETER)) return false;
+    
+    // Page 2
+    auto page2 = device.burst();
+    page2.write<Cal1L>(ped_time_up & 0xFF).write<Cal1H>(ped_time_up >> 8)
+         .write<Cal2L>(ped_time_low).write<Cal2H>(ped_time_cnt_entry)
+         .write<Cal3L>(ped_fix_precision).write<Cal3H>(ped_sig_count)
+         .write<Cal4L>(0x00).write<Cal4H>(0x02);
+    return page2.flush() && sendCommand(CTRL_CMD_CONFIGURE_PEDOMETER);
+}
+
+bool IMU::enablePedometer() {
+    using namespace QMI8658;
     if (!initialized) return false;
     
-    uint8_t status0 = 0;
-    if (!readRegister(REG_STATUS0, &status0)) return false;
+    // The step engine does not run while syncSmpl holds the output registers
+    uint8_t ctrl7 = 0;
+    if (!device.cached<Ctrl7>(ctrl7)) return false;
+    if (Ctrl7_SyncSmpl::decode(ctrl7)) {
+        if (logger != nullptr) logger->warn("IMU", "On-chip pedometer needs the free-running output (not in data ready mode)");
+        return false;
+    }
     
-    // Reading STATUS0 clears INT2 in syncSmpl mode
-    // Bit 0: Accel data ready, Bit 1: Gyro data ready
-    return (status0 & 0x03) == 0x03;  // Both accel and gyro ready
+    if (!configurePedometer(getSampleRateHz())) return false;
+    if (!device.writeField<Ctrl8_PedoEnable>(1)) return false;
+    pedometer_enabled = true;
+    
+    if (logger != nullptr) logger->info("IMU", "On-chip pedometer enabled");
+    return true;
 }
 
-bool IMU::checkMotion() {
+bool IMU::disablePedometer() {
+    if (!initialized) return false;
+    if (!device.writeField<QMI8658::Ctrl8_PedoEnable>(0)) return false;
+    pedometer_enabled = false;
+    return true;
+}
+
+bool IMU::readStepCount(uint32_t& steps) {
     if (!initialized) return false;
     
-    // Rate limiting: only check every 100ms
-    static unsigned long last_check = 0;
-    unsigned long now = millis();
-    if (now - last_check < 100) return false;
-    last_check = now;
-    
-    AccelData accel;
-    if (!readAccel(accel)) return false;
-    
-    // Calculate magnitude of acceleration vector
-    float magnitude = sqrt(accel.x * accel.x + accel.y * accel.y + accel.z * accel.z);
+    // STEP_CNT_LOW/MID/HIGH in one read
+    uint8_t raw[3];
+    if (!device.readBlock(QMI8658::StepCntLow::address, raw, sizeof(raw))) return false;
+    steps = (uint32_t)raw[2] << 16 | (uint32_t)raw[1] << 8 | raw[0];
+    return true;
+}
+
+bool IMU::resetStepCount() {
+    if (!initialized) return false;
+    return sendCommand(QMI8658::CTRL_CMD_RESET_PEDOMETER);
+}
+
+bool IMU::enterMotionWake(MotionInterruptMode mode) {
+    using namespace QMI8658;
+    if (!initialized) return false;
+    if (motion_wake) return true;
     
-    // Initialize on first run
-    if (last_accel_magnitude == 0.0f) {
-        last_accel_magnitude = magnitude;
+    // Remember the sampling configuration so exitMotionWake() can restore it
+    if (!device.cached<Ctrl1>(saved_ctrl[0]) || !device.cached<Ctrl2>(saved_ctrl[1]) ||
+        !device.cached<Ctrl7>(saved_ctrl[2])) {
         return false;
     }
+    resume_fifo = fifo_enabled;
+    if (fifo_enabled && !disableFifo()) return false;
+    
+    // Sensors off while the motion engine is reconfigured
+    if (!device.write<Ctrl7>(0x00)) return false;
+    
+    // Page 1: thresholds and axis logic
+    auto page1 = device.burst();
+    page1.write<Cal1L>(ANY_MOTION_THRESHOLD).write<Cal1H>(ANY_MOTION_THRESHOLD)
+         .write<Cal2L>(ANY_MOTION_THRESHOLD).write<Cal2H>(NO_MOTION_THRESHOLD)
+         .write<Cal3L>(NO_MOTION_THRESHOLD).write<Cal3H>(NO_MOTION_THRESHOLD)
+         .write<Cal4L>(MOTION_MODE_CTRL).write<Cal4H>(0x01);
+    if (!page1.flush() || !sendCommand(CTRL_CMD_CONFIGURE_MOTION)) return false;
+    
+    // Page 2: detection windows
+    auto page2 = device.burst();
+    page2.write<Cal1L>(ANY_MOTION_WINDOW).write<Cal1H>(NO_MOTION_WINDOW)
+         .write<Cal2L>(SIG_MOTION_WAIT_WINDOW & 0xFF).write<Cal2H>(SIG_MOTION_WAIT_WINDOW >> 8)
+         .write<Cal3L>(SIG_MOTION_CONFIRM_WINDOW & 0xFF).write<Cal3H>(SIG_MOTION_CONFIRM_WINDOW >> 8)
+         .write<Cal4L>(0x00).write<Cal4H>(0x02);
+    if (!page2.flush() || !sendCommand(CTRL_CMD_CONFIGURE_MOTION)) return false;
+    
+    // Significant motion is built on top of the any-motion detector. The FIFO
+    // streams the accel frames as wake history, its interrupt kept off INT2
+    // unless the host asked to be woken before it fills up.
+    bool any = (mode == MOTION_ANY || mode == MOTION_SIGNIFICANT);
+    auto burst = device.burst();
+    burst.writeField<Ctrl1_Int2Enable>(1)
+         .writeField<Ctrl1_FifoIntSel>(history_interrupt ? 0 : 1)
+         .writeField<Ctrl2_AccelODR>(ACCEL_ODR_LP_21HZ)
+         .write<FifoWtmTh>(HISTORY_WAKE_WATERMARK)
+         .write<FifoCtrl>(FifoCtrl_Size::encode(FIFO_SIZE_128) | FifoCtrl_Mode::encode(FIFO_MODE_STREAM))
+         .writeField<Ctrl8_ActivityIntSel>(0)
+         .writeField<Ctrl8_AnyMotionEnable>(any ? 1 : 0)
+         .writeField<Ctrl8_NoMotionEnable>(mode == MOTION_NO ? 1 : 0)
+         .writeField<Ctrl8_SigMotionEnable>(mode == MOTION_SIGNIFICANT ? 1 : 0);
+    if (!burst.flush() || !sendCommand(CTRL_CMD_RST_FIFO)) return false;
+    
+    // Accelerometer only, no data ready on INT2
+    if (!device.write<Ctrl7>(Ctrl7_DrdyDisable::encode(1) | Ctrl7_AccelEnable::encode(1))) return false;
+    
+    // Start from a low INT2 line
+    uint8_t status1 = 0;
+    readMotionStatus(status1);
+    
+    motion_wake = true;
+    if (logger != nullptr) logger->info("IMU", (String("Wake-on-motion enabled (mode ") + String(mode) + ")").c_str());
+    return true;
+}
+
+size_t IMU::drainWakeHistory() {
+    if (!initialized || !motion_wake) return 0;
+    
+    // Accel-only frames at the low-power ODR, oldest first
+    return drainFifo();
+}
+
+bool IMU::isHistoryWake() {
+    using namespace QMI8658;
+    if (!motion_wake || !history_interrupt) return false;
+    
+    uint8_t status1 = 0;
+    if (!readMotionStatus(status1)) return false;
+    return !Status1_AnyMotion::decode(status1) && !Status1_NoMotion::decode(status1) &&
+           !Status1_SigMotion::decode(status1);
+}
+
+bool IMU::exitMotionWake() {
+    using namespace QMI8658;
+    if (!initialized || !motion_wake) return false;
+    
+    auto burst = device.burst();
+    burst.write<Ctrl1>(saved_ctrl[0])
+         .write<Ctrl2>(saved_ctrl[1])
+         .write<Ctrl7>(saved_ctrl[2])
+         .write<FifoCtrl>(FifoCtrl_Mode::encode(FIFO_MODE_BYPASS))
+         .writeField<Ctrl8_AnyMotionEnable>(0)
+         .writeField<Ctrl8_NoMotionEnable>(0)
+         .writeField<Ctrl8_SigMotionEnable>(0);
+    if (!burst.flush()) return false;
+    
+    motion_wake = false;
+    if (resume_fifo) return enableFifo(fifo_watermark);
+    return true;
+}
+
+bool IMU::readMotionStatus(uint8_t& status1) {
+    if (!initialized) return false;
+    return device.read<QMI8658::Status1>(status1);
+}
+
+bool IMU::setLowRate(bool low) {
+    using namespace QMI8658;
+    if (!initialized || motion_wake) return false;
+    if (low == low_rate) return true;
     
-    // Check if change in magnitude exceeds threshold
-    float delta = abs(magnitude - last_accel_magnitude);
-    last_accel_magnitude = magnitude;
+    auto burst = device.burst();
+    burst.writeField<Ctrl2_AccelODR>(low ? ACCEL_ODR_LP_21HZ : ACCEL_ODR_128HZ)
+         .writeField<Ctrl7_GyroEnable>(low ? 0 : 1);
+    if (!burst.flush()) return false;
     
-    // Motion detected
-    if (delta > motion_threshold) {
-        // Debounce: only report motion once per 2 seconds
-        if (now - last_motion_time > 2000) {
-            last_motion_time = now;
-            return true;
-        }
+    // Close the expected-sample count at the old rate
+    unsigned long now = millis();
+    fifo_expected += (float)(now - fifo_expected_ms) * 1000.0f / getSamplePeriodUs();
+    fifo_expected_ms = now;
+    low_rate = low;
+    
+    // Frame layout changed: start the FIFO over with a watermark for the new rate
+    if (fifo_enabled) {
+        if (!device.write<FifoWtmTh>(effectiveWatermark()) || !sendCommand(CTRL_CMD_RST_FIFO)) return false;
+        fifo_count = 0;
+        last_fifo_drain = now;
     }
+    return true;
+}
+
+bool IMU::suspend() {
+    if (!initialized || motion_wake) return false;
+    if (suspended) return true;
+    
+    resume_low_rate = low_rate;
+    if (!setLowRate(true)) return false;
+    suspended = true;
+    return true;
+}
+
+bool IMU::resume() {
+    if (!suspended) return true;
+    suspended = false;
+    return setLowRate(resume_low_rate);
+}
+
+bool IMU::setFifoLowLatency(bool on) {
+    if (on == fifo_low_latency) return true;
+    fifo_low_latency = on;
+    if (!fifo_enabled) return true;
+    return device.write<QMI8658::FifoWtmTh>(effectiveWatermark());
+}
+
+uint8_t IMU::effectiveWatermark() const {
+    if (fifo_low_latency) return 1;
+    
+    // Same batch duration at any rate
+    uint32_t watermark = (uint32_t)fifo_watermark * getSampleRateHz() / SAMPLE_RATE_HZ;
+    return watermark > 0 ? (uint8_t)watermark : 1;
+}
+
+void IMU::resetFifoStats() {
+    fifo_stats = {};
+    fifo_stats.enabled_ms = millis();
+    fifo_expected = 0.0f;
+    fifo_expected_ms = fifo_stats.enabled_ms;
+}
+
+float IMU::getFifoLossRate() const {
+    unsigned long elapsed = millis() - fifo_expected_ms;
+    float expected = fifo_expected + (float)elapsed * 1000.0f / getSamplePeriodUs();
+    if (expected < 1.0f) return 0.0f;
+    float loss = 1.0f - (float)fifo_stats.samples / expected;
+    return loss < 0.0f ? 0.0f : loss;
+}
+
+bool IMU::checkDataReadyStatus() {
+    if (!initialized) return false;
+    
+    uint8_t status0 = 0;
+    if (!device.read<QMI8658::Status0>(status0)) return false;
     
-    return false;
+    // Reading STATUS0 clears INT2 in syncSmpl mode
+    // Both accel and gyro ready
+    return QMI8658::Status0_AccelReady::decode(status0) && QMI8658::Status0_GyroReady::decode(status0);
 }
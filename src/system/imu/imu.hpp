@@ -4,100 +4,184 @@
 
 #include "config.h"
 #include "../../logger/logger.hpp"
+#include "../bus/i2c_device.hpp"
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+// QMI8658 register map
+namespace QMI8658 {
+    using WhoAmI = Register<0x00, RegAccess::RO>;
+    using RevisionId = Register<0x01, RegAccess::RO>;
+    using Ctrl1 = Register<0x02>;
+    using Ctrl2 = Register<0x03>;
+    using Ctrl3 = Register<0x04>;
+    using Ctrl4 = Register<0x05>;
+    using Ctrl5 = Register<0x06>;
+    using Ctrl6 = Register<0x07>;
+    using Ctrl7 = Register<0x08>;
+    using Ctrl8 = Register<0x09>;
+    using Ctrl9 = Register<0x0A, RegAccess::WO>;    // Host command register
+    using Cal1L = Register<0x0B>;
+    using Cal1H = Register<0x0C>;
+    using Cal2L = Register<0x0D>;
+    using Cal2H = Register<0x0E>;
+    using Cal3L = Register<0x0F>;
+    using Cal3H = Register<0x10>;
+    using Cal4L = Register<0x11>;
+    using Cal4H = Register<0x12>;
+    using FifoWtmTh = Register<0x13>;
+    using FifoCtrl = Register<0x14>;
+    using FifoSmplCnt = Register<0x15, RegAccess::RO>;
+    using FifoStatus = Register<0x16, RegAccess::RO>;
+    using FifoData = Register<0x17, RegAccess::RO>;
+    using I2cmStatus = Register<0x2C, RegAccess::RO>;
+    using StatusInt = Register<0x2D, RegAccess::RO>;
+    using Status0 = Register<0x2E, RegAccess::RO>;
+    using Status1 = Register<0x2F, RegAccess::RO>;
+    using TimestampL = Register<0x30, RegAccess::RO>;
+    using TempL = Register<0x33, RegAccess::RO>;
+    using AxL = Register<0x35, RegAccess::RO>;
+    using GxL = Register<0x3B, RegAccess::RO>;
+    using dQwL = Register<0x49, RegAccess::RO>;
+    using dVxL = Register<0x51, RegAccess::RO>;
+    using StepCntLow = Register<0x5A, RegAccess::RO>;   // Step counter low byte
+    using StepCntMid = Register<0x5B, RegAccess::RO>;   // Step counter mid byte
+    using StepCntHigh = Register<0x5C, RegAccess::RO>;  // Step counter high byte
+    using Reset = Register<0x60, RegAccess::WO>;
+    
+    // CTRL1
+    using Ctrl1_AddrAI = Field<Ctrl1, 6, 1>;            // Address auto increment
+    using Ctrl1_Int2Enable = Field<Ctrl1, 4, 1>;
+    using Ctrl1_Int1Enable = Field<Ctrl1, 3, 1>;
+    using Ctrl1_FifoIntSel = Field<Ctrl1, 2, 1>;        // FIFO interrupt on INT1 (1) or INT2 (0)
+    
+    // CTRL2 / CTRL3
+    using Ctrl2_AccelRange = Field<Ctrl2, 4, 3>;
+    using Ctrl2_AccelODR = Field<Ctrl2, 0, 4>;
+    using Ctrl3_GyroRange = Field<Ctrl3, 4, 3>;
+    using Ctrl3_GyroODR = Field<Ctrl3, 0, 4>;
+    
+    // CTRL7
+    using Ctrl7_SyncSmpl = Field<Ctrl7, 7, 1>;
+    using Ctrl7_DrdyDisable = Field<Ctrl7, 5, 1>;       // 0 = data ready on INT2
+    using Ctrl7_GyroEnable = Field<Ctrl7, 1, 1>;
+    using Ctrl7_AccelEnable = Field<Ctrl7, 0, 1>;
+    
+    // CTRL8
+    using Ctrl8_HandshakeType = Field<Ctrl8, 7, 1>;     // 1 = CTRL9 handshake via STATUSINT.bit7
+    using Ctrl8_ActivityIntSel = Field<Ctrl8, 6, 1>;    // Motion/pedometer events on INT1 (1) or INT2 (0)
+    using Ctrl8_PedoEnable = Field<Ctrl8, 4, 1>;
+    using Ctrl8_SigMotionEnable = Field<Ctrl8, 3, 1>;
+    using Ctrl8_NoMotionEnable = Field<Ctrl8, 2, 1>;
+    using Ctrl8_AnyMotionEnable = Field<Ctrl8, 1, 1>;
+    
+    // STATUS0
+    using Status0_AccelReady = Field<Status0, 0, 1>;
+    using Status0_GyroReady = Field<Status0, 1, 1>;
+    
+    // STATUS1 (motion flags clear on read)
+    using Status1_SigMotion = Field<Status1, 7, 1>;
+    using Status1_NoMotion = Field<Status1, 6, 1>;
+    using Status1_AnyMotion = Field<Status1, 5, 1>;
+    
+    // STATUSINT
+    using StatusInt_CmdDone = Field<StatusInt, 7, 1>;   // CTRL9 command completed
+    
+    // FIFO_CTRL
+    using FifoCtrl_RdMode = Field<FifoCtrl, 7, 1, RegAccess::RO>;  // Set by CTRL_CMD_REQ_FIFO
+    using FifoCtrl_Size = Field<FifoCtrl, 2, 2>;        // 16/32/64/128 samples
+    using FifoCtrl_Mode = Field<FifoCtrl, 0, 2>;        // Bypass/FIFO/Stream
+    
+    // FIFO_STATUS
+    using FifoStatus_Full = Field<FifoStatus, 7, 1>;
+    using FifoStatus_Wtm = Field<FifoStatus, 6, 1>;
+    using FifoStatus_Overflow = Field<FifoStatus, 5, 1>;
+    using FifoStatus_NotEmpty = Field<FifoStatus, 4, 1>;
+    using FifoStatus_CountMsb = Field<FifoStatus, 0, 2>;
+    
+    // CTRL9 host commands
+    enum Command : uint8_t {
+        CTRL_CMD_ACK = 0x00,
+        CTRL_CMD_RST_FIFO = 0x04,
+        CTRL_CMD_REQ_FIFO = 0x05,
+        CTRL_CMD_CONFIGURE_PEDOMETER = 0x0D,
+        CTRL_CMD_CONFIGURE_MOTION = 0x0E,
+        CTRL_CMD_RESET_PEDOMETER = 0x0F,
+    };
+    
+    // CTRL2 accelerometer ODR codes
+    enum AccelOdr : uint8_t {
+        ACCEL_ODR_128HZ = 0x06,     // 112.1Hz with the gyro on (gyro clock)
+        ACCEL_ODR_LP_21HZ = 0x0D,   // Low-power mode, gyro must be off
+    };
+    
+    enum FifoMode : uint8_t {
+        FIFO_MODE_BYPASS = 0,
+        FIFO_MODE_FIFO = 1,
+        FIFO_MODE_STREAM = 2,
+    };
+    
+    enum FifoSize : uint8_t {
+        FIFO_SIZE_16 = 0,
+        FIFO_SIZE_32 = 1,
+        FIFO_SIZE_64 = 2,
+        FIFO_SIZE_128 = 3,
+    };
+}
 
 class IMU {
-private:
+public:
     static constexpr uint8_t ADDR_QMI8658 = 0x6B;
+
+private:
     static constexpr uint8_t CHIP_ID = 0x05;
     
-    TwoWire* i2c = nullptr;
     Logger* logger = nullptr;
     bool initialized = false;
     uint8_t interrupt_pin = 21;
     static volatile bool motion_detected;
+    static volatile int64_t interrupt_time_us;   // esp_timer time of the last INT2 edge
+    static TaskHandle_t interrupt_task;          // Notified from the ISR when set
     static void IRAM_ATTR motionISR();
     
-    // Software motion detection
-    float last_accel_magnitude = 0.0f;
-    float motion_threshold = 0.15f;  // g threshold for motion (walking ~0.2g, running ~0.5g)
-    unsigned long last_motion_time = 0;
-    
-    // QMI8658 Register addresses
-    enum Registers : uint8_t {
-        REG_WHO_AM_I = 0x00,
-        REG_REVISION_ID = 0x01,
-        REG_CTRL1 = 0x02,
-        REG_CTRL2 = 0x03,
-        REG_CTRL3 = 0x04,
-        REG_CTRL4 = 0x05,
-        REG_CTRL5 = 0x06,
-        REG_CTRL6 = 0x07,
-        REG_CTRL7 = 0x08,
-        REG_CTRL8 = 0x09,
-        REG_CTRL9 = 0x0A,
-        REG_CAL1_L = 0x0B,
-        REG_CAL1_H = 0x0C,
-        REG_CAL2_L = 0x0D,
-        REG_CAL2_H = 0x0E,
-        REG_CAL3_L = 0x0F,
-        REG_CAL3_H = 0x10,
-        REG_CAL4_L = 0x11,
-        REG_CAL4_H = 0x12,
-        REG_FIFO_WTM_TH = 0x13,
-        REG_FIFO_CTRL = 0x14,
-        REG_FIFO_SMPL_CNT = 0x15,
-        REG_FIFO_STATUS = 0x16,
-        REG_FIFO_DATA = 0x17,
-        REG_I2CM_STATUS = 0x2C,
-        REG_STATUSINT = 0x2D,
-        REG_STATUS0 = 0x2E,
-        REG_STATUS1 = 0x2F,
-        REG_TIMESTAMP_L = 0x30,
-        REG_TEMP_L = 0x33,
-        REG_TEMP_H = 0x34,
-        REG_AX_L = 0x35,
-        REG_AX_H = 0x36,
-        REG_AY_L = 0x37,
-        REG_AY_H = 0x38,
-        REG_AZ_L = 0x39,
-        REG_AZ_H = 0x3A,
-        REG_GX_L = 0x3B,
-        REG_GX_H = 0x3C,
-        REG_GY_L = 0x3D,
-        REG_GY_H = 0x3E,
-        REG_GZ_L = 0x3F,
-        REG_GZ_H = 0x40,
-        REG_dQW_L = 0x49,
-        REG_dQW_H = 0x4A,
-        REG_dQX_L = 0x4B,
-        REG_dQX_H = 0x4C,
-        REG_dQY_L = 0x4D,
-        REG_dQY_H = 0x4E,
-        REG_dQZ_L = 0x4F,
-        REG_dQZ_H = 0x50,
-        REG_dVX_L = 0x51,
-        REG_dVX_H = 0x52,
-        REG_dVY_L = 0x53,
-        REG_dVY_H = 0x54,
-        REG_dVZ_L = 0x55,
-        REG_dVZ_H = 0x56,
-        REG_RESET = 0x60,
-        REG_STEP_CNT_LOW = 0x07,   // Step counter low byte
-        REG_STEP_CNT_MID = 0x08,   // Step counter mid byte  
-        REG_STEP_CNT_HIGH = 0x09,  // Step counter high byte
-    };
+    // Register access; CTRL1..FIFO_CTRL are shadow-cached
+    I2CRegisterDevice<ADDR_QMI8658, QMI8658::Ctrl1::address, QMI8658::FifoCtrl::address> device;
+    
+    // FIFO acquisition (accel + gyro frames, 12 bytes each)
+    static constexpr size_t FIFO_CAPACITY = 64;
+    static constexpr size_t HISTORY_CAPACITY = 128;        // Motion wake: accel-only frames, ~6s at 21Hz
+    static constexpr uint8_t HISTORY_WAKE_WATERMARK = 112; // Wakes the host with ~0.7s to spare
+    static constexpr size_t FIFO_FRAME_BYTES = 12;  // 6 when the gyro is off
+    static constexpr size_t FIFO_READ_CHUNK = 10;  // full frames per read (Wire buffer is 128 bytes)
+    static constexpr uint16_t LOW_RATE_HZ = 21;
     
+    // Real output periods. With the gyro on, both sensors run at the gyro ODR,
+    // 7174.4Hz / 2^n, so code 6 is 112.1Hz. The low-power accel modes are nominal.
+    static constexpr uint32_t FULL_RATE_PERIOD_US = 8921;   // 2^6 / 7174.4Hz
+    static constexpr uint32_t LOW_RATE_PERIOD_US = 47619;   // 1 / 21Hz
+    
+    // Motion engine settings (thresholds: [7:5] g, [4:0] 1/32 g; windows in samples)
+    static constexpr uint8_t ANY_MOTION_THRESHOLD = 0x04;      // 0.125g
+    static constexpr uint8_t NO_MOTION_THRESHOLD = 0x02;       // 0.0625g
+    static constexpr uint8_t MOTION_MODE_CTRL = 0xF7;          // All axes (vendor default)
+    static constexpr uint8_t ANY_MOTION_WINDOW = 3;
+    static constexpr uint8_t NO_MOTION_WINDOW = 100;           // ~5s at 21Hz
+    static constexpr uint16_t SIG_MOTION_WAIT_WINDOW = 100;
+    static constexpr uint16_t SIG_MOTION_CONFIRM_WINDOW = 100;
+    
+    bool sendCommand(uint8_t cmd);
+    size_t drainFifo();
+    uint8_t effectiveWatermark() const;
+    bool configurePedometer(uint16_t rate_hz);
+
+public:
     enum MotionInterruptMode : uint8_t {
         MOTION_ANY = 0,         // Any motion
         MOTION_NO = 1,          // No motion
         MOTION_SIGNIFICANT = 2  // Significant motion
     };
     
-    bool writeRegister(uint8_t reg, uint8_t value);
-    bool readRegister(uint8_t reg, uint8_t* value);
-    bool readRegisters(uint8_t reg, uint8_t* buffer, size_t len);
-
-public:
     struct AccelData {
         float x;  // g
         float y;  // g
@@ -110,7 +194,35 @@ public:
         float z;  // dps
     };
     
-    IMU(Logger* logger) : logger(logger) {}
+    // Raw 16-bit sample as stored in the FIFO
+    struct RawSample {
+        int16_t ax, ay, az;
+        int16_t gx, gy, gz;
+    };
+    
+    // Data-ready sample with sensor and host time
+    struct TimedSample {
+        RawSample raw;
+        uint32_t sensor_ticks;  // TIMESTAMP register: 24-bit count, one tick per sample
+        int64_t host_us;        // esp_timer time of the data-ready edge
+    };
+    
+    struct FifoStats {
+        uint32_t drains;
+        uint32_t samples;
+        uint32_t overflows;     // Overflow episodes (the flag is cleared after each)
+        uint32_t transactions;
+        uint64_t bus_time_us;
+        unsigned long enabled_ms;
+    };
+    
+    static constexpr uint16_t SAMPLE_RATE_HZ = 128;  // Full rate
+    
+    // Sensor scales for the configured ranges (8g, 1024dps)
+    static constexpr float ACCEL_SCALE = 8.0f / 32768.0f;
+    static constexpr float GYRO_SCALE = 1024.0f / 32768.0f;
+    
+    IMU(Logger* logger) : logger(logger), device(logger, "IMU") {}
     
     bool setBus(TwoWire& bus);
     bool isInitialized() const { return initialized; }
@@ -118,15 +230,93 @@ public:
     bool readGyro(GyroData& data);
     bool readTemperature(float& temp);
     
+    bool readSample(RawSample& sample);  // Accel + gyro data registers in one read
+    static AccelData toAccel(const RawSample& raw);
+    static GyroData toGyro(const RawSample& raw);
+    
+    // FIFO batch acquisition: stream mode, watermark interrupt on INT2
+    bool enableFifo(uint8_t watermark);
+    bool disableFifo();
+    bool isFifoEnabled() const { return fifo_enabled; }
+    size_t serviceFifo();  // Drains the FIFO when the watermark fired; returns samples read
+    bool setFifoLowLatency(bool on);  // One-sample watermark (e.g. while a wake gesture settles)
+    unsigned long nextFifoDrainMs() const;  // Timed drain if no watermark edge arrives first
+    const RawSample* getFifoBatch(size_t& count) const { count = fifo_count; return fifo_batch; }
+    const FifoStats& getFifoStats() const { return fifo_stats; }
+    void resetFifoStats();  // Starts a new statistics window (e.g. once boot is done)
+    float getFifoLossRate() const;  // Samples read against the real ODR over the window
+    
+    // Output rate: full (accel + gyro at SAMPLE_RATE_HZ) or low (accel only, low-power ODR).
+    // Motion wake samples accel only at the low rate as well.
+    bool setLowRate(bool low);
+    bool isLowRate() const { return low_rate; }
+    bool hasGyro() const { return !low_rate && !motion_wake; }
+    uint16_t getSampleRateHz() const { return hasGyro() ? SAMPLE_RATE_HZ : LOW_RATE_HZ; }
+    uint32_t getSamplePeriodUs() const { return hasGyro() ? FULL_RATE_PERIOD_US : LOW_RATE_PERIOD_US; }
+    
+    // Light sleep without wake-on-motion: low rate (accel only) until resume()
+    // restores the previous rate
+    bool suspend();
+    bool resume();
+    bool isSuspended() const { return suspended; }
+    
+    // On-chip pedometer (runs on the accelerometer, independent of the host).
+    // Needs the free-running output, so it is refused in syncSmpl (data ready)
+    // mode. Its windows are sample counts, set once for the ODR at enable: the
+    // datasheet does not say how the step engine takes a reconfiguration while
+    // it runs, so they are not rescaled. Counts are only within spec at that
+    // ODR; the rate governor's low tier and motion wake stretch every window
+    // in time (6x from full rate to 21Hz).
+    bool enablePedometer();
+    bool disablePedometer();
+    bool readStepCount(uint32_t& steps);
+    bool resetStepCount();
+    
+    // Wake-on-motion: accel only at a low-power ODR, motion engine interrupt on INT2.
+    // The FIFO keeps the last accel frames meanwhile (its interrupt goes to the
+    // unwired INT1); drainWakeHistory() reads them into the FIFO batch before
+    // exitMotionWake() restores the previous sampling configuration.
+    bool enterMotionWake(MotionInterruptMode mode);
+    size_t drainWakeHistory();
+    bool exitMotionWake();
+    // With the history interrupt, a nearly full history also raises INT2 so no
+    // sample is lost (software step counting); isHistoryWake() tells such a wake
+    // from a motion event. Reading the motion flags clears them.
+    void setWakeHistoryInterrupt(bool on) { history_interrupt = on; }
+    bool isHistoryWake();
+    bool isInMotionWake() const { return motion_wake; }
+    bool readMotionStatus(uint8_t& status1);  // Reading STATUS1 clears the motion flags
+    uint8_t getInterruptPin() const { return interrupt_pin; }
+    
     // Data ready interrupt
+    bool enableDataReady();                           // INT2 data ready (syncSmpl mode)
+    void setInterruptTask(TaskHandle_t task) { interrupt_task = task; }
+    bool readTimedSample(TimedSample& sample);        // STATUSINT..GZ_H in one read
     bool isDataReady() { return motion_detected; }
     void clearDataReadyFlag() { motion_detected = false; }
     bool checkDataReadyStatus();  // Poll STATUS0 register instead of interrupt
     
-    // Software motion detection
-    bool checkMotion();  // Returns true if significant motion detected
-    bool checkWristTilt();  // Returns true if wrist raise/tilt gesture detected
-    bool checkWristTiltDown();  // Returns true if arm lowered (watch down)
-    void setMotionThreshold(float threshold_g) { motion_threshold = threshold_g; }
-    float getMotionThreshold() const { return motion_threshold; }
+    // Bus diagnostics
+    uint32_t getTransactionCount() const { return device.getTransactionCount(); }
+    uint32_t getCacheMismatchCount() const { return device.getCacheMismatchCount(); }
+
+private:
+    bool fifo_enabled = false;
+    uint8_t fifo_watermark = 16;
+    bool fifo_low_latency = false;
+    unsigned long last_fifo_drain = 0;
+    RawSample fifo_batch[HISTORY_CAPACITY];
+    size_t fifo_count = 0;
+    FifoStats fifo_stats = {};
+    float fifo_expected = 0.0f;         // Samples expected before fifo_expected_ms (real ODR)
+    unsigned long fifo_expected_ms = 0;
+    
+    bool low_rate = false;
+    bool motion_wake = false;
+    bool suspended = false;
+    bool resume_low_rate = false;
+    bool resume_fifo = false;
+    bool pedometer_enabled = false;
+    bool history_interrupt = false;
+    uint8_t saved_ctrl[3] = {0};  // CTRL1, CTRL2, CTRL7 before entering motion wake
 };
@@ -0,0 +1,53 @@
+#include "imu_kernels.hpp"
+
+void ImuKernels::toFloat(const int16_t* __restrict in, float* __restrict out, size_t n, float scale) {
+    for (size_t i = 0; i < n; i++) {
+        out[i] = (float)in[i] * scale;
+    }
+}
+
+void ImuKernels::magnitudeSquared(const int16_t* __restrict x, const int16_t* __restrict y,
+                                  const int16_t* __restrict z, uint32_t* __restrict out, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        out[i] = (uint32_t)((int32_t)x[i] * x[i]) + (uint32_t)((int32_t)y[i] * y[i]) +
+                 (uint32_t)((int32_t)z[i] * z[i]);
+    }
+}
+
+uint64_t ImuKernels::sumMagnitudeSquared(const int16_t* __restrict x, const int16_t* __restrict y,
+                                         const int16_t* __restrict z, size_t n) {
+    uint64_t total = 0;
+    for (size_t i = 0; i < n; i++) {
+        total += (uint32_t)((int32_t)x[i] * x[i]) + (uint32_t)((int32_t)y[i] * y[i]) +
+                 (uint32_t)((int32_t)z[i] * z[i]);
+    }
+    return total;
+}
+
+int32_t ImuKernels::sum(const int16_t* __restrict v, size_t n) {
+    // n <= 65536 keeps this within int32
+    int32_t total = 0;
+    for (size_t i = 0; i < n; i++) {
+        total += v[i];
+    }
+    return total;
+}
+
+uint64_t ImuKernels::sumSquares(const int16_t* __restrict v, size_t n) {
+    uint64_t total = 0;
+    for (size_t i = 0; i < n; i++) {
+        total += (uint32_t)((int32_t)v[i] * v[i]);
+    }
+    return total;
+}
+
+void ImuKernels::minMax(const int16_t* __restrict v, size_t n, int16_t& min, int16_t& max) {
+    int16_t lo = INT16_MAX;
+    int16_t hi = INT16_MIN;
+    for (size_t i = 0; i < n; i++) {
+        lo = v[i] < lo ? v[i] : lo;
+        hi = v[i] > hi ? v[i] : hi;
+    }
+    min = lo;
+    max = hi;
+}
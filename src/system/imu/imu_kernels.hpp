@@ -0,0 +1,28 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Batch kernels over int16 sample columns (one axis per array).
+ *
+ * Each kernel is a single branch-free loop over restrict-qualified
+ * arrays with no per-element calls, so the compiler can unroll or
+ * vectorize it. It is also the place to drop in an ESP-DSP / PIE
+ * implementation later. No Arduino dependencies.
+ */
+namespace ImuKernels {
+    // out[i] = in[i] * scale
+    void toFloat(const int16_t* __restrict in, float* __restrict out, size_t n, float scale);
+
+    // out[i] = x[i]^2 + y[i]^2 + z[i]^2 (raw counts, exact)
+    void magnitudeSquared(const int16_t* __restrict x, const int16_t* __restrict y,
+                          const int16_t* __restrict z, uint32_t* __restrict out, size_t n);
+
+    // Sum of x^2 + y^2 + z^2 over n samples
+    uint64_t sumMagnitudeSquared(const int16_t* __restrict x, const int16_t* __restrict y,
+                                 const int16_t* __restrict z, size_t n);
+
+    int32_t sum(const int16_t* __restrict v, size_t n);
+    uint64_t sumSquares(const int16_t* __restrict v, size_t n);
+    void minMax(const int16_t* __restrict v, size_t n, int16_t& min, int16_t& max);
+}
@@ -0,0 +1,163 @@
+#include "imu_pipeline.hpp"
+#include "../loop/event_loop.hpp"
+
+bool ImuPipeline::addStage(ImuStage& stage) {
+    if (stage_count >= MAX_STAGES) return false;
+    stages[stage_count++] = &stage;
+    return true;
+}
+
+bool ImuPipeline::startDataReadyTask() {
+    if (task != nullptr) return true;
+    if (!imu.isInitialized() || imu.isFifoEnabled()) return false;
+
+    queue = xQueueCreate(QUEUE_DEPTH, sizeof(IMU::TimedSample));
+    if (queue == nullptr) return false;
+
+    if (xTaskCreate(taskEntry, "imu_sample", TASK_STACK, this, TASK_PRIORITY, &task) != pdPASS) {
+        task = nullptr;
+        return false;
+    }
+    imu.setInterruptTask(task);
+    return imu.enableDataReady();
+}
+
+void ImuPipeline::taskEntry(void* arg) {
+    static_cast<ImuPipeline*>(arg)->taskLoop();
+}
+
+void ImuPipeline::taskLoop() {
+    for (;;) {
+        // Woken by the INT2 edge; the timeout recovers from a missed edge
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(100));
+
+        IMU::TimedSample timed;
+        if (!imu.readTimedSample(timed)) continue;
+        if (xQueueSend(queue, &timed, 0) != pdTRUE) queue_drops++;
+        
+        // Wake the main loop per batch, not per sample
+        if (uxQueueMessagesWaiting(queue) >= NOTIFY_BATCH) EventLoop::post(EventLoop::EVENT_IMU);
+    }
+}
+
+void ImuPipeline::dispatchTimed(const IMU::TimedSample& timed) {
+    // A new output rate restarts the timeline from the ODR table
+    uint16_t rate = imu.getSampleRateHz();
+    if (rate != timeline_rate_hz) {
+        timeline_valid = false;
+        timeline_rate_hz = rate;
+        period_q = ((int64_t)imu.getSamplePeriodUs() * 1000) << PERIOD_FRAC;
+        timing.period_ns = (uint32_t)(period_q >> PERIOD_FRAC);
+    }
+
+    // Sensor counter is 24 bits wide
+    uint32_t ticks = (timed.sensor_ticks - last_ticks) & 0xFFFFFF;
+    if (timeline_valid && ticks == 0) {
+        timing.duplicates++;
+        return;
+    }
+    last_ticks = timed.sensor_ticks;
+
+    // Advance on the sensor timeline, then pull its phase and period towards the
+    // edge times (critically damped PI loop, time constant ~128 samples). Far
+    // off means the ticks were counted at another rate (a sleep): restart there,
+    // keeping the locked period.
+    timeline_ns += ((int64_t)ticks * period_q + (1 << (PERIOD_FRAC - 1))) >> PERIOD_FRAC;
+    int64_t error = timed.host_us * 1000 - timeline_ns;
+    if (!timeline_valid || error > RELOCK_NS || error < -RELOCK_NS) {
+        timeline_valid = true;
+        timeline_ns = timed.host_us * 1000;
+        dispatch(timed.raw, timed.host_us, timed.sensor_ticks);
+        return;
+    }
+    timing.missed += ticks - 1;
+    timeline_ns += error >> LOCK_SHIFT;
+    period_q += error >> (PERIOD_SHIFT - PERIOD_FRAC);
+    timing.period_ns = (uint32_t)(period_q >> PERIOD_FRAC);
+
+    int64_t error_us = error / 1000;
+    uint32_t jitter = (uint32_t)(error_us < 0 ? -error_us : error_us);
+    timing.samples++;
+    timing.sum_jitter_us += jitter;
+    if (jitter > timing.max_jitter_us) timing.max_jitter_us = jitter;
+
+    dispatch(timed.raw, timeline_ns / 1000, timed.sensor_ticks);
+}
+
+size_t ImuPipeline::update() {
+    if (!imu.isInitialized()) return 0;
+
+    unsigned long now = millis();
+
+    if (task != nullptr) {
+        size_t count = 0;
+        IMU::TimedSample timed;
+        while (xQueueReceive(queue, &timed, 0) == pdTRUE) {
+            dispatchTimed(timed);
+            count++;
+        }
+        timing.dropped = queue_drops - queue_drops_reported;
+        return count;
+    }
+
+    if (imu.isFifoEnabled()) {
+        if (imu.serviceFifo() == 0) return 0;
+        return dispatchFifoBatch();
+    }
+
+    // Polling mode: one register read per interval
+    if (now - last_poll < POLL_INTERVAL_MS) return 0;
+    last_poll = now;
+
+    IMU::RawSample raw;
+    if (!imu.readSample(raw)) return 0;
+    dispatch(raw, esp_timer_get_time());
+    return 1;
+}
+
+size_t ImuPipeline::dispatchWakeHistory() {
+    // Data-ready samples queued around the sleep are older than the history or part of it
+    if (queue != nullptr) xQueueReset(queue);
+    if (imu.drainWakeHistory() == 0) return 0;
+    return dispatchFifoBatch();
+}
+
+size_t ImuPipeline::dispatchFifoBatch() {
+    // Frames are evenly spaced at the real ODR; the newest one was taken just now
+    int64_t now_us = esp_timer_get_time();
+    uint32_t period_us = imu.getSamplePeriodUs();
+    size_t batch_count = 0;
+    const IMU::RawSample* batch = imu.getFifoBatch(batch_count);
+    for (size_t i = 0; i < batch_count; i++) {
+        int64_t age_us = (int64_t)(batch_count - 1 - i) * period_us;
+        dispatch(batch[i], now_us - age_us);
+    }
+    return batch_count;
+}
+
+bool ImuPipeline::nextPollDue(unsigned long& due_ms) const {
+    if (!imu.isInitialized() || task != nullptr) return false;
+    
+    due_ms = imu.isFifoEnabled() ? imu.nextFifoDrainMs() : last_poll + POLL_INTERVAL_MS;
+    return true;
+}
+
+void ImuPipeline::dispatch(const IMU::RawSample& raw, int64_t timestamp_us, uint32_t sensor_ticks) {
+    ImuSample sample;
+    sample.timestamp_us = timestamp_us;
+    sample.timestamp_ms = (uint32_t)(timestamp_us / 1000);
+    sample.sensor_ticks = sensor_ticks;
+    sample.period_us = imu.getSamplePeriodUs();
+    sample.gyro_valid = imu.hasGyro();
+    sample.raw = raw;
+    sample.accel = IMU::toAccel(raw);
+    sample.gyro = IMU::toGyro(raw);
+    samples++;
+
+    for (size_t i = 0; i < stage_count; i++) {
+        uint32_t start = ESP.getCycleCount();
+        stages[i]->process(sample);
+        stages[i]->cycles += ESP.getCycleCount() - start;
+        stages[i]->samples++;
+    }
+}
@@ -0,0 +1,131 @@
+#pragma once
+#include <Arduino.h>
+
+#include "imu.hpp"
+#include <freertos/queue.h>
+
+/**
+ * One timestamped accel + gyro sample, shared by all pipeline stages.
+ */
+struct ImuSample {
+    uint32_t timestamp_ms;
+    int64_t timestamp_us;   // esp_timer time base; does not wrap
+    uint32_t sensor_ticks;  // QMI8658 sample counter (data-ready mode only)
+    uint32_t period_us;     // Real output period at the time (IMU::getSamplePeriodUs())
+    bool gyro_valid;        // False for accel-only samples (low rate, motion wake history)
+    IMU::RawSample raw;
+    IMU::AccelData accel;
+    IMU::GyroData gyro;
+};
+
+/**
+ * A processing stage subscribed to the IMU sample stream.
+ * Stages keep their own state; the pipeline measures their CPU cost.
+ */
+class ImuStage {
+private:
+    friend class ImuPipeline;
+    uint32_t samples = 0;
+    uint64_t cycles = 0;
+
+public:
+    virtual ~ImuStage() {}
+    virtual const char* name() const = 0;
+    virtual void process(const ImuSample& sample) = 0;
+
+    uint32_t getSampleCount() const { return samples; }
+    uint64_t getTotalCycles() const { return cycles; }
+    uint32_t getAverageCycles() const { return samples ? (uint32_t)(cycles / samples) : 0; }
+    void resetStats() { samples = 0; cycles = 0; }
+};
+
+/**
+ * Single IMU sampling stage: acquires each sample once and hands it to
+ * every subscribed stage in order.
+ *
+ * Acquisition is either a FIFO batch (watermark interrupt) or, in
+ * data-ready mode, a sampling task woken by the INT2 edge that reads the
+ * sample with the sensor's TIMESTAMP counter and queues it for the main
+ * loop. Data-ready samples are placed on the sensor's own timeline (one
+ * tick per sample) and slowly locked to esp_timer, so stages see an
+ * evenly spaced stream; duplicates and gaps are detected from the counter.
+ * The lock tracks both phase and the sample period, which starts from the
+ * ODR table and converges on the sensor clock's real rate.
+ * Register polling is the fallback when the task cannot be started.
+ */
+class ImuPipeline {
+public:
+    // Data-ready timing; jitter is the host edge time against the sensor timeline
+    struct TimingStats {
+        uint32_t samples;
+        uint32_t duplicates;    // Same sensor tick read twice
+        uint32_t missed;        // Sensor ticks never read
+        uint32_t dropped;       // Queue full
+        uint32_t max_jitter_us;
+        uint64_t sum_jitter_us;
+        uint32_t period_ns;     // Sample period the timeline has locked to
+    };
+
+private:
+    static constexpr size_t MAX_STAGES = 12;
+    static constexpr unsigned long POLL_INTERVAL_MS = 50;  // Polling fallback only
+    static constexpr size_t QUEUE_DEPTH = 32;              // 250ms at 128Hz
+    static constexpr size_t NOTIFY_BATCH = 8;              // Queued samples per main loop wake
+    static constexpr uint32_t TASK_STACK = 3072;
+    static constexpr UBaseType_t TASK_PRIORITY = 5;
+    static constexpr int32_t LOCK_SHIFT = 6;               // Timeline follows esp_timer with gain 1/64
+    static constexpr int32_t PERIOD_SHIFT = 14;            // Period follows it with gain 1/(4 * 64^2)
+    static constexpr int32_t PERIOD_FRAC = 10;             // Fraction bits of the period (ns)
+    static constexpr int64_t RELOCK_NS = 50000000;         // Timeline error that restarts it
+
+    IMU& imu;
+    ImuStage* stages[MAX_STAGES] = {nullptr};
+    size_t stage_count = 0;
+    unsigned long last_poll = 0;
+    uint32_t samples = 0;
+
+    // Data-ready mode
+    TaskHandle_t task = nullptr;
+    QueueHandle_t queue = nullptr;
+    volatile uint32_t queue_drops = 0;
+    uint32_t queue_drops_reported = 0;
+    bool timeline_valid = false;
+    uint16_t timeline_rate_hz = 0;
+    uint32_t last_ticks = 0;
+    int64_t timeline_ns = 0;
+    int64_t period_q = 0;       // ns << PERIOD_FRAC
+    TimingStats timing = {};
+
+    static void taskEntry(void* arg);
+    void taskLoop();
+    void dispatchTimed(const IMU::TimedSample& timed);
+    size_t dispatchFifoBatch();
+    void dispatch(const IMU::RawSample& raw, int64_t timestamp_us, uint32_t sensor_ticks = 0);
+
+public:
+    explicit ImuPipeline(IMU& imu) : imu(imu) {}
+
+    // Start interrupt-driven data-ready acquisition (non-FIFO mode)
+    bool startDataReadyTask();
+    bool isDataReadyMode() const { return task != nullptr; }
+    // millis() time at which update() next reads without an event; false when fully event driven
+    bool nextPollDue(unsigned long& due_ms) const;
+    const TimingStats& getTimingStats() const { return timing; }
+    void resetTimingStats() {
+        timing = {};
+        timing.period_ns = (uint32_t)(period_q >> PERIOD_FRAC);
+        queue_drops_reported = queue_drops;
+    }
+
+    bool addStage(ImuStage& stage);
+    size_t getStageCount() const { return stage_count; }
+    ImuStage* getStage(size_t index) { return index < stage_count ? stages[index] : nullptr; }
+
+    // Acquire new samples and run them through all stages; returns samples processed
+    size_t update();
+    // After a motion wake, before IMU::exitMotionWake(): runs the accel history
+    // the FIFO kept while asleep, so the stages see the start of the movement
+    size_t dispatchWakeHistory();
+
+    uint32_t getSampleCount() const { return samples; }
+};
@@ -0,0 +1,187 @@
+#include "imu_trace.hpp"
+
+namespace {
+    uint32_t zigzag(int32_t value) {
+        return ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);
+    }
+
+    size_t putVarint(uint8_t* out, uint32_t value) {
+        size_t n = 0;
+        while (value >= 0x80) {
+            out[n++] = (uint8_t)(value | 0x80);
+            value >>= 7;
+        }
+        out[n++] = (uint8_t)value;
+        return n;
+    }
+
+    void putU16(uint8_t* out, uint16_t value) {
+        out[0] = (uint8_t)value;
+        out[1] = (uint8_t)(value >> 8);
+    }
+
+    void putU32(uint8_t* out, uint32_t value) {
+        for (size_t i = 0; i < 4; i++) out[i] = (uint8_t)(value >> (8 * i));
+    }
+
+    int32_t unzigzag(uint32_t value) {
+        return (int32_t)(value >> 1) ^ -(int32_t)(value & 1);
+    }
+
+    // Bounded varint read; returns false past end or on an over-long value
+    bool getVarint(const uint8_t* in, size_t len, size_t& pos, int32_t& value) {
+        uint32_t raw = 0;
+        for (uint32_t shift = 0; shift < 35; shift += 7) {
+            if (pos >= len) return false;
+            uint8_t byte = in[pos++];
+            raw |= (uint32_t)(byte & 0x7F) << shift;
+            if (byte < 0x80) {
+                value = unzigzag(raw);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    uint16_t getU16(const uint8_t* in) {
+        return (uint16_t)(in[0] | in[1] << 8);
+    }
+
+    uint32_t getU32(const uint8_t* in) {
+        return (uint32_t)in[0] | (uint32_t)in[1] << 8 | (uint32_t)in[2] << 16 | (uint32_t)in[3] << 24;
+    }
+}
+
+void ImuTrace::encodeHeader(const Header& header, uint8_t out[HEADER_BYTES]) {
+    out[0] = 'I';
+    out[1] = 'M';
+    out[2] = 'U';
+    out[3] = 'T';
+    out[4] = VERSION;
+    out[5] = header.accel_range_g;
+    putU16(&out[6], header.gyro_range_dps);
+    putU16(&out[8], header.rate_hz);
+    putU16(&out[10], header.block_samples);
+    putU32(&out[12], 0);
+}
+
+size_t ImuTrace::encodeBlock(const uint32_t* timestamps_us, const int16_t* const channels[CHANNELS],
+                             size_t count, uint8_t* out) {
+    if (count == 0) return 0;
+
+    uint8_t* payload = out + BLOCK_HEADER_BYTES;
+    size_t n = 0;
+
+    // Timestamps: first interval, then delta-of-delta
+    int32_t previous_delta = 0;
+    for (size_t i = 1; i < count; i++) {
+        int32_t delta = (int32_t)(timestamps_us[i] - timestamps_us[i - 1]);
+        n += putVarint(payload + n, zigzag(i == 1 ? delta : delta - previous_delta));
+        previous_delta = delta;
+    }
+
+    // Channels: first value, then deltas
+    for (size_t c = 0; c < CHANNELS; c++) {
+        const int16_t* values = channels[c];
+        n += putVarint(payload + n, zigzag(values[0]));
+        for (size_t i = 1; i < count; i++) {
+            n += putVarint(payload + n, zigzag((int32_t)values[i] - values[i - 1]));
+        }
+    }
+
+    out[0] = 'B';
+    out[1] = 'K';
+    putU16(&out[2], (uint16_t)count);
+    putU16(&out[4], (uint16_t)n);
+    putU32(&out[6], timestamps_us[0]);
+    return BLOCK_HEADER_BYTES + n;
+}
+
+void ImuTrace::encodeEvent(const Event& event, uint8_t out[EVENT_BYTES]) {
+    out[0] = 'E';
+    out[1] = 'V';
+    out[2] = event.type;
+    out[3] = 0;
+    putU32(&out[4], event.timestamp_us);
+    putU16(&out[8], (uint16_t)event.a);
+    putU16(&out[10], (uint16_t)event.b);
+    putU16(&out[12], (uint16_t)event.c);
+}
+
+ImuTrace::Reader::Reader(const uint8_t* data, size_t len) : data(data), len(len) {
+    if (len < HEADER_BYTES || data[0] != 'I' || data[1] != 'M' || data[2] != 'U' || data[3] != 'T' ||
+        data[4] == 0 || data[4] > VERSION) {
+        corrupt = true;
+        return;
+    }
+    header.accel_range_g = data[5];
+    header.gyro_range_dps = getU16(&data[6]);
+    header.rate_hz = getU16(&data[8]);
+    header.block_samples = getU16(&data[10]);
+}
+
+bool ImuTrace::Reader::next(RecordType& type, Event& event, uint32_t* timestamps_us,
+                            int16_t* const channels[CHANNELS], size_t max_count, size_t& count) {
+    if (corrupt || pos + 2 > len) return false;
+
+    const uint8_t* in = data + pos;
+    if (in[0] == 'E' && in[1] == 'V') {
+        if (pos + EVENT_BYTES > len) {
+            corrupt = true;
+            return false;
+        }
+        event.type = (EventType)in[2];
+        event.timestamp_us = getU32(&in[4]);
+        event.a = (int16_t)getU16(&in[8]);
+        event.b = (int16_t)getU16(&in[10]);
+        event.c = (int16_t)getU16(&in[12]);
+        pos += EVENT_BYTES;
+        type = EVENT;
+        return true;
+    }
+
+    if (in[0] != 'B' || in[1] != 'K' || pos + BLOCK_HEADER_BYTES > len) {
+        corrupt = true;
+        return false;
+    }
+    size_t samples = getU16(&in[2]);
+    size_t payload_len = getU16(&in[4]);
+    size_t end = pos + BLOCK_HEADER_BYTES + payload_len;
+    if (samples == 0 || samples > max_count || end > len) {
+        corrupt = true;
+        return false;
+    }
+
+    size_t p = pos + BLOCK_HEADER_BYTES;
+    int32_t value;
+
+    // Timestamps: first interval, then delta-of-delta
+    timestamps_us[0] = getU32(&in[6]);
+    int32_t delta = 0;
+    for (size_t i = 1; i < samples; i++) {
+        if (!getVarint(data, end, p, value)) {
+            corrupt = true;
+            return false;
+        }
+        delta = (i == 1) ? value : delta + value;
+        timestamps_us[i] = timestamps_us[i - 1] + (uint32_t)delta;
+    }
+
+    // Channels: first value, then deltas
+    for (size_t c = 0; c < CHANNELS; c++) {
+        int32_t current = 0;
+        for (size_t i = 0; i < samples; i++) {
+            if (!getVarint(data, end, p, value)) {
+                corrupt = true;
+                return false;
+            }
+            current = (i == 0) ? value : current + value;
+            channels[c][i] = (int16_t)current;
+        }
+    }
+
+    pos = end;
+    count = samples;
+    type = BLOCK;
+    return true;
+}
@@ -0,0 +1,112 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Binary IMU trace format (raw QMI8658 counts).
+ *
+ * File header (16 bytes, little endian):
+ *   "IMUT" | version u8 | accel range g u8 | gyro range dps u16 |
+ *   nominal rate Hz u16 | samples per block u16 | reserved u32
+ *
+ * Block:
+ *   "BK" | sample count u16 | payload length u16 | first timestamp us u32 |
+ *   payload
+ *
+ * The payload is columnar. Timestamps come first: the first interval,
+ * then delta-of-delta for each further sample. Then six int16 channels
+ * (ax, ay, az, gx, gy, gz), each as its first value followed by
+ * sample-to-sample deltas. Every value is a zigzag varint, so a steady
+ * sample rate and slowly changing axes cost about one byte each.
+ *
+ * Input event (version 2, 14 bytes, interleaved with blocks):
+ *   "EV" | type u8 | reserved u8 | timestamp us u32 | a i16 | b i16 | c i16
+ *
+ * Events are written ahead of the block that was open when they
+ * happened, so readers order them against samples by timestamp.
+ *
+ * Timestamps are the low 32 bits of esp_timer time and wrap every
+ * 71.6 minutes. Readers unwrap each one (block first timestamps and
+ * event timestamps alike) by its signed 32-bit difference to the
+ * previous record.
+ *
+ * No Arduino dependencies: tools/imu_trace_to_csv.py and
+ * tools/input_replay.cpp decode it on the host.
+ */
+namespace ImuTrace {
+    static constexpr uint8_t VERSION = 2;
+    static constexpr size_t HEADER_BYTES = 16;
+    static constexpr size_t BLOCK_HEADER_BYTES = 10;
+    static constexpr size_t EVENT_BYTES = 14;
+    static constexpr size_t CHANNELS = 6;
+
+    enum EventType : uint8_t {
+        EVENT_TOUCH = 1,    // a = finger count, b = x, c = y
+        EVENT_BUTTON = 2,   // a = GPIO, b = level
+        EVENT_RTC = 3,      // a = RtcSource bits
+    };
+
+    enum RtcSource : uint8_t {
+        RTC_ALARM = 0x01,
+        RTC_TIMER = 0x02,
+        RTC_MINUTE = 0x04,
+    };
+
+    struct Event {
+        EventType type;
+        uint32_t timestamp_us;
+        int16_t a;
+        int16_t b;
+        int16_t c;
+    };
+
+    // Worst case payload: 5-byte timestamp deltas, 3-byte channel deltas
+    static constexpr size_t maxPayloadBytes(size_t samples) {
+        return (samples > 0 ? (samples - 1) * 5 : 0) + CHANNELS * samples * 3;
+    }
+
+    struct Header {
+        uint8_t accel_range_g;
+        uint16_t gyro_range_dps;
+        uint16_t rate_hz;
+        uint16_t block_samples;
+    };
+
+    void encodeHeader(const Header& header, uint8_t out[HEADER_BYTES]);
+
+    // Encodes one block (header + payload) from columnar input; returns bytes written.
+    // out must hold BLOCK_HEADER_BYTES + maxPayloadBytes(count).
+    size_t encodeBlock(const uint32_t* timestamps_us, const int16_t* const channels[CHANNELS],
+                       size_t count, uint8_t* out);
+
+    void encodeEvent(const Event& event, uint8_t out[EVENT_BYTES]);
+
+    /**
+     * Sequential decoder over a trace held in memory (versions 1 and 2).
+     * next() returns false at the end of the data or on a corrupt record;
+     * isCorrupt() tells the two apart.
+     */
+    class Reader {
+    public:
+        enum RecordType { BLOCK, EVENT };
+
+    private:
+        const uint8_t* data;
+        size_t len;
+        size_t pos = HEADER_BYTES;
+        bool corrupt = false;
+        Header header = {};
+
+    public:
+        Reader(const uint8_t* data, size_t len);
+
+        bool isValid() const { return !corrupt; }
+        bool isCorrupt() const { return corrupt; }
+        const Header& getHeader() const { return header; }
+
+        // On BLOCK, up to max_count samples are written to the outputs and
+        // count is set; blocks larger than max_count are reported corrupt.
+        bool next(RecordType& type, Event& event, uint32_t* timestamps_us, int16_t* const channels[CHANNELS],
+                  size_t max_count, size_t& count);
+    };
+}
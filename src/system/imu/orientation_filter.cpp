@@ -0,0 +1,244 @@
+#include "orientation_filter.hpp"
+
+#include <math.h>
+
+void MahonyFilter::reset() {
+    q0 = 1.0f;
+    q1 = q2 = q3 = 0.0f;
+    ix = iy = iz = 0.0f;
+}
+
+void MahonyFilter::update(const int16_t accel[3], const int16_t gyro[3], uint32_t dt_us) {
+    float dt = dt_us * 1e-6f;
+    float gx = gyro[0] * GYRO_RAD_PER_LSB;
+    float gy = gyro[1] * GYRO_RAD_PER_LSB;
+    float gz = gyro[2] * GYRO_RAD_PER_LSB;
+
+    float ax = accel[0], ay = accel[1], az = accel[2];
+    float norm = sqrtf(ax * ax + ay * ay + az * az);
+
+    // Gravity correction only with a valid accelerometer reading
+    if (norm > 0.0f) {
+        ax /= norm;
+        ay /= norm;
+        az /= norm;
+
+        // Estimated gravity direction from the current attitude
+        float vx = 2.0f * (q1 * q3 - q0 * q2);
+        float vy = 2.0f * (q0 * q1 + q2 * q3);
+        float vz = q0 * q0 - q1 * q1 - q2 * q2 + q3 * q3;
+
+        // Error is the cross product between measured and estimated gravity
+        float ex = ay * vz - az * vy;
+        float ey = az * vx - ax * vz;
+        float ez = ax * vy - ay * vx;
+
+        if (ki > 0.0f) {
+            ix += ki * ex * dt;
+            iy += ki * ey * dt;
+            iz += ki * ez * dt;
+            gx += ix;
+            gy += iy;
+            gz += iz;
+        }
+
+        gx += kp * ex;
+        gy += kp * ey;
+        gz += kp * ez;
+    }
+
+    // Integrate rate of change of quaternion
+    float half_dt = 0.5f * dt;
+    gx *= half_dt;
+    gy *= half_dt;
+    gz *= half_dt;
+    float qa = q0, qb = q1, qc = q2;
+    q0 += -qb * gx - qc * gy - q3 * gz;
+    q1 += qa * gx + qc * gz - q3 * gy;
+    q2 += qa * gy - qb * gz + q3 * gx;
+    q3 += qa * gz + qb * gy - qc * gx;
+
+    float qn = 1.0f / sqrtf(q0 * q0 + q1 * q1 + q2 * q2 + q3 * q3);
+    q0 *= qn;
+    q1 *= qn;
+    q2 *= qn;
+    q3 *= qn;
+}
+
+void MahonyFilter::align(const int16_t accel[3]) {
+    float ax = accel[0], ay = accel[1], az = accel[2];
+    float norm = sqrtf(ax * ax + ay * ay + az * az);
+    if (norm <= 0.0f) return;
+    ax /= norm;
+    ay /= norm;
+    az /= norm;
+
+    // A rotation taking the resting gravity (+Z) onto the measured one. Facing
+    // down, the same tilt after a half turn about X keeps the divisor >= 0.707.
+    ix = iy = iz = 0.0f;
+    if (az >= 0.0f) {
+        float c = sqrtf(0.5f * (1.0f + az));
+        q0 = c;
+        q1 = 0.5f * ay / c;
+        q2 = -0.5f * ax / c;
+        q3 = 0.0f;
+    } else {
+        float c = sqrtf(0.5f * (1.0f - az));
+        q0 = 0.5f * ay / c;
+        q1 = c;
+        q2 = 0.0f;
+        q3 = 0.5f * ax / c;
+    }
+}
+
+void MahonyFilter::getQuaternion(float q[4]) const {
+    q[0] = q0;
+    q[1] = q1;
+    q[2] = q2;
+    q[3] = q3;
+}
+
+void MahonyFilter::getGravity(float g[3]) const {
+    g[0] = 2.0f * (q1 * q3 - q0 * q2);
+    g[1] = 2.0f * (q0 * q1 + q2 * q3);
+    g[2] = q0 * q0 - q1 * q1 - q2 * q2 + q3 * q3;
+}
+
+uint32_t MahonyFilterQ::isqrt(uint32_t value) {
+    // Bitwise integer square root
+    uint32_t result = 0;
+    uint32_t bit = 1UL << 30;
+    while (bit > value) bit >>= 2;
+    while (bit != 0) {
+        if (value >= result + bit) {
+            value -= result + bit;
+            result = (result >> 1) + bit;
+        } else {
+            result >>= 1;
+        }
+        bit >>= 2;
+    }
+    return result;
+}
+
+void MahonyFilterQ::reset() {
+    q[0] = 1 << 30;
+    q[1] = q[2] = q[3] = 0;
+    integral[0] = integral[1] = integral[2] = 0;
+}
+
+void MahonyFilterQ::update(const int16_t accel[3], const int16_t gyro[3], uint32_t dt_us) {
+    // 0.5 * dt in Q30, recomputed only when the sample interval changes
+    if (dt_us != last_dt_us) {
+        last_dt_us = dt_us;
+        half_dt_q30 = (int32_t)(((int64_t)dt_us << 29) / 1000000);
+    }
+
+    int32_t rate[3];
+    for (int i = 0; i < 3; i++) rate[i] = gyro[i] * GYRO_Q20_PER_LSB;
+
+    uint32_t norm = isqrt((uint32_t)((int32_t)accel[0] * accel[0]) +
+                          (uint32_t)((int32_t)accel[1] * accel[1]) +
+                          (uint32_t)((int32_t)accel[2] * accel[2]));
+
+    if (norm > 0) {
+        // Measured gravity direction, Q15
+        int32_t a[3];
+        for (int i = 0; i < 3; i++) a[i] = (accel[i] * 32768) / (int32_t)norm;
+
+        // Estimated gravity direction, Q15
+        int16_t v[3];
+        getGravityQ15(v);
+
+        // Cross product error, Q15
+        int32_t e[3];
+        e[0] = (a[1] * v[2] - a[2] * v[1]) >> 15;
+        e[1] = (a[2] * v[0] - a[0] * v[2]) >> 15;
+        e[2] = (a[0] * v[1] - a[1] * v[0]) >> 15;
+
+        for (int i = 0; i < 3; i++) {
+            // Q15 * Q16 >> 11 = Q20
+            if (ki_q16 > 0) {
+                integral[i] += (int32_t)(((int64_t)e[i] * ki_q16 >> 11) * dt_us / 1000000);
+                rate[i] += integral[i];
+            }
+            rate[i] += (int32_t)((int64_t)e[i] * kp_q16 >> 11);
+        }
+    }
+
+    // Half-angle increments, Q30
+    int64_t h[3];
+    for (int i = 0; i < 3; i++) h[i] = ((int64_t)rate[i] * half_dt_q30) >> 20;
+
+    int64_t q0 = q[0], q1 = q[1], q2 = q[2], q3 = q[3];
+    q[0] += (int32_t)((-q1 * h[0] - q2 * h[1] - q3 * h[2]) >> 30);
+    q[1] += (int32_t)((q0 * h[0] + q2 * h[2] - q3 * h[1]) >> 30);
+    q[2] += (int32_t)((q0 * h[1] - q1 * h[2] + q3 * h[0]) >> 30);
+    q[3] += (int32_t)((q0 * h[2] + q1 * h[1] - q2 * h[0]) >> 30);
+
+    // Renormalize with one Newton step: q is always close to unit length
+    int64_t n2 = ((int64_t)q[0] * q[0] + (int64_t)q[1] * q[1] +
+                  (int64_t)q[2] * q[2] + (int64_t)q[3] * q[3]) >> 30;
+    int64_t inv = ((3LL << 30) - n2) >> 1;
+    for (int i = 0; i < 4; i++) q[i] = (int32_t)(((int64_t)q[i] * inv) >> 30);
+}
+
+void MahonyFilterQ::align(const int16_t accel[3]) {
+    uint32_t norm = isqrt((uint32_t)((int32_t)accel[0] * accel[0]) +
+                          (uint32_t)((int32_t)accel[1] * accel[1]) +
+                          (uint32_t)((int32_t)accel[2] * accel[2]));
+    if (norm == 0) return;
+
+    // Measured gravity direction, Q15
+    int32_t a[3];
+    for (int i = 0; i < 3; i++) a[i] = (accel[i] * 32768) / (int32_t)norm;
+
+    // As the float filter: c = sqrt((1 +- az) / 2) in Q15 (>= 0.707), the
+    // other terms (ay, -+ax) / (2 * c) in Q30
+    integral[0] = integral[1] = integral[2] = 0;
+    bool up = a[2] >= 0;
+    int32_t c = (int32_t)isqrt((uint32_t)(up ? 32768 + a[2] : 32768 - a[2]) << 14);
+    int32_t ty = (int32_t)(((int64_t)a[1] << 29) / c);
+    int32_t tx = (int32_t)(((int64_t)a[0] << 29) / c);
+    if (up) {
+        q[0] = c << 15;
+        q[1] = ty;
+        q[2] = -tx;
+        q[3] = 0;
+    } else {
+        q[0] = ty;
+        q[1] = c << 15;
+        q[2] = 0;
+        q[3] = tx;
+    }
+
+    // The Q15 square root leaves q slightly off unit length: one Newton step
+    int64_t n2 = ((int64_t)q[0] * q[0] + (int64_t)q[1] * q[1] +
+                  (int64_t)q[2] * q[2] + (int64_t)q[3] * q[3]) >> 30;
+    int64_t inv = ((3LL << 30) - n2) >> 1;
+    for (int i = 0; i < 4; i++) q[i] = (int32_t)(((int64_t)q[i] * inv) >> 30);
+}
+
+static inline int16_t saturateQ15(int64_t value) {
+    if (value > 32767) return 32767;
+    if (value < -32768) return -32768;
+    return (int16_t)value;
+}
+
+void MahonyFilterQ::getGravityQ15(int16_t g[3]) const {
+    int64_t q0 = q[0], q1 = q[1], q2 = q[2], q3 = q[3];
+    // Q60 products, 2x scale folded into the shift: Q60 >> 45 = Q15
+    g[0] = saturateQ15((q1 * q3 - q0 * q2) >> 44);
+    g[1] = saturateQ15((q0 * q1 + q2 * q3) >> 44);
+    g[2] = saturateQ15((q0 * q0 - q1 * q1 - q2 * q2 + q3 * q3) >> 45);
+}
+
+void MahonyFilterQ::getQuaternion(float out[4]) const {
+    for (int i = 0; i < 4; i++) out[i] = q[i] / 1073741824.0f;
+}
+
+void MahonyFilterQ::getGravity(float g[3]) const {
+    int16_t gq[3];
+    getGravityQ15(gq);
+    for (int i = 0; i < 3; i++) g[i] = gq[i] / 32768.0f;
+}
@@ -0,0 +1,71 @@
+#pragma once
+#include <stdint.h>
+
+/**
+ * Mahony complementary orientation filter.
+ *
+ * Integrates the gyro into a quaternion and pulls it towards the measured
+ * gravity direction with a PI correction. Outputs the attitude quaternion
+ * and the gravity direction in the sensor frame (unit vector, same sign as
+ * the accelerometer at rest), which is free of the linear acceleration
+ * that moving the arm adds to the raw accel axes.
+ *
+ * Both implementations take raw QMI8658 counts (8g accel, 1024dps gyro)
+ * and have no Arduino dependencies so they can run against recorded
+ * traces off-target.
+ */
+
+// Float reference implementation
+class MahonyFilter {
+private:
+    float q0 = 1.0f, q1 = 0.0f, q2 = 0.0f, q3 = 0.0f;
+    float ix = 0.0f, iy = 0.0f, iz = 0.0f;  // Integral feedback
+    float kp;
+    float ki;
+
+public:
+    // Gyro scale for the 1024dps range, in rad/s per LSB
+    static constexpr float GYRO_RAD_PER_LSB = (1024.0f / 32768.0f) * 0.017453292f;
+
+    MahonyFilter(float kp = 1.0f, float ki = 0.0f) : kp(kp), ki(ki) {}
+
+    void reset();
+    void update(const int16_t accel[3], const int16_t gyro[3], uint32_t dt_us);
+    // Without a gyro: level the attitude to the accelerometer (yaw is lost)
+    void align(const int16_t accel[3]);
+
+    void getQuaternion(float q[4]) const;
+    void getGravity(float g[3]) const;
+};
+
+// Fixed-point implementation: quaternion in Q30, unit vectors in Q15,
+// angular rates in Q20 rad/s. No floating point in update().
+class MahonyFilterQ {
+private:
+    int32_t q[4] = {1 << 30, 0, 0, 0};      // Q30
+    int32_t integral[3] = {0, 0, 0};        // Q20 rad/s
+    int32_t kp_q16;
+    int32_t ki_q16;
+    uint32_t last_dt_us = 0;
+    int32_t half_dt_q30 = 0;
+
+    static uint32_t isqrt(uint32_t value);
+
+public:
+    // Gyro scale for the 1024dps range in Q20 rad/s per LSB (0.000545415 * 2^20)
+    static constexpr int32_t GYRO_Q20_PER_LSB = 572;
+
+    MahonyFilterQ(float kp = 1.0f, float ki = 0.0f)
+        : kp_q16((int32_t)(kp * 65536.0f)), ki_q16((int32_t)(ki * 65536.0f)) {}
+
+    void reset();
+    void update(const int16_t accel[3], const int16_t gyro[3], uint32_t dt_us);
+    // Without a gyro: level the attitude to the accelerometer (yaw is lost)
+    void align(const int16_t accel[3]);
+
+    const int32_t* getQuaternionQ30() const { return q; }
+    void getGravityQ15(int16_t g[3]) const;
+
+    void getQuaternion(float out[4]) const;
+    void getGravity(float g[3]) const;
+};
@@ -0,0 +1,68 @@
+#include "orientation_stage.hpp"
+
+void OrientationStage::process(const ImuSample& sample) {
+    // Sample interval from timestamps; the real ODR period for the first sample
+    uint32_t dt_us = sample.period_us;
+    if (valid) {
+        int64_t elapsed = sample.timestamp_us - last_timestamp_us;
+        if (elapsed < MIN_DT_US) elapsed = MIN_DT_US;
+        if (elapsed > MAX_DT_US) elapsed = MAX_DT_US;
+        dt_us = (uint32_t)elapsed;
+    }
+    last_timestamp_us = sample.timestamp_us;
+
+    const int16_t* accel = &sample.raw.ax;
+    const int16_t* gyro = &sample.raw.gx;
+    float g[3];
+    uint32_t start;
+
+    if (!sample.gyro_valid) {
+        // Accel only (low rate, wake history): nothing to integrate, so the
+        // attitude follows the accelerometer and is current when the gyro returns
+#if ORIENTATION_FILTER_FIXED || ORIENTATION_FILTER_COMPARE
+        fixed_filter.align(accel);
+#endif
+#if !ORIENTATION_FILTER_FIXED || ORIENTATION_FILTER_COMPARE
+        float_filter.align(accel);
+#endif
+    } else {
+#if ORIENTATION_FILTER_FIXED || ORIENTATION_FILTER_COMPARE
+        start = ESP.getCycleCount();
+        fixed_filter.update(accel, gyro, dt_us);
+        fixed_cycles += ESP.getCycleCount() - start;
+        fixed_updates++;
+#endif
+#if !ORIENTATION_FILTER_FIXED || ORIENTATION_FILTER_COMPARE
+        start = ESP.getCycleCount();
+        float_filter.update(accel, gyro, dt_us);
+        float_cycles += ESP.getCycleCount() - start;
+        float_updates++;
+#endif
+    }
+
+#if ORIENTATION_FILTER_FIXED
+    fixed_filter.getQuaternion(quaternion);
+    fixed_filter.getGravity(g);
+#else
+    float_filter.getQuaternion(quaternion);
+    float_filter.getGravity(g);
+#endif
+
+#if ORIENTATION_FILTER_COMPARE
+    float other[3];
+#if ORIENTATION_FILTER_FIXED
+    float_filter.getGravity(other);
+#else
+    fixed_filter.getGravity(other);
+#endif
+    for (int i = 0; i < 3; i++) {
+        float deviation = abs(g[i] - other[i]);
+        if (deviation > max_deviation) max_deviation = deviation;
+    }
+#endif
+
+    gravity.x = g[0];
+    gravity.y = g[1];
+    gravity.z = g[2];
+    valid = true;
+}
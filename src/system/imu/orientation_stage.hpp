@@ -0,0 +1,48 @@
+#pragma once
+#include <Arduino.h>
+
+#include "config.h"
+#include "imu_pipeline.hpp"
+#include "orientation_filter.hpp"
+
+/**
+ * Runs the Mahony orientation filter on every IMU sample and publishes the
+ * attitude quaternion and gravity direction for later stages. Accel-only
+ * samples level the filter to the accelerometer instead.
+ *
+ * ORIENTATION_FILTER_FIXED selects the fixed-point filter (default) or the
+ * float reference. With ORIENTATION_FILTER_COMPARE both run on every sample
+ * and the largest gravity deviation between them is tracked.
+ */
+class OrientationStage : public ImuStage {
+private:
+    static constexpr uint32_t MIN_DT_US = 1000;
+    static constexpr uint32_t MAX_DT_US = 200000;
+
+    MahonyFilterQ fixed_filter;
+    MahonyFilter float_filter;
+
+    int64_t last_timestamp_us = 0;
+    bool valid = false;
+    float quaternion[4] = {1.0f, 0.0f, 0.0f, 0.0f};
+    IMU::AccelData gravity = {0.0f, 0.0f, 1.0f};
+
+    // Per-implementation cost (cycles) and agreement
+    uint32_t fixed_updates = 0;
+    uint32_t float_updates = 0;
+    uint64_t fixed_cycles = 0;
+    uint64_t float_cycles = 0;
+    float max_deviation = 0.0f;
+
+public:
+    const char* name() const override { return "orientation"; }
+    void process(const ImuSample& sample) override;
+
+    bool isValid() const { return valid; }
+    const float* getQuaternion() const { return quaternion; }
+    const IMU::AccelData& getGravity() const { return gravity; }
+
+    uint32_t getFixedCyclesPerUpdate() const { return fixed_updates ? (uint32_t)(fixed_cycles / fixed_updates) : 0; }
+    uint32_t getFloatCyclesPerUpdate() const { return float_updates ? (uint32_t)(float_cycles / float_updates) : 0; }
+    float getMaxDeviation() const { return max_deviation; }
+};
@@ -0,0 +1,122 @@
+#include "pedometer.hpp"
+
+bool HardwarePedometer::begin() {
+    enabled = imu.enablePedometer() && imu.resetStepCount();
+    if (!enabled) {
+        if (logger != nullptr) logger->warn("STEPS", "On-chip pedometer configuration failed");
+        return false;
+    }
+    count = 0;
+    last_poll_ms = millis();
+    return true;
+}
+
+void HardwarePedometer::update(uint32_t now_ms) {
+    if (!enabled || now_ms - last_poll_ms < POLL_INTERVAL_MS) return;
+
+    uint32_t hw_count = 0;
+    if (!imu.readStepCount(hw_count)) return;
+
+    // Smooth the per-poll cadence; the count is 24 bits wide on the sensor
+    uint32_t delta = (hw_count - count) & 0xFFFFFF;
+    float instant = delta * 60000.0f / (now_ms - last_poll_ms);
+    steps_per_minute = (delta == 0) ? 0.0f : 0.5f * steps_per_minute + 0.5f * instant;
+
+    count = hw_count;
+    last_poll_ms = now_ms;
+}
+
+void HardwarePedometer::reset() {
+    if (enabled) imu.resetStepCount();
+    count = 0;
+    steps_per_minute = 0.0f;
+}
+
+void StepCounterStage::process(const ImuSample& sample) {
+    uint32_t now = sample.timestamp_ms;
+    const IMU::AccelData& a = sample.accel;
+    float magnitude = sqrt(a.x * a.x + a.y * a.y + a.z * a.z);
+
+    if (!state.primed) {
+        state.lowpass = magnitude;
+        state.baseline = magnitude;
+        state.primed = true;
+        return;
+    }
+
+    // First-order filters over the real sample period
+    float dt = (float)sample.period_us;
+    state.lowpass += (magnitude - state.lowpass) * (dt / (LOWPASS_TAU_US + dt));
+    state.baseline += (state.lowpass - state.baseline) * (dt / (BASELINE_TAU_US + dt));
+    float signal = state.lowpass - state.baseline;
+
+    float threshold = state.peak_average * THRESHOLD_RATIO;
+    if (threshold < MIN_THRESHOLD_G) threshold = MIN_THRESHOLD_G;
+
+    if (!state.in_peak) {
+        if (signal > threshold) {
+            state.in_peak = true;
+            state.peak_value = signal;
+            state.peak_ms = now;
+        }
+        return;
+    }
+
+    // Track the top of the peak until the signal falls back through zero
+    if (signal > state.peak_value) {
+        state.peak_value = signal;
+        state.peak_ms = now;
+    }
+    if (signal < 0.0f) {
+        state.in_peak = false;
+        onPeak(state.peak_value, state.peak_ms);
+    }
+}
+
+void StepCounterStage::onPeak(float height, uint32_t now) {
+    uint32_t interval = now - state.last_step_ms;
+
+    // Too close to the previous step: part of the same foot strike
+    if (state.last_step_ms != 0 && interval < MIN_STEP_INTERVAL_MS) return;
+
+    state.peak_average += (height - state.peak_average) * 0.25f;
+
+    bool regular = (state.last_step_ms != 0 && interval <= MAX_STEP_INTERVAL_MS);
+    state.last_step_ms = now;
+
+    if (!regular) {
+        // Start of a new walk (or a stray bump)
+        state.candidates = 1;
+        state.interval_average_ms = 0.0f;
+        return;
+    }
+
+    state.interval_average_ms = (state.interval_average_ms == 0.0f)
+        ? interval
+        : state.interval_average_ms + (interval - state.interval_average_ms) * 0.25f;
+
+    if (state.candidates < REGULAR_STEPS) {
+        // Walk confirmed: credit the steps that were held back
+        if (++state.candidates == REGULAR_STEPS) count += REGULAR_STEPS;
+        return;
+    }
+    count++;
+}
+
+void StepCounterStage::update(uint32_t now_ms) {
+    // Walk ended: the next steps have to prove regularity again
+    if (state.last_step_ms != 0 && now_ms - state.last_step_ms > MAX_STEP_INTERVAL_MS) {
+        state.candidates = 0;
+        state.interval_average_ms = 0.0f;
+    }
+}
+
+float StepCounterStage::cadence() const {
+    if (state.candidates < REGULAR_STEPS || state.interval_average_ms <= 0.0f) return 0.0f;
+    return 60000.0f / state.interval_average_ms;
+}
+
+void StepCounterStage::reset() {
+    state = State();
+    count = 0;
+}
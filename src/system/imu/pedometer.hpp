@@ -0,0 +1,103 @@
+#pragma once
+#include <Arduino.h>
+
+#include "imu.hpp"
+#include "imu_pipeline.hpp"
+#include "../../logger/logger.hpp"
+
+/**
+ * Common step counter interface. Backends report the total step count and
+ * the current cadence in steps per minute (0 when not walking).
+ */
+class Pedometer {
+public:
+    virtual ~Pedometer() {}
+
+    virtual const char* backendName() const = 0;
+    virtual void update(uint32_t now_ms) { (void)now_ms; }
+    virtual uint32_t steps() const = 0;
+    virtual float cadence() const = 0;
+    virtual void reset() = 0;
+};
+
+/**
+ * QMI8658 on-chip pedometer. Steps are counted by the sensor itself, so
+ * the host only has to read STEP_CNT now and then and may sleep meanwhile.
+ * Cadence is derived from the count delta between polls.
+ */
+class HardwarePedometer : public Pedometer {
+private:
+    static constexpr uint32_t POLL_INTERVAL_MS = 2000;
+
+    IMU& imu;
+    Logger* logger = nullptr;
+    bool enabled = false;
+    uint32_t count = 0;
+    uint32_t last_poll_ms = 0;
+    float steps_per_minute = 0.0f;
+
+public:
+    HardwarePedometer(IMU& imu, Logger* logger) : imu(imu), logger(logger) {}
+
+    bool begin();
+    bool isEnabled() const { return enabled; }
+
+    const char* backendName() const override { return "qmi8658"; }
+    void update(uint32_t now_ms) override;
+    uint32_t steps() const override { return count; }
+    float cadence() const override { return steps_per_minute; }
+    void reset() override;
+};
+
+/**
+ * Software step detector, streaming over the accelerometer magnitude with
+ * constant memory:
+ *
+ *  - low-pass the magnitude (~6Hz) and subtract a slow baseline (gravity);
+ *    both are time constants, so the detector is the same at any ODR
+ *  - a step is a peak above an adaptive threshold (fraction of the average
+ *    peak height), ended by the signal crossing back below zero
+ *  - peaks closer than MIN_STEP_INTERVAL_MS are merged; a walk is only
+ *    counted after REGULAR_STEPS consecutive peaks with plausible spacing,
+ *    so single bumps and arm gestures do not add steps
+ */
+class StepCounterStage : public ImuStage, public Pedometer {
+private:
+    static constexpr float LOWPASS_TAU_US = 27000.0f;
+    static constexpr float BASELINE_TAU_US = 440000.0f;
+    static constexpr float MIN_THRESHOLD_G = 0.05f;
+    static constexpr float THRESHOLD_RATIO = 0.4f;
+    static constexpr uint32_t MIN_STEP_INTERVAL_MS = 250;
+    static constexpr uint32_t MAX_STEP_INTERVAL_MS = 2000;
+    static constexpr uint8_t REGULAR_STEPS = 4;
+
+    struct State {
+        bool primed = false;
+        float lowpass = 1.0f;
+        float baseline = 1.0f;
+        float peak_average = 0.15f;
+        bool in_peak = false;
+        float peak_value = 0.0f;
+        uint32_t peak_ms = 0;
+        uint32_t last_step_ms = 0;
+        uint8_t candidates = 0;
+        float interval_average_ms = 0.0f;
+    };
+
+    State state;
+    uint32_t count = 0;
+
+    void onPeak(float height, uint32_t now);
+
+public:
+    // ImuStage
+    const char* name() const override { return "steps"; }
+    void process(const ImuSample& sample) override;
+
+    // Pedometer
+    const char* backendName() const override { return "software"; }
+    void update(uint32_t now_ms) override;
+    uint32_t steps() const override { return count; }
+    float cadence() const override;
+    void reset() override;
+};
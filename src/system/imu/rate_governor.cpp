@@ -0,0 +1,66 @@
+#include "rate_governor.hpp"
+
+void ImuRateGovernor::process(const ImuSample& sample) {
+    const IMU::AccelData& a = sample.accel;
+    float magnitude = sqrt(a.x * a.x + a.y * a.y + a.z * a.z);
+
+    if (!state.primed) {
+        state.baseline = magnitude;
+        state.last_activity_ms = sample.timestamp_ms;
+        state.primed = true;
+        return;
+    }
+
+    float activity = abs(magnitude - state.baseline);
+    state.baseline += (magnitude - state.baseline) * BASELINE_ALPHA;
+
+    // Rotation only counts while the gyro is running (ACTIVE tier)
+    bool rotating = !imu.isLowRate() &&
+                    (abs(sample.gyro.x) > STILL_GYRO_DPS || abs(sample.gyro.y) > STILL_GYRO_DPS ||
+                     abs(sample.gyro.z) > STILL_GYRO_DPS);
+
+    if (activity > MOTION_THRESHOLD_G) {
+        state.motion = true;
+    }
+    if (activity > STILL_THRESHOLD_G || rotating) {
+        state.last_activity_ms = sample.timestamp_ms;
+    }
+}
+
+void ImuRateGovernor::update(unsigned long now) {
+    if (!imu.isInitialized() || imu.isInMotionWake()) return;
+    if (tier_since == 0) tier_since = now;
+
+    bool held = (long)(hold_until - now) > 0;
+
+    if (tier == TIER_STILL && (state.motion || held)) {
+        setTier(TIER_ACTIVE, now);
+    } else if (tier == TIER_ACTIVE && !held && now - state.last_activity_ms > STILL_HOLD_MS) {
+        setTier(TIER_STILL, now);
+    }
+    state.motion = false;
+}
+
+void ImuRateGovernor::holdFullRate(unsigned long duration_ms) {
+    hold_until = millis() + duration_ms;
+    state.last_activity_ms = millis();
+}
+
+bool ImuRateGovernor::setTier(Tier next, unsigned long now) {
+    if (!imu.setLowRate(next == TIER_STILL)) {
+        if (logger != nullptr) logger->warn("IMU", "Failed to change output rate");
+        return false;
+    }
+
+    tier_time_ms[tier] += now - tier_since;
+    tier_since = now;
+    tier = next;
+    transitions++;
+    return true;
+}
+
+uint64_t ImuRateGovernor::getTierTimeMs(Tier which) const {
+    uint64_t time = tier_time_ms[which];
+    if (which == tier && tier_since != 0) time += millis() - tier_since;
+    return time;
+}
@@ -0,0 +1,72 @@
+#pragma once
+#include <Arduino.h>
+
+#include "imu.hpp"
+#include "imu_pipeline.hpp"
+#include "../../logger/logger.hpp"
+
+/**
+ * Activity-aware IMU output rate governor.
+ *
+ * Watches the sample stream for activity (change of the acceleration
+ * magnitude against a slow baseline, plus rotation while the gyro is on)
+ * and switches the IMU between two tiers:
+ *
+ *  - STILL:  accelerometer only at the low-power ODR, gyro off
+ *  - ACTIVE: accelerometer + gyro at full rate
+ *
+ * Hysteresis: one sample above MOTION_THRESHOLD_G ramps up at once, while
+ * dropping back needs STILL_HOLD_MS below STILL_THRESHOLD_G (and no
+ * rotation). holdFullRate() keeps ACTIVE for a gesture window.
+ *
+ * process() only observes; update() applies tier changes from the main
+ * loop, outside of the pipeline dispatch.
+ */
+class ImuRateGovernor : public ImuStage {
+public:
+    enum Tier : uint8_t {
+        TIER_STILL = 0,
+        TIER_ACTIVE = 1,
+        TIER_COUNT
+    };
+
+private:
+    static constexpr float MOTION_THRESHOLD_G = 0.08f;
+    static constexpr float STILL_THRESHOLD_G = 0.03f;
+    static constexpr float STILL_GYRO_DPS = 8.0f;
+    static constexpr float BASELINE_ALPHA = 0.1f;
+    static constexpr uint32_t STILL_HOLD_MS = 3000;
+
+    struct State {
+        bool primed = false;
+        float baseline = 1.0f;
+        bool motion = false;            // Ramp-up requested since the last update()
+        uint32_t last_activity_ms = 0;
+    };
+
+    IMU& imu;
+    Logger* logger = nullptr;
+    State state;
+    Tier tier = TIER_ACTIVE;
+    unsigned long hold_until = 0;
+    unsigned long tier_since = 0;
+    uint64_t tier_time_ms[TIER_COUNT] = {0};
+    uint32_t transitions = 0;
+
+    bool setTier(Tier next, unsigned long now);
+
+public:
+    ImuRateGovernor(IMU& imu, Logger* logger) : imu(imu), logger(logger) {}
+
+    // ImuStage
+    const char* name() const override { return "rate"; }
+    void process(const ImuSample& sample) override;
+
+    void update(unsigned long now);
+    void holdFullRate(unsigned long duration_ms);
+
+    Tier getTier() const { return tier; }
+    static const char* tierName(Tier tier) { return tier == TIER_STILL ? "still" : "active"; }
+    uint64_t getTierTimeMs(Tier which) const;
+    uint32_t getTransitionCount() const { return transitions; }
+};
@@ -0,0 +1,77 @@
+#include "sample_window.hpp"
+
+void SampleWindow::push(const IMU::RawSample& sample) {
+    const int16_t* raw = &sample.ax;
+    for (size_t c = 0; c < CHANNELS; c++) {
+        data[c][head] = raw[c];
+    }
+    head = (head + 1) & (CAPACITY - 1);
+    if (count < CAPACITY) count++;
+    total++;
+}
+
+void SampleWindow::spans(size_t n, size_t& first, size_t& len1, size_t& len2) const {
+    if (n > count) n = count;
+    first = (head + CAPACITY - n) & (CAPACITY - 1);
+    len1 = (first + n <= CAPACITY) ? n : CAPACITY - first;
+    len2 = n - len1;
+}
+
+SampleWindow::Stats SampleWindow::stats(Channel channel, size_t n) const {
+    Stats result = {0.0f, 0.0f, 0, 0};
+    size_t first, len1, len2;
+    spans(n, first, len1, len2);
+    n = len1 + len2;
+    if (n == 0) return result;
+
+    const int16_t* v = data[channel];
+    int32_t sum = ImuKernels::sum(v + first, len1) + ImuKernels::sum(v, len2);
+    uint64_t sum_sq = ImuKernels::sumSquares(v + first, len1) + ImuKernels::sumSquares(v, len2);
+
+    int16_t min1, max1;
+    ImuKernels::minMax(v + first, len1, min1, max1);
+    if (len2 > 0) {
+        int16_t min2, max2;
+        ImuKernels::minMax(v, len2, min2, max2);
+        if (min2 < min1) min1 = min2;
+        if (max2 > max1) max1 = max2;
+    }
+
+    // n * sum_sq - sum^2 is exact in 64 bits (n <= CAPACITY); in float the two
+    // terms cancel and lose the variance of a channel sitting at 1g
+    result.mean = (float)sum / n;
+    result.variance = (float)((int64_t)(n * sum_sq) - (int64_t)sum * sum) / ((float)n * n);
+    result.min = min1;
+    result.max = max1;
+    return result;
+}
+
+float SampleWindow::meanSquareMagnitude(Channel first_axis, size_t n) const {
+    size_t first, len1, len2;
+    spans(n, first, len1, len2);
+    n = len1 + len2;
+    if (n == 0) return 0.0f;
+
+    const int16_t* x = data[first_axis];
+    const int16_t* y = data[first_axis + 1];
+    const int16_t* z = data[first_axis + 2];
+    uint64_t total = ImuKernels::sumMagnitudeSquared(x + first, y + first, z + first, len1) +
+                     ImuKernels::sumMagnitudeSquared(x, y, z, len2);
+    return (float)total / n;
+}
+
+size_t SampleWindow::copyScaled(Channel channel, size_t n, float scale, float* out) const {
+    size_t first, len1, len2;
+    spans(n, first, len1, len2);
+    ImuKernels::toFloat(data[channel] + first, out, len1, scale);
+    ImuKernels::toFloat(data[channel], out + len1, len2, scale);
+    return len1 + len2;
+}
+
+size_t SampleWindow::copyRaw(Channel channel, size_t n, int16_t* out) const {
+    size_t first, len1, len2;
+    spans(n, first, len1, len2);
+    memcpy(out, data[channel] + first, len1 * sizeof(int16_t));
+    memcpy(out + len1, data[channel], len2 * sizeof(int16_t));
+    return len1 + len2;
+}
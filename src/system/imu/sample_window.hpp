@@ -0,0 +1,60 @@
+#pragma once
+#include <Arduino.h>
+
+#include "imu.hpp"
+#include "imu_kernels.hpp"
+#include "imu_pipeline.hpp"
+
+/**
+ * Ring of the most recent raw samples in structure-of-arrays layout: one
+ * int16 array per axis, so window features run as batch kernels over
+ * contiguous memory (at most two spans when the ring wraps).
+ */
+class SampleWindow {
+public:
+    enum Channel : uint8_t { AX = 0, AY, AZ, GX, GY, GZ, CHANNELS };
+    static constexpr size_t CAPACITY = 128;  // ~1s at full rate
+
+    struct Stats {
+        float mean;
+        float variance;
+        int16_t min;
+        int16_t max;
+    };
+
+private:
+    static_assert((CAPACITY & (CAPACITY - 1)) == 0, "CAPACITY must be a power of two");
+
+    int16_t data[CHANNELS][CAPACITY] = {{0}};
+    size_t head = 0;       // Next write position
+    size_t count = 0;
+    uint32_t total = 0;
+
+    // Newest n samples as [first, first + len1) and [0, len2)
+    void spans(size_t n, size_t& first, size_t& len1, size_t& len2) const;
+
+public:
+    void push(const IMU::RawSample& sample);
+    void clear() { head = 0; count = 0; }
+
+    size_t size() const { return count; }
+    uint32_t getTotal() const { return total; }  // Samples pushed since boot
+
+    // Features over the newest n samples (clamped to size())
+    Stats stats(Channel channel, size_t n) const;
+    float meanSquareMagnitude(Channel first_axis, size_t n) const;  // Raw counts^2
+    size_t copyScaled(Channel channel, size_t n, float scale, float* out) const;
+    size_t copyRaw(Channel channel, size_t n, int16_t* out) const;  // Oldest first
+};
+
+// Pipeline stage feeding a shared window; add it before the stages that read it
+class ImuWindowStage : public ImuStage {
+private:
+    SampleWindow window;
+
+public:
+    const char* name() const override { return "window"; }
+    void process(const ImuSample& sample) override { window.push(sample.raw); }
+
+    const SampleWindow& getWindow() const { return window; }
+};
@@ -0,0 +1,126 @@
+#include "trace_recorder.hpp"
+
+bool TraceRecorder::start(const char* path, size_t max_bytes) {
+    if (recording) stop();
+    if (!fs.isInitialized()) return false;
+
+    file = fs.openFile(path, FILE_WRITE);
+    if (!file) return false;
+
+    ImuTrace::Header header;
+    header.accel_range_g = 8;
+    header.gyro_range_dps = 1024;
+    header.rate_hz = IMU::SAMPLE_RATE_HZ;
+    header.block_samples = BLOCK_SAMPLES;
+
+    uint8_t raw[ImuTrace::HEADER_BYTES];
+    ImuTrace::encodeHeader(header, raw);
+    if (file.write(raw, sizeof(raw)) != sizeof(raw)) {
+        file.close();
+        return false;
+    }
+
+    this->max_bytes = max_bytes;
+    count = 0;
+    event_count = 0;
+    stats = {};
+    stats.bytes = sizeof(raw);
+    recording = true;
+
+    if (logger != nullptr) logger->info("TRACE", (String("Recording IMU trace to ") + path).c_str());
+    return true;
+}
+
+void TraceRecorder::stop() {
+    if (!recording) return;
+
+    flushBlock();
+    file.close();
+    recording = false;
+
+    if (logger != nullptr) {
+        logger->info("TRACE", (String("Trace stopped: ") + String(stats.samples) + " samples, " +
+                               String(stats.bytes) + " bytes").c_str());
+    }
+}
+
+void TraceRecorder::process(const ImuSample& sample) {
+    if (!recording) return;
+
+    const int16_t* raw = &sample.raw.ax;
+    timestamps[count] = (uint32_t)sample.timestamp_us;  // Low 32 bits, see ImuTrace
+    for (size_t c = 0; c < ImuTrace::CHANNELS; c++) {
+        columns[c][count] = raw[c];
+    }
+    count++;
+    stats.samples++;
+
+    if (count == BLOCK_SAMPLES && !flushBlock()) {
+        if (logger != nullptr) logger->warn("TRACE", "Trace write failed - recording stopped");
+        file.close();
+        recording = false;
+    }
+}
+
+void TraceRecorder::recordEvent(ImuTrace::EventType type, int16_t a, int16_t b, int16_t c) {
+    if (!recording) return;
+
+    if (event_count == EVENT_SLOTS && !flushEvents()) {
+        if (logger != nullptr) logger->warn("TRACE", "Trace write failed - recording stopped");
+        file.close();
+        recording = false;
+        return;
+    }
+
+    ImuTrace::Event event = {type, (uint32_t)esp_timer_get_time(), a, b, c};
+    ImuTrace::encodeEvent(event, &events[event_count * ImuTrace::EVENT_BYTES]);
+    event_count++;
+    stats.events++;
+}
+
+bool TraceRecorder::flushBlock() {
+    if (!flushEvents()) return false;
+    if (count == 0) return true;
+
+    uint32_t start = ESP.getCycleCount();
+    const int16_t* channels[ImuTrace::CHANNELS];
+    for (size_t c = 0; c < ImuTrace::CHANNELS; c++) channels[c] = columns[c];
+    size_t len = ImuTrace::encodeBlock(timestamps, channels, count, block);
+    stats.encode_cycles += ESP.getCycleCount() - start;
+    count = 0;
+
+    if (!writeChecked(block, len)) return false;
+    if (recording) stats.blocks++;
+    return true;
+}
+
+bool TraceRecorder::flushEvents() {
+    if (event_count == 0) return true;
+
+    size_t len = event_count * ImuTrace::EVENT_BYTES;
+    event_count = 0;
+    return writeChecked(events, len);
+}
+
+// Returns false only on a failed write; hitting the size limit ends the recording
+bool TraceRecorder::writeChecked(const uint8_t* data, size_t len) {
+    if (!recording) return true;
+
+    if (stats.bytes + len > max_bytes) {
+        if (logger != nullptr) logger->info("TRACE", "Trace size limit reached - recording stopped");
+        file.close();
+        recording = false;
+        return true;
+    }
+
+    int64_t write_start = esp_timer_get_time();
+    bool ok = (file.write(data, len) == len);
+    uint32_t write_us = (uint32_t)(esp_timer_get_time() - write_start);
+
+    stats.write_us += write_us;
+    if (write_us > stats.max_write_us) stats.max_write_us = write_us;
+    if (!ok) return false;
+
+    stats.bytes += len;
+    return true;
+}
@@ -0,0 +1,73 @@
+#pragma once
+#include <Arduino.h>
+
+#include "imu_pipeline.hpp"
+#include "imu_trace.hpp"
+#include "../storage/fs_manager.hpp"
+#include "../../logger/logger.hpp"
+
+/**
+ * Records raw accel/gyro samples to LittleFS in the ImuTrace format.
+ *
+ * Samples are collected column-wise into one block (BLOCK_SAMPLES, ~1s at
+ * full rate), encoded and written with a single file write, so RAM use is
+ * fixed (~5KB) and the filesystem sees one write per block. Recording
+ * stops by itself at the size limit.
+ *
+ * Touch frames, button edges and RTC interrupts are captured alongside
+ * with recordEvent() and written in front of the next block, giving a
+ * complete input stream for tools/input_replay.cpp.
+ */
+class TraceRecorder : public ImuStage {
+public:
+    struct Stats {
+        uint32_t samples;
+        uint32_t events;
+        uint32_t blocks;
+        uint32_t bytes;          // Including file and block headers
+        uint64_t encode_cycles;
+        uint64_t write_us;
+        uint32_t max_write_us;
+    };
+
+private:
+    static constexpr size_t BLOCK_SAMPLES = 128;
+    static constexpr size_t BLOCK_BUFFER = ImuTrace::BLOCK_HEADER_BYTES + ImuTrace::maxPayloadBytes(BLOCK_SAMPLES);
+    static constexpr size_t EVENT_SLOTS = 16;
+
+    FSManager& fs;
+    Logger* logger = nullptr;
+    File file;
+    bool recording = false;
+    size_t max_bytes = 0;
+
+    uint32_t timestamps[BLOCK_SAMPLES];
+    int16_t columns[ImuTrace::CHANNELS][BLOCK_SAMPLES];
+    size_t count = 0;
+    uint8_t block[BLOCK_BUFFER];
+    uint8_t events[EVENT_SLOTS * ImuTrace::EVENT_BYTES];
+    size_t event_count = 0;
+
+    Stats stats = {};
+
+    bool flushBlock();
+    bool flushEvents();
+    bool writeChecked(const uint8_t* data, size_t len);
+
+public:
+    TraceRecorder(FSManager& fs, Logger* logger) : fs(fs), logger(logger) {}
+
+    bool start(const char* path, size_t max_bytes);
+    void stop();
+    bool isRecording() const { return recording; }
+
+    // Timestamped on the esp_timer clock, like the IMU samples
+    void recordEvent(ImuTrace::EventType type, int16_t a, int16_t b = 0, int16_t c = 0);
+
+    // ImuStage
+    const char* name() const override { return "recorder"; }
+    void process(const ImuSample& sample) override;
+
+    const Stats& getStats() const { return stats; }
+    float getBytesPerSample() const { return stats.samples ? (float)stats.bytes / stats.samples : 0.0f; }
+};
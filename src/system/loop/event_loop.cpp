@@ -0,0 +1,81 @@
+#include "event_loop.hpp"
+
+#include <esp_timer.h>
+
+TaskHandle_t EventLoop::task = nullptr;
+
+bool EventLoop::begin(uint32_t tick_ms) {
+    tick_timer = xTimerCreate("loop_tick", pdMS_TO_TICKS(tick_ms), pdTRUE, this, tickCallback);
+    if (tick_timer == nullptr) return false;
+
+    task = xTaskGetCurrentTaskHandle();
+    if (xTimerStart(tick_timer, 0) != pdPASS) {
+        task = nullptr;
+        return false;
+    }
+    resetStats(esp_timer_get_time());
+    post(EVENT_TICK);  // First pass runs at once and picks up anything flagged during init
+    return true;
+}
+
+void EventLoop::tickCallback(TimerHandle_t timer) {
+    (void)timer;
+    post(EVENT_TICK);
+}
+
+void EventLoop::post(uint32_t events) {
+    if (task != nullptr) xTaskNotify(task, events, eSetBits);
+}
+
+void IRAM_ATTR EventLoop::postFromISR(uint32_t events) {
+    if (task == nullptr) return;
+    BaseType_t woken = pdFALSE;
+    xTaskNotifyFromISR(task, events, eSetBits, &woken);
+    portYIELD_FROM_ISR(woken);
+}
+
+uint32_t EventLoop::wait(int64_t deadline_us) {
+    if (task == nullptr) return 0;
+
+    int64_t start = esp_timer_get_time();
+    int64_t timeout_us = deadline_us - start;
+    if (timeout_us < 0) timeout_us = 0;
+
+    // Round up: waking a tick early would only mean another wait
+    uint32_t tick_us = portTICK_PERIOD_MS * 1000;
+    TickType_t ticks = (timeout_us >= (int64_t)portMAX_DELAY * tick_us) ? portMAX_DELAY - 1
+                                                                        : (TickType_t)((timeout_us + tick_us - 1) / tick_us);
+
+    uint32_t events = 0;
+    xTaskNotifyWait(0, UINT32_MAX, &events, ticks);
+
+    stats.idle_us += esp_timer_get_time() - start;
+    stats.wakes++;
+    if (events == 0) stats.deadlines++;
+    for (uint8_t i = 0; i < EVENT_COUNT; i++) {
+        if (events & (1UL << i)) stats.events[i]++;
+    }
+    return events;
+}
+
+const char* EventLoop::eventName(Event event) {
+    switch (event) {
+        case EVENT_TOUCH: return "touch";
+        case EVENT_IMU: return "imu";
+        case EVENT_RTC: return "rtc";
+        case EVENT_BUTTON: return "button";
+        case EVENT_PMU: return "pmu";
+        case EVENT_TICK: return "tick";
+        default: return "?";
+    }
+}
+
+float EventLoop::getIdlePercent(int64_t now_us) const {
+    int64_t elapsed = now_us - stats.since_us;
+    return elapsed > 0 ? 100.0f * stats.idle_us / elapsed : 0.0f;
+}
+
+void EventLoop::resetStats(int64_t now_us) {
+    stats = {};
+    stats.since_us = now_us;
+}
@@ -0,0 +1,63 @@
+#pragma once
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/timers.h>
+
+/**
+ * Blocking wait for the main loop.
+ *
+ * Interrupt handlers (touch, IMU INT2, RTC, PMU, button) and a periodic
+ * software timer post event bits to the loop task's notification value.
+ * wait() blocks in xTaskNotifyWait() until a bit arrives or the caller's
+ * next deadline passes, so the core idles (and FreeRTOS can enter its
+ * idle hooks / automatic light sleep) instead of spinning through
+ * SystemManager::update().
+ *
+ * There is one loop task; post()/postFromISR() are static so drivers can
+ * signal it without a reference to the loop. Posting before begin() is a
+ * no-op. Idle time and wake causes are kept for the heartbeat.
+ */
+class EventLoop {
+public:
+    enum Event : uint32_t {
+        EVENT_TOUCH = 1 << 0,
+        EVENT_IMU = 1 << 1,
+        EVENT_RTC = 1 << 2,
+        EVENT_BUTTON = 1 << 3,
+        EVENT_PMU = 1 << 4,
+        EVENT_TICK = 1 << 5,        // Periodic housekeeping timer
+        EVENT_COUNT = 6
+    };
+
+    struct Stats {
+        uint32_t wakes;
+        uint32_t deadlines;                 // Woken by the timeout, not an event
+        uint32_t events[EVENT_COUNT];
+        uint64_t idle_us;
+        int64_t since_us;
+    };
+
+private:
+    static TaskHandle_t task;
+    TimerHandle_t tick_timer = nullptr;
+    Stats stats = {};
+
+    static void tickCallback(TimerHandle_t timer);
+
+public:
+    // Binds the loop to the calling task and starts the housekeeping tick
+    bool begin(uint32_t tick_ms);
+    bool isRunning() const { return task != nullptr; }
+
+    static void post(uint32_t events);
+    static void IRAM_ATTR postFromISR(uint32_t events);
+
+    // Blocks until an event or deadline_us (esp_timer time); returns the events
+    uint32_t wait(int64_t deadline_us);
+
+    static const char* eventName(Event event);
+    const Stats& getStats() const { return stats; }
+    float getIdlePercent(int64_t now_us) const;
+    void resetStats(int64_t now_us);
+};
@@ -0,0 +1,149 @@
+#include "energy_account.hpp"
+
+namespace {
+    // Nominal battery current per component (uA), used only to split measured steps
+    const uint32_t NOMINAL_UA[EnergyAccount::COMPONENT_COUNT] = {
+        30000,  // ESP32-S3 awake, peripherals polled
+        1500,   // Light sleep with IMU/RTC/touch powered
+        25000,  // AMOLED panel at typical content
+        20000,  // WiFi associated (modem sleep)
+    };
+
+    const char MAGIC[4] = {'N', 'R', 'G', 'A'};
+}
+
+const char* EnergyAccount::componentName(Component component) {
+    static const char* NAMES[COMPONENT_COUNT] = {"active", "sleep", "display", "wifi"};
+    return component < COMPONENT_COUNT ? NAMES[component] : "?";
+}
+
+float EnergyAccount::nominalCurrentMa(Component component) {
+    return component < COMPONENT_COUNT ? NOMINAL_UA[component] / 1000.0f : 0.0f;
+}
+
+void EnergyAccount::update(uint32_t now_ms, uint8_t next_state, const PMU::Telemetry& telemetry) {
+    if (started) {
+        uint32_t dt = now_ms - last_update_ms;
+        bool components[COMPONENT_COUNT] = {
+            !(state & STATE_SLEEP), (state & STATE_SLEEP) != 0,
+            (state & STATE_DISPLAY) != 0, (state & STATE_WIFI) != 0
+        };
+        for (size_t c = 0; c < COMPONENT_COUNT; c++) {
+            if (!components[c]) continue;
+            totals.time_ms[c] += dt;
+            window_charge[c] += (uint64_t)NOMINAL_UA[c] * dt;
+        }
+    }
+    started = true;
+    last_update_ms = now_ms;
+    state = next_state;
+
+    if (telemetry.valid && (!telemetry_seen || telemetry.timestamp_ms != telemetry_ms)) {
+        telemetry_seen = true;
+        telemetry_ms = telemetry.timestamp_ms;
+        onGauge(telemetry, now_ms);
+    }
+}
+
+void EnergyAccount::resetWindow(uint32_t now_ms) {
+    for (size_t c = 0; c < COMPONENT_COUNT; c++) window_charge[c] = 0;
+    window_start_ms = now_ms;
+}
+
+void EnergyAccount::onGauge(const PMU::Telemetry& telemetry, uint32_t now_ms) {
+    battery_percent = telemetry.battery_percent;
+
+    // Only discharge on battery is measured; charging restarts the reference
+    if (!telemetry.battery_present || telemetry.vbus_present || telemetry.charging) {
+        have_reference = false;
+        window_aligned = false;
+        resetWindow(now_ms);
+        return;
+    }
+    if (!have_reference || telemetry.battery_percent > reference_percent) {
+        have_reference = true;
+        window_aligned = false;
+        reference_percent = telemetry.battery_percent;
+        resetWindow(now_ms);
+        return;
+    }
+    if (telemetry.battery_percent == reference_percent) return;
+
+    uint8_t steps = reference_percent - telemetry.battery_percent;
+    float measured = steps * mwhPerPercent();
+
+    uint64_t modeled = 0;
+    for (size_t c = 0; c < COMPONENT_COUNT; c++) modeled += window_charge[c];
+    for (size_t c = 0; c < COMPONENT_COUNT; c++) {
+        totals.energy_mwh[c] += (modeled > 0) ? measured * ((float)window_charge[c] / (float)modeled)
+                                              : (c == COMPONENT_ACTIVE ? measured : 0.0f);
+    }
+    totals.measured_mwh += measured;
+    totals.gauge_steps += steps;
+
+    // The first window starts mid-step, so only later ones give a drain rate
+    uint32_t window_ms = now_ms - window_start_ms;
+    if (window_aligned && window_ms > 0) {
+        float mw = measured / (window_ms / 3600000.0f);
+        drain_mw = (drain_mw > 0.0f) ? drain_mw + (mw - drain_mw) * DRAIN_ALPHA : mw;
+    }
+    window_aligned = true;
+    reference_percent = telemetry.battery_percent;
+    resetWindow(now_ms);
+}
+
+float EnergyAccount::getModelPowerMw() const {
+    uint32_t ua = (state & STATE_SLEEP) ? NOMINAL_UA[COMPONENT_SLEEP] : NOMINAL_UA[COMPONENT_ACTIVE];
+    if (state & STATE_DISPLAY) ua += NOMINAL_UA[COMPONENT_DISPLAY];
+    if (state & STATE_WIFI) ua += NOMINAL_UA[COMPONENT_WIFI];
+    return ua / 1000.0f * (BATTERY_NOMINAL_MV / 1000.0f);
+}
+
+float EnergyAccount::getTimeToEmptyHours() const {
+    if (!have_reference) return -1.0f;  // On external power or no gauge reading yet
+    float mw = (drain_mw > 0.0f) ? drain_mw : getModelPowerMw();
+    return mw > 0.0f ? battery_percent * mwhPerPercent() / mw : -1.0f;
+}
+
+bool EnergyAccount::load(FSManager& fs, const char* path) {
+    if (!fs.isInitialized() || !fs.exists(path)) return false;
+
+    File file = fs.openFile(path, FILE_READ);
+    if (!file) return false;
+
+    uint8_t header[sizeof(MAGIC) + 1];
+    Totals stored;
+    bool ok = file.read(header, sizeof(header)) == sizeof(header) &&
+              memcmp(header, MAGIC, sizeof(MAGIC)) == 0 && header[sizeof(MAGIC)] == FILE_VERSION &&
+              file.read((uint8_t*)&stored, sizeof(stored)) == sizeof(stored);
+    file.close();
+
+    if (!ok) {
+        if (logger != nullptr) logger->warn("ENERGY", (String("Ignoring invalid totals in ") + path).c_str());
+        return false;
+    }
+    totals = stored;
+    if (logger != nullptr) {
+        logger->info("ENERGY", (String("Restored totals: ") + String(totals.measured_mwh, 1) + " mWh over " +
+                                String(totals.gauge_steps) + " gauge steps").c_str());
+    }
+    return true;
+}
+
+bool EnergyAccount::save(FSManager& fs, const char* path, uint32_t now_ms) {
+    last_save_ms = now_ms;
+    if (!fs.isInitialized()) return false;
+
+    File file = fs.openFile(path, FILE_WRITE);
+    if (!file) return false;
+
+    uint8_t header[sizeof(MAGIC) + 1];
+    memcpy(header, MAGIC, sizeof(MAGIC));
+    header[sizeof(MAGIC)] = FILE_VERSION;
+    bool ok = file.write(header, sizeof(header)) == sizeof(header) &&
+              file.write((const uint8_t*)&totals, sizeof(totals)) == sizeof(totals);
+    file.close();
+
+    if (!ok && logger != nullptr) logger->warn("ENERGY", (String("Failed to save totals to ") + path).c_str());
+    return ok;
+}
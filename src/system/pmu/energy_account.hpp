@@ -0,0 +1,100 @@
+#pragma once
+#include <Arduino.h>
+
+#include "config.h"
+#include "pmu.hpp"
+#include "../storage/fs_manager.hpp"
+#include "../../logger/logger.hpp"
+
+/**
+ * Battery energy accounting by power consumer.
+ *
+ * The AXP2101 has no readable coulomb counter, only a 1% fuel gauge, so
+ * energy is measured in gauge steps (BATTERY_CAPACITY_MAH at
+ * BATTERY_NOMINAL_MV per 100%) while running on battery. Between two steps
+ * the time spent in each component (CPU active or light-sleeping, display
+ * on, WiFi on) is weighted by a nominal current per component; the
+ * measured step is split over the components in proportion to that
+ * modeled charge.
+ *
+ * The drain rate is smoothed over gauge steps; until the first full step
+ * time-to-empty falls back to the model. Totals survive reboots through
+ * save()/load().
+ */
+class EnergyAccount {
+public:
+    enum Component : uint8_t {
+        COMPONENT_ACTIVE = 0,   // CPU awake
+        COMPONENT_SLEEP,        // CPU in light sleep
+        COMPONENT_DISPLAY,      // Panel on
+        COMPONENT_WIFI,         // Radio on
+        COMPONENT_COUNT
+    };
+
+    // State flags passed to update(); CPU active unless STATE_SLEEP
+    enum State : uint8_t {
+        STATE_SLEEP = 1 << 0,
+        STATE_DISPLAY = 1 << 1,
+        STATE_WIFI = 1 << 2
+    };
+
+    // Persisted running totals
+    struct Totals {
+        uint64_t time_ms[COMPONENT_COUNT];
+        float energy_mwh[COMPONENT_COUNT];
+        float measured_mwh;
+        uint32_t gauge_steps;
+    };
+
+private:
+    static constexpr float DRAIN_ALPHA = 0.3f;                  // Smoothing per gauge step
+    static constexpr uint32_t SAVE_INTERVAL_MS = 15 * 60000UL;  // Flash writes at most this often
+    static constexpr uint8_t FILE_VERSION = 1;
+
+    Logger* logger = nullptr;
+    Totals totals = {};
+
+    uint8_t state = 0;
+    bool started = false;
+    uint32_t last_update_ms = 0;
+
+    // Current gauge window (since the last step on battery)
+    uint64_t window_charge[COMPONENT_COUNT] = {0};  // Modeled uA*ms
+    bool have_reference = false;
+    bool window_aligned = false;                    // Window started on a gauge step
+    uint8_t reference_percent = 0;
+    uint32_t window_start_ms = 0;
+    bool telemetry_seen = false;
+    uint32_t telemetry_ms = 0;
+    uint8_t battery_percent = 0;
+
+    float drain_mw = 0.0f;                          // Smoothed measured drain, 0 until measured
+    uint32_t last_save_ms = 0;
+
+    void resetWindow(uint32_t now_ms);
+    void onGauge(const PMU::Telemetry& telemetry, uint32_t now_ms);
+
+public:
+    EnergyAccount(Logger* logger) : logger(logger) {}
+
+    // Charge the time since the previous call to the previous state, then
+    // switch to `state`; picks up new PMU snapshots
+    void update(uint32_t now_ms, uint8_t state, const PMU::Telemetry& telemetry);
+
+    static const char* componentName(Component component);
+    static float nominalCurrentMa(Component component);
+    static float mwhPerPercent() { return BATTERY_CAPACITY_MAH * (BATTERY_NOMINAL_MV / 1000.0f) / 100.0f; }
+
+    const Totals& getTotals() const { return totals; }
+    // Measured drain (smoothed), or 0 before the first full gauge step
+    float getDrainMw() const { return drain_mw; }
+    // Model estimate for the current state
+    float getModelPowerMw() const;
+    // Hours left at the measured (else modeled) drain; negative if unknown
+    float getTimeToEmptyHours() const;
+
+    // Persistence (LittleFS)
+    bool load(FSManager& fs, const char* path);
+    bool save(FSManager& fs, const char* path, uint32_t now_ms);
+    bool isSaveDue(uint32_t now_ms) const { return now_ms - last_save_ms >= SAVE_INTERVAL_MS; }
+};
@@ -1,4 +1,37 @@
 #include "pmu.hpp"
+#include "../loop/event_loop.hpp"
+
+namespace {
+    // ADC results are high byte first; VBAT has 13 bits, the rest 14
+    uint16_t adcValue(const uint8_t* data, uint8_t high_mask = 0x3F) {
+        return (uint16_t)(((data[0] & high_mask) << 8) | data[1]);
+    }
+
+    // IRQ_STATUS_n bit -> event
+    struct IrqSource {
+        uint8_t index;
+        uint8_t bit;
+        PMU::Event event;
+    };
+
+    const IrqSource IRQ_SOURCES[] = {
+        {0, 6, PMU::EVENT_BATTERY_LOW},
+        {0, 7, PMU::EVENT_BATTERY_CRITICAL},
+        {1, 2, PMU::EVENT_KEY_LONG},
+        {1, 3, PMU::EVENT_KEY_SHORT},
+        {1, 4, PMU::EVENT_BATTERY_REMOVE},
+        {1, 5, PMU::EVENT_BATTERY_INSERT},
+        {1, 6, PMU::EVENT_VBUS_REMOVE},
+        {1, 7, PMU::EVENT_VBUS_INSERT},
+        {2, 2, PMU::EVENT_OVER_TEMP},
+        {2, 3, PMU::EVENT_CHARGE_START},
+        {2, 4, PMU::EVENT_CHARGE_DONE},
+    };
+
+    // Events that change what the telemetry snapshot reports
+    const uint16_t TELEMETRY_EVENTS = PMU::EVENT_VBUS_INSERT | PMU::EVENT_VBUS_REMOVE | PMU::EVENT_BATTERY_INSERT |
+                                      PMU::EVENT_BATTERY_REMOVE | PMU::EVENT_CHARGE_START | PMU::EVENT_CHARGE_DONE;
+}
 
 bool PMU::setBus(TwoWire &wire) {
     logger->debug("PMU", "Starting AXP2101 initialization...");
@@ -7,8 +40,161 @@ bool PMU::setBus(TwoWire &wire) {
         initialized = false;
         return false;
     }
+    device.setBus(wire);
+
+    // Battery voltage and die temperature are on by default; add VBUS and VSYS
+    using namespace AXP2101;
+    uint8_t channels = AdcEnable_Vbat::encode(1) | AdcEnable_Vbus::encode(1) |
+                       AdcEnable_Vsys::encode(1) | AdcEnable_Tdie::encode(1);
+    if (!device.modify<AdcEnable>(channels, 0x00)) {
+        logger->warn("PMU", "Failed to enable ADC channels");
+    }
 
-    logger->success("PMU", "AXP2101 initialized successfully");
     initialized = true;
+    refresh_requested = true;
+    if (!setupInterrupts()) {
+        logger->warn("PMU", "Failed to configure IRQs - power events unavailable");
+    }
+
+    logger->success("PMU", "AXP2101 initialized successfully");
+    return true;
+}
+
+bool PMU::setupInterrupts() {
+    using namespace AXP2101;
+
+    // Enable only the sources that map to events, then drop anything latched before boot
+    uint8_t enable[IRQ_BLOCK_LEN] = {0};
+    for (const IrqSource& source : IRQ_SOURCES) enable[source.index] |= (uint8_t)(1 << source.bit);
+    uint8_t clear[IRQ_BLOCK_LEN] = {0xFF, 0xFF, 0xFF};
+    if (!device.writeBlock(IrqEnable0::address, enable, sizeof(enable)) ||
+        !device.writeBlock(IrqStatus0::address, clear, sizeof(clear))) {
+        return false;
+    }
+
+#if PMU_INT >= 0
+    pinMode(PMU_INT, INPUT_PULLUP);
+    attachInterruptArg(digitalPinToInterrupt(PMU_INT), PMU::isrArg, this, FALLING);
+#endif
+    return true;
+}
+
+void IRAM_ATTR PMU::isrArg(void* arg) {
+    PMU* self = static_cast<PMU*>(arg);
+    if (self) {
+        // Status registers need I2C: only note the edge here, decode in handleInterrupt()
+        self->interrupt_pending = true;
+        EventLoop::postFromISR(EventLoop::EVENT_PMU);
+    }
+}
+
+bool PMU::handleInterrupt() {
+#if PMU_INT < 0
+    // No IRQ line: one status read per PMU_IRQ_POLL_MS instead of an edge
+    uint32_t now = millis();
+    if (now - last_irq_poll_ms >= PMU_IRQ_POLL_MS) {
+        last_irq_poll_ms = now;
+        interrupt_pending = true;
+    }
+#endif
+    if (!interrupt_pending || !initialized) return false;
+    interrupt_pending = false;
+
+    using namespace AXP2101;
+    uint8_t status[IRQ_BLOCK_LEN];
+    if (!device.readBlock(IrqStatus0::address, status, sizeof(status))) {
+        interrupt_pending = true;  // Retry on the next loop
+        return false;
+    }
+    if ((status[0] | status[1] | status[2]) == 0) return false;
+
+    // W1C: writing back what was read clears exactly those bits
+    if (!device.writeBlock(IrqStatus0::address, status, sizeof(status))) {
+        interrupt_pending = true;
+    }
+#if PMU_INT >= 0
+    // A source raised while clearing keeps the line low without a new edge
+    if (digitalRead(PMU_INT) == LOW) interrupt_pending = true;
+#endif
+
+    uint16_t events = 0;
+    for (const IrqSource& source : IRQ_SOURCES) {
+        if (status[source.index] & (1 << source.bit)) events |= source.event;
+    }
+    irq_count++;
+    if (events & TELEMETRY_EVENTS) refresh_requested = true;
+    pending_events |= events;
+    return events != 0;
+}
+
+const char* PMU::eventName(Event event) {
+    switch (event) {
+        case EVENT_VBUS_INSERT: return "USB inserted";
+        case EVENT_VBUS_REMOVE: return "USB removed";
+        case EVENT_BATTERY_INSERT: return "battery inserted";
+        case EVENT_BATTERY_REMOVE: return "battery removed";
+        case EVENT_CHARGE_START: return "charging started";
+        case EVENT_CHARGE_DONE: return "charging done";
+        case EVENT_KEY_SHORT: return "power key short press";
+        case EVENT_KEY_LONG: return "power key long press";
+        case EVENT_BATTERY_LOW: return "battery low";
+        case EVENT_BATTERY_CRITICAL: return "battery critical";
+        case EVENT_OVER_TEMP: return "over temperature";
+        default: return "?";
+    }
+}
+
+uint32_t PMU::getTelemetryInterval() const {
+    bool external = telemetry.vbus_present || telemetry.charging;
+    return external ? PMU_TELEMETRY_CHARGING_MS : PMU_TELEMETRY_BATTERY_MS;
+}
+
+bool PMU::update(uint32_t now_ms) {
+    if (!initialized) return false;
+
+    // Schedule from the last attempt so a failing bus is not retried every loop
+    if (!refresh_requested && samples + failures > 0 && now_ms - last_attempt_ms < getTelemetryInterval()) {
+        return false;
+    }
+    last_attempt_ms = now_ms;
+    refresh_requested = false;
+
+    if (!sampleTelemetry(now_ms)) {
+        failures++;
+        return false;
+    }
+    samples++;
+    return true;
+}
+
+bool PMU::sampleTelemetry(uint32_t now_ms) {
+    using namespace AXP2101;
+    uint8_t status[2];
+    uint8_t adc[ADC_BLOCK_LEN];
+    uint8_t percent = 0;
+
+    if (!device.readBlock(Status1::address, status, sizeof(status))) return false;
+    if (!device.readBlock(VbatHigh::address, adc, sizeof(adc))) return false;
+
+    Telemetry next;
+    next.battery_present = Status1_BatteryPresent::decode(status[0]);
+    // Same test as XPowersLib isVbusIn()
+    next.vbus_present = Status1_VbusGood::decode(status[0]) && !Status2_VbusLimited::decode(status[1]);
+    next.charging = Status2_Direction::decode(status[1]) == 1;
+    next.charge_phase = Status2_ChargePhase::decode(status[1]);
+
+    // The fuel gauge and VBAT are meaningless without a battery
+    if (next.battery_present) {
+        if (!device.read<BatteryPercent>(percent)) return false;
+        next.battery_percent = percent;
+        next.battery_mv = adcValue(&adc[0], 0x1F);
+    }
+    if (next.vbus_present) next.vbus_mv = adcValue(&adc[4]);
+    next.system_mv = adcValue(&adc[6]);
+    next.die_temp_c10 = (int16_t)(220 + (7274 - (int32_t)adcValue(&adc[8])) / 2);  // 22 °C + (7274 - raw) / 20
+
+    next.valid = true;
+    next.timestamp_ms = now_ms;
+    telemetry = next;
     return true;
 }
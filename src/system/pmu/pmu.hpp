@@ -4,36 +4,134 @@
 #include "XPowersAXP2101.tpp"
 
 #include "../../logger/logger.hpp"
+#include "../bus/i2c_device.hpp"
+
+// AXP2101 registers used for telemetry (XPowersLib handles the rest)
+namespace AXP2101 {
+    using Status1 = Register<0x00, RegAccess::RO>;
+    using Status2 = Register<0x01, RegAccess::RO>;
+    using AdcEnable = Register<0x30>;
+    using IrqEnable0 = Register<0x40>;                  // IRQ_ENABLE_0..2 (0x40..0x42), same bits as IRQ_STATUS_0..2
+    using IrqStatus0 = Register<0x48, RegAccess::W1C>;  // IRQ_STATUS_0..2 (0x48..0x4A)
+    using VbatHigh = Register<0x34, RegAccess::RO>;     // 0x34..0x3D: VBAT, TS, VBUS, VSYS, TDIE (high byte first)
+    using BatteryPercent = Register<0xA4, RegAccess::RO>;
+
+    // STATUS_1
+    using Status1_VbusGood = Field<Status1, 5, 1>;
+    using Status1_BatteryPresent = Field<Status1, 3, 1>;
+
+    // STATUS_2
+    using Status2_Direction = Field<Status2, 5, 2>;     // 0 = standby, 1 = charging, 2 = discharging
+    using Status2_VbusLimited = Field<Status2, 3, 1>;
+    using Status2_ChargePhase = Field<Status2, 0, 3>;   // 0 trickle, 1 pre, 2 CC, 3 CV, 4 done, 5 off
+
+    // ADC_CHANNEL_CTRL
+    using AdcEnable_Vbat = Field<AdcEnable, 0, 1>;
+    using AdcEnable_Vbus = Field<AdcEnable, 2, 1>;
+    using AdcEnable_Vsys = Field<AdcEnable, 3, 1>;
+    using AdcEnable_Tdie = Field<AdcEnable, 4, 1>;
+
+    static constexpr size_t ADC_BLOCK_LEN = 10;
+    static constexpr size_t IRQ_BLOCK_LEN = 3;
+}
 
 class PMU {
+public:
+    // Power events decoded from the IRQ status registers (bit mask)
+    enum Event : uint16_t {
+        EVENT_VBUS_INSERT = 1 << 0,
+        EVENT_VBUS_REMOVE = 1 << 1,
+        EVENT_BATTERY_INSERT = 1 << 2,
+        EVENT_BATTERY_REMOVE = 1 << 3,
+        EVENT_CHARGE_START = 1 << 4,
+        EVENT_CHARGE_DONE = 1 << 5,
+        EVENT_KEY_SHORT = 1 << 6,
+        EVENT_KEY_LONG = 1 << 7,
+        EVENT_BATTERY_LOW = 1 << 8,         // Fuel gauge warning level 1
+        EVENT_BATTERY_CRITICAL = 1 << 9,    // Fuel gauge warning level 2
+        EVENT_OVER_TEMP = 1 << 10,          // Die over temperature
+        EVENT_COUNT = 11
+    };
+
+    /**
+     * Power telemetry snapshot.
+     *
+     * Refreshed by update() with three block reads (status, ADC results,
+     * fuel gauge) instead of one XPowersLib transaction per value; reading
+     * it costs no bus time. timestamp_ms is the millis() of the read.
+     */
+    struct Telemetry {
+        bool valid = false;
+        uint32_t timestamp_ms = 0;
+        bool battery_present = false;
+        bool vbus_present = false;
+        bool charging = false;
+        uint8_t charge_phase = 0;
+        uint8_t battery_percent = 0;
+        uint16_t battery_mv = 0;
+        uint16_t vbus_mv = 0;
+        uint16_t system_mv = 0;
+        int16_t die_temp_c10 = 0;   // 0.1 °C
+    };
+
+    static constexpr uint8_t ADDR_AXP2101 = 0x34;
+
 private:
     Logger* logger = nullptr;
     XPowersAXP2101 pmu;
-    uint8_t pmuAddress = 0x34;
+    uint8_t pmuAddress = ADDR_AXP2101;
     bool initialized = false;
+
+    // Telemetry register access; only the ADC enable register is cached
+    I2CRegisterDevice<ADDR_AXP2101, AXP2101::AdcEnable::address, AXP2101::AdcEnable::address> device;
+    Telemetry telemetry;
+    uint32_t last_attempt_ms = 0;
+    bool refresh_requested = true;
+    uint32_t samples = 0;
+    uint32_t failures = 0;
+
+    // IRQ line (PMU_INT), or a slow poll of the status registers without one
+    volatile bool interrupt_pending = false;
+    uint16_t pending_events = 0;
+    uint32_t last_irq_poll_ms = 0;
+    uint32_t irq_count = 0;
+
+    bool sampleTelemetry(uint32_t now_ms);
+    bool setupInterrupts();
+    static void IRAM_ATTR isrArg(void* arg);
+
 public:
-    PMU(Logger *logger) { this->logger = logger; };
+    PMU(Logger *logger) : logger(logger), device(logger, "PMU") {}
     bool setBus(TwoWire &wire);
-    
+
     bool isInitialized() const { return initialized; }
-    
-    bool isBatteryConnect() {
-        return initialized ? pmu.isBatteryConnect() : false;
-    }
-    
-    bool isCharging() {
-        return initialized ? pmu.isCharging() : false;
-    }
-    
-    bool isUSBConnected() {
-        return initialized ? pmu.isVbusIn() : false;
-    }
-    
-    uint8_t getBatteryPercent() {
-        return initialized ? pmu.getBatteryPercent() : 0;
-    }
-    
-    uint16_t getBattVoltage() {
-        return initialized ? pmu.getBattVoltage() : 0;
-    }
-};
\ No newline at end of file
+
+    // Refreshes the snapshot when it is older than the current interval
+    // (PMU_TELEMETRY_CHARGING_MS on external power, PMU_TELEMETRY_BATTERY_MS
+    // otherwise). Returns true if a new snapshot was read.
+    bool update(uint32_t now_ms);
+    // Read on the next update() regardless of age (e.g. after a power event)
+    void requestTelemetry() { refresh_requested = true; }
+
+    const Telemetry& getTelemetry() const { return telemetry; }
+    uint32_t getTelemetryAgeMs(uint32_t now_ms) const { return telemetry.valid ? now_ms - telemetry.timestamp_ms : UINT32_MAX; }
+    uint32_t getTelemetryInterval() const;
+    uint32_t getSampleCount() const { return samples; }
+    uint32_t getFailureCount() const { return failures; }
+    uint32_t getTransactionCount() const { return device.getTransactionCount(); }
+
+    // Deferred interrupt handler (main loop): reads IRQ_STATUS_0..2 in one
+    // transaction, clears exactly the bits it saw and queues their events.
+    // Returns true if new events are waiting in takeEvents().
+    bool handleInterrupt();
+    uint16_t takeEvents() { uint16_t events = pending_events; pending_events = 0; return events; }
+    static const char* eventName(Event event);
+    uint32_t getIrqCount() const { return irq_count; }
+
+    // Values from the last snapshot
+    bool isBatteryConnect() const { return telemetry.battery_present; }
+    bool isCharging() const { return telemetry.charging; }
+    bool isUSBConnected() const { return telemetry.vbus_present; }
+    uint8_t getBatteryPercent() const { return telemetry.battery_percent; }
+    uint16_t getBattVoltage() const { return telemetry.battery_mv; }
+};
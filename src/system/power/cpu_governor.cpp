@@ -0,0 +1,79 @@
+#include "cpu_governor.hpp"
+
+namespace {
+    // How long each hint keeps the boost clock
+    const unsigned long HOLD_MS[CpuGovernor::HINT_COUNT] = {
+        50,     // Render: covers one clock frame
+        500,    // Input: follow-up frames and gesture handling
+        300,    // Transition: panel power-up and first redraw
+    };
+}
+
+bool CpuGovernor::begin() {
+    level_since = millis();
+#if CPU_GOVERNOR
+#if CONFIG_PM_ENABLE
+    esp_pm_config_t config = {};
+    config.max_freq_mhz = CPU_FREQ_BOOST_MHZ;
+    config.min_freq_mhz = CPU_FREQ_IDLE_MHZ;
+    config.light_sleep_enable = CPU_AUTO_LIGHT_SLEEP;
+    if (esp_pm_configure(&config) != ESP_OK ||
+        esp_pm_lock_create(ESP_PM_CPU_FREQ_MAX, 0, "cpu_boost", &boost_lock) != ESP_OK) {
+        if (logger != nullptr) logger->warn("CPU", "esp_pm unavailable - frequency scaling disabled");
+        return false;
+    }
+    esp_pm_lock_acquire(boost_lock);  // Matches the boot clock (LEVEL_BOOST)
+#endif
+    enabled = true;
+    if (logger != nullptr) {
+        logger->info("CPU", (String("Frequency scaling ") + String(CPU_FREQ_IDLE_MHZ) + "/" + String(CPU_FREQ_BOOST_MHZ) +
+                             " MHz").c_str());
+    }
+#endif
+    return enabled;
+}
+
+void CpuGovernor::hint(Hint which, unsigned long now) {
+    hints[which]++;
+    if (!enabled) return;
+
+    unsigned long until = now + HOLD_MS[which];
+    if (level != LEVEL_BOOST || (long)(until - boost_until) > 0) boost_until = until;
+    if (level != LEVEL_BOOST) setLevel(LEVEL_BOOST, now);
+}
+
+void CpuGovernor::update(unsigned long now) {
+    if (!enabled) return;
+    if (level == LEVEL_BOOST && (long)(now - boost_until) >= 0) setLevel(LEVEL_IDLE, now);
+}
+
+void CpuGovernor::recordFrame(uint32_t render_us) {
+    frame_us[level] += render_us;
+    frames[level]++;
+}
+
+bool CpuGovernor::setLevel(Level next, unsigned long now) {
+    int64_t start = esp_timer_get_time();
+#if CONFIG_PM_ENABLE
+    bool ok = (next == LEVEL_BOOST ? esp_pm_lock_acquire(boost_lock) : esp_pm_lock_release(boost_lock)) == ESP_OK;
+#else
+    bool ok = setCpuFrequencyMhz(levelMhz(next));
+#endif
+    switch_us += (uint32_t)(esp_timer_get_time() - start);
+    if (!ok) {
+        if (logger != nullptr) logger->warn("CPU", (String("Failed to switch to ") + String(levelMhz(next)) + " MHz").c_str());
+        return false;
+    }
+
+    level_time_ms[level] += now - level_since;
+    level_since = now;
+    level = next;
+    transitions++;
+    return true;
+}
+
+uint64_t CpuGovernor::getLevelTimeMs(Level which) const {
+    uint64_t total = level_time_ms[which];
+    if (which == level) total += millis() - level_since;
+    return total;
+}
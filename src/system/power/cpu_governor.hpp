@@ -0,0 +1,83 @@
+#pragma once
+#include <Arduino.h>
+#include <esp_pm.h>
+#include <esp_timer.h>
+
+#include "config.h"
+#include "../../logger/logger.hpp"
+
+/**
+ * Hint-driven CPU frequency policy.
+ *
+ * The loop spends most of its time polling sensors and waiting on I2C,
+ * which runs the same at CPU_FREQ_IDLE_MHZ (the APB and I2C clocks do not
+ * change at 80MHz and above). Rendering and input handling raise the clock
+ * to CPU_FREQ_BOOST_MHZ for a hold time per hint; update() drops back once
+ * every hold has expired.
+ *
+ * With CONFIG_PM_ENABLE the range is handed to esp_pm and BOOST holds an
+ * ESP_PM_CPU_FREQ_MAX lock; otherwise the clock is set directly.
+ * CPU_AUTO_LIGHT_SLEEP additionally lets esp_pm light-sleep while every
+ * task is blocked (the main loop waits in EventLoop::wait()).
+ *
+ * Time at each level and frame render times per level are kept for the
+ * heartbeat.
+ */
+class CpuGovernor {
+public:
+    enum Hint : uint8_t {
+        HINT_RENDER = 0,        // A frame is about to be drawn
+        HINT_INPUT,             // Touch/button/gesture: more frames likely
+        HINT_TRANSITION,        // Screen on/off or page change
+        HINT_COUNT
+    };
+
+    enum Level : uint8_t {
+        LEVEL_IDLE = 0,
+        LEVEL_BOOST = 1,
+        LEVEL_COUNT
+    };
+
+private:
+    Logger* logger = nullptr;
+    bool enabled = false;
+    Level level = LEVEL_BOOST;      // Boot clock
+    unsigned long boost_until = 0;
+    unsigned long level_since = 0;
+    uint64_t level_time_ms[LEVEL_COUNT] = {0};
+    uint32_t transitions = 0;
+    uint32_t hints[HINT_COUNT] = {0};
+    uint32_t switch_us = 0;         // Total time spent changing the clock
+    uint64_t frame_us[LEVEL_COUNT] = {0};
+    uint32_t frames[LEVEL_COUNT] = {0};
+#if CONFIG_PM_ENABLE
+    esp_pm_lock_handle_t boost_lock = nullptr;
+#endif
+
+    bool setLevel(Level next, unsigned long now);
+
+public:
+    CpuGovernor(Logger* logger) : logger(logger) {}
+
+    bool begin();
+    bool isEnabled() const { return enabled; }
+
+    void hint(Hint hint, unsigned long now);
+    void update(unsigned long now);
+    void recordFrame(uint32_t render_us);
+
+    Level getLevel() const { return level; }
+    // millis() time at which update() drops to IDLE; false when not boosted
+    bool nextIdleDue(unsigned long& due_ms) const {
+        if (!enabled || level != LEVEL_BOOST) return false;
+        due_ms = boost_until;
+        return true;
+    }
+    static uint32_t levelMhz(Level level) { return level == LEVEL_IDLE ? CPU_FREQ_IDLE_MHZ : CPU_FREQ_BOOST_MHZ; }
+    uint64_t getLevelTimeMs(Level which) const;
+    uint32_t getTransitionCount() const { return transitions; }
+    uint32_t getHintCount(Hint which) const { return hints[which]; }
+    uint32_t getSwitchTimeUs() const { return switch_us; }
+    uint32_t getFrameCount(Level which) const { return frames[which]; }
+    uint32_t getAverageFrameUs(Level which) const { return frames[which] ? (uint32_t)(frame_us[which] / frames[which]) : 0; }
+};
@@ -0,0 +1,37 @@
+#include "retained_state.hpp"
+
+#include <cstddef>
+#include <cstring>
+
+RTC_DATA_ATTR RetainedState::Data RetainedState::data;
+
+uint32_t RetainedState::computeChecksum(const Data& record) {
+    // FNV-1a over everything before the checksum field
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&record);
+    uint32_t hash = 2166136261UL;
+    for (size_t i = 0; i < offsetof(Data, checksum); i++) {
+        hash = (hash ^ bytes[i]) * 16777619UL;
+    }
+    return hash;
+}
+
+bool RetainedState::isValid() {
+    if (esp_reset_reason() != ESP_RST_DEEPSLEEP) return false;
+    return data.magic == MAGIC && data.version == VERSION && data.checksum == computeChecksum(data);
+}
+
+void RetainedState::reset() {
+    memset(&data, 0, sizeof(data));
+    data.magic = MAGIC;
+    data.version = VERSION;
+}
+
+void RetainedState::seal() {
+    data.checksum = computeChecksum(data);
+}
+
+uint8_t RetainedState::deviceCount() {
+    uint8_t count = 0;
+    for (uint8_t i = 0; i < 4; i++) count += __builtin_popcount(data.i2c_map[i]);
+    return count;
+}
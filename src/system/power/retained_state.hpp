@@ -0,0 +1,70 @@
+#pragma once
+#include <Arduino.h>
+
+/**
+ * State carried across deep sleep in RTC slow memory.
+ *
+ * Deep sleep powers down the CPU and main SRAM but keeps the RTC domain,
+ * so one RTC_DATA_ATTR record survives it (a reset or power cycle does
+ * not keep it). It holds what the cold boot path rebuilds slowly:
+ * - the I2C device map from the bus scan
+ * - the time service drift estimate and the last NTP sync
+ * - the WiFi access point, so it can reconnect without a scan
+ * - the screen brightness
+ * - the cold boot's first-frame time, as the reference for the resume
+ *   report
+ *
+ * seal() checksums the record just before esp_deep_sleep_start().
+ * isValid() accepts it only after a deep sleep reset.
+ */
+class RetainedState {
+public:
+    struct Data {
+        uint32_t magic;
+        uint8_t version;
+        uint32_t resumes;               // Deep sleep resumes since the cold boot
+
+        // Time
+        int32_t rate_ppb;               // TimeService drift correction
+        int64_t last_ntp_local_s;       // 0 = never synced
+
+        // WiFi
+        bool wifi_valid;
+        uint8_t wifi_index;             // WIFI_CREDENTIALS entry
+        uint8_t wifi_channel;
+        uint8_t wifi_bssid[6];
+
+        // I2C scan: one bit per 7-bit address
+        uint32_t i2c_map[4];
+
+        // Screen
+        uint8_t brightness;             // Last applied; 0 = not set
+
+        // Cold boot reference for the resume report
+        uint32_t cold_first_frame_us;
+
+        uint32_t checksum;
+    };
+
+private:
+    static constexpr uint32_t MAGIC = 0x52544D31;  // "RTM1"
+    static constexpr uint8_t VERSION = 1;
+
+    static Data data;
+
+    static uint32_t computeChecksum(const Data& record);
+
+public:
+    // True after a deep sleep reset with a sealed record
+    static bool isValid();
+    // Cold boot: empty record
+    static void reset();
+    // Before esp_deep_sleep_start()
+    static void seal();
+
+    static Data& get() { return data; }
+
+    static void markDevice(uint8_t address) { data.i2c_map[address >> 5] |= 1UL << (address & 31); }
+    static bool hasDevice(uint8_t address) { return data.i2c_map[address >> 5] & (1UL << (address & 31)); }
+    static uint8_t deviceCount();
+};
@@ -0,0 +1,102 @@
+#include "wake_sources.hpp"
+
+namespace {
+    struct Line {
+        uint8_t pin;
+        uint8_t active;             // Level that wakes
+        gpio_int_type_t restore;    // Interrupt the driver attached
+    };
+
+    const Line LINES[WakeSources::SOURCE_COUNT] = {
+        {BTN_BOOT, LOW, GPIO_INTR_NEGEDGE},
+        {BTN_PWR, LOW, GPIO_INTR_DISABLE},
+        {TOUCH_INT, LOW, GPIO_INTR_NEGEDGE},
+        {IMU_INT2, HIGH, GPIO_INTR_POSEDGE},
+        {RTC_INT, LOW, GPIO_INTR_NEGEDGE},
+    };
+}
+
+uint8_t WakeSources::arm(uint8_t sources) {
+    esp_sleep_disable_wakeup_source(ESP_SLEEP_WAKEUP_ALL);
+    armed = 0;
+    display_pending = false;  // A wake that never turned the display on is not measured
+
+    for (uint8_t i = 0; i < SOURCE_COUNT; i++) {
+        if (!(sources & (1 << i))) continue;
+        gpio_num_t pin = (gpio_num_t)LINES[i].pin;
+        if (gpio_get_level(pin) == LINES[i].active) continue;
+
+        // Level interrupts would storm once awake: keep the CPU out of it until disarm()
+        gpio_intr_disable(pin);
+        if (gpio_wakeup_enable(pin, LINES[i].active ? GPIO_INTR_HIGH_LEVEL : GPIO_INTR_LOW_LEVEL) != ESP_OK) {
+            gpio_set_intr_type(pin, LINES[i].restore);
+            if (LINES[i].restore != GPIO_INTR_DISABLE) gpio_intr_enable(pin);
+            continue;
+        }
+        armed |= 1 << i;
+    }
+
+    if (armed != 0) esp_sleep_enable_gpio_wakeup();
+    return armed;
+}
+
+uint8_t WakeSources::decode(int64_t now_us) {
+    wake_us = now_us;
+    fired = 0;
+    esp_sleep_wakeup_cause_t cause = esp_sleep_get_wakeup_cause();
+    if (cause == ESP_SLEEP_WAKEUP_GPIO) {
+        for (uint8_t i = 0; i < SOURCE_COUNT; i++) {
+            if ((armed & (1 << i)) && gpio_get_level((gpio_num_t)LINES[i].pin) == LINES[i].active) fired |= 1 << i;
+        }
+    }
+
+    for (uint8_t i = 0; i < SOURCE_COUNT; i++) {
+        if (fired & (1 << i)) stats[i].wakes++;
+    }
+    if (fired == 0 && cause != ESP_SLEEP_WAKEUP_TIMER) unknown++;  // The timer is the deep sleep deadline
+    display_pending = true;
+    return fired;
+}
+
+void WakeSources::disarm() {
+    for (uint8_t i = 0; i < SOURCE_COUNT; i++) {
+        if (!(armed & (1 << i))) continue;
+        gpio_num_t pin = (gpio_num_t)LINES[i].pin;
+        gpio_wakeup_disable(pin);
+        gpio_set_intr_type(pin, LINES[i].restore);
+        if (LINES[i].restore != GPIO_INTR_DISABLE) gpio_intr_enable(pin);
+    }
+}
+
+void WakeSources::attribute(Source source) {
+    if (fired & mask(source)) return;
+    if (fired == 0 && unknown > 0) unknown--;
+    fired |= mask(source);
+    stats[source].wakes++;
+}
+
+void WakeSources::markDisplayOn(int64_t now_us) {
+    if (!display_pending) return;
+    display_pending = false;
+
+    uint32_t latency = (uint32_t)(now_us - wake_us);
+    for (uint8_t i = 0; i < SOURCE_COUNT; i++) {
+        if (!(fired & (1 << i))) continue;
+        Stats& s = stats[i];
+        s.displayed++;
+        s.last_us = latency;
+        s.sum_us += latency;
+        if (latency > s.max_us) s.max_us = latency;
+    }
+}
+
+const char* WakeSources::sourceName(Source source) {
+    switch (source) {
+        case SOURCE_BUTTON: return "button";
+        case SOURCE_POWER_KEY: return "power";
+        case SOURCE_TOUCH: return "touch";
+        case SOURCE_MOTION: return "motion";
+        case SOURCE_RTC: return "rtc";
+        default: return "?";
+    }
+}
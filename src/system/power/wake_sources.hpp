@@ -0,0 +1,73 @@
+#pragma once
+#include <Arduino.h>
+#include <driver/gpio.h>
+#include <esp_sleep.h>
+
+#include "config.h"
+
+/**
+ * GPIO wake-up sources for light sleep.
+ *
+ * Every source is a level on its interrupt line, armed with
+ * gpio_wakeup_enable() so lines outside the RTC domain (touch and RTC
+ * interrupts on GPIO38/39) can wake the chip as well. Arming switches the
+ * pin to a level interrupt, so its CPU interrupt is masked for the sleep
+ * and disarm() puts back the edge the driver attached.
+ *
+ * decode() samples the lines right after esp_light_sleep_start() returns.
+ * A pulse that ended during the wake-up path cannot be attributed and
+ * counts as unknown. A timer wake is SystemManager's deep sleep deadline
+ * and counts as neither.
+ *
+ * Latency per source runs from the wake (the return of
+ * esp_light_sleep_start(); the hardware wake-up before it is not visible)
+ * to the display being powered on.
+ */
+class WakeSources {
+public:
+    enum Source : uint8_t {
+        SOURCE_BUTTON = 0,      // BTN_BOOT
+        SOURCE_POWER_KEY,       // BTN_PWR
+        SOURCE_TOUCH,           // TOUCH_INT, touch controller in monitor mode
+        SOURCE_MOTION,          // IMU_INT2, motion engine
+        SOURCE_RTC,             // RTC_INT, alarm/countdown
+        SOURCE_COUNT
+    };
+
+    struct Stats {
+        uint32_t wakes;         // Wakes this source took part in
+        uint32_t displayed;     // ...that ended with the display on
+        uint32_t last_us;       // Wake to display on
+        uint32_t max_us;
+        uint64_t sum_us;
+    };
+
+    static uint8_t mask(Source source) { return 1 << source; }
+
+private:
+    uint8_t armed = 0;
+    uint8_t fired = 0;          // Decoded at the last wake
+    int64_t wake_us = 0;
+    bool display_pending = false;
+    Stats stats[SOURCE_COUNT] = {};
+    uint32_t unknown = 0;
+
+public:
+    // Arms the given source bits; lines already at their active level are skipped (they would wake at once)
+    uint8_t arm(uint8_t sources);
+    // Right after esp_light_sleep_start(): latches the wake time and the active lines
+    uint8_t decode(int64_t now_us);
+    // Restores the drivers' edge interrupts (getArmed() keeps the last sleep's sources)
+    void disarm();
+
+    // Attribute a source found by other means (e.g. a touch read over I2C)
+    void attribute(Source source);
+    // Display powered on: closes the latency measurement of the last wake
+    void markDisplayOn(int64_t now_us);
+
+    uint8_t getArmed() const { return armed; }
+    uint8_t getFired() const { return fired; }
+    const Stats& getStats(Source source) const { return stats[source]; }
+    uint32_t getUnknownCount() const { return unknown; }
+    static const char* sourceName(Source source);
+};
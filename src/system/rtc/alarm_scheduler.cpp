@@ -0,0 +1,111 @@
+#include "alarm_scheduler.hpp"
+
+#include <algorithm>
+#include <time.h>
+
+bool AlarmScheduler::later(const Entry& a, const Entry& b) {
+    // std heap functions build a max-heap: "less" means later, so the earliest is on top
+    if (a.due_s != b.due_s) return a.due_s > b.due_s;
+    return (int32_t)(a.id - b.id) > 0;
+}
+
+uint32_t AlarmScheduler::schedule(int64_t due_s, Callback callback, void* arg, int64_t now_s) {
+    uint32_t id = next_id++;
+    if (next_id == INVALID_ID) next_id = 1;
+
+    Entry entry = {due_s, id, callback, arg};
+    heap.push_back(entry);
+    std::push_heap(heap.begin(), heap.end(), later);
+    stats.scheduled++;
+
+    rearm(now_s);
+    return id;
+}
+
+bool AlarmScheduler::cancel(uint32_t id, int64_t now_s) {
+    for (size_t i = 0; i < heap.size(); i++) {
+        if (heap[i].id != id) continue;
+
+        heap[i] = heap.back();
+        heap.pop_back();
+        std::make_heap(heap.begin(), heap.end(), later);
+        stats.cancelled++;
+
+        rearm(now_s);
+        return true;
+    }
+    return false;
+}
+
+size_t AlarmScheduler::dispatch(int64_t now_s, bool hardware_fired) {
+    // A fired alarm/countdown is spent, even if it came early (countdown phase)
+    if (hardware_fired) armed_target_s = -1;
+
+    size_t count = 0;
+    while (!heap.empty() && heap.front().due_s <= now_s) {
+        std::pop_heap(heap.begin(), heap.end(), later);
+        Entry entry = heap.back();
+        heap.pop_back();
+
+        stats.dispatched++;
+        count++;
+        if (entry.callback != nullptr) entry.callback(entry.arg, entry.id);
+    }
+
+    rearm(now_s);
+    return count;
+}
+
+void AlarmScheduler::refresh(int64_t now_s) {
+    armed_target_s = -1;  // Force a rewrite
+    rearm(now_s);
+}
+
+int64_t AlarmScheduler::secondsUntilNext(int64_t now_s) const {
+    if (heap.empty()) return -1;
+    int64_t delta = heap.front().due_s - now_s;
+    return delta > 0 ? delta : 0;
+}
+
+void AlarmScheduler::rearm(int64_t now_s) {
+    if (heap.empty()) {
+        if (armed != ARMED_NONE) {
+            hardware.disarm();
+            stats.hardware_writes++;
+            armed = ARMED_NONE;
+        }
+        return;
+    }
+
+    // Already due: dispatch() runs it from the loop, no hardware needed
+    int64_t due = heap.front().due_s;
+    int64_t delta = due - now_s;
+    if (delta <= 0) return;
+
+    // The armed target still stands while it lies ahead and was computed for
+    // this event; an intermediate alarm is recomputed only once it has fired
+    if (armed != ARMED_NONE && armed_due_s == due && armed_target_s > now_s && armed_target_s <= due) return;
+
+    Armed kind = (delta <= COUNTDOWN_MAX_S) ? ARMED_COUNTDOWN : ARMED_ALARM;
+    int64_t target = (delta <= ALARM_HORIZON_S) ? due : now_s + ALARM_HORIZON_S;
+
+    if (armed != ARMED_NONE && kind != armed) {
+        hardware.disarm();
+        stats.hardware_writes++;
+    }
+
+    bool ok;
+    if (kind == ARMED_COUNTDOWN) {
+        ok = hardware.armCountdown((uint8_t)delta);
+    } else {
+        time_t seconds = (time_t)target;
+        tm t;
+        gmtime_r(&seconds, &t);  // Local seconds: no zone conversion
+        ok = hardware.armAlarm((uint8_t)t.tm_mday, (uint8_t)t.tm_hour, (uint8_t)t.tm_min, (uint8_t)t.tm_sec);
+    }
+    stats.hardware_writes++;
+
+    armed = ok ? kind : ARMED_NONE;
+    armed_target_s = ok ? target : -1;
+    armed_due_s = due;
+}
@@ -0,0 +1,103 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+#include <vector>
+
+/**
+ * Hardware that can raise one wake-up event: an absolute alarm (day of
+ * month, hour, minute, second match) or a relative countdown in seconds.
+ * Arming one kind does not have to disarm the other; the scheduler calls
+ * disarm() when it switches.
+ */
+class AlarmHardware {
+public:
+    virtual ~AlarmHardware() {}
+    virtual bool armAlarm(uint8_t day, uint8_t hour, uint8_t minute, uint8_t second) = 0;
+    virtual bool armCountdown(uint8_t seconds) = 0;
+    virtual bool disarm() = 0;
+};
+
+/**
+ * Any number of timed events multiplexed over one hardware alarm.
+ *
+ * Pending events live in a min-heap ordered by due time (local seconds,
+ * ties in scheduling order). Only the earliest one is programmed into the
+ * hardware: events up to COUNTDOWN_MAX_S away use the countdown timer,
+ * later ones the alarm registers. Events beyond ALARM_HORIZON_S get an
+ * intermediate alarm, so the day-of-month match never wraps.
+ *
+ * dispatch() is the deferred handler: call it from the main loop (it is
+ * O(1) when nothing is due) and after the RTC interrupt. Callbacks run in
+ * that context and may schedule or cancel events, but must not schedule
+ * anything already due.
+ *
+ * No Arduino dependencies, so the scheduler runs against a simulated
+ * clock on the host.
+ */
+class AlarmScheduler {
+public:
+    typedef void (*Callback)(void* arg, uint32_t id);
+
+    static constexpr uint32_t INVALID_ID = 0;
+    static constexpr int64_t COUNTDOWN_MAX_S = 255;           // PCF85063 timer at 1Hz
+    static constexpr int64_t ALARM_HORIZON_S = 27 * 86400;    // Shorter than any month
+
+    enum Armed : uint8_t {
+        ARMED_NONE = 0,
+        ARMED_ALARM,
+        ARMED_COUNTDOWN,
+    };
+
+    struct Stats {
+        uint32_t scheduled;
+        uint32_t dispatched;
+        uint32_t cancelled;
+        uint32_t hardware_writes;
+    };
+
+private:
+    struct Entry {
+        int64_t due_s;
+        uint32_t id;
+        Callback callback;
+        void* arg;
+    };
+
+    AlarmHardware& hardware;
+    std::vector<Entry> heap;
+    uint32_t next_id = 1;
+
+    Armed armed = ARMED_NONE;
+    int64_t armed_target_s = 0;
+    int64_t armed_due_s = 0;    // Due time of the event armed_target_s was computed for
+    Stats stats = {};
+
+    static bool later(const Entry& a, const Entry& b);
+    void rearm(int64_t now_s);
+
+public:
+    explicit AlarmScheduler(AlarmHardware& hardware) : hardware(hardware) {}
+
+    // Returns the event id (never INVALID_ID)
+    uint32_t schedule(int64_t due_s, Callback callback, void* arg, int64_t now_s);
+    uint32_t scheduleIn(uint32_t delay_s, Callback callback, void* arg, int64_t now_s) {
+        return schedule(now_s + delay_s, callback, arg, now_s);
+    }
+    bool cancel(uint32_t id, int64_t now_s);
+
+    // Runs every due callback and re-arms the hardware; returns the number dispatched.
+    // hardware_fired: the RTC reported the alarm/countdown, so it must be rewritten.
+    // Otherwise the hardware is left alone unless the earliest event changed.
+    size_t dispatch(int64_t now_s, bool hardware_fired = false);
+    // Re-arm after the clock was stepped
+    void refresh(int64_t now_s);
+
+    size_t pending() const { return heap.size(); }
+    // Seconds until the next event (0 if due), or -1 when nothing is pending
+    int64_t secondsUntilNext(int64_t now_s) const;
+
+    Armed getArmed() const { return armed; }
+    int64_t getArmedTarget() const { return armed_target_s; }
+    const Stats& getStats() const { return stats; }
+};
@@ -1,70 +1,94 @@
 #include "rtc.hpp"
+#include "../loop/event_loop.hpp"
 
 bool RTC::setBus(TwoWire &bus) {
-    i2c = &bus;
+    device.setBus(bus);
     
     // Test communication by reading control register
     uint8_t ctrl1 = 0;
-    if (!readRegister(REG_CONTROL_1, &ctrl1)) {
+    if (!device.read<PCF85063::Control1>(ctrl1)) {
         if (logger) logger->failure("RTC", "PCF85063 not found");
         return false;
     }
     
     // Enable RTC, disable 12h mode (use 24h)
-    if (!writeRegister(REG_CONTROL_1, 0x00)) {
+    if (!device.write<PCF85063::Control1>(0x00)) {
         if (logger) logger->failure("RTC", "Failed to configure PCF85063");
         return false;
     }
     
+    // Seed the CONTROL_2 shadow (CONTROL_1 was cached by the write above)
+    device.declareVolatile<PCF85063::Control2_AF>();
+    device.declareVolatile<PCF85063::Control2_TF>();
+    uint8_t ctrl2 = 0;
+    if (!device.cached<PCF85063::Control2>(ctrl2)) {
+        if (logger) logger->failure("RTC", "Failed to read CONTROL_2");
+        return false;
+    }
+    
     // Setup interrupt pin
     pinMode(interrupt_pin, INPUT_PULLUP);
     attachInterruptArg(digitalPinToInterrupt(interrupt_pin), RTC::isrArg, this, FALLING);
     
     if (logger) logger->success("RTC", "PCF85063 initialized");
     initialized = true;
+    
+    // INT only falls on a new flag: decode (and clear) anything left from before reset
+    interrupt_pending = true;
     return true;
 }
 
 void IRAM_ATTR RTC::isrArg(void* arg) {
     RTC* self = static_cast<RTC*>(arg);
     if (self) {
-        // Check which interrupt fired by reading CONTROL_2
-        // We'll set flags and check them in main loop
-        self->alarm_triggered = true;  // Could be alarm, timer, or minute
-        self->timer_triggered = true;
-        self->minute_triggered = true;
+        // CONTROL_2 needs I2C: only note the edge here, decode in handleInterrupt()
+        self->interrupt_pending = true;
+        EventLoop::postFromISR(EventLoop::EVENT_RTC);
     }
 }
 
-bool RTC::writeRegister(uint8_t reg, uint8_t value) {
-    if (!i2c) return false;
-    
-    i2c->beginTransmission(ADDR_PCF85063);
-    i2c->write(reg);
-    i2c->write(value);
-    return (i2c->endTransmission() == 0);
-}
-
-bool RTC::readRegister(uint8_t reg, uint8_t* value) {
-    return readRegisters(reg, value, 1);
-}
-
-bool RTC::readRegisters(uint8_t reg, uint8_t* buffer, size_t len) {
-    if (!i2c) return false;
-    
-    i2c->beginTransmission(ADDR_PCF85063);
-    i2c->write(reg);
-    if (i2c->endTransmission(false) != 0) return false;
+bool RTC::handleInterrupt() {
+    if (!interrupt_pending || !initialized) return false;
+    interrupt_pending = false;
     
-    if (i2c->requestFrom(ADDR_PCF85063, len) != len) return false;
+    using namespace PCF85063;
     
-    for (size_t i = 0; i < len; i++) {
-        buffer[i] = i2c->read();
+    uint8_t ctrl2 = 0;
+    if (!device.read<Control2>(ctrl2)) {
+        interrupt_pending = true;  // Retry on the next loop
+        return false;
     }
     
+    // TF is shared by the countdown timer and the minute interrupt
+    uint8_t timer_mode = 0;
+    device.cached<TimerMode>(timer_mode);
+    bool alarm = Control2_AF::decode(ctrl2) && Control2_AIE::decode(ctrl2);
+    bool tf = Control2_TF::decode(ctrl2);
+    if (alarm) alarm_triggered = true;
+    if (tf && TimerMode_TIE::decode(timer_mode)) timer_triggered = true;
+    if (tf && Control2_MI::decode(ctrl2)) minute_triggered = true;
+    
+    // Clear only the flags that were seen (W0C: the other stays untouched)
+    uint8_t clear = (Control2_AF::decode(ctrl2) ? Control2_AF::mask : 0) | (tf ? Control2_TF::mask : 0);
+    if (clear != 0 && !device.modify<Control2>(0x00, clear)) {
+        interrupt_pending = true;
+    }
     return true;
 }
 
+bool RTC::armAlarm(uint8_t day, uint8_t hour, uint8_t minute, uint8_t second) {
+    return setAlarm(hour, minute, second, day);
+}
+
+bool RTC::armCountdown(uint8_t seconds) {
+    return setTimer(seconds, TIMER_1HZ);
+}
+
+bool RTC::disarm() {
+    bool alarm = clearAlarm();
+    return clearTimer() && alarm;
+}
+
 bool RTC::setDateTime(const DateTime& dt) {
     if (!initialized) return false;
     
@@ -78,13 +102,7 @@ bool RTC::setDateTime(const DateTime& dt) {
     data[6] = decToBcd(dt.year - 2000);
     
     // Write all time/date registers at once
-    i2c->beginTransmission(ADDR_PCF85063);
-    i2c->write(REG_SECONDS);
-    for (int i = 0; i < 7; i++) {
-        i2c->write(data[i]);
-    }
-    
-    bool success = (i2c->endTransmission() == 0);
+    bool success = device.writeBlock(PCF85063::Seconds::address, data, sizeof(data));
     
     if (logger) {
         if (success) {
@@ -97,11 +115,29 @@ bool RTC::setDateTime(const DateTime& dt) {
     return success;
 }
 
+bool RTC::setDateTimeAligned(const DateTime& dt) {
+    if (!initialized) return false;
+    
+    using namespace PCF85063;
+    
+    // STOP resets the prescaler; releasing it starts a fresh second
+    if (!device.writeField<Control1_Stop>(1)) return false;
+    bool success = setDateTime(dt);
+    return device.writeField<Control1_Stop>(0) && success;
+}
+
 bool RTC::getDateTime(DateTime& dt) {
+    bool valid;
+    return getDateTime(dt, valid);
+}
+
+bool RTC::getDateTime(DateTime& dt, bool& valid) {
     if (!initialized) return false;
     
     uint8_t data[7];
-    if (!readRegisters(REG_SECONDS, data, 7)) return false;
+    if (!device.readBlock(PCF85063::Seconds::address, data, sizeof(data))) return false;
+    
+    valid = (data[0] & 0x80) == 0;  // OS: oscillator stopped since the time was last set
     
     dt.second = bcdToDec(data[0] & 0x7F);
     dt.minute = bcdToDec(data[1] & 0x7F);
@@ -139,25 +175,24 @@ bool RTC::setDate(uint16_t year, uint8_t month, uint8_t day) {
 bool RTC::setAlarm(uint8_t hour, uint8_t minute, uint8_t second, uint8_t day) {
     if (!initialized) return false;
     
+    using namespace PCF85063;
+    
     // 0x80 = alarm disabled for that field
-    uint8_t alarm_second = (second == 0xFF) ? 0x80 : (decToBcd(second) & 0x7F);
-    uint8_t alarm_minute = (minute == 0xFF) ? 0x80 : (decToBcd(minute) & 0x7F);
-    uint8_t alarm_hour = (hour == 0xFF) ? 0x80 : (decToBcd(hour) & 0x3F);
-    uint8_t alarm_day = (day == 0xFF) ? 0x80 : (decToBcd(day) & 0x3F);
-    uint8_t alarm_weekday = 0x80; // Disable weekday alarm
-    
-    // Write alarm registers
-    if (!writeRegister(REG_SECOND_ALARM, alarm_second)) return false;
-    if (!writeRegister(REG_MINUTE_ALARM, alarm_minute)) return false;
-    if (!writeRegister(REG_HOUR_ALARM, alarm_hour)) return false;
-    if (!writeRegister(REG_DAY_ALARM, alarm_day)) return false;
-    if (!writeRegister(REG_WEEKDAY_ALARM, alarm_weekday)) return false;
-    
-    // Enable alarm interrupt in CONTROL_2 (bit 7 = AIE)
-    uint8_t ctrl2 = 0;
-    if (!readRegister(REG_CONTROL_2, &ctrl2)) return false;
-    ctrl2 |= 0x80; // Set AIE bit
-    if (!writeRegister(REG_CONTROL_2, ctrl2)) return false;
+    uint8_t alarm_second = (second == 0xFF) ? ALARM_DISABLED : (decToBcd(second) & 0x7F);
+    uint8_t alarm_minute = (minute == 0xFF) ? ALARM_DISABLED : (decToBcd(minute) & 0x7F);
+    uint8_t alarm_hour = (hour == 0xFF) ? ALARM_DISABLED : (decToBcd(hour) & 0x3F);
+    uint8_t alarm_day = (day == 0xFF) ? ALARM_DISABLED : (decToBcd(day) & 0x3F);
+    uint8_t alarm_weekday = ALARM_DISABLED; // Disable weekday alarm
+    
+    // Alarm registers 0x0B-0x0F go out as one burst, AIE as a second write
+    auto burst = device.burst();
+    burst.write<SecondAlarm>(alarm_second)
+         .write<MinuteAlarm>(alarm_minute)
+         .write<HourAlarm>(alarm_hour)
+         .write<DayAlarm>(alarm_day)
+         .write<WeekdayAlarm>(alarm_weekday)
+         .writeField<Control2_AIE>(1);
+    if (!burst.flush()) return false;
     
     if (logger) {
         logger->success("RTC", (String("Alarm set: ") + String(hour) + ":" + String(minute)).c_str());
@@ -169,12 +204,9 @@ bool RTC::setAlarm(uint8_t hour, uint8_t minute, uint8_t second, uint8_t day) {
 bool RTC::clearAlarm() {
     if (!initialized) return false;
     
-    // Disable alarm interrupt in CONTROL_2
-    uint8_t ctrl2 = 0;
-    if (!readRegister(REG_CONTROL_2, &ctrl2)) return false;
-    ctrl2 &= ~0x80; // Clear AIE bit
-    ctrl2 &= ~0x40; // Clear AF (alarm flag)
-    if (!writeRegister(REG_CONTROL_2, ctrl2)) return false;
+    // Disable alarm interrupt and clear the alarm flag in CONTROL_2
+    using namespace PCF85063;
+    if (!device.modify<Control2>(0x00, Control2_AIE::mask | Control2_AF::mask)) return false;
     
     alarm_triggered = false;
     
@@ -186,20 +218,14 @@ bool RTC::clearAlarm() {
 bool RTC::setTimer(uint8_t value, TimerClockFreq freq) {
     if (!initialized) return false;
     
-    // PCF85063 uses OFFSET register as timer countdown
-    if (!writeRegister(REG_OFFSET, value)) return false;
+    using namespace PCF85063;
     
-    // Enable timer interrupt in CONTROL_1
-    // Bits [2:0] = timer frequency
-    uint8_t ctrl1 = freq & 0x03;
-    ctrl1 |= 0x04;  // Enable timer
-    if (!writeRegister(REG_CONTROL_1, ctrl1)) return false;
-    
-    // Enable timer interrupt in CONTROL_2 (bit 4 = TIE)
-    uint8_t ctrl2 = 0;
-    if (!readRegister(REG_CONTROL_2, &ctrl2)) return false;
-    ctrl2 |= 0x10;  // Set TIE bit
-    if (!writeRegister(REG_CONTROL_2, ctrl2)) return false;
+    // TIMER_VALUE and TIMER_MODE are adjacent: one transaction.
+    // Interrupt in flag mode (TI_TP = 0) so INT stays low until TF is cleared.
+    uint8_t mode = TimerMode_TCF::encode(freq) | TimerMode_TE::encode(1) | TimerMode_TIE::encode(1);
+    auto burst = device.burst();
+    burst.write<TimerValue>(value).write<TimerMode>(mode);
+    if (!burst.flush()) return false;
     
     if (logger) {
         const char* freq_str[] = {"4096Hz", "64Hz", "1Hz", "1/60Hz"};
@@ -212,18 +238,13 @@ bool RTC::setTimer(uint8_t value, TimerClockFreq freq) {
 bool RTC::clearTimer() {
     if (!initialized) return false;
     
-    // Disable timer in CONTROL_1
-    uint8_t ctrl1 = 0;
-    if (!readRegister(REG_CONTROL_1, &ctrl1)) return false;
-    ctrl1 &= ~0x04;  // Clear timer enable
-    if (!writeRegister(REG_CONTROL_1, ctrl1)) return false;
+    using namespace PCF85063;
     
-    // Disable timer interrupt in CONTROL_2
-    uint8_t ctrl2 = 0;
-    if (!readRegister(REG_CONTROL_2, &ctrl2)) return false;
-    ctrl2 &= ~0x10;  // Clear TIE bit
-    ctrl2 &= ~0x08;  // Clear TF (timer flag)
-    if (!writeRegister(REG_CONTROL_2, ctrl2)) return false;
+    // Disable timer and timer interrupt in TIMER_MODE
+    if (!device.modify<TimerMode>(0x00, TimerMode_TE::mask | TimerMode_TIE::mask)) return false;
+    
+    // Clear TF (timer flag) in CONTROL_2
+    if (!device.modify<Control2>(0x00, Control2_TF::mask)) return false;
     
     timer_triggered = false;
     
@@ -235,11 +256,8 @@ bool RTC::clearTimer() {
 bool RTC::enableMinuteInterrupt() {
     if (!initialized) return false;
     
-    // Enable minute interrupt in CONTROL_2 (bit 0 = MI)
-    uint8_t ctrl2 = 0;
-    if (!readRegister(REG_CONTROL_2, &ctrl2)) return false;
-    ctrl2 |= 0x01;  // Set MI bit
-    if (!writeRegister(REG_CONTROL_2, ctrl2)) return false;
+    // Enable minute interrupt in CONTROL_2
+    if (!device.writeField<PCF85063::Control2_MI>(1)) return false;
     
     if (logger) logger->info("RTC", "Minute interrupt enabled");
     
@@ -250,10 +268,7 @@ bool RTC::disableMinuteInterrupt() {
     if (!initialized) return false;
     
     // Disable minute interrupt in CONTROL_2
-    uint8_t ctrl2 = 0;
-    if (!readRegister(REG_CONTROL_2, &ctrl2)) return false;
-    ctrl2 &= ~0x01;  // Clear MI bit
-    if (!writeRegister(REG_CONTROL_2, ctrl2)) return false;
+    if (!device.writeField<PCF85063::Control2_MI>(0)) return false;
     
     minute_triggered = false;
     
@@ -265,11 +280,8 @@ bool RTC::disableMinuteInterrupt() {
 bool RTC::setClockOut(ClockOutFreq freq) {
     if (!initialized) return false;
     
-    // Set CLKOUT frequency in CONTROL_1 bits [7:5]
-    uint8_t ctrl1 = 0;
-    if (!readRegister(REG_CONTROL_1, &ctrl1)) return false;
-    ctrl1 = (ctrl1 & 0x1F) | ((freq & 0x07) << 5);
-    if (!writeRegister(REG_CONTROL_1, ctrl1)) return false;
+    // Set CLKOUT frequency in CONTROL_2 COF bits [2:0]
+    if (!device.writeField<PCF85063::Control2_COF>(freq)) return false;
     
     if (logger) {
         const char* freq_str[] = {"32768Hz", "16384Hz", "8192Hz", "4096Hz", "2048Hz", "1024Hz", "1Hz", "OFF"};
@@ -3,48 +3,78 @@
 #include <Wire.h>
 
 #include "config.h"
+#include "alarm_scheduler.hpp"
 #include "../../logger/logger.hpp"
+#include "../bus/i2c_device.hpp"
 
-class RTC {
-private:
-    static constexpr uint8_t ADDR_PCF85063 = 0x51;
+// PCF85063A register map
+namespace PCF85063 {
+    using Control1 = Register<0x00>;
+    using Control2 = Register<0x01>;
+    using Offset = Register<0x02>;
+    using RamByte = Register<0x03>;
+    using Seconds = Register<0x04>;
+    using Minutes = Register<0x05>;
+    using Hours = Register<0x06>;
+    using Days = Register<0x07>;
+    using Weekdays = Register<0x08>;
+    using Months = Register<0x09>;
+    using Years = Register<0x0A>;
+    using SecondAlarm = Register<0x0B>;
+    using MinuteAlarm = Register<0x0C>;
+    using HourAlarm = Register<0x0D>;
+    using DayAlarm = Register<0x0E>;
+    using WeekdayAlarm = Register<0x0F>;
+    using TimerValue = Register<0x10>;
+    using TimerMode = Register<0x11>;
+    
+    // CONTROL_1
+    using Control1_Stop = Field<Control1, 5, 1>;
+    using Control1_12_24 = Field<Control1, 1, 1>;
+    using Control1_CapSel = Field<Control1, 0, 1>;
+    
+    // CONTROL_2
+    using Control2_AIE = Field<Control2, 7, 1>;                     // Alarm interrupt enable
+    using Control2_AF = Field<Control2, 6, 1, RegAccess::W0C>;      // Alarm flag
+    using Control2_MI = Field<Control2, 5, 1>;                      // Minute interrupt
+    using Control2_HMI = Field<Control2, 4, 1>;                     // Half-minute interrupt
+    using Control2_TF = Field<Control2, 3, 1, RegAccess::W0C>;      // Timer flag
+    using Control2_COF = Field<Control2, 0, 3>;                     // CLKOUT frequency
     
-    TwoWire* i2c = nullptr;
+    // Seconds
+    using Seconds_OS = Field<Seconds, 7, 1>;                        // Oscillator stopped
+    
+    // TIMER_MODE
+    using TimerMode_TCF = Field<TimerMode, 3, 2>;                   // Timer clock frequency
+    using TimerMode_TE = Field<TimerMode, 2, 1>;                    // Timer enable
+    using TimerMode_TIE = Field<TimerMode, 1, 1>;                   // Timer interrupt enable
+    using TimerMode_TI_TP = Field<TimerMode, 0, 1>;                 // Pulse (1) or flag-level (0) interrupt
+    
+    // Alarm registers: bit 7 set disables the field
+    static constexpr uint8_t ALARM_DISABLED = 0x80;
+}
+
+class RTC : public AlarmHardware {
+public:
+    static constexpr uint8_t ADDR_PCF85063 = 0x51;
+
+private:
     Logger* logger = nullptr;
     bool initialized = false;
     
-    // PCF85063 Register addresses
-    enum Registers : uint8_t {
-        REG_CONTROL_1 = 0x00,
-        REG_CONTROL_2 = 0x01,
-        REG_OFFSET = 0x02,
-        REG_RAM_BYTE = 0x03,
-        REG_SECONDS = 0x04,
-        REG_MINUTES = 0x05,
-        REG_HOURS = 0x06,
-        REG_DAYS = 0x07,
-        REG_WEEKDAYS = 0x08,
-        REG_MONTHS = 0x09,
-        REG_YEARS = 0x0A,
-        REG_SECOND_ALARM = 0x0B,
-        REG_MINUTE_ALARM = 0x0C,
-        REG_HOUR_ALARM = 0x0D,
-        REG_DAY_ALARM = 0x0E,
-        REG_WEEKDAY_ALARM = 0x0F,
-    };
+    // Register access; CONTROL_1 through TIMER_MODE are shadow-cached
+    I2CRegisterDevice<ADDR_PCF85063, PCF85063::Control1::address, PCF85063::TimerMode::address> device;
     
     uint8_t interrupt_pin = RTC_INT;
-    volatile bool alarm_triggered = false;
-    volatile bool timer_triggered = false;
-    volatile bool minute_triggered = false;
+    volatile bool interrupt_pending = false;  // Set by the ISR, decoded in handleInterrupt()
+    bool alarm_triggered = false;
+    bool timer_triggered = false;
+    bool minute_triggered = false;
     
     // Helper functions
     uint8_t bcdToDec(uint8_t val) { return (val / 16 * 10) + (val % 16); }
     uint8_t decToBcd(uint8_t val) { return (val / 10 * 16) + (val % 10); }
     
-    bool writeRegister(uint8_t reg, uint8_t value);
-    bool readRegister(uint8_t reg, uint8_t* value);
-    bool readRegisters(uint8_t reg, uint8_t* buffer, size_t len);
     static void IRAM_ATTR isrArg(void* arg);
 
 public:
@@ -58,13 +88,28 @@ public:
         uint16_t year;
     };
     
-    RTC(Logger* logger) : logger(logger) {}
+    RTC(Logger* logger) : logger(logger), device(logger, "RTC") {}
     
     bool setBus(TwoWire &bus);
     bool isInitialized() const { return initialized; }
     
+    // Deferred interrupt handler (main loop): reads CONTROL_2 once, sets the
+    // alarm/timer/minute flags for the sources that fired and clears them in
+    // hardware. Returns true if an interrupt was pending.
+    bool handleInterrupt();
+    // INT held low without an edge (e.g. the line was a light-sleep wake source): decode it anyway
+    void notifyInterrupt() { interrupt_pending = true; }
+    
     bool setDateTime(const DateTime& dt);
     bool getDateTime(DateTime& dt);
+    // Also reports whether the time can be trusted (oscillator-stop flag clear)
+    bool getDateTime(DateTime& dt, bool& valid);
+    
+    // Writes dt with the prescaler held in STOP. The first increment follows
+    // STOP_RELEASE_TO_TICK_US after the call, so issuing it that long before
+    // the end of dt's second aligns the RTC to the sub-second
+    static constexpr uint32_t STOP_RELEASE_TO_TICK_US = 507813;
+    bool setDateTimeAligned(const DateTime& dt);
     
     // Convenience functions
     bool setTime(uint8_t hour, uint8_t minute, uint8_t second);
@@ -79,7 +124,7 @@ public:
     // Timer functions (countdown timer)
     enum TimerClockFreq : uint8_t {
         TIMER_4096HZ = 0,   // 244 µs per tick
-        TIMER_64HZ = 1,     // 15.625 ms per tick  
+        TIMER_64HZ = 1,     // 15.625 ms per tick
         TIMER_1HZ = 2,      // 1 second per tick
         TIMER_1_60HZ = 3    // 1 minute per tick
     };
@@ -108,4 +153,13 @@ public:
     };
     
     bool setClockOut(ClockOutFreq freq);
+    
+    // AlarmHardware (AlarmScheduler)
+    bool armAlarm(uint8_t day, uint8_t hour, uint8_t minute, uint8_t second) override;
+    bool armCountdown(uint8_t seconds) override;
+    bool disarm() override;
+    
+    // Bus diagnostics
+    uint32_t getTransactionCount() const { return device.getTransactionCount(); }
+    uint32_t getCacheMismatchCount() const { return device.getCacheMismatchCount(); }
 };
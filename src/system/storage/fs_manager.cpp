@@ -1,6 +1,6 @@
 #include "fs_manager.hpp"
 
-FSManager::FSManager(Logger* logger) {
+FSManager::FSManager(Logger* logger, bool report) {
     this->logger = logger;
 
     // Try to mount LittleFS first without formatting
@@ -16,9 +16,11 @@ FSManager::FSManager(Logger* logger) {
         logger->success("FSManager", "LittleFS mounted successfully");
     }
 
-    logger->info("FSManager", String("Total space: " + String(totalKB()) + " KB").c_str());
-    logger->info("FSManager", String("Used space: " + String(usedKB()) + " KB").c_str());
-    logger->info("FSManager", String("Free space: " + String(totalKB() - usedKB()) + " KB").c_str());
+    if (report) {
+        logger->info("FSManager", String("Total space: " + String(totalKB()) + " KB").c_str());
+        logger->info("FSManager", String("Used space: " + String(usedKB()) + " KB").c_str());
+        logger->info("FSManager", String("Free space: " + String(totalKB() - usedKB()) + " KB").c_str());
+    }
 
     initialized = true;
 }
@@ -64,4 +66,22 @@ String FSManager::readFile(const char* path) {
     logger->success("FSManager", String("Successfully read file: " + String(path)).c_str());
 
     return out;
+}
+
+bool FSManager::removeFile(const char* path) {
+    if (!LittleFS.exists(path)) return true;
+    if (!LittleFS.remove(path)) {
+        logger->failure("FSManager", String("Failed to remove file: " + String(path)).c_str());
+        return false;
+    }
+    return true;
+}
+
+File FSManager::openFile(const char* path, const char* mode) {
+    File file = LittleFS.open(path, mode);
+    if (!file || file.isDirectory()) {
+        logger->failure("FSManager", String("Failed to open file: " + String(path)).c_str());
+        return File();
+    }
+    return file;
 }
\ No newline at end of file
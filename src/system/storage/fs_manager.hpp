@@ -8,7 +8,8 @@ private:
     Logger* logger = nullptr;
     bool initialized = false;
 public:
-    FSManager(Logger* logger);
+    // report: log the space statistics (walks the file system)
+    FSManager(Logger* logger, bool report = true);
     ~FSManager();
 
     bool isInitialized() const { return initialized; }
@@ -17,4 +18,8 @@ public:
     bool exists(const char* path) { return LittleFS.exists(path); }
     bool writeFile(const char* path, const String& data);
     String readFile(const char* path);
+    bool removeFile(const char* path);
+
+    // Handle for streaming (block-buffered) writers; caller closes it
+    File openFile(const char* path, const char* mode);
 };
@@ -1,34 +1,71 @@
 #include "system_manager.hpp"
 #include <cstring>
 
-SystemManager::SystemManager(Logger* logger)
-    : logger(logger), pmu(logger), display(logger), touchController(logger), fsManager(logger), rtc(logger), imu(logger)
+namespace {
+    // esp_timer deadline for a millis() due time (now if already due)
+    int64_t msDeadline(int64_t now_us, unsigned long now_ms, unsigned long due_ms) {
+        long remaining = (long)(due_ms - now_ms);
+        return now_us + (remaining > 0 ? remaining * 1000LL : 0);
+    }
+}
+
+SystemManager::SystemManager(Logger* logger, bool resume)
+    : logger(logger), pmu(logger), energy(logger), cpuGovernor(logger), display(logger), touchController(logger), fsManager(logger, !resume), rtc(logger),
+      timeService(rtc, logger), alarms(rtc), imu(logger),
+      imuPipeline(imu), wristRaise(logger, &orientationStage), wristLower(logger, &orientationStage),
+      gestureStage(windowStage, gestureTree, logger),
+      motionStage(windowStage),
+      hardwarePedometer(imu, logger), rateGovernor(imu, logger),
+      traceRecorder(fsManager, logger)
 {
     logger->header("SystemManager Initialization");
+    resuming = resume;
+    if (!resume) RetainedState::reset();
+    RetainedState::Data& retained = RetainedState::get();
+    cpuGovernor.begin();
+    if (!eventLoop.begin(EVENT_LOOP_TICK_MS)) {
+        logger->warn("LOOP", "Event loop unavailable - falling back to polling");
+    }
 
-    // init power button
+    // init power button (the edge only wakes the loop; debounce stays in buttonPressed())
     pinMode(BTN_BOOT, INPUT_PULLUP);
+    attachInterrupt(digitalPinToInterrupt(BTN_BOOT), buttonISR, FALLING);
+    pinMode(BTN_PWR, INPUT_PULLUP);  // Light-sleep wake only
     
     // Initialize I2C bus (100kHz Standard Mode)
-    logger->info("I2C", "Initializing bus at 100kHz...");
-    Wire.begin(I2C_SDA, I2C_SCL, 100000);
+    logger->info("I2C", (String("Initializing bus at ") + String(I2C_CLOCK_HZ / 1000) + "kHz...").c_str());
+    Wire.begin(I2C_SDA, I2C_SCL, I2C_CLOCK_HZ);
+    I2CBusStats::setClock(I2C_CLOCK_HZ);
+    if (!I2CBusLock::begin()) logger->warn("I2C", "Bus lock unavailable");
     this->i2c = &Wire;
     
-    Serial.println("I2C scanner start");
-    for (uint8_t addr = 1; addr < 127; ++addr) {
-        i2c->beginTransmission(addr);
-        int r = i2c->endTransmission();
-        if (r == 0) {
-        Serial.printf("Found I2C device at 0x%02X\n", addr);
-        } // ignore other errors here
+    if (resume) {
+        logger->info("I2C", (String("Scan skipped: ") + String(RetainedState::deviceCount()) + " devices from RTC memory").c_str());
+    } else {
+        Serial.println("I2C scanner start");
+        for (uint8_t addr = 1; addr < 127; ++addr) {
+            i2c->beginTransmission(addr);
+            int r = i2c->endTransmission();
+            if (r == 0) {
+            Serial.printf("Found I2C device at 0x%02X\n", addr);
+            RetainedState::markDevice(addr);
+            } // ignore other errors here
+        }
+        Serial.println("I2C scanner done");
     }
-    Serial.println("I2C scanner done");
 
-    logger->success("I2C", "Bus initialized at 400kHz");
+    logger->success("I2C", (String("Bus initialized at ") + String(I2C_CLOCK_HZ / 1000) + "kHz").c_str());
+
+    // Devices missing from the scan (or the retained map on resume) are not probed
+    auto onBus = [logger](uint8_t address, const char* component) {
+        if (RetainedState::hasDevice(address)) return true;
+        logger->failure(component, (String("No device at 0x") + String(address, HEX)).c_str());
+        return false;
+    };
 
     // Initialize PMU
     logger->info("PMU", "Initializing AXP2101...");
-    if (!pmu.setBus(*i2c)) {
+    if (!onBus(PMU::ADDR_AXP2101, "PMU") || !pmu.setBus(*i2c)) {
         logger->failure("PMU", "AXP2101 initialization failed");
         logger->footer();
         return;
@@ -41,10 +78,13 @@ SystemManager::SystemManager(Logger* logger)
         logger->footer();
         return;
     }
+    if (resume && retained.brightness != 0) {
+        display.setBrightness(retained.brightness);  // Before the first frame; the power policy follows later
+    }
 
     // Initialize Touch
     logger->info("TOUCH", "Initializing Touch Controller...");
-    if (!touchController.setBus(*i2c)) {
+    if (!onBus(TouchController::ADDR_FT3168, "TOUCH") || !touchController.setBus(*i2c)) {
         logger->failure("TOUCH", "Touch Controller initialization failed");
         logger->footer();
         return;
@@ -52,32 +92,87 @@ SystemManager::SystemManager(Logger* logger)
 
     // Initialize RTC
     logger->info("RTC", "Initializing PCF85063...");
-    if (!rtc.setBus(*i2c)) {
+    if (!onBus(RTC::ADDR_PCF85063, "RTC") || !rtc.setBus(*i2c)) {
         logger->failure("RTC", "PCF85063 initialization failed");
         logger->footer();
         return;
     }
     
-    // Set initial time for testing (2025-12-01 14:30:00)
-    RTC::DateTime testTime;
-    testTime.year = 2025;
-    testTime.month = 12;
-    testTime.day = 1;
-    testTime.hour = 14;
-    testTime.minute = 30;
-    testTime.second = 0;
-    testTime.weekday = 0; // Sunday
-    if (rtc.setDateTime(testTime)) {
-        logger->info("RTC", "Test time set: 2025-12-01 14:30:00");
+    // Deep sleep resume: a button brings the screen up; motion and alarm (timer) wakes stay dark
+    if (resume) {
+        retained.resumes++;
+        esp_sleep_wakeup_cause_t cause = esp_sleep_get_wakeup_cause();
+        bool userWake = cause == ESP_SLEEP_WAKEUP_EXT0 ||
+                        (cause == ESP_SLEEP_WAKEUP_EXT1 && (esp_sleep_get_ext1_wakeup_status() & (1ULL << BTN_PWR)));
+        logger->info("SYSTEM", (String("Resumed from deep sleep #") + String(retained.resumes) +
+                                (userWake ? " (button)" : cause == ESP_SLEEP_WAKEUP_TIMER ? " (alarm)" : " (motion)")).c_str());
+        if (!userWake) {
+            display.powerOff();
+            suspendPeripherals();
+            sleeping = true;
+            sleepSinceMs = millis() - DEEP_SLEEP_AFTER_MS;  // Back to deep sleep after the wake window
+            motionWakeTime = millis();
+            firstClockFrameUs = -1;  // No resume frame to report
+        }
+    }
+
+    // The RTC is the boot time source: the clock can render before WiFi/NTP
+    if (timeService.anchorToRtc(esp_timer_get_time())) {
+        if (resume) timeService.restoreRate(retained.rate_ppb);
+        seedSystemClock();
+        logger->info("TIME", "Clock seeded from RTC");
+        updateClockDisplay();  // First frame now, not after WiFi/NTP
+        
+        // An NTP sync from before deep sleep still counts towards TIME_SYNC_INTERVAL
+        int64_t ntpAgeS = timeService.localSeconds(esp_timer_get_time()) - retained.last_ntp_local_s;
+        if (resume && retained.last_ntp_local_s > 0 && ntpAgeS >= 0 && ntpAgeS * 1000 < (int64_t)TIME_SYNC_INTERVAL) {
+            lastNtpLocalS = retained.last_ntp_local_s;
+            lastTimeSyncAttempt = millis() - (unsigned long)(ntpAgeS * 1000);
+            ntpRetained = true;
+        }
     }
 
     // Initialize IMU
     logger->info("IMU", "Initializing QMI8658...");
-    if (!imu.setBus(*i2c)) {
+    if (!onBus(IMU::ADDR_QMI8658, "IMU") || !imu.setBus(*i2c)) {
         logger->failure("IMU", "QMI8658 initialization failed");
         logger->footer();
         return;
     }
+#if IMU_USE_FIFO
+    if (!imu.enableFifo(IMU_FIFO_WATERMARK)) {
+        logger->warn("IMU", "FIFO unavailable - falling back to data ready sampling");
+    }
+#endif
+    if (!imu.isFifoEnabled() && !imuPipeline.startDataReadyTask()) {
+        logger->warn("IMU", "Data ready task unavailable - falling back to register polling");
+    }
+    imuPipeline.addStage(windowStage);       // Shared sample window, read by the motion stage
+    imuPipeline.addStage(orientationStage);  // Must run before the gesture stages
+#if GESTURE_CLASSIFIER
+    loadGestureTree(fsManager, GESTURE_TREE_PATH, gestureTree, logger);
+    imuPipeline.addStage(gestureStage);
+#else
+    imuPipeline.addStage(wristRaise);
+    imuPipeline.addStage(wristLower);
+#endif
+    imuPipeline.addStage(motionStage);
+    
+    // Step counting: on-chip when available, software detector otherwise
+#if PEDOMETER_USE_HARDWARE
+    if (hardwarePedometer.begin()) {
+        pedometer = &hardwarePedometer;
+    }
+#endif
+    if (pedometer == nullptr) {
+        imuPipeline.addStage(stepCounterStage);
+        pedometer = &stepCounterStage;
+        imu.setWakeHistoryInterrupt(true);  // Keep counting steps through light sleep
+    }
+    logger->info("STEPS", (String("Pedometer backend: ") + pedometer->backendName()).c_str());
+#if IMU_RATE_GOVERNOR
+    imuPipeline.addStage(rateGovernor);
+#endif
 
     // Initialize File System
     logger->info("LittleFS", "Initializing LittleFS...");
@@ -86,59 +181,133 @@ SystemManager::SystemManager(Logger* logger)
         logger->footer();
         return;
     }
+    energy.load(fsManager, ENERGY_STATS_PATH);
+
+#if IMU_TRACE_RECORD
+    if (traceRecorder.start(IMU_TRACE_PATH, IMU_TRACE_MAX_KB * 1024UL)) {
+        imuPipeline.addStage(traceRecorder);
+    }
+#endif
     
-    if (!initWiFi()) {
+    if (resume && resumeWiFi()) {
+        logger->info("WIFI", "Reconnecting to the retained access point");
+    } else if (!initWiFi()) {
         logger->warn("WIFI", "WiFi connection unavailable - clock will fall back to cached time");
     }
 
+    // Brightness/WiFi policy for the current supply; PMU events switch it later
+    pmu.update(millis());
+    applyPowerPolicy(pmu.getTelemetry().vbus_present);
+
     logger->success("SYSTEM", "All components initialized successfully");
     logger->footer();
     
+    // FIFO statistics cover normal operation: drain what queued up (and
+    // overflowed) during the blocking WiFi/NTP setup, then start the window
+    imuPipeline.update();
+    imu.resetFifoStats();
     this->initialized = true;
     return;
 }
 
 void SystemManager::update() {
     static unsigned long lastTime = 0;
+    
+    // Block until an interrupt, the housekeeping tick or the next deadline
+    uint32_t events = eventLoop.wait(nextDeadlineUs(esp_timer_get_time()));
+    
     unsigned long current_time = millis();
     unsigned long idle_time = current_time - last_activity_time;
+    int64_t loop_start = esp_timer_get_time();
+    loopIterations++;
+    
+    // wifiMulti.run() scans/polls the driver: housekeeping rate is enough. A scan
+    // blocks for seconds, so not while the time service is timing an RTC edge.
+    if (((events & EventLoop::EVENT_TICK) || !eventLoop.isRunning()) && !timeService.isHunting()) {
+        maintainWiFi();
+    }
+    if (pmu.handleInterrupt()) {
+        handlePowerEvents(pmu.takeEvents());
+    }
+    pmu.update(current_time);
+    energy.update(current_time, energyState(), pmu.getTelemetry());
+    if (energy.isSaveDue(current_time)) energy.save(fsManager, ENERGY_STATS_PATH, current_time);
+    timeService.update(loop_start);
+    updateClockDisplay();
+
+    if (touchController.handleInterrupt()) {
+        const TouchFrame& frame = touchController.getLastFrame();
+        traceRecorder.recordEvent(ImuTrace::EVENT_TOUCH, frame.fingers, frame.x, frame.y);
+        cpuGovernor.hint(CpuGovernor::HINT_INPUT, current_time);
+#if SLEEP_WAKE_TOUCH
+        if (sleeping && frame.fingers > 0) wakeDisplay();  // Tap during a motion wake window
+#endif
+    }
+    
+    // RTC interrupt: decode CONTROL_2 (deferred from the ISR), then run due alarms
+    bool rtcHardwareFired = false;
+    if (rtc.handleInterrupt()) {
+        uint8_t sources = (rtc.isAlarmTriggered() ? ImuTrace::RTC_ALARM : 0) |
+                          (rtc.isTimerTriggered() ? ImuTrace::RTC_TIMER : 0) |
+                          (rtc.isMinuteTriggered() ? ImuTrace::RTC_MINUTE : 0);
+        traceRecorder.recordEvent(ImuTrace::EVENT_RTC, sources);
+        if (rtc.isAlarmTriggered()) logger->info("RTC", "⏰ ALARM TRIGGERED!");
+        
+        rtcHardwareFired = rtc.isAlarmTriggered() || rtc.isTimerTriggered();
+        rtc.clearAlarmFlag();
+        rtc.clearTimerFlag();
+        rtc.clearMinuteFlag();
+    }
+    if (timeService.isValid()) {
+        alarms.dispatch(timeService.localSeconds(loop_start), rtcHardwareFired);
+    }
     
     // Simple button check
     if (buttonPressed(BTN_BOOT)) {
+        traceRecorder.recordEvent(ImuTrace::EVENT_BUTTON, BTN_BOOT, LOW);
         this->sleep();
         return;
     }
 
-    maintainWiFi();
-    updateClockDisplay();
-
-    touchController.handleInterrupt();
+    // Acquire IMU samples once and run them through all motion detectors
+    imuPipeline.update();
+    if (pedometer != nullptr) pedometer->update(current_time);
+#if IMU_RATE_GOVERNOR
+    rateGovernor.update(current_time);
+#endif
+    
+#if GESTURE_CLASSIFIER
+    Gesture gesture = gestureStage.takeEvent();
+    bool wristRaised = (gesture == GESTURE_WRIST_RAISE);
+    bool wristLowered = (gesture == GESTURE_WRIST_LOWER);
+#else
+    bool wristRaised = wristRaise.takeEvent();
+    bool wristLowered = wristLower.takeEvent();
+#endif
     
-    // Check IMU for wrist gestures (has its own rate limiting)
     // Check for wrist tilt UP to wake display
-    if (imu.checkWristTilt()) {
+    if (wristRaised) {
+        rateGovernor.holdFullRate(LIGHT_SLEEP_TIMEOUT);  // Keep the gyro for the wrist lower gesture
         if (sleeping) {
             logger->info("IMU", "⌚ Wrist raise - waking display!");
-            display.powerOn();
-            sleeping = false;
+            wakeDisplay();
         }
 
         last_activity_time = millis();
     }
     
     // Check for wrist tilt DOWN to sleep
-    if (imu.checkWristTiltDown()) {
+    if (wristLowered) {
         if (!sleeping) {
             logger->info("IMU", "⌚ Wrist lowered - entering sleep");
             sleep();
         }
     }
     
-    // Check RTC alarm
-    if (rtc.isAlarmTriggered()) {
-        logger->info("RTC", "⏰ ALARM TRIGGERED!");
-        rtc.clearAlarmFlag();
-        rtc.clearAlarm();
+    // Motion wake without a wrist raise: back to sleep
+    if (sleeping && millis() - motionWakeTime > MOTION_WAKE_WINDOW) {
+        sleep();
+        return;
     }
     
     // Auto Sleep Logic
@@ -147,6 +316,12 @@ void SystemManager::update() {
         sleep();
     }
     
+    cpuGovernor.update(millis());
+    
+    uint32_t loop_us = (uint32_t)(esp_timer_get_time() - loop_start);
+    loopTimeUs += loop_us;
+    if (loop_us > maxLoopTimeUs) maxLoopTimeUs = loop_us;
+    
     // Heartbeat every 5 seconds
     if (millis() - lastTime > 5000) {
         lastTime = millis();
@@ -186,15 +361,22 @@ bool SystemManager::initWiFi() {
 void SystemManager::maintainWiFi() {
     if (WIFI_CREDENTIAL_COUNT == 0) return;
 
-    uint8_t status = wifiMulti.run();
+    // A retained-AP reconnect is in progress: a WiFiMulti scan would abort it
+    bool fastConnect = wifiFastUntil != 0 && (long)(millis() - wifiFastUntil) < 0;
+    wl_status_t status = fastConnect ? WiFi.status() : (wl_status_t)wifiMulti.run();
     bool currentlyConnected = (status == WL_CONNECTED);
 
     if (currentlyConnected && !wifiConnected) {
         wifiConnected = true;
+        wifiFastUntil = 0;
         if (logger) {
             logger->success("WIFI", (String("Reconnected to ") + WiFi.SSID() + String(" - ") + WiFi.localIP().toString()).c_str());
         }
-        syncTime();
+        if (ntpRetained) {
+            ntpRetained = false;  // Synced before deep sleep; the hourly check takes over
+        } else {
+            syncTime();
+        }
     } else if (!currentlyConnected && wifiConnected) {
         wifiConnected = false;
         if (logger) logger->warn("WIFI", "WiFi connection lost");
@@ -214,31 +396,54 @@ bool SystemManager::syncTime() {
     lastTimeSyncAttempt = millis();
     configTime(WIFI_GMT_OFFSET_SEC, WIFI_DAYLIGHT_OFFSET, WIFI_PRIMARY_NTP, WIFI_SECONDARY_NTP);
 
-    tm timeinfo;
-    if (getLocalTime(&timeinfo, 5000)) {
-        timeAvailable = true;
-        if (logger) {
-            char buffer[32];
-            strftime(buffer, sizeof(buffer), "%d/%m/%Y %H:%M:%S", &timeinfo);
-            logger->success("TIME", (String("Synchronized: ") + String(buffer)).c_str());
+    // The system clock may already be seeded from the RTC: wait for SNTP itself
+    unsigned long start = millis();
+    while (sntp_get_sync_status() != SNTP_SYNC_STATUS_COMPLETED) {
+        if (millis() - start > 5000) {
+            if (logger) logger->warn("TIME", "Failed to obtain NTP time");
+            return false;
         }
-        return true;
+        delay(10);
     }
 
-    if (logger) logger->warn("TIME", "Failed to obtain NTP time");
-    return false;
+    // Hand the NTP-disciplined system clock to the time service (local time, sub-second)
+    timeval tv;
+    gettimeofday(&tv, nullptr);
+    int64_t at_us = esp_timer_get_time();
+    tm timeinfo;
+    localtime_r(&tv.tv_sec, &timeinfo);
+    timeService.discipline(TimeService::toSeconds(timeinfo) * 1000000 + tv.tv_usec, at_us, TimeService::SOURCE_NTP);
+    lastNtpLocalS = TimeService::toSeconds(timeinfo);
+    timeService.requestRtcWriteback(at_us);
+    alarms.refresh(timeService.localSeconds(at_us));  // The clock may have been stepped
+
+    if (logger) {
+        char buffer[32];
+        strftime(buffer, sizeof(buffer), "%d/%m/%Y %H:%M:%S", &timeinfo);
+        logger->success("TIME", (String("Synchronized: ") + String(buffer)).c_str());
+    }
+    return true;
+}
+
+void SystemManager::seedSystemClock() {
+    // System time is UTC; the time service keeps local time
+    int64_t local_us = timeService.localMicros(esp_timer_get_time());
+    timeval tv;
+    tv.tv_sec = (time_t)(local_us / 1000000 - WIFI_GMT_OFFSET_SEC - WIFI_DAYLIGHT_OFFSET);
+    tv.tv_usec = (suseconds_t)(local_us % 1000000);
+    settimeofday(&tv, nullptr);
 }
 
 void SystemManager::updateClockDisplay() {
     if (!display.isInitialized() || sleeping) return;
 
-    unsigned long now = millis();
-
-    if (!timeAvailable) {
+    if (!timeService.isValid()) {
         // Only update waiting screen every 1 second
+        unsigned long now = millis();
         if (now - lastClockDraw < CLOCK_DRAW_INTERVAL) return;
         lastClockDraw = now;
         
+        cpuGovernor.hint(CpuGovernor::HINT_RENDER, now);
         display.fillScreen(0x0000);
         display.setTextColor(0xFFFF);
         display.setTextSize(2);
@@ -247,22 +452,29 @@ void SystemManager::updateClockDisplay() {
         return;
     }
 
+    // Only render when the second changes (event from the time service, no polling)
+    if (!timeService.takeSecondChanged() && clockInitialized) return;
+
     tm timeinfo;
-    if (!getLocalTime(&timeinfo)) {
-        if (wifiConnected && (now - lastTimeSyncAttempt > 10000)) {
-            syncTime();
-        }
-        return;
-    }
+    if (!timeService.getLocalTime(timeinfo, esp_timer_get_time())) return;
+    cpuGovernor.hint(CpuGovernor::HINT_RENDER, millis());
+    int64_t renderStart = esp_timer_get_time();
+    renderClockFace(timeinfo);
+    cpuGovernor.recordFrame((uint32_t)(esp_timer_get_time() - renderStart));
+    clockInitialized = true;
 
-    // Only render when time changes (not every millisecond)
-    char currentTime[16];
-    strftime(currentTime, sizeof(currentTime), "%H:%M:%S", &timeinfo);
-    
-    if (strcmp(currentTime, lastDisplayedTime) != 0 || !clockInitialized) {
-        strcpy(lastDisplayedTime, currentTime);
-        clockInitialized = true;
-        renderClockFace(timeinfo);
+    if (firstClockFrameUs == 0) {
+        firstClockFrameUs = esp_timer_get_time();
+        RetainedState::Data& retained = RetainedState::get();
+        if (resuming) {
+            logger->info("TIME", (String("Resume to first clock frame ") + String(firstClockFrameUs / 1000.0f, 1) +
+                                  " ms (cold boot " + (retained.cold_first_frame_us ? String(retained.cold_first_frame_us / 1000.0f, 1) + " ms"
+                                                                                   : String("n/a")) + ")").c_str());
+        } else {
+            retained.cold_first_frame_us = (uint32_t)firstClockFrameUs;
+            logger->info("TIME", (String("First clock frame ") + String((unsigned long)(firstClockFrameUs / 1000)) +
+                                  " ms after boot (" + TimeService::sourceName(timeService.getSource()) + ")").c_str());
+        }
     }
 }
 
@@ -327,7 +539,8 @@ void SystemManager::sleep() {
         display.powerOff();
         delay(50); // Safely turn off display
 
-        // TODO: sleep peripherals (I2C, PMU, etc.)
+        suspendPeripherals();
+        sleepSinceMs = millis();
 
         // Wait until button is released (HIGH)
         while (digitalRead(BTN_BOOT) == LOW) {
@@ -338,24 +551,297 @@ void SystemManager::sleep() {
     logger->info("SYSTEM", "Button released, preparing for light sleep...");
 
     sleeping = true;
-    esp_sleep_enable_ext0_wakeup((gpio_num_t)BTN_BOOT, 0); // Wakeup on LOW
-    esp_sleep_enable_timer_wakeup(1000000); // Wakeup after 1 second (microseconds)
-    esp_light_sleep_start();
+    imu.setFifoLowLatency(false);
+
+    // Let the IMU motion engine wake us for a wrist raise
+    bool motionWake = false;
+#if IMU_WAKE_ON_MOTION
+    motionWake = imu.enterMotionWake(IMU::MOTION_ANY);
+#endif
+    if (!motionWake) {
+        imu.suspend();  // Accel only at the low-power ODR until the next wake
+    }
+    if (deepSleepDue()) enterDeepSleep();  // Does not return
+
+    // Every source is a GPIO level; alarms live in the RTC, so RTC_INT replaces any timer wake
+    uint8_t sources = WakeSources::mask(WakeSources::SOURCE_BUTTON) | WakeSources::mask(WakeSources::SOURCE_RTC);
+#if SLEEP_WAKE_POWER_KEY
+    sources |= WakeSources::mask(WakeSources::SOURCE_POWER_KEY);
+#endif
+#if SLEEP_WAKE_TOUCH
+    sources |= WakeSources::mask(WakeSources::SOURCE_TOUCH);
+#endif
+    if (motionWake) sources |= WakeSources::mask(WakeSources::SOURCE_MOTION);
+    
+    // A nearly full wake history (software step counter) wakes us too: feed it
+    // to the pipeline and go back to sleep without the display
+    bool historyWake;
+    do {
+        uint8_t armed = wakeSources.arm(sources);
+        if (armed != sources) {
+            logger->warn("SLEEP", (String("Wake line already active, not armed: 0x") + String(sources & ~armed, HEX)).c_str());
+        }
+        if (armed == 0) {
+            // Nothing could wake us: stay up and retry after the wake window
+            motionWakeTime = millis();
+            return;
+        }
+#if DEEP_SLEEP_AFTER_MS > 0
+        // One-shot timer at the deep sleep deadline (on battery only, see deepSleepDue())
+        long toDeepMs = (long)(sleepSinceMs + DEEP_SLEEP_AFTER_MS - millis());
+        if (toDeepMs > 0 && !pmu.getTelemetry().vbus_present) esp_sleep_enable_timer_wakeup((uint64_t)toDeepMs * 1000);
+#endif
+
+        energy.update(millis(), energyState() | EnergyAccount::STATE_SLEEP, pmu.getTelemetry());
+        int64_t sleepStart = esp_timer_get_time();
+        esp_light_sleep_start();
+        int64_t wakeUs = esp_timer_get_time();
+        wakeSources.decode(wakeUs);  // Before anything else: the lines may be pulses
+        wakeSources.disarm();
+        sleepTimeUs += wakeUs - sleepStart;
+        energy.update(millis(), energyState(), pmu.getTelemetry());
+        historyWake = wakeSources.getFired() == WakeSources::mask(WakeSources::SOURCE_MOTION) && imu.isHistoryWake();
+        if (historyWake) {
+            imuPipeline.dispatchWakeHistory();
+            if (deepSleepDue()) enterDeepSleep();  // The timer is not re-armed past the deadline
+        }
+    } while (historyWake);
+    if (esp_sleep_get_wakeup_cause() == ESP_SLEEP_WAKEUP_TIMER && deepSleepDue()) enterDeepSleep();
 
     // After light sleep: reinitialize display
     logger->info("SYSTEM", "Waking up from light sleep...");
     wakeup();
 }
 
+void IRAM_ATTR SystemManager::buttonISR() {
+    EventLoop::postFromISR(EventLoop::EVENT_BUTTON);
+}
+
+int64_t SystemManager::nextDeadlineUs(int64_t now_us) {
+    unsigned long now_ms = millis();
+    int64_t deadline = timeService.nextDeadline(now_us);
+    unsigned long due_ms;
+    
+    // Clock face: the next second edge, or the waiting screen redraw
+    if (display.isInitialized() && !sleeping) {
+        int64_t frame = timeService.isValid() ? timeService.nextSecondUs(now_us)
+                                              : msDeadline(now_us, now_ms, lastClockDraw + CLOCK_DRAW_INTERVAL);
+        if (frame < deadline) deadline = frame;
+    }
+    
+    // Software alarms are dispatched on the local second they fall due
+    if (timeService.isValid() && alarms.pending() > 0) {
+        int64_t local_us = timeService.localMicros(now_us);
+        int64_t alarm = now_us + alarms.secondsUntilNext(local_us / 1000000) * 1000000 - local_us % 1000000;
+        if (alarm < deadline) deadline = alarm;
+    }
+    
+    // Polled IMU acquisition (data ready mode posts its own events)
+    if (imuPipeline.nextPollDue(due_ms)) {
+        int64_t poll = msDeadline(now_us, now_ms, due_ms);
+        if (poll < deadline) deadline = poll;
+    }
+    
+    if (cpuGovernor.nextIdleDue(due_ms)) {
+        int64_t idle = msDeadline(now_us, now_ms, due_ms);
+        if (idle < deadline) deadline = idle;
+    }
+    
+    // Auto sleep, or the end of the motion wake window (both compare with '>')
+    due_ms = sleeping ? motionWakeTime + MOTION_WAKE_WINDOW + 1 : last_activity_time + LIGHT_SLEEP_TIMEOUT + 1;
+    int64_t timeout = msDeadline(now_us, now_ms, due_ms);
+    if (timeout < deadline) deadline = timeout;
+    
+    return deadline;
+}
+
+bool SystemManager::deepSleepDue() {
+#if DEEP_SLEEP_AFTER_MS > 0
+    // On USB the console and a quick wake are worth more than the last milliamps
+    return sleeping && !pmu.getTelemetry().vbus_present && millis() - sleepSinceMs >= DEEP_SLEEP_AFTER_MS;
+#else
+    return false;
+#endif
+}
+
+void SystemManager::enterDeepSleep() {
+    logger->info("SYSTEM", "Entering deep sleep...");
+
+    // RAM is lost: flush the energy totals, then keep what the resume path needs in RTC memory
+    energy.update(millis(), energyState() | EnergyAccount::STATE_SLEEP, pmu.getTelemetry());
+    energy.save(fsManager, ENERGY_STATS_PATH, millis());
+    retainState();
+
+    // Touch cannot wake deep sleep (GPIO38 is not an RTC GPIO): hibernate it
+    touchController.resume();
+    touchController.suspend(false);
+
+    // Only RTC GPIOs wake deep sleep: BTN_BOOT on EXT0, motion or the power key on EXT1.
+    // RTC_INT (GPIO39) cannot, so the next alarm becomes a timer wake.
+    esp_sleep_disable_wakeup_source(ESP_SLEEP_WAKEUP_ALL);
+    rtc_gpio_pullup_en((gpio_num_t)BTN_BOOT);
+    rtc_gpio_pulldown_dis((gpio_num_t)BTN_BOOT);
+    esp_sleep_enable_ext0_wakeup((gpio_num_t)BTN_BOOT, 0);
+    if (imu.isInMotionWake()) {
+        esp_sleep_enable_ext1_wakeup(1ULL << IMU_INT2, ESP_EXT1_WAKEUP_ANY_HIGH);
+    } else if (SLEEP_WAKE_POWER_KEY) {
+        rtc_gpio_pullup_en((gpio_num_t)BTN_PWR);
+        rtc_gpio_pulldown_dis((gpio_num_t)BTN_PWR);
+        esp_sleep_enable_ext1_wakeup(1ULL << BTN_PWR, ESP_EXT1_WAKEUP_ANY_LOW);
+    }
+    if (timeService.isValid() && alarms.pending() > 0) {
+        int64_t localUs = timeService.localMicros(esp_timer_get_time());
+        int64_t untilUs = alarms.secondsUntilNext(localUs / 1000000) * 1000000 - localUs % 1000000;
+        esp_sleep_enable_timer_wakeup(untilUs > 1000 ? untilUs : 1000);
+    }
+
+    esp_deep_sleep_start();
+}
+
+void SystemManager::retainState() {
+    RetainedState::Data& retained = RetainedState::get();
+    retained.rate_ppb = timeService.getRatePpb();
+    retained.last_ntp_local_s = lastNtpLocalS;
+
+    // Access point of the current connection, for a reconnect without a scan
+    retained.wifi_valid = false;
+    const uint8_t* bssid = WiFi.BSSID();
+    if (wifiConnected && bssid != nullptr) {
+        String ssid = WiFi.SSID();
+        for (size_t i = 0; i < WIFI_CREDENTIAL_COUNT; i++) {
+            if (strcmp(ssid.c_str(), WIFI_CREDENTIALS[i].ssid) != 0) continue;
+            retained.wifi_valid = true;
+            retained.wifi_index = (uint8_t)i;
+            retained.wifi_channel = (uint8_t)WiFi.channel();
+            memcpy(retained.wifi_bssid, bssid, sizeof(retained.wifi_bssid));
+            break;
+        }
+    }
+    RetainedState::seal();
+}
+
+bool SystemManager::resumeWiFi() {
+    const RetainedState::Data& retained = RetainedState::get();
+    if (!retained.wifi_valid || retained.wifi_index >= WIFI_CREDENTIAL_COUNT) return false;
+
+    WiFi.mode(WIFI_STA);
+    WiFi.setSleep(false);
+    for (size_t i = 0; i < WIFI_CREDENTIAL_COUNT; ++i) {
+        wifiMulti.addAP(WIFI_CREDENTIALS[i].ssid, WIFI_CREDENTIALS[i].password);
+    }
+
+    // Known channel and BSSID: no scan, and no wait here; maintainWiFi() picks up the connection
+    const WiFiCredential& ap = WIFI_CREDENTIALS[retained.wifi_index];
+    WiFi.begin(ap.ssid, ap.password, retained.wifi_channel, retained.wifi_bssid);
+    wifiFastUntil = millis() + WIFI_FAST_CONNECT_MS;
+    return true;
+}
+
+void SystemManager::handlePowerEvents(uint16_t events) {
+    for (uint8_t i = 0; i < PMU::EVENT_COUNT; i++) {
+        PMU::Event event = (PMU::Event)(1 << i);
+        if (events & event) logger->info("PMU", (String("Event: ") + PMU::eventName(event)).c_str());
+    }
+
+    if (events & PMU::EVENT_VBUS_INSERT) applyPowerPolicy(true);
+    if (events & PMU::EVENT_VBUS_REMOVE) applyPowerPolicy(false);
+    if (events & PMU::EVENT_BATTERY_CRITICAL) logger->warn("PMU", "Battery critical");
+
+    // Power key toggles the screen
+    if (events & PMU::EVENT_KEY_SHORT) {
+        if (sleeping) {
+            wakeDisplay();
+        } else {
+            sleep();
+        }
+    }
+}
+
+void SystemManager::applyPowerPolicy(bool externalPower) {
+    uint8_t brightness = externalPower ? LCD_BRIGHTNESS_USB : LCD_BRIGHTNESS_BATTERY;
+    display.setBrightness(brightness);
+    RetainedState::get().brightness = brightness;
+
+    // Radio: full performance on USB, modem sleep on battery
+    WiFi.setSleep(!externalPower);
+    if (externalPower && wifiConnected) {
+        lastTimeSyncAttempt = millis() - TIME_SYNC_INTERVAL - 1;  // Sync now that it is cheap
+    }
+    logger->info("PMU", externalPower ? "USB power policy" : "Battery power policy");
+}
+
+void SystemManager::suspendPeripherals() {
+    int64_t start = esp_timer_get_time();
+
+    // Touch stays in monitor mode when it is a wake source
+    touchController.suspend(SLEEP_WAKE_TOUCH);
+
+    lastSuspendUs = (uint32_t)(esp_timer_get_time() - start);
+    if (lastSuspendUs > maxSuspendUs) maxSuspendUs = lastSuspendUs;
+}
+
+void SystemManager::resumePeripherals() {
+    int64_t start = esp_timer_get_time();
+
+    touchController.resume();
+
+    lastResumeUs = (uint32_t)(esp_timer_get_time() - start);
+    if (lastResumeUs > maxResumeUs) maxResumeUs = lastResumeUs;
+}
+
+uint8_t SystemManager::energyState() const {
+    return (sleeping ? 0 : EnergyAccount::STATE_DISPLAY) | (wifiConnected ? EnergyAccount::STATE_WIFI : 0);
+}
+
 void SystemManager::wakeup() {
-    esp_sleep_wakeup_cause_t wakeup_reason = esp_sleep_get_wakeup_cause();
+    using WS = WakeSources;
+    
+    // A tap can end before the CPU is up: ask the controller when nothing was decoded
+    if (wakeSources.getFired() == 0 && (wakeSources.getArmed() & WS::mask(WS::SOURCE_TOUCH)) && touchController.isTouched()) {
+        wakeSources.attribute(WS::SOURCE_TOUCH);
+    }
+    uint8_t fired = wakeSources.getFired();
+    
+    String cause = "";
+    for (uint8_t s = 0; s < WS::SOURCE_COUNT; s++) {
+        if (fired & (1 << s)) cause += String(cause.length() ? "+" : "") + WS::sourceName((WS::Source)s);
+    }
+    logger->info("SYSTEM", (String("Woke up by ") + (cause.length() ? cause : String("unknown source"))).c_str());
 
-    if (wakeup_reason == ESP_SLEEP_WAKEUP_EXT0) {
-        logger->info("SYSTEM", "Woke up by button press");
-        display.powerOn();
-        sleeping = false;
-        last_activity_time = millis();  // Reset idle timer!
+    // Back to normal sampling so the wrist gesture stages can run. A raise has
+    // mostly happened by the time motion wakes us: the stages first get the
+    // accel history the FIFO kept while we slept.
+    if (imu.isInMotionWake()) {
+        imuPipeline.dispatchWakeHistory();
+        imu.exitMotionWake();
+    }
+    imu.resume();
+    motionWakeTime = millis();
+
+    // The lines woke us as levels: their edge interrupts were masked, so hand the events on
+    if (fired & WS::mask(WS::SOURCE_RTC)) {
+        rtc.notifyInterrupt();
+        EventLoop::post(EventLoop::EVENT_RTC);
+    }
+    if (fired & WS::mask(WS::SOURCE_MOTION)) {
+        // Gyro and per-sample FIFO drains until the wrist stage has settled
+        rateGovernor.holdFullRate(MOTION_WAKE_WINDOW);
+        imu.setFifoLowLatency(true);
+        EventLoop::post(EventLoop::EVENT_IMU);
     }
+    if (fired & (WS::mask(WS::SOURCE_BUTTON) | WS::mask(WS::SOURCE_POWER_KEY) | WS::mask(WS::SOURCE_TOUCH))) {
+        wakeDisplay();
+    }
+}
+
+void SystemManager::wakeDisplay() {
+    cpuGovernor.hint(CpuGovernor::HINT_TRANSITION, millis());
+    resumePeripherals();
+    display.powerOn();
+    wakeSources.markDisplayOn(esp_timer_get_time());
+    imu.setFifoLowLatency(false);  // Wake gesture done
+    sleeping = false;
+    last_activity_time = millis();  // Reset idle timer!
 }
 
 void SystemManager::logHeartbeat() {
@@ -375,24 +861,123 @@ void SystemManager::logHeartbeat() {
         logger->info("MEMORY", (String("PSRAM Free: ") + String(ESP.getFreePsram() / 1024) + String(" KB")).c_str());
         logger->info("MEMORY", (String("FLASH Size: ") + String(ESP.getFlashChipSize() / 1024) + String(" KB")).c_str());
 
-        logger->info("BATTERY", (String("Battery Voltage: ") + String(this->getPMU().getBattVoltage()) + String(" mV")).c_str());
-        logger->info("BATTERY", (String("Battery Percentage: ") + String(this->getPMU().getBatteryPercent()) + String(" %")).c_str());
-
-        logger->info("BATTERY", (String("USB Connected: ") + String(this->getPMU().isUSBConnected() ? "Yes" : "No")).c_str());
-        logger->info("BATTERY", (String("Battery Connected: ") + String(this->getPMU().isBatteryConnect() ? "Yes" : "No")).c_str());
-        logger->info("BATTERY", (String("Charging: ") + String(this->getPMU().isCharging() ? "Yes" : "No")).c_str());
-
-        // RTC Status
-        if (rtc.isInitialized()) {
-            RTC::DateTime dt;
-            if (rtc.getDateTime(dt)) {
-                char timeStr[32];
-                snprintf(timeStr, sizeof(timeStr), "%04d-%02d-%02d %02d:%02d:%02d", 
-                         dt.year, dt.month, dt.day, dt.hour, dt.minute, dt.second);
-                logger->info("RTC", (String("Current Time: ") + String(timeStr)).c_str());
-            } else {
-                logger->warn("RTC", "Failed to read time");
+        // I2C bus cost since the previous heartbeat (estimated at the bus clock)
+        uint32_t loops = loopIterations - lastHeartbeatIterations;
+        uint64_t busUs = I2CBusStats::getBusTimeUs() - lastHeartbeatBusTimeUs;
+        uint32_t transactions = I2CBusStats::getTransactionCount() - lastHeartbeatTransactions;
+        lastHeartbeatIterations = loopIterations;
+        lastHeartbeatBusTimeUs = I2CBusStats::getBusTimeUs();
+        lastHeartbeatTransactions = I2CBusStats::getTransactionCount();
+        if (loops > 0) {
+            logger->info("I2C", (String("Bus time: ") + String((unsigned long)(busUs / loops)) + " us/loop, " +
+                                 String(transactions) + " transactions over " + String(loops) + " loops").c_str());
+            logger->info("LOOP", (String("Loop time: ") + String((unsigned long)(loopTimeUs / loops)) + " us/iteration (max " +
+                                  String(maxLoopTimeUs) + " us)").c_str());
+        }
+        loopTimeUs = 0;
+        maxLoopTimeUs = 0;
+
+        // CPU clock residency and frame cost per level
+        uint64_t idleMs = cpuGovernor.getLevelTimeMs(CpuGovernor::LEVEL_IDLE);
+        uint64_t boostMs = cpuGovernor.getLevelTimeMs(CpuGovernor::LEVEL_BOOST);
+        uint64_t totalMs = idleMs + boostMs;
+        String cpuLine = String("Clock: ") + (cpuGovernor.isEnabled() ? "" : "fixed, ");
+        for (uint8_t l = 0; l < CpuGovernor::LEVEL_COUNT; l++) {
+            CpuGovernor::Level level = (CpuGovernor::Level)l;
+            uint64_t ms = (level == CpuGovernor::LEVEL_IDLE) ? idleMs : boostMs;
+            cpuLine += String(CpuGovernor::levelMhz(level)) + " MHz " + String(totalMs ? (float)(100.0 * ms / totalMs) : 0.0f, 1) +
+                       "% (" + String(cpuGovernor.getFrameCount(level)) + " frames, " +
+                       String(cpuGovernor.getAverageFrameUs(level)) + " us/frame), ";
+        }
+        cpuLine += String(cpuGovernor.getTransitionCount()) + " switches, " + String(cpuGovernor.getSwitchTimeUs()) + " us switching";
+        logger->info("CPU", cpuLine.c_str());
+
+        // Event loop: share of wall time blocked in wait(), and what ended each wait
+        if (eventLoop.isRunning()) {
+            int64_t nowUs = esp_timer_get_time();
+            const EventLoop::Stats& loopStats = eventLoop.getStats();
+            String wakeLine = String("Idle ") + String(eventLoop.getIdlePercent(nowUs), 1) + "%, " +
+                              String(loopStats.wakes) + " wakes (deadline " + String(loopStats.deadlines);
+            for (uint8_t e = 0; e < EventLoop::EVENT_COUNT; e++) {
+                wakeLine += String(", ") + EventLoop::eventName((EventLoop::Event)(1 << e)) + " " + String(loopStats.events[e]);
             }
+            logger->info("LOOP", (wakeLine + ")").c_str());
+            eventLoop.resetStats(nowUs);
+        }
+
+        // Wakes per source, and wake to display on latency where the display came on
+        String wakeLine = "Wakes:";
+        for (uint8_t s = 0; s < WakeSources::SOURCE_COUNT; s++) {
+            const WakeSources::Stats& wake = wakeSources.getStats((WakeSources::Source)s);
+            wakeLine += String(" ") + WakeSources::sourceName((WakeSources::Source)s) + " " + String(wake.wakes);
+            if (wake.displayed > 0) {
+                wakeLine += String(" (on ") + String((uint32_t)(wake.sum_us / wake.displayed) / 1000.0f, 1) + " ms avg, max " +
+                            String(wake.max_us / 1000.0f, 1) + ")";
+            }
+            wakeLine += ",";
+        }
+        logger->info("SLEEP", (wakeLine + " unknown " + String(wakeSources.getUnknownCount()) + ", asleep " +
+                               String((unsigned long)(sleepTimeUs / 1000000)) + " s, deep sleep resumes " +
+                               String(RetainedState::get().resumes)).c_str());
+        logger->info("SLEEP", (String("Peripheral suspend ") + String(lastSuspendUs) + " us (max " + String(maxSuspendUs) +
+                               "), resume " + String(lastResumeUs) + " us (max " + String(maxResumeUs) + ")").c_str());
+
+        // Power status from the PMU telemetry snapshot (no bus access)
+        const PMU::Telemetry& power = pmu.getTelemetry();
+        if (power.valid) {
+            logger->info("BATTERY", (String("Battery Voltage: ") + String(power.battery_mv) + String(" mV")).c_str());
+            logger->info("BATTERY", (String("Battery Percentage: ") + String(power.battery_percent) + String(" %")).c_str());
+
+            logger->info("BATTERY", (String("USB Connected: ") + String(power.vbus_present ? "Yes" : "No") +
+                                     (power.vbus_present ? String(" (") + String(power.vbus_mv) + " mV)" : String(""))).c_str());
+            logger->info("BATTERY", (String("Battery Connected: ") + String(power.battery_present ? "Yes" : "No")).c_str());
+            logger->info("BATTERY", (String("Charging: ") + String(power.charging ? "Yes" : "No")).c_str());
+            logger->info("PMU", (String("System ") + String(power.system_mv) + " mV, die " + String(power.die_temp_c10 / 10.0f, 1) +
+                                 "°C, snapshot age " + String((unsigned long)pmu.getTelemetryAgeMs(millis())) + " ms (every " +
+                                 String((unsigned long)pmu.getTelemetryInterval()) + " ms, " + String(pmu.getSampleCount()) +
+                                 " reads, " + String(pmu.getFailureCount()) + " failed)").c_str());
+        } else {
+            logger->warn("BATTERY", "No PMU telemetry yet");
+        }
+
+        // Energy accounting (gauge steps split by the component model)
+        const EnergyAccount::Totals& energyTotals = energy.getTotals();
+        float tteHours = energy.getTimeToEmptyHours();
+        logger->info("ENERGY", (String("Drain: ") + (energy.getDrainMw() > 0 ? String(energy.getDrainMw(), 1) + " mW measured" :
+                                                     String(energy.getModelPowerMw(), 1) + " mW modeled") +
+                                ", time to empty " + (tteHours >= 0 ? String(tteHours, 1) + " h" : String("n/a")) +
+                                ", total " + String(energyTotals.measured_mwh, 1) + " mWh").c_str());
+        String split = "By component:";
+        for (uint8_t c = 0; c < EnergyAccount::COMPONENT_COUNT; c++) {
+            split += String(" ") + EnergyAccount::componentName((EnergyAccount::Component)c) + " " +
+                     String(energyTotals.energy_mwh[c], 1) + " mWh/" +
+                     String((unsigned long)(energyTotals.time_ms[c] / 60000)) + " min";
+        }
+        logger->info("ENERGY", split.c_str());
+
+        // Time Status (from the time service; no RTC read)
+        tm now;
+        if (timeService.getLocalTime(now, esp_timer_get_time())) {
+            char timeStr[32];
+            strftime(timeStr, sizeof(timeStr), "%Y-%m-%d %H:%M:%S", &now);
+            const TimeService::Stats& timeStats = timeService.getStats();
+            logger->info("TIME", (String("Current Time: ") + String(timeStr) + " (" +
+                                  TimeService::sourceName(timeService.getSource()) + ")").c_str());
+            logger->info("TIME", (String("Drift: ") + String(timeService.getDriftPpm(), 2) + " ppm, last offset " +
+                                  String(timeStats.last_offset_us) + " us, slewing " +
+                                  String((int32_t)timeService.getPendingSlewUs()) + " us, RTC edges " +
+                                  String(timeStats.rtc_samples) + " (" + String(timeStats.rtc_reads) + " reads, last " +
+                                  String(timeStats.last_edge_reads) + "), steps " +
+                                  String(timeStats.steps)).c_str());
+            
+            const AlarmScheduler::Stats& alarmStats = alarms.getStats();
+            int64_t nextAlarm = alarms.secondsUntilNext(timeService.localSeconds(esp_timer_get_time()));
+            logger->info("ALARM", (String("Pending: ") + String((unsigned long)alarms.pending()) +
+                                   (nextAlarm >= 0 ? String(", next in ") + String((long)nextAlarm) + " s" : String("")) +
+                                   ", dispatched " + String(alarmStats.dispatched) + ", RTC writes " +
+                                   String(alarmStats.hardware_writes)).c_str());
+        } else {
+            logger->warn("TIME", "Clock not set");
         }
         
         // IMU Status
@@ -412,6 +997,80 @@ void SystemManager::logHeartbeat() {
             if (imu.readTemperature(temp)) {
                 logger->info("IMU", (String("Temperature: ") + String(temp, 1) + "°C").c_str());
             }
+            
+            // Per-stage CPU cost since the previous heartbeat
+            for (size_t i = 0; i < imuPipeline.getStageCount(); i++) {
+                ImuStage* stage = imuPipeline.getStage(i);
+                logger->info("IMU", (String("Stage ") + stage->name() + ": " + String(stage->getSampleCount()) +
+                                     " samples, " + String(stage->getAverageCycles()) + " cycles/sample").c_str());
+                stage->resetStats();
+            }
+            
+            const float* q = orientationStage.getQuaternion();
+            logger->info("IMU", (String("Orientation q=(") + String(q[0], 3) + ", " + String(q[1], 3) + ", " +
+                                 String(q[2], 3) + ", " + String(q[3], 3) + "), cycles/update fixed=" +
+                                 String(orientationStage.getFixedCyclesPerUpdate()) + " float=" +
+                                 String(orientationStage.getFloatCyclesPerUpdate())).c_str());
+            
+            if (pedometer != nullptr) {
+                logger->info("STEPS", (String("Steps: ") + String(pedometer->steps()) + ", cadence " +
+                                       String(pedometer->cadence(), 0) + " steps/min (" +
+                                       pedometer->backendName() + ")").c_str());
+            }
+            
+#if IMU_RATE_GOVERNOR
+            logger->info("IMU", (String("Rate tier: ") + ImuRateGovernor::tierName(rateGovernor.getTier()) +
+                                 " (" + String(imu.getSampleRateHz()) + "Hz), still " +
+                                 String((unsigned long)(rateGovernor.getTierTimeMs(ImuRateGovernor::TIER_STILL) / 1000)) +
+                                 " s, active " +
+                                 String((unsigned long)(rateGovernor.getTierTimeMs(ImuRateGovernor::TIER_ACTIVE) / 1000)) +
+                                 " s, " + String(rateGovernor.getTransitionCount()) + " transitions").c_str());
+#endif
+            
+#if GESTURE_CLASSIFIER
+            const GestureClassifierStage::Stats& gestures = gestureStage.getStats();
+            if (gestures.windows > 0) {
+                logger->info("GESTURE", (String("Classifier: ") + String(gestures.windows) + " windows, " +
+                                         String((uint32_t)(gestures.cycles / gestures.windows)) + " cycles/window (max " +
+                                         String(gestures.max_cycles) + "), over budget " +
+                                         String(gestures.over_budget)).c_str());
+                gestureStage.resetClassifierStats();
+            }
+#endif
+            
+            const TraceRecorder::Stats& trace = traceRecorder.getStats();
+            if (trace.samples > 0) {
+                uint32_t writeUsPerBlock = trace.blocks ? (uint32_t)(trace.write_us / trace.blocks) : 0;
+                logger->info("TRACE", (String(traceRecorder.isRecording() ? "Recording: " : "Stopped: ") +
+                                       String(trace.samples) + " samples, " + String(trace.events) + " events, " +
+                                       String(trace.bytes) + " bytes, " +
+                                       String(traceRecorder.getBytesPerSample(), 2) + " bytes/sample, encode " +
+                                       String((uint32_t)(trace.encode_cycles / trace.samples)) + " cycles/sample, write " +
+                                       String(writeUsPerBlock) + " us/block (max " + String(trace.max_write_us) + ")").c_str());
+            }
+            
+            if (imuPipeline.isDataReadyMode()) {
+                const ImuPipeline::TimingStats& timing = imuPipeline.getTimingStats();
+                uint32_t meanJitter = timing.samples ? (uint32_t)(timing.sum_jitter_us / timing.samples) : 0;
+                logger->info("IMU", (String("Data ready: ") + String(timing.samples) + " samples, jitter mean " +
+                                     String(meanJitter) + " us max " + String(timing.max_jitter_us) + " us, period " +
+                                     String(timing.period_ns / 1000.0f, 1) + " us, missed " +
+                                     String(timing.missed) + ", duplicates " + String(timing.duplicates) +
+                                     ", dropped " + String(timing.dropped)).c_str());
+                imuPipeline.resetTimingStats();
+            }
+            
+            if (imu.isFifoEnabled()) {
+                const IMU::FifoStats& fifo = imu.getFifoStats();
+                unsigned long seconds = (millis() - fifo.enabled_ms) / 1000;
+                if (seconds > 0) {
+                    logger->info("IMU", (String("FIFO: ") + String(fifo.samples / seconds) + " samples/s, " +
+                                         String(fifo.transactions / seconds) + " transactions/s, " +
+                                         String((unsigned long)(fifo.bus_time_us / seconds)) + " us bus/s, loss " +
+                                         String(imu.getFifoLossRate() * 100.0f, 1) + "%, overflows " +
+                                         String(fifo.overflows)).c_str());
+                }
+            }
         }
         
         logger->footer();
@@ -5,15 +5,33 @@
 #include <LittleFS.h>
 #include <WiFi.h>
 #include <WiFiMulti.h>
+#include <driver/rtc_io.h>
+#include <esp_sntp.h>
+#include <sys/time.h>
 #include <time.h>
 
+#include "bus/bus_stats.hpp"
 #include "button/button.hpp"
 #include "config.h"
 #include "display/display.hpp"
+#include "imu/gesture_classifier_stage.hpp"
+#include "imu/gesture_stages.hpp"
 #include "imu/imu.hpp"
+#include "imu/imu_pipeline.hpp"
+#include "imu/orientation_stage.hpp"
+#include "imu/pedometer.hpp"
+#include "imu/rate_governor.hpp"
+#include "imu/trace_recorder.hpp"
+#include "loop/event_loop.hpp"
+#include "pmu/energy_account.hpp"
 #include "pmu/pmu.hpp"
+#include "power/cpu_governor.hpp"
+#include "power/retained_state.hpp"
+#include "power/wake_sources.hpp"
+#include "rtc/alarm_scheduler.hpp"
 #include "rtc/rtc.hpp"
 #include "storage/fs_manager.hpp"
+#include "time/time_service.hpp"
 #include "touch/touch_controller.hpp"
 #include "wifi_credentials.h"
 
@@ -25,39 +43,101 @@ class SystemManager {
   static constexpr unsigned long LIGHT_SLEEP_TIMEOUT = 30000;   // 30 seconds
   static constexpr unsigned long CLOCK_DRAW_INTERVAL = 1000;    // 1 second
   static constexpr unsigned long TIME_SYNC_INTERVAL = 3600000;  // 1 hour
+  static constexpr unsigned long MOTION_WAKE_WINDOW = 2000;     // Time to complete a wrist raise after a motion wake
+  static constexpr unsigned long WIFI_FAST_CONNECT_MS = 5000;   // Retained-AP reconnect before falling back to WiFiMulti
 
   Logger* logger = nullptr;
   TwoWire* i2c = nullptr;
   PMU pmu;
+  EnergyAccount energy;
+  CpuGovernor cpuGovernor;
+  EventLoop eventLoop;
+  WakeSources wakeSources;
   FSManager fsManager;
   Display display;
   TouchController touchController;
   RTC rtc;
+  TimeService timeService;
+  AlarmScheduler alarms;
   IMU imu;
+  ImuPipeline imuPipeline;
+  ImuWindowStage windowStage;
+  OrientationStage orientationStage;
+  WristRaiseStage wristRaise;
+  WristLowerStage wristLower;
+  DecisionTreeClassifier gestureTree;
+  GestureClassifierStage gestureStage;
+  MotionStage motionStage;
+  StepCounterStage stepCounterStage;
+  HardwarePedometer hardwarePedometer;
+  Pedometer* pedometer = nullptr;
+  ImuRateGovernor rateGovernor;
+  TraceRecorder traceRecorder;
   WiFiMulti wifiMulti;
   bool wifiConnected = false;
-  bool timeAvailable = false;
   unsigned long lastClockDraw = 0;
   unsigned long lastTimeSyncAttempt = 0;
-  char lastDisplayedTime[16] = {0};
   bool clockInitialized = false;
+  int64_t firstClockFrameUs = 0;  // Boot-to-first-clock latency
+
+  // Loop/bus accounting for the heartbeat
+  uint32_t loopIterations = 0;
+  uint64_t loopTimeUs = 0;
+  uint32_t maxLoopTimeUs = 0;
+  uint32_t lastHeartbeatIterations = 0;
+  uint64_t lastHeartbeatBusTimeUs = 0;
+  uint32_t lastHeartbeatTransactions = 0;
+
+  // Wake accounting (light sleep)
+  unsigned long motionWakeTime = 0;
+  uint64_t sleepTimeUs = 0;
+
+  // Deep sleep: state retained in RTC memory, fast resume
+  bool resuming = false;            // Booted from deep sleep with a valid retained record
+  unsigned long sleepSinceMs = 0;   // Display off since
+  unsigned long wifiFastUntil = 0;  // Retained-AP reconnect in progress until then
+  int64_t lastNtpLocalS = 0;
+  bool ntpRetained = false;         // Sync from before deep sleep still fresh: skip it on reconnect
+
+  // Peripheral suspend/resume latency (display off/on)
+  uint32_t lastSuspendUs = 0;
+  uint32_t maxSuspendUs = 0;
+  uint32_t lastResumeUs = 0;
+  uint32_t maxResumeUs = 0;
 
   void sleep();
   void wakeup();
+  void wakeDisplay();
+  bool deepSleepDue();
+  void enterDeepSleep();
+  void retainState();
+  bool resumeWiFi();
+  void suspendPeripherals();
+  void resumePeripherals();
+  void handlePowerEvents(uint16_t events);
+  void applyPowerPolicy(bool externalPower);
   void logHeartbeat();
+  int64_t nextDeadlineUs(int64_t now_us);
+  static void IRAM_ATTR buttonISR();
   bool initWiFi();
   void maintainWiFi();
   bool syncTime();
+  void seedSystemClock();
+  uint8_t energyState() const;
   void updateClockDisplay();
 
  public:
   void renderClockFace(const tm& timeinfo);
-  SystemManager(Logger* logger);
+  // resume: waking from deep sleep with RetainedState valid (skips the bus scan and diagnostics)
+  SystemManager(Logger* logger, bool resume = false);
   bool isInitialized() const { return initialized; }
   PMU& getPMU() { return pmu; }
   Display& getDisplay() { return display; }
   RTC& getRTC() { return rtc; }
+  AlarmScheduler& getAlarms() { return alarms; }
+  TimeService& getTimeService() { return timeService; }
   IMU& getIMU() { return imu; }
+  ImuPipeline& getImuPipeline() { return imuPipeline; }
   Logger* getLogger() { return logger; }
   TwoWire* getI2C() { return i2c; }
 
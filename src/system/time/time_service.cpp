@@ -0,0 +1,311 @@
+#include "time_service.hpp"
+
+#include <esp_timer.h>
+
+namespace {
+    int64_t clamp(int64_t value, int64_t low, int64_t high) {
+        return value < low ? low : (value > high ? high : value);
+    }
+}
+
+int64_t TimeService::daysFromCivil(int32_t year, uint32_t month, uint32_t day) {
+    year -= month <= 2;
+    const int32_t era = (year >= 0 ? year : year - 399) / 400;
+    const uint32_t year_of_era = (uint32_t)(year - era * 400);
+    const uint32_t day_of_year = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    const uint32_t day_of_era = year_of_era * 365 + year_of_era / 4 - year_of_era / 100 + day_of_year;
+    return (int64_t)era * 146097 + (int64_t)day_of_era - 719468;
+}
+
+int64_t TimeService::toSeconds(const RTC::DateTime& dt) {
+    return daysFromCivil(dt.year, dt.month, dt.day) * 86400 + dt.hour * 3600 + dt.minute * 60 + dt.second;
+}
+
+int64_t TimeService::toSeconds(const tm& t) {
+    return daysFromCivil(t.tm_year + 1900, t.tm_mon + 1, t.tm_mday) * 86400 + t.tm_hour * 3600 + t.tm_min * 60 +
+           t.tm_sec;
+}
+
+const char* TimeService::sourceName(Source source) {
+    switch (source) {
+        case SOURCE_RTC: return "RTC";
+        case SOURCE_NTP: return "NTP";
+        default: return "none";
+    }
+}
+
+int64_t TimeService::localMicros(int64_t now_us) const {
+    int64_t elapsed = now_us - base_timer_us;
+    return base_local_us + elapsed + (elapsed * rate_ppb + rate_residue) / 1000000000LL;
+}
+
+bool TimeService::getLocalTime(tm& out, int64_t now_us) const {
+    if (!isValid()) return false;
+    time_t seconds = (time_t)localSeconds(now_us);
+    return gmtime_r(&seconds, &out) != nullptr;  // Already local: no zone conversion
+}
+
+bool TimeService::takeSecondChanged() {
+    bool changed = second_changed;
+    second_changed = false;
+    return changed;
+}
+
+bool TimeService::readRtcSeconds(int64_t& seconds) {
+    RTC::DateTime dt;
+    stats.rtc_reads++;
+    if (!rtc.getDateTime(dt)) return false;
+    seconds = toSeconds(dt);
+    return true;
+}
+
+bool TimeService::anchorToRtc(int64_t now_us) {
+    if (!rtc.isInitialized()) return false;
+
+    RTC::DateTime dt;
+    bool valid = false;
+    stats.rtc_reads++;
+    if (!rtc.getDateTime(dt, valid)) return false;
+    if (!valid) {
+        if (logger != nullptr) logger->warn("TIME", "RTC oscillator was stopped - time invalid until NTP sync");
+        return false;
+    }
+    int64_t seconds = toSeconds(dt);
+
+    // Phase within the second is unknown until the first edge is timed; starting
+    // at the beginning of the second means that correction only moves forward
+    base_local_us = seconds * 1000000;
+    base_timer_us = now_us;
+    rate_residue = 0;
+    slew_us = 0;
+    source = SOURCE_RTC;
+    last_reference = SOURCE_NONE;
+    next_discipline_us = now_us + FIRST_DISCIPLINE_US;
+    return true;
+}
+
+void TimeService::restoreRate(int32_t ppb) {
+    rate_ppb = (int32_t)clamp(ppb, -MAX_RATE_PPB, MAX_RATE_PPB);
+    rate_residue = 0;
+}
+
+void TimeService::discipline(int64_t reference_local_us, int64_t at_us, Source from) {
+    if (!isValid()) {
+        base_local_us = reference_local_us;
+        base_timer_us = at_us;
+        source = from;
+        last_reference = from;
+        last_reference_timer_us = at_us;
+        if (logger != nullptr) logger->info("TIME", (String("Clock anchored to ") + sourceName(from)).c_str());
+        return;
+    }
+
+    int64_t offset = localMicros(at_us) + slew_us - reference_local_us;
+    stats.last_offset_us = (int32_t)clamp(offset, INT32_MIN, INT32_MAX);
+
+    // The coarse RTC anchor is always stepped onto the first measured edge
+    bool coarse = (last_reference == SOURCE_NONE);
+    if (coarse || offset > STEP_THRESHOLD_US || offset < -STEP_THRESHOLD_US) {
+        // Too far off to slew: step, and restart drift tracking from here
+        base_local_us = reference_local_us;
+        base_timer_us = at_us;
+        rate_residue = 0;
+        slew_us = 0;
+        last_reference = from;
+        last_reference_timer_us = at_us;
+        if (from >= source) source = from;
+        if (coarse) return;
+
+        stats.steps++;
+        if (logger != nullptr) {
+            logger->info("TIME", (String("Clock stepped by ") + String((int32_t)(offset / 1000)) + " ms (" +
+                                  sourceName(from) + ")").c_str());
+        }
+        return;
+    }
+
+    // Offset accumulated since the previous reference of the same kind is drift
+    if (last_reference == from) {
+        int64_t interval = at_us - last_reference_timer_us;
+        if (interval > 0) {
+            int64_t drift_ppb = offset * 1000000000LL / interval;
+            rate_ppb -= (int32_t)(drift_ppb >> RATE_GAIN_SHIFT);
+            rate_ppb = (int32_t)clamp(rate_ppb, -MAX_RATE_PPB, MAX_RATE_PPB);
+        }
+    }
+    last_reference = from;
+    last_reference_timer_us = at_us;
+
+    // NTP outranks the RTC once available
+    if (from >= source) source = from;
+    slew_us -= offset;
+}
+
+void TimeService::rebase(int64_t now_us) {
+    int64_t elapsed = now_us - base_timer_us;
+    if (elapsed <= 0) return;
+
+    // Rate correction with its sub-microsecond remainder carried over, so
+    // small corrections survive frequent rebasing
+    int64_t correction = elapsed * rate_ppb + rate_residue;
+    int64_t local = base_local_us + elapsed + correction / 1000000000LL;
+    rate_residue = correction % 1000000000LL;
+
+    if (slew_us != 0) {
+        slew_budget += elapsed * MAX_SLEW_PPM;
+        int64_t limit = slew_budget / 1000000;
+        int64_t step = clamp(slew_us, -limit, limit);
+        local += step;
+        slew_us -= step;
+        slew_budget -= (step < 0 ? -step : step) * 1000000;
+    } else {
+        slew_budget = 0;
+    }
+    base_local_us = local;
+    base_timer_us = now_us;
+}
+
+void TimeService::endHunt(int64_t next_us) {
+    hunting = false;
+    next_discipline_us = next_us;
+}
+
+void TimeService::hunt(int64_t now_us) {
+    // now_us is the loop start; the loop may have spent a while since
+    int64_t start_us = esp_timer_get_time();
+
+    if (!hunting) {
+        // Once NTP has set the clock the RTC is only a fallback
+        if (source != SOURCE_RTC || now_us < next_discipline_us || !rtc.isInitialized()) return;
+
+        // First read just before the next edge of the (estimated) second
+        int64_t to_edge = 1000000 - localMicros(start_us) % 1000000;
+        hunting = true;
+        hunt_step_us = EDGE_FIRST_STEP_US;
+        hunt_rtc_second = -1;
+        hunt_reads = 0;
+        next_read_us = start_us + (to_edge > EDGE_LEAD_US ? to_edge - EDGE_LEAD_US : 0);
+    }
+    if (start_us < next_read_us) return;
+
+    int64_t seconds;
+    bool ok = readRtcSeconds(seconds);
+    int64_t read_us = esp_timer_get_time();
+    read_latency_us = read_us - start_us;
+    hunt_reads++;
+
+    if (!ok) {
+        endHunt(read_us + DISCIPLINE_INTERVAL_US);
+        return;
+    }
+
+    if (hunt_rtc_second < 0 || seconds == hunt_rtc_second) {
+        if (hunt_reads == 1) {
+            pass_end_us = read_us + EDGE_TIMEOUT_US;
+        } else if (read_us > pass_end_us) {
+            // Woke up too late for this pass, or the RTC is not ticking
+            endHunt(read_us + (hunt_step_us == EDGE_FIRST_STEP_US ? DISCIPLINE_INTERVAL_US : EDGE_RETRY_US));
+            return;
+        }
+        hunt_rtc_second = seconds;
+        last_read_us = read_us;
+        next_read_us = read_us + hunt_step_us;
+        return;
+    }
+
+    // The edge lies between the last two reads
+    int64_t gap = read_us - last_read_us;
+    if (hunt_step_us > 0) {
+        // Narrow it down on a following edge, with reads spaced closer
+        hunt_step_us /= EDGE_STEP_DIVIDER;
+        if (hunt_step_us <= read_latency_us) hunt_step_us = 0;
+        int64_t start = last_read_us + 1000000 - EDGE_PASS_MARGIN_US;
+        int64_t skipped = read_us > start ? (read_us - start) / 1000000 + 1 : 0;
+        next_read_us = start + skipped * 1000000;
+        pass_end_us = next_read_us + gap + 2 * EDGE_PASS_MARGIN_US;
+        hunt_rtc_second = -1;
+        return;
+    }
+
+    if (gap > EDGE_MAX_GAP_US) {
+        // Loop too slow around the edge; try again shortly
+        endHunt(read_us + EDGE_RETRY_US);
+        return;
+    }
+    stats.rtc_samples++;
+    stats.last_edge_reads = hunt_reads;
+    discipline(seconds * 1000000, last_read_us + gap / 2, SOURCE_RTC);
+    endHunt(read_us + DISCIPLINE_INTERVAL_US);
+}
+
+void TimeService::requestRtcWriteback(int64_t now_us) {
+    writeback_pending = true;
+    writeback_requested_us = now_us;
+}
+
+void TimeService::writeback(int64_t now_us) {
+    if (!writeback_pending || !rtc.isInitialized()) return;
+
+    // Release STOP so that the RTC's first tick lands on our next second edge
+    const int64_t phase = 1000000 - RTC::STOP_RELEASE_TO_TICK_US;
+    int64_t local = localMicros(now_us);
+    int64_t into_second = local % 1000000;
+    bool aligned = into_second >= phase && into_second < phase + WRITEBACK_WINDOW_US;
+    if (!aligned && now_us - writeback_requested_us < WRITEBACK_TIMEOUT_US) return;
+
+    time_t seconds = (time_t)(local / 1000000);
+    tm t;
+    gmtime_r(&seconds, &t);
+    RTC::DateTime dt;
+    dt.year = t.tm_year + 1900;
+    dt.month = t.tm_mon + 1;
+    dt.day = t.tm_mday;
+    dt.weekday = t.tm_wday;
+    dt.hour = t.tm_hour;
+    dt.minute = t.tm_min;
+    dt.second = t.tm_sec;
+
+    bool ok = aligned ? rtc.setDateTimeAligned(dt) : rtc.setDateTime(dt);
+    writeback_pending = false;
+    if (logger != nullptr && !ok) logger->warn("TIME", "Failed to write time back to the RTC");
+}
+
+int64_t TimeService::nextDeadline(int64_t now_us) const {
+    if (!isValid()) return INT64_MAX;
+    if (hunting) return next_read_us > now_us ? next_read_us : now_us;
+
+    int64_t deadline = INT64_MAX;
+    if (source == SOURCE_RTC && rtc.isInitialized()) {
+        // Hunting starts EDGE_LEAD_US before the first edge after the discipline is due
+        int64_t due = next_discipline_us > now_us ? next_discipline_us : now_us;
+        int64_t to_edge = 1000000 - localMicros(due) % 1000000;
+        deadline = due + (to_edge > EDGE_LEAD_US ? to_edge - EDGE_LEAD_US : 0);
+    }
+
+    if (writeback_pending && rtc.isInitialized()) {
+        const int64_t phase = 1000000 - RTC::STOP_RELEASE_TO_TICK_US;
+        int64_t into_second = localMicros(now_us) % 1000000;
+        int64_t aligned;
+        if (into_second < phase) aligned = now_us + phase - into_second;
+        else if (into_second < phase + WRITEBACK_WINDOW_US) aligned = now_us;
+        else aligned = now_us + 1000000 - into_second + phase;
+        int64_t timeout = writeback_requested_us + WRITEBACK_TIMEOUT_US;
+        if (aligned < deadline) deadline = aligned;
+        if (timeout < deadline) deadline = timeout;
+    }
+    return deadline;
+}
+
+void TimeService::update(int64_t now_us) {
+    if (!isValid()) return;
+
+    rebase(now_us);
+    hunt(now_us);
+    writeback(now_us);
+
+    int64_t second = localSeconds(now_us);
+    if (second != last_second) {
+        last_second = second;
+        second_changed = true;
+    }
+}
@@ -0,0 +1,154 @@
+#pragma once
+#include <Arduino.h>
+#include <time.h>
+
+#include "../rtc/rtc.hpp"
+#include "../../logger/logger.hpp"
+
+/**
+ * Wall-clock time derived from esp_timer.
+ *
+ * The service is anchored once to the RTC or to NTP. After that, local
+ * time is the anchor plus the esp_timer time elapsed since, corrected by
+ * a drift estimate. Reading the time is arithmetic only: no I2C and no
+ * SNTP/newlib calls.
+ *
+ * Discipline: every DISCIPLINE_INTERVAL_US, update() times an RTC seconds
+ * edge. The edge repeats every second, so it is narrowed down over a few
+ * consecutive edges: the first pass reads the PCF85063 every
+ * EDGE_FIRST_STEP_US from EDGE_LEAD_US before the expected edge, each
+ * following pass starts just before the bracket found by the previous one
+ * with a quarter of the spacing, and the last pass reads back to back
+ * (spaced by the read latency). A measurement costs about 15 7-byte reads
+ * (about 70 for the first one after boot, when the phase is still
+ * unknown); the heartbeat reports the reads of the last one. NTP syncs go through discipline() as
+ * well; once NTP has set the clock, the RTC is no longer consulted. Offsets below STEP_THRESHOLD_US are slewed out at most
+ * MAX_SLEW_PPM, so time never runs backwards. Larger offsets step the
+ * clock. Each offset also feeds a drift (rate) estimate that is applied
+ * continuously.
+ *
+ * The RTC is the boot time source unless its oscillator-stop flag marks
+ * the time invalid. After an NTP sync, requestRtcWriteback() copies the
+ * time back to the RTC. The write is timed within the second, so the RTC
+ * carries sub-second alignment across power cycles.
+ *
+ * Times are local (the RTC keeps local time), in microseconds since
+ * 1970-01-01 00:00 local.
+ */
+class TimeService {
+public:
+    enum Source : uint8_t {
+        SOURCE_NONE = 0,
+        SOURCE_RTC,
+        SOURCE_NTP,
+    };
+
+    struct Stats {
+        uint32_t rtc_samples;       // RTC edges measured
+        uint32_t rtc_reads;         // I2C reads spent on them
+        uint32_t last_edge_reads;   // Reads of the last measured edge
+        uint32_t steps;             // Offsets too large to slew
+        int32_t last_offset_us;     // Estimate minus reference at the last discipline
+    };
+
+private:
+    static constexpr int64_t DISCIPLINE_INTERVAL_US = 600000000LL;  // 10 minutes
+    static constexpr int64_t FIRST_DISCIPLINE_US = 2000000;         // Refine the coarse RTC anchor soon after boot
+    static constexpr int64_t EDGE_LEAD_US = 60000;                  // Start reading before the expected edge
+    static constexpr int64_t EDGE_FIRST_STEP_US = 16000;            // Read spacing of the first pass
+    static constexpr int64_t EDGE_STEP_DIVIDER = 4;                 // Spacing of each further pass
+    static constexpr int64_t EDGE_PASS_MARGIN_US = 3000;            // Start before the bracket: wake-up latency, drift
+    static constexpr int64_t EDGE_MAX_GAP_US = 20000;               // Coarser edge brackets are discarded
+    static constexpr int64_t EDGE_TIMEOUT_US = 1500000;
+    static constexpr int64_t EDGE_RETRY_US = 10000000;
+    static constexpr int64_t STEP_THRESHOLD_US = 500000;
+    static constexpr int32_t MAX_SLEW_PPM = 500;
+    static constexpr int32_t MAX_RATE_PPB = 200000;                 // ±200 ppm
+    static constexpr int32_t RATE_GAIN_SHIFT = 1;                   // Apply half of each measured drift
+    static constexpr int64_t WRITEBACK_WINDOW_US = 20000;           // Tolerance on the aligned RTC write
+    static constexpr int64_t WRITEBACK_TIMEOUT_US = 10000000;       // Then write unaligned
+
+    RTC& rtc;
+    Logger* logger = nullptr;
+
+    Source source = SOURCE_NONE;
+    int64_t base_local_us = 0;      // Local time at base_timer_us
+    int64_t base_timer_us = 0;
+    int32_t rate_ppb = 0;           // esp_timer correction
+    int64_t rate_residue = 0;       // Fraction of a microsecond, in ppb-us
+    int64_t slew_us = 0;            // Offset still to apply
+    int64_t slew_budget = 0;        // Slew allowance in ppm-us
+
+    // Drift estimation: previous discipline against the same source
+    Source last_reference = SOURCE_NONE;
+    int64_t last_reference_timer_us = 0;
+
+    // RTC edge measurement
+    bool hunting = false;
+    int64_t next_discipline_us = 0;
+    int64_t hunt_step_us = 0;       // Read spacing of this pass; 0 = back to back
+    int64_t pass_end_us = 0;        // No edge by then: it was missed
+    int64_t next_read_us = 0;
+    int64_t last_read_us = 0;
+    int64_t read_latency_us = 0;
+    int64_t hunt_rtc_second = -1;
+    uint32_t hunt_reads = 0;
+
+    // RTC write-back after NTP
+    bool writeback_pending = false;
+    int64_t writeback_requested_us = 0;
+
+    int64_t last_second = -1;
+    bool second_changed = false;
+    Stats stats = {};
+
+    void rebase(int64_t now_us);
+    void hunt(int64_t now_us);
+    void endHunt(int64_t next_us);
+    void writeback(int64_t now_us);
+    bool readRtcSeconds(int64_t& seconds);
+
+public:
+    TimeService(RTC& rtc, Logger* logger) : rtc(rtc), logger(logger) {}
+
+    // Coarse anchor from the RTC (start of its second); update() refines it on the next seconds edge.
+    // Fails if the RTC reports an invalid time (oscillator stopped).
+    bool anchorToRtc(int64_t now_us);
+    // Copy the current time to the RTC from update(), aligned to the second
+    void requestRtcWriteback(int64_t now_us);
+    // Reference time from any source; slewed or stepped, and used for drift tracking
+    void discipline(int64_t reference_local_us, int64_t at_us, Source from);
+
+    // Once per main loop iteration: slewing, RTC discipline, second edges
+    void update(int64_t now_us);
+    // esp_timer time by which update() has discipline or write-back work (INT64_MAX if none).
+    // Second edges are not included: see nextSecondUs().
+    int64_t nextDeadline(int64_t now_us) const;
+    // esp_timer time of the next local second edge
+    int64_t nextSecondUs(int64_t now_us) const { return now_us + 1000000 - localMicros(now_us) % 1000000; }
+
+    bool isValid() const { return source != SOURCE_NONE; }
+    // An RTC edge is being timed: the loop should not block until it is done
+    bool isHunting() const { return hunting; }
+    Source getSource() const { return source; }
+    static const char* sourceName(Source source);
+
+    int64_t localMicros(int64_t now_us) const;
+    int64_t localSeconds(int64_t now_us) const { return localMicros(now_us) / 1000000; }
+    bool getLocalTime(tm& out, int64_t now_us) const;
+
+    // True once after each change of the local second (checked in update())
+    bool takeSecondChanged();
+
+    float getDriftPpm() const { return rate_ppb / 1000.0f; }
+    // Drift estimate carried across deep sleep (esp_timer restarts, the crystal does not change)
+    int32_t getRatePpb() const { return rate_ppb; }
+    void restoreRate(int32_t ppb);
+    int64_t getPendingSlewUs() const { return slew_us; }
+    const Stats& getStats() const { return stats; }
+
+    // Days since 1970-01-01 for a proleptic Gregorian date
+    static int64_t daysFromCivil(int32_t year, uint32_t month, uint32_t day);
+    static int64_t toSeconds(const RTC::DateTime& dt);
+    static int64_t toSeconds(const tm& t);
+};
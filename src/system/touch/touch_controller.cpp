@@ -1,7 +1,11 @@
 #include "touch_controller.hpp"
+#include "../loop/event_loop.hpp"
 
 #include <Arduino.h>
 
+#include "../bus/bus_lock.hpp"
+#include "../bus/bus_stats.hpp"
+
 bool TouchController::setBus(TwoWire &bus) {
     i2c = &bus;
     
@@ -21,13 +25,10 @@ bool TouchController::init() {
     digitalWrite(reset_pin, LOW);
     delay(20);
     digitalWrite(reset_pin, HIGH);
-    delay(50);
+    delay(BOOT_MS);
 
     // Initialize power mode
-    i2c->beginTransmission(i2c_addr);
-    i2c->write(REG_POWER_MODE);
-    i2c->write(0x01);
-    if (i2c->endTransmission() != 0) {
+    if (!writeRegister(REG_POWER_MODE, POWER_MONITOR)) {
         if (logger) logger->failure("TOUCH", "Power mode init failed");
         return false;
     }
@@ -55,116 +56,109 @@ void IRAM_ATTR TouchController::isrArg(void* arg) {
     TouchController* self = static_cast<TouchController*>(arg);
     if (self) {
         self->touch_event = true;
+        EventLoop::postFromISR(EventLoop::EVENT_TOUCH);
     }
 }
 
-void TouchController::handleInterrupt() {
+bool TouchController::handleInterrupt() {
     // called from non-ISR context (e.g. SystemManager::update())
-    if (!touch_event) return;
+    if (!touch_event) return false;
     touch_event = false; // clear early
+    if (hibernating) return false;  // Not readable until resume()
 
     // Read finger count first
-    uint8_t fingers = 0;
-    if (!safeReadRegisters(TouchController::REG_FINGER_NUM, &fingers, 1)) {
-        return; // failed to read finger count
+    TouchFrame frame = {0, last_frame.x, last_frame.y};
+    if (!safeReadRegisters(TouchController::REG_FINGER_NUM, &frame.fingers, 1)) {
+        return false; // failed to read finger count
     }
 
-    if (fingers == 0) {
-        // Finger released - detect swipe gesture (if no long press was fired)
-        if (touch_active) {
-            touch_active = false;
-            long_press_fired = false; // reset for next touch
-            
-            int16_t dx = touch_last_x - touch_start_x;
-            int16_t dy = touch_last_y - touch_start_y;
-            uint32_t duration = millis() - touch_start_time;
-            
-            int16_t abs_dx = dx < 0 ? -dx : dx;
-            int16_t abs_dy = dy < 0 ? -dy : dy;
-            
-            // Swipe detection: minimum distance (50px) and max duration (800ms)
-            if (duration < 800 && (abs_dx > 50 || abs_dy > 50)) {
-                String gesture = "";
-                
-                // Determine edge zones (assume ~480x480 display, adjust if needed)
-                const uint16_t edge_threshold = 100; // pixels from edge
-                bool from_top = (touch_start_y < edge_threshold);
-                bool from_bottom = (touch_start_y > 380);
-                bool from_left = (touch_start_x < edge_threshold);
-                bool from_right = (touch_start_x > 380);
-                
-                // Build gesture name from start position + direction
-                if (from_top && from_left) gesture = "TopLeft";
-                else if (from_top && from_right) gesture = "TopRight";
-                else if (from_bottom && from_left) gesture = "BottomLeft";
-                else if (from_bottom && from_right) gesture = "BottomRight";
-                else if (from_top) gesture = "Top";
-                else if (from_bottom) gesture = "Bottom";
-                else if (from_left) gesture = "Left";
-                else if (from_right) gesture = "Right";
-                
-                // Add swipe direction
-                if (abs_dx > abs_dy) {
-                    gesture += (dx > 0) ? " Swipe Right" : " Swipe Left";
-                } else {
-                    gesture += (dy > 0) ? " Swipe Down" : " Swipe Up";
-                }
-                
-                if (logger) {
-                    logger->info("TOUCH", (String("Gesture: ") + gesture).c_str());
-                }
-            }
-        }
-        return;
+    // Active touch - read coordinates
+    if (frame.fingers != 0 && !readTouch(frame.x, frame.y)) {
+        return false;
     }
+    last_frame = frame;
 
-    // Active touch - read coordinates and track for gesture detection
-    uint16_t x, y;
-    if (readTouch(x, y)) {
-        if (!touch_active) {
-            // New touch started
-            touch_active = true;
-            touch_start_x = x;
-            touch_start_y = y;
-            touch_start_time = millis();
-            long_press_fired = false;
-        }
-        touch_last_x = x;
-        touch_last_y = y;
-        
-        // Check for long press while finger is still down
-        if (!long_press_fired && touch_active) {
-            uint32_t duration = millis() - touch_start_time;
-            if (duration > 500) {
-                int16_t dx = x - touch_start_x;
-                int16_t dy = y - touch_start_y;
-                int16_t abs_dx = dx < 0 ? -dx : dx;
-                int16_t abs_dy = dy < 0 ? -dy : dy;
-                
-                // Fire long press if minimal movement (<20px)
-                if (abs_dx < 20 && abs_dy < 20) {
-                    long_press_fired = true;
-                    if (logger) {
-                        logger->info("TOUCH", "Gesture: Long Press");
-                    }
-                }
-            }
+    TouchGesture gesture = gestures.update(frame, millis());
+    if (gesture.type != TouchGesture::NONE && logger) {
+        char name[32];
+        gesture.format(name, sizeof(name));
+        logger->info("TOUCH", (String("Gesture: ") + name).c_str());
+    }
+    return true;
+}
+
+bool TouchController::isTouched() {
+    if (!initialized || hibernating) return false;
+
+    uint8_t fingers = 0;
+    return safeReadRegisters(REG_FINGER_NUM, &fingers, 1) && fingers != 0;
+}
+
+bool TouchController::suspend(bool keep_wake) {
+    if (!initialized) return false;
+    if (suspended) return true;
+
+    if (!writeRegister(REG_POWER_MODE, keep_wake ? POWER_MONITOR : POWER_HIBERNATE)) {
+        if (logger) logger->warn("TOUCH", "Failed to enter low-power mode");
+        return false;
+    }
+    suspended = true;
+    hibernating = !keep_wake;
+    return true;
+}
+
+bool TouchController::resume() {
+    if (!suspended) return true;
+
+    // Hibernate only ends with a reset; the configuration is the same as after init()
+    if (hibernating) {
+        digitalWrite(reset_pin, LOW);
+        delay(1);
+        digitalWrite(reset_pin, HIGH);
+        delay(BOOT_MS);
+        if (!writeRegister(REG_POWER_MODE, POWER_MONITOR)) {
+            if (logger) logger->warn("TOUCH", "Failed to resume from hibernate");
+            return false;
         }
     }
+    suspended = false;
+    hibernating = false;
+    touch_event = false;  // Edges seen while suspended are not touches
+    last_frame.fingers = 0;
+    return true;
+}
+
+bool TouchController::writeRegister(uint8_t reg, uint8_t value) {
+    if (!i2c) return false;
+
+    I2CBusLock::Guard lock;
+    I2CBusStats::chargeWrite(1);
+    i2c->beginTransmission(i2c_addr);
+    i2c->write(reg);
+    i2c->write(value);
+    return i2c->endTransmission() == 0;
 }
 
 bool TouchController::safeReadRegisters(uint8_t reg, uint8_t* buf, size_t len, int retries) {
     if (!i2c) return false;
 
     for (int i=0; i<retries; i++) {
-        i2c->beginTransmission(i2c_addr);
-        i2c->write(reg);
-        if (i2c->endTransmission(false) != 0) { delay(10 + i*10); continue; }
-        delayMicroseconds(500);
-        size_t got = i2c->requestFrom(static_cast<uint8_t>(i2c_addr), static_cast<size_t>(len));
-        if (got < len) { delay(10 + i*10); continue; }
-        for (size_t j=0; j<len; j++) buf[j] = i2c->read();
-        return true;
+        {
+            // The retry back-off below runs with the bus released
+            I2CBusLock::Guard lock;
+            I2CBusStats::chargeRead(len);
+            i2c->beginTransmission(i2c_addr);
+            i2c->write(reg);
+            if (i2c->endTransmission(false) == 0) {
+                delayMicroseconds(500);
+                size_t got = i2c->requestFrom(static_cast<uint8_t>(i2c_addr), static_cast<size_t>(len));
+                if (got >= len) {
+                    for (size_t j=0; j<len; j++) buf[j] = i2c->read();
+                    return true;
+                }
+            }
+        }
+        delay(10 + i*10);
     }
     return false;
 }
@@ -3,11 +3,14 @@
 #include <Wire.h>
 
 #include "config.h"
+#include "touch_gestures.hpp"
 #include "../../logger/logger.hpp"
 
 class TouchController {
-private:
+public:
     static constexpr uint8_t ADDR_FT3168 = 0x38;
+
+private:
     static constexpr uint8_t DEV_ID = 3;
 
     uint8_t i2c_addr = ADDR_FT3168; // default I2C address
@@ -16,28 +19,46 @@ private:
     TwoWire* i2c = nullptr;
     Logger* logger = nullptr;
     bool initialized = false;
+    bool suspended = false;
+    bool hibernating = false;
     volatile bool touch_event = false;
     
+    static constexpr unsigned long BOOT_MS = 50;    // Reset release to first I2C access
+    
     // Software gesture detection
-    bool touch_active = false;
-    bool long_press_fired = false;
-    uint16_t touch_start_x = 0;
-    uint16_t touch_start_y = 0;
-    uint16_t touch_last_x = 0;
-    uint16_t touch_last_y = 0;
-    uint32_t touch_start_time = 0;
+    TouchGestureDetector gestures;
+    TouchFrame last_frame = {0, 0, 0};
 
     bool init();
     static void IRAM_ATTR isrArg(void* arg);
     bool safeReadRegisters(uint8_t reg, uint8_t *buf, size_t len, int retries = 3);
+    bool writeRegister(uint8_t reg, uint8_t value);
 public:
     // Constructor: optionally specify I2C address for different FT3x68 variants
     TouchController(Logger* logger) { this->logger = logger; };
     bool setBus(TwoWire &bus);
 
-    void handleInterrupt();
+    // Returns true when a new frame was read (see getLastFrame())
+    bool handleInterrupt();
+    const TouchFrame& getLastFrame() const { return last_frame; }
 
     bool readTouch(uint16_t &x, uint16_t &y);
+    // Finger on the panel now (one register read; false while hibernating)
+    bool isTouched();
+
+    // Sleep: hibernate (lowest current, no touch interrupt, resume needs a
+    // reset pulse) or monitor mode when touch must still wake the system.
+    // resume() skips the ID check and interrupt setup of a full init.
+    bool suspend(bool keep_wake);
+    bool resume();
+    bool isSuspended() const { return suspended; }
+
+    // REG_POWER_MODE values
+    enum PowerMode : uint8_t {
+        POWER_ACTIVE = 0x00,
+        POWER_MONITOR = 0x01,
+        POWER_HIBERNATE = 0x03,
+    };
 
     // FT3168 register map
     enum Registers : uint8_t {
@@ -0,0 +1,78 @@
+#include "touch_gestures.hpp"
+
+#include <stdio.h>
+
+namespace {
+    int16_t absolute(int16_t value) {
+        return value < 0 ? -value : value;
+    }
+}
+
+void TouchGesture::format(char* out, size_t len) const {
+    if (type == LONG_PRESS) {
+        snprintf(out, len, "Long Press");
+        return;
+    }
+    if (type != SWIPE) {
+        snprintf(out, len, "None");
+        return;
+    }
+
+    const char* vertical = (edges & EDGE_TOP) ? "Top" : (edges & EDGE_BOTTOM) ? "Bottom" : "";
+    const char* horizontal = (edges & EDGE_LEFT) ? "Left" : (edges & EDGE_RIGHT) ? "Right" : "";
+    static const char* DIRECTIONS[] = {"Up", "Down", "Left", "Right"};
+    snprintf(out, len, "%s%s Swipe %s", vertical, horizontal, DIRECTIONS[direction]);
+}
+
+TouchGesture TouchGestureDetector::update(const TouchFrame& frame, uint32_t now_ms) {
+    TouchGesture gesture = {TouchGesture::NONE, TouchGesture::UP, TouchGesture::EDGE_NONE};
+
+    if (frame.fingers == 0) {
+        // Finger released - detect swipe gesture (if no long press was fired)
+        if (!touch_active) return gesture;
+        touch_active = false;
+        long_press_fired = false;
+
+        int16_t dx = last_x - start_x;
+        int16_t dy = last_y - start_y;
+        uint32_t duration = now_ms - start_ms;
+
+        // Swipe detection: minimum distance and max duration
+        if (duration < SWIPE_MAX_MS && (absolute(dx) > SWIPE_MIN_PX || absolute(dy) > SWIPE_MIN_PX)) {
+            gesture.type = TouchGesture::SWIPE;
+            if (start_y < EDGE_NEAR) gesture.edges |= TouchGesture::EDGE_TOP;
+            else if (start_y > EDGE_FAR) gesture.edges |= TouchGesture::EDGE_BOTTOM;
+            if (start_x < EDGE_NEAR) gesture.edges |= TouchGesture::EDGE_LEFT;
+            else if (start_x > EDGE_FAR) gesture.edges |= TouchGesture::EDGE_RIGHT;
+
+            if (absolute(dx) > absolute(dy)) {
+                gesture.direction = (dx > 0) ? TouchGesture::RIGHT : TouchGesture::LEFT;
+            } else {
+                gesture.direction = (dy > 0) ? TouchGesture::DOWN : TouchGesture::UP;
+            }
+        }
+        return gesture;
+    }
+
+    // Active touch - track for gesture detection
+    if (!touch_active) {
+        touch_active = true;
+        start_x = frame.x;
+        start_y = frame.y;
+        start_ms = now_ms;
+        long_press_fired = false;
+    }
+    last_x = frame.x;
+    last_y = frame.y;
+
+    // Long press while the finger is still down, with minimal movement
+    if (!long_press_fired && now_ms - start_ms > LONG_PRESS_MS) {
+        int16_t dx = frame.x - start_x;
+        int16_t dy = frame.y - start_y;
+        if (absolute(dx) < LONG_PRESS_SLOP_PX && absolute(dy) < LONG_PRESS_SLOP_PX) {
+            long_press_fired = true;
+            gesture.type = TouchGesture::LONG_PRESS;
+        }
+    }
+    return gesture;
+}
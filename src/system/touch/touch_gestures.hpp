@@ -0,0 +1,60 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * One FT3168 report: finger count and first touch point (0 fingers = release).
+ */
+struct TouchFrame {
+    uint8_t fingers;
+    uint16_t x;
+    uint16_t y;
+};
+
+struct TouchGesture {
+    enum Type : uint8_t { NONE, LONG_PRESS, SWIPE };
+    enum Direction : uint8_t { UP, DOWN, LEFT, RIGHT };
+    enum Edge : uint8_t {
+        EDGE_NONE = 0,
+        EDGE_TOP = 0x01,
+        EDGE_BOTTOM = 0x02,
+        EDGE_LEFT = 0x04,
+        EDGE_RIGHT = 0x08,
+    };
+
+    Type type;
+    Direction direction;  // SWIPE only
+    uint8_t edges;        // Edge bits of the swipe start point
+
+    // e.g. "TopLeft Swipe Right", "Long Press"
+    void format(char* out, size_t len) const;
+};
+
+/**
+ * Swipe and long-press detection over a stream of touch frames.
+ *
+ * Kept free of Arduino and I2C so recorded touch input can be replayed on
+ * the host (tools/input_replay.cpp) through the same code as on the watch.
+ */
+class TouchGestureDetector {
+private:
+    static constexpr uint32_t SWIPE_MAX_MS = 800;
+    static constexpr int16_t SWIPE_MIN_PX = 50;
+    static constexpr uint32_t LONG_PRESS_MS = 500;
+    static constexpr int16_t LONG_PRESS_SLOP_PX = 20;
+    static constexpr uint16_t EDGE_NEAR = 100;  // Pixels from the top/left edge
+    static constexpr uint16_t EDGE_FAR = 380;   // ~480x480 panel
+
+    bool touch_active = false;
+    bool long_press_fired = false;
+    uint16_t start_x = 0;
+    uint16_t start_y = 0;
+    uint16_t last_x = 0;
+    uint16_t last_y = 0;
+    uint32_t start_ms = 0;
+
+public:
+    // Returns the gesture completed by this frame (type NONE if none)
+    TouchGesture update(const TouchFrame& frame, uint32_t now_ms);
+    bool isTouching() const { return touch_active; }
+};
@@ -0,0 +1,201 @@
+// AlarmScheduler against a simulated PCF85063 and clock.
+//   pio test -e native -f test_alarm_scheduler
+
+#include <time.h>
+#include <unity.h>
+
+#include "system/rtc/alarm_scheduler.hpp"
+
+namespace {
+    const int64_t START_S = 1767225600;  // 2026-01-01 00:00:00 local
+    const int64_t DAY_S = 86400;
+
+    // Alarm registers match on day, hour, minute and second; the countdown
+    // runs at 1Hz. Every arm/disarm is one register write.
+    class FakeRtc : public AlarmHardware {
+    public:
+        int64_t now_s = START_S;
+        bool alarm_enabled = false;
+        uint8_t alarm[4] = {};
+        bool countdown_enabled = false;
+        int64_t countdown_end_s = 0;
+        uint32_t writes = 0;
+
+        bool armAlarm(uint8_t day, uint8_t hour, uint8_t minute, uint8_t second) override {
+            alarm_enabled = true;
+            alarm[0] = day;
+            alarm[1] = hour;
+            alarm[2] = minute;
+            alarm[3] = second;
+            writes++;
+            return true;
+        }
+
+        bool armCountdown(uint8_t seconds) override {
+            countdown_enabled = true;
+            countdown_end_s = now_s + seconds;
+            writes++;
+            return true;
+        }
+
+        bool disarm() override {
+            alarm_enabled = false;
+            countdown_enabled = false;
+            writes++;
+            return true;
+        }
+
+        // Advances the clock by one second; true when the alarm or countdown fired
+        bool tick() {
+            now_s++;
+            bool fired = false;
+            if (countdown_enabled && now_s >= countdown_end_s) {
+                countdown_enabled = false;
+                fired = true;
+            }
+            if (alarm_enabled) {
+                time_t seconds = (time_t)now_s;
+                tm t;
+                gmtime_r(&seconds, &t);
+                fired |= t.tm_mday == alarm[0] && t.tm_hour == alarm[1] && t.tm_min == alarm[2] &&
+                         t.tm_sec == alarm[3];
+            }
+            return fired;
+        }
+    };
+
+    struct Fired {
+        FakeRtc* rtc;
+        int64_t at_s;
+        int count;
+    };
+
+    void record(void* arg, uint32_t id) {
+        Fired* fired = (Fired*)arg;
+        fired->at_s = fired->rtc->now_s;
+        fired->count++;
+        (void)id;
+    }
+
+    // The main loop: dispatch every second, with the RTC interrupt flag
+    void runUntilIdle(FakeRtc& rtc, AlarmScheduler& scheduler, int64_t limit_s) {
+        while (scheduler.pending() > 0 && rtc.now_s < limit_s) {
+            bool fired = rtc.tick();
+            scheduler.dispatch(rtc.now_s, fired);
+        }
+    }
+}
+
+void setUp() {}
+void tearDown() {}
+
+void test_countdown_written_once() {
+    FakeRtc rtc;
+    AlarmScheduler scheduler(rtc);
+    Fired fired = {&rtc, 0, 0};
+    int64_t due = START_S + 100;
+
+    scheduler.schedule(due, record, &fired, rtc.now_s);
+    TEST_ASSERT_EQUAL(AlarmScheduler::ARMED_COUNTDOWN, scheduler.getArmed());
+    runUntilIdle(rtc, scheduler, due + 10);
+
+    TEST_ASSERT_EQUAL(1, fired.count);
+    TEST_ASSERT_EQUAL_INT64(due, fired.at_s);
+    // Countdown, then disarm once the heap is empty
+    TEST_ASSERT_EQUAL_UINT32(2, rtc.writes);
+    TEST_ASSERT_EQUAL_UINT32(2, scheduler.getStats().hardware_writes);
+}
+
+void test_alarm_kept_inside_countdown_range() {
+    FakeRtc rtc;
+    AlarmScheduler scheduler(rtc);
+    Fired fired = {&rtc, 0, 0};
+    int64_t due = START_S + 3600;
+
+    scheduler.schedule(due, record, &fired, rtc.now_s);
+    TEST_ASSERT_EQUAL(AlarmScheduler::ARMED_ALARM, scheduler.getArmed());
+    runUntilIdle(rtc, scheduler, due + 10);
+
+    TEST_ASSERT_EQUAL(1, fired.count);
+    TEST_ASSERT_EQUAL_INT64(due, fired.at_s);
+    TEST_ASSERT_EQUAL_UINT32(2, rtc.writes);
+}
+
+void test_far_event_rewrites_only_when_intermediate_fires() {
+    FakeRtc rtc;
+    AlarmScheduler scheduler(rtc);
+    Fired fired = {&rtc, 0, 0};
+    int64_t due = START_S + 60 * DAY_S + 123;
+
+    scheduler.schedule(due, record, &fired, rtc.now_s);
+    TEST_ASSERT_EQUAL_INT64(START_S + AlarmScheduler::ALARM_HORIZON_S, scheduler.getArmedTarget());
+
+    // One more loop pass must not touch the hardware
+    rtc.tick();
+    scheduler.dispatch(rtc.now_s);
+    TEST_ASSERT_EQUAL_UINT32(1, rtc.writes);
+
+    runUntilIdle(rtc, scheduler, due + 10);
+
+    TEST_ASSERT_EQUAL(1, fired.count);
+    TEST_ASSERT_EQUAL_INT64(due, fired.at_s);
+    // Intermediate alarms at +27 d and +54 d, the final alarm, then disarm
+    TEST_ASSERT_EQUAL_UINT32(4, rtc.writes);
+}
+
+void test_heap_top_change_rearms() {
+    FakeRtc rtc;
+    AlarmScheduler scheduler(rtc);
+    Fired fired = {&rtc, 0, 0};
+    int64_t far = START_S + 10 * DAY_S;
+    int64_t near = START_S + 3600;
+
+    scheduler.schedule(far, record, &fired, rtc.now_s);
+    TEST_ASSERT_EQUAL_UINT32(1, rtc.writes);
+
+    // A later event leaves the hardware alone
+    uint32_t later = scheduler.schedule(far + DAY_S, record, &fired, rtc.now_s);
+    TEST_ASSERT_EQUAL_UINT32(1, rtc.writes);
+
+    // An earlier one takes over, and cancelling it restores the first
+    uint32_t earlier = scheduler.schedule(near, record, &fired, rtc.now_s);
+    TEST_ASSERT_EQUAL_UINT32(2, rtc.writes);
+    TEST_ASSERT_EQUAL_INT64(near, scheduler.getArmedTarget());
+
+    TEST_ASSERT_TRUE(scheduler.cancel(earlier, rtc.now_s));
+    TEST_ASSERT_EQUAL_UINT32(3, rtc.writes);
+    TEST_ASSERT_EQUAL_INT64(far, scheduler.getArmedTarget());
+
+    TEST_ASSERT_TRUE(scheduler.cancel(later, rtc.now_s));
+    TEST_ASSERT_EQUAL_UINT32(3, rtc.writes);
+
+    runUntilIdle(rtc, scheduler, far + 10);
+    TEST_ASSERT_EQUAL(1, fired.count);
+    TEST_ASSERT_EQUAL_INT64(far, fired.at_s);
+}
+
+void test_refresh_rewrites_after_clock_step() {
+    FakeRtc rtc;
+    AlarmScheduler scheduler(rtc);
+    Fired fired = {&rtc, 0, 0};
+    int64_t due = START_S + 2 * DAY_S;
+
+    scheduler.schedule(due, record, &fired, rtc.now_s);
+    rtc.now_s += DAY_S;  // Clock stepped forward by a sync
+    scheduler.refresh(rtc.now_s);
+    TEST_ASSERT_EQUAL_UINT32(2, rtc.writes);
+
+    runUntilIdle(rtc, scheduler, due + 10);
+    TEST_ASSERT_EQUAL(1, fired.count);
+    TEST_ASSERT_EQUAL_INT64(due, fired.at_s);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_countdown_written_once);
+    RUN_TEST(test_alarm_kept_inside_countdown_range);
+    RUN_TEST(test_far_event_rewrites_only_when_intermediate_fires);
+    RUN_TEST(test_heap_top_change_rearms);
+    RUN_TEST(test_refresh_rewrites_after_clock_step);
+    return UNITY_END();
+}
@@ -0,0 +1,177 @@
+// Replays labeled IMU traces through the on-device gesture classifier.
+//
+// Input: CSV from `imu_trace_to_csv.py --raw` with an extra `label` column
+// (0 = none, 1 = wrist raise, 2 = wrist lower) marking each sample.
+//
+// Build (from the repository root):
+//   g++ -O2 -std=gnu++11 -Isrc -o gesture_eval tools/gesture_eval.cpp
+//       src/system/imu/gesture_classifier.cpp src/system/imu/imu_kernels.cpp
+// Run:
+//   ./gesture_eval [--tree gesture_tree.bin] trace1.csv [trace2.csv ...]
+//
+// Reports per-window accuracy, per-gesture recall / false events and the
+// host time per window. Windowing and event rules mirror
+// GestureClassifierStage (128-sample window, 16-sample hop, 1s cooldown).
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "system/imu/gesture_classifier.hpp"
+
+namespace {
+    const size_t WINDOW = 128;
+    const size_t HOP = 16;
+    const int64_t COOLDOWN_US = 1000000;
+    const int64_t LATE_US = 500000;  // Events this long after a labeled gesture still count
+
+    struct Sample {
+        int64_t timestamp_us;  // Unwrapped by imu_trace_to_csv.py
+        int16_t axes[6];
+        uint8_t label;
+    };
+
+    struct Segment {
+        int64_t start_us;
+        int64_t end_us;
+        uint8_t label;
+        bool hit;
+    };
+
+    struct Totals {
+        uint32_t windows = 0;
+        uint32_t correct = 0;
+        uint32_t segments[GESTURE_COUNT] = {0};
+        uint32_t hits[GESTURE_COUNT] = {0};
+        uint32_t false_events[GESTURE_COUNT] = {0};
+        double ns = 0.0;
+    };
+
+    bool readTrace(const char* path, std::vector<Sample>& samples) {
+        FILE* f = fopen(path, "r");
+        if (f == nullptr) return false;
+        char line[256];
+        if (fgets(line, sizeof(line), f) == nullptr) {  // Header
+            fclose(f);
+            return false;
+        }
+        while (fgets(line, sizeof(line), f) != nullptr) {
+            Sample s;
+            int v[6];
+            long long ts;
+            int label;
+            if (sscanf(line, "%lld,%d,%d,%d,%d,%d,%d,%d", &ts, &v[0], &v[1], &v[2], &v[3], &v[4], &v[5], &label) != 8) {
+                continue;
+            }
+            s.timestamp_us = (int64_t)ts;
+            for (int i = 0; i < 6; i++) s.axes[i] = (int16_t)v[i];
+            s.label = (uint8_t)label;
+            samples.push_back(s);
+        }
+        fclose(f);
+        return true;
+    }
+
+    void evaluate(const std::vector<Sample>& samples, GestureClassifier& classifier, Totals& totals) {
+        // Labeled gesture segments
+        std::vector<Segment> segments;
+        for (size_t i = 0; i < samples.size(); i++) {
+            if (samples[i].label == GESTURE_NONE || samples[i].label >= GESTURE_COUNT) continue;
+            if (segments.empty() || segments.back().label != samples[i].label ||
+                samples[i - 1].label != samples[i].label) {
+                segments.push_back(Segment{samples[i].timestamp_us, samples[i].timestamp_us, samples[i].label, false});
+                totals.segments[samples[i].label]++;
+            }
+            segments.back().end_us = samples[i].timestamp_us;
+        }
+
+        std::vector<int16_t> columns[6];
+        Gesture last_class = GESTURE_NONE;
+        int64_t last_event_us = 0;
+        bool any_event = false;
+
+        for (size_t end = WINDOW; end <= samples.size(); end += HOP) {
+            for (int c = 0; c < 6; c++) {
+                columns[c].resize(WINDOW);
+                for (size_t i = 0; i < WINDOW; i++) columns[c][i] = samples[end - WINDOW + i].axes[c];
+            }
+            const int16_t* axes[6];
+            for (int c = 0; c < 6; c++) axes[c] = columns[c].data();
+
+            auto start = std::chrono::steady_clock::now();
+            Gesture gesture = classifier.classify(axes, WINDOW);
+            totals.ns += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+            const Sample& newest = samples[end - 1];
+            totals.windows++;
+            if (gesture == newest.label) totals.correct++;
+
+            bool cooled = !any_event || newest.timestamp_us - last_event_us > COOLDOWN_US;
+            if (gesture != GESTURE_NONE && gesture != last_class && cooled) {
+                any_event = true;
+                last_event_us = newest.timestamp_us;
+
+                bool matched = false;
+                for (Segment& segment : segments) {
+                    if (segment.label == gesture && newest.timestamp_us >= segment.start_us &&
+                        newest.timestamp_us <= segment.end_us + LATE_US) {
+                        if (!segment.hit) totals.hits[gesture]++;
+                        segment.hit = true;
+                        matched = true;
+                    }
+                }
+                if (!matched) totals.false_events[gesture]++;
+            }
+            last_class = gesture;
+        }
+    }
+
+    bool loadTree(const char* path, DecisionTreeClassifier& tree) {
+        FILE* f = fopen(path, "rb");
+        if (f == nullptr) return false;
+        uint8_t blob[5 + DecisionTreeClassifier::MAX_NODES * DecisionTreeClassifier::NODE_BYTES];
+        size_t len = fread(blob, 1, sizeof(blob), f);
+        fclose(f);
+        return tree.load(blob, len);
+    }
+}
+
+int main(int argc, char** argv) {
+    DecisionTreeClassifier tree;
+    Totals totals;
+    int traces = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--tree") == 0 && i + 1 < argc) {
+            if (!loadTree(argv[++i], tree)) {
+                fprintf(stderr, "invalid tree: %s\n", argv[i]);
+                return 1;
+            }
+            continue;
+        }
+        std::vector<Sample> samples;
+        if (!readTrace(argv[i], samples)) {
+            fprintf(stderr, "cannot read %s\n", argv[i]);
+            return 1;
+        }
+        evaluate(samples, tree, totals);
+        traces++;
+    }
+
+    if (traces == 0) {
+        fprintf(stderr, "usage: %s [--tree tree.bin] trace.csv...\n", argv[0]);
+        return 1;
+    }
+
+    static const char* NAMES[GESTURE_COUNT] = {"none", "wrist_raise", "wrist_lower"};
+    printf("windows: %u, accuracy %.1f%%, %.0f ns/window (host)\n", totals.windows,
+           totals.windows ? 100.0 * totals.correct / totals.windows : 0.0,
+           totals.windows ? totals.ns / totals.windows : 0.0);
+    for (int g = 1; g < GESTURE_COUNT; g++) {
+        printf("%s: %u/%u detected, %u false events\n", NAMES[g], totals.hits[g], totals.segments[g],
+               totals.false_events[g]);
+    }
+    return 0;
+}
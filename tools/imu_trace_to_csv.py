@@ -0,0 +1,131 @@
+#!/usr/bin/env python3
+"""Convert an IMU trace recorded on the watch (ImuTrace format) to CSV.
+
+Usage: imu_trace_to_csv.py imu_trace.bin [out.csv] [--raw] [--events]
+
+By default accel is written in g and gyro in dps; --raw keeps the int16
+sensor counts. --events writes the recorded input events (touch frames,
+button edges, RTC interrupts) instead of the samples. See
+src/system/imu/imu_trace.hpp for the format.
+"""
+import csv
+import struct
+import sys
+
+HEADER = struct.Struct("<4sBBHHHI")
+BLOCK_HEADER = struct.Struct("<2sHHI")
+EVENT = struct.Struct("<2sBxIhhh")
+CHANNELS = ("ax", "ay", "az", "gx", "gy", "gz")
+EVENT_TYPES = {1: "touch", 2: "button", 3: "rtc"}
+
+
+def unzigzag(value):
+    return (value >> 1) ^ -(value & 1)
+
+
+def varints(data, pos):
+    while True:
+        value = 0
+        shift = 0
+        while True:
+            byte = data[pos]
+            pos += 1
+            value |= (byte & 0x7F) << shift
+            shift += 7
+            if byte < 0x80:
+                break
+        yield unzigzag(value)
+
+
+def decode(data):
+    magic, version, accel_g, gyro_dps, rate_hz, block_samples, _ = HEADER.unpack_from(data, 0)
+    if magic != b"IMUT" or version not in (1, 2):
+        raise ValueError("not an IMU trace (version 1 or 2)")
+    info = {"accel_g": accel_g, "gyro_dps": gyro_dps, "rate_hz": rate_hz, "block_samples": block_samples}
+
+    samples = []
+    events = []
+    last_us = None
+
+    # Stamps are the low 32 bits of the watch clock: unwrap against the previous record
+    def unwrap(stamp):
+        nonlocal last_us
+        if last_us is not None:
+            delta = (stamp - last_us) & 0xFFFFFFFF
+            stamp = last_us + (delta - (1 << 32) if delta & 0x80000000 else delta)
+        last_us = stamp
+        return stamp
+
+    pos = HEADER.size
+    while pos + BLOCK_HEADER.size <= len(data):
+        if data[pos:pos + 2] == b"EV":
+            _, kind, timestamp, a, b, c = EVENT.unpack_from(data, pos)
+            events.append((unwrap(timestamp), EVENT_TYPES.get(kind, str(kind)), a, b, c))
+            pos += EVENT.size
+            continue
+        sync, count, length, first_us = BLOCK_HEADER.unpack_from(data, pos)
+        pos += BLOCK_HEADER.size
+        if sync != b"BK" or pos + length > len(data):
+            raise ValueError("corrupt block at offset %d" % (pos - BLOCK_HEADER.size))
+        values = varints(data, pos)
+        pos += length
+
+        timestamps = [unwrap(first_us)]
+        delta = 0
+        for i in range(1, count):
+            delta = next(values) if i == 1 else delta + next(values)
+            timestamps.append(timestamps[-1] + delta)
+        last_us = timestamps[-1]
+
+        columns = []
+        for _ in CHANNELS:
+            column = [next(values)]
+            for _ in range(1, count):
+                column.append(column[-1] + next(values))
+            columns.append(column)
+
+        for i in range(count):
+            samples.append((timestamps[i],) + tuple(column[i] for column in columns))
+    events.sort(key=lambda event: event[0])
+    return info, samples, events
+
+
+def main(argv):
+    args = [a for a in argv[1:] if not a.startswith("--")]
+    raw = "--raw" in argv
+    only_events = "--events" in argv
+    if not args:
+        sys.exit(__doc__)
+
+    with open(args[0], "rb") as f:
+        data = f.read()
+    info, samples, events = decode(data)
+
+    accel_scale = info["accel_g"] / 32768.0
+    gyro_scale = info["gyro_dps"] / 32768.0
+    out = open(args[1], "w", newline="") if len(args) > 1 else sys.stdout
+    writer = csv.writer(out)
+    if only_events:
+        writer.writerow(("timestamp_us", "type", "a", "b", "c"))
+        writer.writerows(events)
+        samples = []
+    else:
+        writer.writerow(("timestamp_us",) + CHANNELS)
+    for sample in samples:
+        if raw:
+            writer.writerow(sample)
+        else:
+            writer.writerow((sample[0],) +
+                            tuple("%.5f" % (v * accel_scale) for v in sample[1:4]) +
+                            tuple("%.3f" % (v * gyro_scale) for v in sample[4:7]))
+    if out is not sys.stdout:
+        out.close()
+    if only_events:
+        sys.stderr.write("%d events\n" % len(events))
+    else:
+        sys.stderr.write("%d samples, %d events, %.2f bytes/sample\n" %
+                         (len(samples), len(events), len(data) / len(samples) if samples else 0))
+
+
+if __name__ == "__main__":
+    main(sys.argv)
@@ -0,0 +1,457 @@
+// Replays a recorded input trace (IMU samples, touch frames, button edges,
+// RTC interrupts) through the full firmware on the simulated board
+// (host/sim), as fast as the host runs it.
+//
+// Record on the watch with IMU_TRACE_RECORD=1, then copy IMU_TRACE_PATH
+// off LittleFS.
+//
+// Build (from the repository root):
+//   g++ -O2 -std=gnu++11 -pthread -DSIM_CUSTOM_MAIN -Isrc -Ihost/sim/include
+//       -Ihost/sim/src -o input_replay tools/input_replay.cpp
+//       $(find src host/sim/src -name '*.cpp')
+// Run:
+//   ./input_replay [--log] [--quiet] [--bus-hz HZ] imu_trace.bin
+//   ./input_replay [--log] [--quiet] [--bus-hz HZ] --demo
+//
+// --demo replays a built-in 40 s trace instead: three wrist raise, swipe,
+// wrist lower cycles with the arm hanging in between, then a BOOT press.
+// The watch is asleep before each raise, so this checks raise-to-wake: the
+// exit status is 1 unless every cycle gave one wrist raise and one lower.
+//
+// The firmware boots and settles on the simulated board, then the trace
+// is fed in at its recorded times: IMU samples become the QMI8658 model's
+// motion, so they reach ImuPipeline::dispatch() through the configured
+// FIFO or data-ready path and every configured stage; touch frames are
+// reported by the FT3168 model to TouchController; button edges drive the
+// GPIO; RTC interrupts set the PCF85063 flags. SystemManager::update()
+// handles all of it as on the watch.
+//
+// Prints the events the firmware reported (gestures, sleep, alarms) at
+// their trace time, then per-stage cost (host cycles per sample, summed
+// over the heartbeat reports), the I2C bus time of the replay, and the
+// replay speed against real time.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+#include "config.h"
+#include "sim/board.hpp"
+#include "sim/bus_report.hpp"
+#include "sim/i2c.hpp"
+#include "sim/sim.hpp"
+#include "system/imu/imu_trace.hpp"
+#include "system/system_manager.hpp"
+
+extern SystemManager* system_manager;
+
+namespace {
+    const size_t MAX_BLOCK = 1024;
+    const int64_t SETTLE_US = 5000000;      // Boot, WiFi join and first rate decision
+    const int64_t TAIL_US = 2000000;        // Let the detectors finish after the last input
+    const int64_t BUTTON_PRESS_US = 100000; // Traces record the press edge only
+
+    struct Sample {
+        int64_t t_us;   // From the start of the trace
+        int16_t axes[ImuTrace::CHANNELS];
+    };
+
+    struct Event {
+        int64_t t_us;
+        ImuTrace::Event event;
+    };
+
+    // Firmware log lines that report a detected event
+    struct Marker {
+        const char* text;
+        const char* name;
+        uint32_t count;
+    };
+
+    Marker markers[] = {
+        {"Wrist raise gesture", "wrist raise", 0},
+        {"Wrist lowered - sleep", "wrist lower", 0},
+        {"TOUCH: Gesture:", "touch gesture", 0},
+        {"ALARM TRIGGERED", "alarm", 0},
+        {"Entering light sleep mode", "sleep", 0},
+        {"Waking up from light sleep", "wake", 0},
+        {"Entering deep sleep", "deep sleep", 0},
+    };
+
+    // Pipeline stage cost; the heartbeat resets the stage counters, so its
+    // "Stage <name>: <n> samples, <c> cycles/sample" lines are summed up
+    struct StageCost {
+        std::string name;
+        uint64_t samples;
+        uint64_t cycles;
+    };
+
+    std::vector<StageCost> stage_costs;
+
+    void addStageCost(const char* name, uint64_t samples, uint64_t cycles) {
+        for (StageCost& cost : stage_costs) {
+            if (cost.name != name) continue;
+            cost.samples += samples;
+            cost.cycles += cycles;
+            return;
+        }
+        stage_costs.push_back({name, samples, cycles});
+    }
+
+    void parseStageLine(const char* line) {
+        const char* stage = strstr(line, "IMU: Stage ");
+        if (stage == nullptr) return;
+        char name[32];
+        unsigned long samples = 0, cycles = 0;
+        if (sscanf(stage, "IMU: Stage %31[^:]: %lu samples, %lu cycles/sample", name, &samples, &cycles) == 3) {
+            addStageCost(name, samples, (uint64_t)samples * cycles);
+        }
+    }
+
+    typedef std::chrono::steady_clock Clock;
+
+    bool readFile(const char* path, std::vector<uint8_t>& data) {
+        FILE* f = fopen(path, "rb");
+        if (f == nullptr) return false;
+        uint8_t chunk[4096];
+        size_t n;
+        while ((n = fread(chunk, 1, sizeof(chunk), f)) > 0) data.insert(data.end(), chunk, chunk + n);
+        fclose(f);
+        return true;
+    }
+
+    // Trace timestamps are 32-bit µs; times are kept relative to the first record
+    bool decode(const std::vector<uint8_t>& data, ImuTrace::Header& header, std::vector<Sample>& samples,
+                std::vector<Event>& events) {
+        ImuTrace::Reader reader(data.data(), data.size());
+        if (!reader.isValid()) return false;
+        header = reader.getHeader();
+
+        static uint32_t timestamps[MAX_BLOCK];
+        static int16_t columns[ImuTrace::CHANNELS][MAX_BLOCK];
+        int16_t* channels[ImuTrace::CHANNELS];
+        for (size_t c = 0; c < ImuTrace::CHANNELS; c++) channels[c] = columns[c];
+
+        ImuTrace::Reader::RecordType type;
+        ImuTrace::Event event;
+        size_t count = 0;
+        bool have_origin = false;
+        int64_t last_t = 0;
+        uint32_t last_stamp = 0;
+        auto relative = [&](uint32_t stamp) {
+            if (!have_origin) {
+                have_origin = true;
+                last_stamp = stamp;
+                return (int64_t)0;
+            }
+            // Unwrap against the previous record
+            last_t += (int32_t)(stamp - last_stamp);
+            last_stamp = stamp;
+            return last_t;
+        };
+
+        while (reader.next(type, event, timestamps, channels, MAX_BLOCK, count)) {
+            if (type == ImuTrace::Reader::EVENT) {
+                events.push_back({relative(event.timestamp_us), event});
+                continue;
+            }
+            for (size_t i = 0; i < count; i++) {
+                Sample s;
+                s.t_us = relative(timestamps[i]);
+                for (size_t c = 0; c < ImuTrace::CHANNELS; c++) s.axes[c] = columns[c][i];
+                samples.push_back(s);
+            }
+        }
+
+        // Events are written ahead of their block and may be earlier than
+        // samples already seen: shift everything so the earliest record is 0
+        int64_t first = 0;
+        if (!samples.empty()) first = samples[0].t_us;
+        for (const Event& e : events) first = std::min(first, e.t_us);
+        for (Sample& s : samples) s.t_us -= first;
+        for (Event& e : events) e.t_us -= first;
+        std::stable_sort(events.begin(), events.end(),
+                         [](const Event& a, const Event& b) { return a.t_us < b.t_us; });
+        return !reader.isCorrupt();
+    }
+
+    // Built-in trace: the arm hangs (gravity on -Y), is raised to face the
+    // user (+X/-Z) with some linear acceleration, swiped and lowered again
+    class DemoTrace {
+    public:
+        static constexpr uint32_t CYCLES = 3;
+
+        std::vector<uint8_t> build() {
+            for (uint32_t cycle = 0; cycle < CYCLES; cycle++) {
+                hold(4.0f);
+                move(0.6f, 0.5f, 0.0f, -0.866f);
+                hold(1.0f);
+                for (int frame = 0; frame <= 10; frame++) {
+                    event(ImuTrace::EVENT_TOUCH, now() + frame * 15000, frame < 10 ? 1 : 0, 300 - frame * 25, 200);
+                }
+                hold(2.0f);
+                move(0.6f, 0.0f, -1.0f, 0.0f);
+                hold(4.0f);
+            }
+            event(ImuTrace::EVENT_BUTTON, now(), BTN_BOOT, 0, 0);
+            hold(3.0f);
+            return encode();
+        }
+
+    private:
+        static constexpr uint32_t RATE_HZ = 128;
+        static constexpr uint32_t BLOCK = 256;
+        static constexpr float LSB_PER_G = 32768.0f / 8.0f;
+        static constexpr float LSB_PER_DPS = 32768.0f / 1024.0f;
+
+        std::vector<uint32_t> timestamps;
+        std::vector<int16_t> columns[ImuTrace::CHANNELS];
+        std::vector<ImuTrace::Event> events;
+        float gravity[3] = {0.0f, -1.0f, 0.0f};
+
+        uint32_t now() const { return (uint32_t)(timestamps.size() * 1000000ULL / RATE_HZ); }
+
+        void event(ImuTrace::EventType type, uint32_t t_us, int a, int b, int c) {
+            events.push_back({type, t_us, (int16_t)a, (int16_t)b, (int16_t)c});
+        }
+
+        void push(const float accel[3], const float rate_rad[3]) {
+            timestamps.push_back(now());
+            for (int i = 0; i < 3; i++) {
+                columns[i].push_back((int16_t)lrintf(accel[i] * LSB_PER_G));
+                columns[3 + i].push_back((int16_t)lrintf(rate_rad[i] * 57.29578f * LSB_PER_DPS));
+            }
+        }
+
+        void hold(float seconds) {
+            const float still[3] = {0.0f, 0.0f, 0.0f};
+            for (uint32_t i = 0; i < (uint32_t)(seconds * RATE_HZ); i++) push(gravity, still);
+        }
+
+        // Eased rotation of the gravity direction to the target; the body rate
+        // follows from it (dg/dt = g x w), the arm adds up to 0.3 g along the path
+        void move(float seconds, float x, float y, float z) {
+            float from[3] = {gravity[0], gravity[1], gravity[2]};
+            float to[3] = {x, y, z};
+            float angle = acosf(from[0] * to[0] + from[1] * to[1] + from[2] * to[2]);
+            uint32_t n = (uint32_t)(seconds * RATE_HZ);
+            float last[3] = {from[0], from[1], from[2]};
+            for (uint32_t i = 1; i <= n; i++) {
+                float u = 0.5f - 0.5f * cosf(3.14159265f * i / n);
+                float a = sinf((1.0f - u) * angle) / sinf(angle);
+                float b = sinf(u * angle) / sinf(angle);
+                float g[3], d[3], w[3], accel[3];
+                for (int k = 0; k < 3; k++) {
+                    g[k] = a * from[k] + b * to[k];
+                    d[k] = (g[k] - last[k]) * RATE_HZ;
+                    last[k] = g[k];
+                }
+                w[0] = d[1] * g[2] - d[2] * g[1];
+                w[1] = d[2] * g[0] - d[0] * g[2];
+                w[2] = d[0] * g[1] - d[1] * g[0];
+                float push_g = 0.3f * sinf(2.0f * 3.14159265f * i / n);
+                for (int k = 0; k < 3; k++) accel[k] = g[k] + push_g * (to[k] - from[k]);
+                push(accel, w);
+            }
+            for (int k = 0; k < 3; k++) gravity[k] = to[k];
+        }
+
+        std::vector<uint8_t> encode() {
+            std::vector<uint8_t> out(ImuTrace::HEADER_BYTES);
+            ImuTrace::Header header = {8, 1024, RATE_HZ, BLOCK};
+            ImuTrace::encodeHeader(header, out.data());
+            size_t next_event = 0;
+            for (size_t first = 0; first < timestamps.size(); first += BLOCK) {
+                size_t count = std::min((size_t)BLOCK, timestamps.size() - first);
+                // Events go ahead of the block that was open when they happened
+                while (next_event < events.size() && events[next_event].timestamp_us <= timestamps[first + count - 1]) {
+                    uint8_t record[ImuTrace::EVENT_BYTES];
+                    ImuTrace::encodeEvent(events[next_event++], record);
+                    out.insert(out.end(), record, record + sizeof(record));
+                }
+                const int16_t* channels[ImuTrace::CHANNELS];
+                for (size_t c = 0; c < ImuTrace::CHANNELS; c++) channels[c] = &columns[c][first];
+                std::vector<uint8_t> block(ImuTrace::BLOCK_HEADER_BYTES + ImuTrace::maxPayloadBytes(count));
+                size_t len = ImuTrace::encodeBlock(&timestamps[first], channels, count, block.data());
+                out.insert(out.end(), block.begin(), block.begin() + len);
+            }
+            for (; next_event < events.size(); next_event++) {
+                uint8_t record[ImuTrace::EVENT_BYTES];
+                ImuTrace::encodeEvent(events[next_event], record);
+                out.insert(out.end(), record, record + sizeof(record));
+            }
+            return out;
+        }
+    };
+
+    // The sample in effect at trace time t (zero-order hold)
+    const Sample& sampleAt(const std::vector<Sample>& samples, int64_t t_us) {
+        auto later = std::upper_bound(samples.begin(), samples.end(), t_us,
+                                      [](int64_t t, const Sample& s) { return t < s.t_us; });
+        return later == samples.begin() ? *later : *(later - 1);
+    }
+
+    void deliver(const ImuTrace::Event& event) {
+        switch (event.type) {
+            case ImuTrace::EVENT_TOUCH:
+                sim::board::touch().frame((uint8_t)event.a, (uint16_t)event.b, (uint16_t)event.c);
+                break;
+            case ImuTrace::EVENT_BUTTON:
+                if (event.b == 0) sim::board::pressButton(event.a, BUTTON_PRESS_US);
+                break;
+            case ImuTrace::EVENT_RTC:
+                sim::board::rtc().raiseFlags((event.a & ImuTrace::RTC_ALARM) != 0,
+                                             (event.a & (ImuTrace::RTC_TIMER | ImuTrace::RTC_MINUTE)) != 0);
+                break;
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    const char* path = nullptr;
+    bool demo = false;
+    bool log = false;
+    bool quiet = false;
+    uint32_t bus_hz = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--log") == 0) {
+            log = true;
+        } else if (strcmp(argv[i], "--quiet") == 0) {
+            quiet = true;
+        } else if (strcmp(argv[i], "--demo") == 0) {
+            demo = true;
+        } else if (strcmp(argv[i], "--bus-hz") == 0 && i + 1 < argc) {
+            bus_hz = (uint32_t)atol(argv[++i]);
+        } else {
+            path = argv[i];
+        }
+    }
+    if (path == nullptr && !demo) {
+        fprintf(stderr, "usage: %s [--log] [--quiet] [--bus-hz HZ] (trace.bin | --demo)\n", argv[0]);
+        return 1;
+    }
+
+    std::vector<uint8_t> data;
+    ImuTrace::Header header = {};
+    std::vector<Sample> samples;
+    std::vector<Event> events;
+    if (demo) {
+        path = "demo";
+        data = DemoTrace().build();
+    } else if (!readFile(path, data)) {
+        fprintf(stderr, "cannot read %s\n", path);
+        return 1;
+    }
+    if (!decode(data, header, samples, events)) {
+        fprintf(stderr, "%s: invalid or truncated trace, replaying what was decoded\n", path);
+    }
+    if (samples.empty()) {
+        fprintf(stderr, "%s: no IMU samples\n", path);
+        return 1;
+    }
+
+    if (bus_hz) sim::i2c::setClockOverride(bus_hz);
+    sim::console::setEcho(log);
+
+    // The trace starts after the firmware has settled; hold its first sample until then
+    const int64_t start_us = SETTLE_US;
+    float accel_scale = (header.accel_range_g ? header.accel_range_g : 8) / 32768.0f;
+    float gyro_scale = (header.gyro_range_dps ? header.gyro_range_dps : 1024) / 32768.0f;
+    sim::board::imu().setMotion([&samples, accel_scale, gyro_scale, start_us](int64_t t_us) {
+        const Sample& s = sampleAt(samples, t_us - start_us);
+        sim::board::Motion m;
+        m.ax = s.axes[0] * accel_scale;
+        m.ay = s.axes[1] * accel_scale;
+        m.az = s.axes[2] * accel_scale;
+        m.gx = s.axes[3] * gyro_scale;
+        m.gy = s.axes[4] * gyro_scale;
+        m.gz = s.axes[5] * gyro_scale;
+        return m;
+    });
+
+    bool replaying = false;
+    sim::console::onLine([&replaying, quiet, start_us](const char* line) {
+        if (!replaying) return;
+        parseStageLine(line);
+        for (Marker& marker : markers) {
+            if (strstr(line, marker.text) == nullptr) continue;
+            marker.count++;
+            if (!quiet) printf("[%9.3f s] %s\n", (sim::now() - start_us) / 1e6, line);
+            break;
+        }
+    });
+
+    sim::run(start_us);
+    if (system_manager == nullptr || !system_manager->isInitialized()) {
+        fprintf(stderr, "firmware did not start\n");
+        return 1;
+    }
+
+    // Stage statistics and the bus report cover the replay only
+    ImuPipeline& pipeline = system_manager->getImuPipeline();
+    for (size_t i = 0; i < pipeline.getStageCount(); i++) pipeline.getStage(i)->resetStats();
+    uint32_t pipeline_start = pipeline.getSampleCount();
+    uint32_t model_start = sim::board::imu().getSampleCount();
+    sim::BusReport bus;
+    bus.start();
+    replaying = true;
+
+    for (const Event& e : events) {
+        ImuTrace::Event event = e.event;
+        sim::at(start_us + e.t_us, [event] { deliver(event); });
+    }
+
+    int64_t trace_us = samples.back().t_us;
+    if (!events.empty()) trace_us = std::max(trace_us, events.back().t_us);
+    Clock::time_point wall_start = Clock::now();
+    sim::run(start_us + trace_us + TAIL_US);
+    double wall_s = std::chrono::duration<double>(Clock::now() - wall_start).count();
+
+    // A deep sleep restart builds a new SystemManager: read the stages from the live one
+    ImuPipeline& live = system_manager->getImuPipeline();
+    uint32_t dispatched = live.getSampleCount() - (&live == &pipeline ? pipeline_start : 0);
+    double trace_s = trace_us / 1e6;
+
+    printf("\n%zu samples, %zu events, %.1f s of input replayed in %.3f s (%.0fx real time)\n", samples.size(),
+           events.size(), trace_s, wall_s, wall_s > 0 ? (trace_s + TAIL_US / 1e6) / wall_s : 0.0);
+    printf("IMU: %u samples produced by the sensor, %u dispatched through %zu stages (%s)\n",
+           sim::board::imu().getSampleCount() - model_start, dispatched, live.getStageCount(),
+           IMU_USE_FIFO ? "FIFO" : "data ready");
+    printf("events:");
+    for (const Marker& marker : markers) printf(" %u %s,", marker.count, marker.name);
+    printf(" %u deep sleep resets\n", sim::getResetCount());
+
+    // Add what the stages counted since the last heartbeat
+    for (size_t i = 0; i < live.getStageCount(); i++) {
+        ImuStage* stage = live.getStage(i);
+        addStageCost(stage->name(), stage->getSampleCount(),
+                     (uint64_t)stage->getSampleCount() * stage->getAverageCycles());
+    }
+    printf("stage          samples  host cycles/sample\n");
+    for (const StageCost& cost : stage_costs) {
+        printf("  %-12s %8llu %10llu\n", cost.name.c_str(), (unsigned long long)cost.samples,
+               (unsigned long long)(cost.samples ? cost.cycles / cost.samples : 0));
+    }
+    printf("I2C: %u loop() passes, %.2f ms bus time, %.1f us/loop\n", bus.getLoops(),
+           bus.getTotal().bus_ns / 1e6, bus.getBusUsPerLoop());
+
+    int status = 0;
+    if (demo) {
+        uint32_t raises = markers[0].count;
+        uint32_t lowers = markers[1].count;
+        bool ok = raises == DemoTrace::CYCLES && lowers == DemoTrace::CYCLES;
+        printf("demo check: %u/%u wrist raises, %u/%u wrist lowers: %s\n", raises, DemoTrace::CYCLES, lowers,
+               DemoTrace::CYCLES, ok ? "ok" : "FAILED");
+        status = ok ? 0 : 1;
+    }
+    fflush(stdout);
+    _exit(status);  // Firmware tasks stay blocked in their threads
+}
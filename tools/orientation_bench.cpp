@@ -0,0 +1,238 @@
+// Runs both orientation filters (float MahonyFilter, fixed-point
+// MahonyFilterQ) on the host over synthetic motion with a known attitude,
+// and optionally over recorded traces.
+//
+// Build (from the repository root):
+//   g++ -O2 -std=gnu++11 -Isrc -o orientation_bench tools/orientation_bench.cpp
+//       src/system/imu/orientation_filter.cpp src/system/imu/imu_trace.cpp
+// Run:
+//   ./orientation_bench [imu_trace.bin ...]
+//
+// For each scenario it reports the host ns per update of each filter, the
+// worst gravity error against the true attitude (synthetic scenarios only,
+// after a 1 s settle) and the worst gravity deviation between the two
+// filters. On the watch, ORIENTATION_FILTER_COMPARE puts the cycles per
+// update of both versions in the IMU heartbeat.
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+#include "system/imu/imu_trace.hpp"
+#include "system/imu/orientation_filter.hpp"
+
+namespace {
+    const uint32_t RATE_HZ = 128;
+    const uint32_t DT_US = 1000000 / RATE_HZ;
+    const float ACCEL_LSB_PER_G = 32768.0f / 8.0f;
+    const float GYRO_LSB_PER_DPS = 32768.0f / 1024.0f;
+    const float PI_F = 3.14159265f;
+    const size_t SETTLE_SAMPLES = RATE_HZ;
+    const int TIMING_PASSES = 50;
+    const size_t MAX_BLOCK = 1024;
+
+    struct Sample {
+        uint32_t dt_us;
+        int16_t accel[3];
+        int16_t gyro[3];
+        float gravity[3];   // True gravity direction, sensor frame
+        bool known;
+    };
+
+    struct Result {
+        double float_ns = 0.0;
+        double fixed_ns = 0.0;
+        float float_error = 0.0f;
+        float fixed_error = 0.0f;
+        float deviation = 0.0f;
+    };
+
+    typedef std::chrono::steady_clock Clock;
+
+    int16_t toRaw(float value, float scale) {
+        float raw = value * scale;
+        if (raw > 32767.0f) raw = 32767.0f;
+        if (raw < -32768.0f) raw = -32768.0f;
+        return (int16_t)lrintf(raw);
+    }
+
+    // Rotation about X at the given rate with optional linear acceleration
+    // along Y; gravity in the sensor frame is (0, sin a, cos a) at angle a
+    void roll(std::vector<Sample>& out, float seconds, float dps, float swing_g, float swing_hz) {
+        float angle = 0.0f;
+        size_t n = (size_t)(seconds * RATE_HZ);
+        for (size_t i = 0; i < n; i++) {
+            float t = (float)i / RATE_HZ;
+            Sample s = {};
+            s.dt_us = DT_US;
+            s.gravity[0] = 0.0f;
+            s.gravity[1] = sinf(angle);
+            s.gravity[2] = cosf(angle);
+            float linear = swing_g * sinf(2.0f * PI_F * swing_hz * t);
+            s.accel[0] = 0;
+            s.accel[1] = toRaw(s.gravity[1] + linear, ACCEL_LSB_PER_G);
+            s.accel[2] = toRaw(s.gravity[2], ACCEL_LSB_PER_G);
+            s.gyro[0] = toRaw(dps, GYRO_LSB_PER_DPS);
+            s.known = true;
+            out.push_back(s);
+            angle += dps * PI_F / 180.0f / RATE_HZ;
+        }
+    }
+
+    // Arm raise: 0 -> 80 deg about X over 0.4 s with a smooth rate profile, hold, lower
+    void wristRaise(std::vector<Sample>& out, int repeats) {
+        for (int r = 0; r < repeats; r++) {
+            float angle = 0.0f;
+            for (int phase = 0; phase < 4; phase++) {
+                float seconds = (phase % 2 == 0) ? 0.4f : 1.0f;
+                float sign = phase == 0 ? 1.0f : (phase == 2 ? -1.0f : 0.0f);
+                size_t n = (size_t)(seconds * RATE_HZ);
+                for (size_t i = 0; i < n; i++) {
+                    float t = (float)i / n;
+                    // Raised-cosine rate profile integrating to 80 deg
+                    float dps = sign * 80.0f / seconds * (1.0f - cosf(2.0f * PI_F * t));
+                    Sample s = {};
+                    s.dt_us = DT_US;
+                    s.gravity[1] = sinf(angle);
+                    s.gravity[2] = cosf(angle);
+                    s.accel[1] = toRaw(s.gravity[1], ACCEL_LSB_PER_G);
+                    s.accel[2] = toRaw(s.gravity[2], ACCEL_LSB_PER_G);
+                    s.gyro[0] = toRaw(dps, GYRO_LSB_PER_DPS);
+                    s.known = true;
+                    out.push_back(s);
+                    angle += dps * PI_F / 180.0f / RATE_HZ;
+                }
+            }
+        }
+    }
+
+    bool readTrace(const char* path, std::vector<Sample>& out) {
+        FILE* f = fopen(path, "rb");
+        if (f == nullptr) return false;
+        std::vector<uint8_t> data;
+        uint8_t chunk[4096];
+        size_t n;
+        while ((n = fread(chunk, 1, sizeof(chunk), f)) > 0) data.insert(data.end(), chunk, chunk + n);
+        fclose(f);
+
+        ImuTrace::Reader reader(data.data(), data.size());
+        if (!reader.isValid()) return false;
+        static uint32_t timestamps[MAX_BLOCK];
+        static int16_t columns[ImuTrace::CHANNELS][MAX_BLOCK];
+        int16_t* channels[ImuTrace::CHANNELS];
+        for (size_t c = 0; c < ImuTrace::CHANNELS; c++) channels[c] = columns[c];
+
+        ImuTrace::Reader::RecordType type;
+        ImuTrace::Event event;
+        size_t count = 0;
+        bool first = true;
+        uint32_t last_us = 0;
+        while (reader.next(type, event, timestamps, channels, MAX_BLOCK, count)) {
+            if (type != ImuTrace::Reader::BLOCK) continue;
+            for (size_t i = 0; i < count; i++) {
+                Sample s = {};
+                s.dt_us = first ? DT_US : timestamps[i] - last_us;
+                for (int a = 0; a < 3; a++) {
+                    s.accel[a] = columns[a][i];
+                    s.gyro[a] = columns[3 + a][i];
+                }
+                out.push_back(s);
+                last_us = timestamps[i];
+                first = false;
+            }
+        }
+        return !reader.isCorrupt();
+    }
+
+    // Angle between two directions; atan2 stays accurate near zero and ignores length
+    float angleError(const float a[3], const float b[3]) {
+        float cx = a[1] * b[2] - a[2] * b[1];
+        float cy = a[2] * b[0] - a[0] * b[2];
+        float cz = a[0] * b[1] - a[1] * b[0];
+        float dot = a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+        return atan2f(sqrtf(cx * cx + cy * cy + cz * cz), dot) * 180.0f / PI_F;
+    }
+
+    template <typename Filter>
+    double timeFilter(const std::vector<Sample>& samples) {
+        Filter filter;
+        Clock::time_point start = Clock::now();
+        for (int pass = 0; pass < TIMING_PASSES; pass++) {
+            filter.reset();
+            for (const Sample& s : samples) filter.update(s.accel, s.gyro, s.dt_us);
+        }
+        double ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+        float q[4];
+        filter.getQuaternion(q);  // Keeps the loop from being optimized away
+        if (q[0] != q[0]) printf("nan\n");
+        return ns / ((double)samples.size() * TIMING_PASSES);
+    }
+
+    Result run(const std::vector<Sample>& samples) {
+        Result result;
+        MahonyFilter float_filter;
+        MahonyFilterQ fixed_filter;
+        for (size_t i = 0; i < samples.size(); i++) {
+            const Sample& s = samples[i];
+            float_filter.update(s.accel, s.gyro, s.dt_us);
+            fixed_filter.update(s.accel, s.gyro, s.dt_us);
+            float gf[3], gq[3];
+            float_filter.getGravity(gf);
+            fixed_filter.getGravity(gq);
+            for (int a = 0; a < 3; a++) {
+                float deviation = fabsf(gf[a] - gq[a]);
+                if (deviation > result.deviation) result.deviation = deviation;
+            }
+            if (!s.known || i < SETTLE_SAMPLES) continue;
+            float ef = angleError(gf, s.gravity);
+            float eq = angleError(gq, s.gravity);
+            if (ef > result.float_error) result.float_error = ef;
+            if (eq > result.fixed_error) result.fixed_error = eq;
+        }
+        result.float_ns = timeFilter<MahonyFilter>(samples);
+        result.fixed_ns = timeFilter<MahonyFilterQ>(samples);
+        return result;
+    }
+
+    void report(const char* name, const std::vector<Sample>& samples) {
+        Result r = run(samples);
+        if (samples.empty() || !samples[0].known) {
+            printf("%-20s %6zu %8.1f %8.1f %9s %9s %10.5f\n", name, samples.size(), r.float_ns, r.fixed_ns, "-", "-",
+                   r.deviation);
+        } else {
+            printf("%-20s %6zu %8.1f %8.1f %9.2f %9.2f %10.5f\n", name, samples.size(), r.float_ns, r.fixed_ns,
+                   r.float_error, r.fixed_error, r.deviation);
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    printf("%-20s %6s %8s %8s %9s %9s %10s\n", "scenario", "n", "float", "fixed", "float", "fixed", "deviation");
+    printf("%-20s %6s %8s %8s %9s %9s %10s\n", "", "", "ns/upd", "ns/upd", "err deg", "err deg", "gravity");
+
+    std::vector<Sample> samples;
+    roll(samples, 10.0f, 0.0f, 0.0f, 0.0f);
+    report("still", samples);
+
+    samples.clear();
+    roll(samples, 8.0f, 90.0f, 0.0f, 0.0f);
+    report("roll 90 dps", samples);
+
+    samples.clear();
+    roll(samples, 8.0f, 30.0f, 0.5f, 2.0f);
+    report("roll + 0.5 g swing", samples);
+
+    samples.clear();
+    wristRaise(samples, 5);
+    report("wrist raise x5", samples);
+
+    for (int i = 1; i < argc; i++) {
+        samples.clear();
+        if (!readTrace(argv[i], samples)) {
+            fprintf(stderr, "%s: invalid or truncated trace, using what was decoded\n", argv[i]);
+        }
+        if (!samples.empty()) report(argv[i], samples);
+    }
+    return 0;
+}
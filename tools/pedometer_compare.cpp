@@ -0,0 +1,240 @@
+// Compares the two step counter backends on the simulated board: the
+// QMI8658 on-chip pedometer (the sensor model's step engine, configured by
+// the firmware) and the software StepCounterStage, over synthetic walks
+// with a known step count.
+//
+// Build (from the repository root):
+//   g++ -O2 -std=gnu++11 -pthread -DSIM_CUSTOM_MAIN -Isrc -Ihost/sim/include
+//       -Ihost/sim/src -o pedometer_compare tools/pedometer_compare.cpp
+//       $(find src host/sim/src -name '*.cpp')
+// Run:
+//   ./pedometer_compare [--log] [--awake]
+//
+// The firmware boots and settles, then a StepCounterStage owned by this
+// tool joins its IMU pipeline, so both backends see the same motion at
+// whatever rate the firmware runs the sensor (the rate governor drops to
+// 21Hz between bouts and the host may sleep). Each bout is separated by
+// still time. The chip count is STEP_CNT as the firmware reads it.
+//
+// The arm hangs by default, so the watch sleeps through most of each walk
+// and the software backend counts from the wake history the IMU keeps
+// meanwhile (the host wakes briefly to drain it before it fills). --awake
+// holds the watch face up and taps the screen every few seconds. Only a
+// wrist raise resets the idle timer, so the host still sleeps (idle timeout,
+// lowered wrist), but each tap wakes it again: it is up for most of each
+// walk and this mostly compares the two detectors themselves.
+//
+// Prints per bout the true steps, both counts and their error, and the
+// sensor ODR when the bout started.
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include <unistd.h>
+
+#include "config.h"
+#include "sim/board.hpp"
+#include "sim/sim.hpp"
+#include "system/imu/pedometer.hpp"
+#include "system/system_manager.hpp"
+
+extern SystemManager* system_manager;
+
+namespace {
+    const int64_t SETTLE_US = 5000000;
+    const int64_t REST_US = 10000000;        // Still between bouts: the governor drops the rate
+    const int64_t UPDATE_US = 500000;        // StepCounterStage::update() period, as the main loop
+    const int64_t TAP_US = 5000000;          // --awake: a screen tap this often
+    const float PI_F = 3.14159265f;
+
+    enum Kind { WALK, GESTURES, TREMOR };
+
+    struct Bout {
+        const char* name;
+        Kind kind;
+        float seconds;
+        float steps_per_min;
+        float bounce_g;     // Vertical acceleration per foot strike
+        float swing_deg;    // Arm swing amplitude (one period per two steps)
+    };
+
+    const Bout BOUTS[] = {
+        {"slow walk",      WALK,     60.0f,  80.0f, 0.18f, 15.0f},
+        {"walk",           WALK,     60.0f, 110.0f, 0.30f, 25.0f},
+        {"brisk walk",     WALK,     60.0f, 130.0f, 0.40f, 30.0f},
+        {"run",            WALK,     30.0f, 165.0f, 0.80f, 45.0f},
+        {"wrist gestures", GESTURES, 30.0f,   0.0f, 0.00f,  0.0f},
+        {"typing tremor",  TREMOR,   30.0f,   0.0f, 0.05f,  0.0f},
+    };
+    const size_t BOUT_COUNT = sizeof(BOUTS) / sizeof(BOUTS[0]);
+
+    struct Result {
+        uint32_t truth;
+        uint32_t chip;
+        uint32_t software;
+        double odr_hz;
+    };
+
+    // Deterministic sensor-independent noise, +-amplitude
+    float noise(uint32_t& seed, float amplitude) {
+        seed = seed * 1664525u + 1013904223u;
+        return ((seed >> 8) / 8388608.0f - 1.0f) * amplitude;
+    }
+
+    // Arm hanging (gravity along -y) with the bout's motion t seconds in
+    sim::board::Motion boutMotion(const Bout& bout, float t, uint32_t& seed) {
+        sim::board::Motion m = {0.0f, -1.0f, 0.0f, 0.0f, 0.0f, 0.0f};
+        switch (bout.kind) {
+            case WALK: {
+                float f = bout.steps_per_min / 60.0f;
+                float swing = bout.swing_deg * PI_F / 180.0f;
+                float angle = swing * sinf(PI_F * f * t);
+                // Foot strike: a sharp upward pulse, zero mean over the step
+                float phase = 2.0f * PI_F * f * t;
+                float strike = bout.bounce_g * (sinf(phase) + 0.35f * sinf(2.0f * phase + 0.6f));
+                m.ay = -cosf(angle) + strike;
+                m.az = sinf(angle) + 0.1f * bout.bounce_g * cosf(phase);
+                m.gx = bout.swing_deg * PI_F * f * cosf(PI_F * f * t);
+                break;
+            }
+            case GESTURES: {
+                // Raise to the face over 0.6 s, hold 2 s, lower, every 5 s
+                float cycle = fmodf(t, 5.0f);
+                float u = 0.0f;
+                float rate = 0.0f;
+                if (cycle < 0.6f) {
+                    u = 0.5f - 0.5f * cosf(PI_F * cycle / 0.6f);
+                    rate = 90.0f * 0.5f * PI_F / 0.6f * sinf(PI_F * cycle / 0.6f);
+                } else if (cycle < 2.6f) {
+                    u = 1.0f;
+                } else if (cycle < 3.2f) {
+                    u = 0.5f + 0.5f * cosf(PI_F * (cycle - 2.6f) / 0.6f);
+                    rate = -90.0f * 0.5f * PI_F / 0.6f * sinf(PI_F * (cycle - 2.6f) / 0.6f);
+                }
+                float angle = u * PI_F / 2.0f;
+                m.ay = -cosf(angle);
+                m.az = -sinf(angle);
+                m.gx = -rate;
+                break;
+            }
+            case TREMOR:
+                m.ax = bout.bounce_g * sinf(2.0f * PI_F * 6.0f * t);
+                m.az = 0.5f * bout.bounce_g * sinf(2.0f * PI_F * 9.0f * t);
+                break;
+        }
+        m.ax += noise(seed, 0.01f);
+        m.ay += noise(seed, 0.01f);
+        m.az += noise(seed, 0.01f);
+        return m;
+    }
+
+    // Bout i runs from boutStart(i) for its duration, after REST_US still
+    int64_t boutStart(size_t index) {
+        int64_t start = SETTLE_US + REST_US;
+        for (size_t i = 0; i < index; i++) start += (int64_t)(BOUTS[i].seconds * 1e6) + REST_US;
+        return start;
+    }
+
+    // Rotation about X by 90 degrees: the hanging arm becomes face up
+    sim::board::Motion faceUp(const sim::board::Motion& m) {
+        sim::board::Motion r = {m.ax, m.az, -m.ay, m.gx, m.gz, -m.gy};
+        return r;
+    }
+
+    StepCounterStage software;
+
+    void scheduleTap(int64_t when_us) {
+        sim::at(when_us, [when_us] {
+            sim::board::touch().press(233, 233, 50000);
+            scheduleTap(when_us + TAP_US);
+        });
+    }
+
+    void scheduleUpdate(int64_t when_us) {
+        sim::at(when_us, [when_us] {
+            software.update((uint32_t)(when_us / 1000));
+            scheduleUpdate(when_us + UPDATE_US);
+        });
+    }
+}
+
+int main(int argc, char** argv) {
+    bool log = false;
+    bool awake = false;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--log") == 0) {
+            log = true;
+        } else if (strcmp(argv[i], "--awake") == 0) {
+            awake = true;
+        } else {
+            fprintf(stderr, "usage: %s [--log] [--awake]\n", argv[0]);
+            return 1;
+        }
+    }
+    sim::console::setEcho(log);
+
+    uint32_t seed = 1;
+    sim::board::imu().setMotion([&seed, awake](int64_t t_us) {
+        sim::board::Motion m = {noise(seed, 0.005f), -1.0f + noise(seed, 0.005f), noise(seed, 0.005f),
+                                0.0f, 0.0f, 0.0f};
+        for (size_t i = 0; i < BOUT_COUNT; i++) {
+            int64_t start = boutStart(i);
+            if (t_us >= start && t_us < start + (int64_t)(BOUTS[i].seconds * 1e6)) {
+                m = boutMotion(BOUTS[i], (t_us - start) / 1e6f, seed);
+            }
+        }
+        return awake ? faceUp(m) : m;
+    });
+
+    sim::run(SETTLE_US);
+    if (system_manager == nullptr || !system_manager->isInitialized()) {
+        fprintf(stderr, "firmware did not start\n");
+        return 1;
+    }
+    if (!system_manager->getImuPipeline().addStage(software)) {
+        fprintf(stderr, "no free pipeline stage\n");
+        return 1;
+    }
+    // As the firmware does for its own software backend
+    system_manager->getIMU().setWakeHistoryInterrupt(true);
+    scheduleUpdate(sim::now() + UPDATE_US);
+    if (awake) scheduleTap(sim::now() + TAP_US);
+
+    std::vector<Result> results;
+    for (size_t i = 0; i < BOUT_COUNT; i++) {
+        const Bout& bout = BOUTS[i];
+        int64_t start = boutStart(i);
+        sim::run(start);
+
+        Result r;
+        r.truth = (uint32_t)(bout.seconds * bout.steps_per_min / 60.0f + 0.5f);
+        r.odr_hz = sim::board::imu().getOutputRateHz();
+        uint32_t chip_start = sim::board::imu().getStepCount();
+        uint32_t software_start = software.steps();
+
+        // The rest after the bout lets both backends finish the last steps
+        sim::run(start + (int64_t)(bout.seconds * 1e6) + REST_US);
+        r.chip = (sim::board::imu().getStepCount() - chip_start) & 0xFFFFFF;
+        r.software = software.steps() - software_start;
+        results.push_back(r);
+    }
+
+    printf("%-16s %6s %8s %6s %8s %8s %8s\n", "bout", "truth", "qmi8658", "err", "software", "err", "odr");
+    uint32_t total[3] = {0, 0, 0};
+    for (size_t i = 0; i < results.size(); i++) {
+        const Result& r = results[i];
+        total[0] += r.truth;
+        total[1] += r.chip;
+        total[2] += r.software;
+        printf("%-16s %6u %8u %+6d %8u %+8d %6.0fHz\n", BOUTS[i].name, r.truth, r.chip,
+               (int)r.chip - (int)r.truth, r.software, (int)r.software - (int)r.truth, r.odr_hz);
+    }
+    printf("%-16s %6u %8u %+5.1f%% %8u %+7.1f%%\n", "total", total[0], total[1],
+           100.0 * ((double)total[1] - total[0]) / total[0], total[2],
+           100.0 * ((double)total[2] - total[0]) / total[0]);
+    fflush(stdout);
+    _exit(0);  // Firmware tasks stay blocked in their threads
+}